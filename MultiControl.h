@@ -22,6 +22,114 @@ int multiControlAnyButtonPressed = 0;
 int multiControlAnyPressed = 0;
 float MAX_10_INV = 0.0009765625f;
 
+// Optional input latency tracing. Define MULTICONTROL_TRACE before including this file.
+// Each control logs, with micros() timestamps, the first raw change it sees, the moment its
+// debounced / hysteresis state flips, and the moment the app consumes the result.
+// Dump the ring with multiControlTraceDump(Serial) and convert it with extras/mctrace.py.
+#define MC_TRACE_RAW 0      // first raw change (value = raw level or delta)
+#define MC_TRACE_STATE 1    // debounced state or output value changed
+#define MC_TRACE_CONSUME 2  // app read a changed state or value
+#define MC_TRACE_GESTURE 3  // app read a gesture event (value = MC_TRACE_EVENT_*)
+#define MC_TRACE_EVENT_SINGLE 1
+#define MC_TRACE_EVENT_DOUBLE 2
+#define MC_TRACE_EVENT_HOLD 3
+#define MC_TRACE_EVENT_LONG 4
+
+// Gesture event bits returned by takeGestureEvents()
+#define MC_GESTURE_PRESS 0x01
+#define MC_GESTURE_RELEASE 0x02
+#define MC_GESTURE_DOUBLE 0x04
+#define MC_GESTURE_SINGLE 0x08
+#define MC_GESTURE_HOLD 0x10
+#define MC_GESTURE_LONG 0x20
+#define MC_GESTURE_PROVISIONAL 0x40  // speculative single click (see setSpeculativeClick())
+#define MC_GESTURE_CANCEL 0x80       // the speculative click became a double-click
+
+// Consumers of takeGestureEvents(): each takes its own copy of the events
+#define MC_CONSUMER_APP 0     // the sketch (the default)
+#define MC_CONSUMER_TASKS 1   // MultiControlTasks
+#define MC_CONSUMER_STREAM 2  // MultiControlStream
+#define MC_CONSUMER_OTHER 3   // free for another output stage
+
+// Button debounce modes for setDebounceMode()
+#define MC_DEBOUNCE_STABLE 0  // accept a level once it has been stable for the debounce time
+#define MC_DEBOUNCE_EAGER 1   // accept the first edge at once, then ignore edges for the debounce time
+
+#ifdef MULTICONTROL_TRACE
+#ifndef MULTICONTROL_TRACE_SIZE
+#define MULTICONTROL_TRACE_SIZE 256  // records in the ring (8 bytes each)
+#endif
+struct MultiControlTraceRecord {
+  uint32_t micros;
+  uint8_t id;     // control trace id
+  uint8_t kind;   // MC_TRACE_*
+  int16_t value;
+};
+MultiControlTraceRecord multiControlTraceRing[MULTICONTROL_TRACE_SIZE];
+uint16_t multiControlTraceHead = 0;   // next slot to write
+uint32_t multiControlTraceTotal = 0;  // records written since the last clear
+
+inline void multiControlTrace(uint8_t id, uint8_t kind, int16_t value) {
+  MultiControlTraceRecord& r = multiControlTraceRing[multiControlTraceHead];
+  r.micros = micros();
+  r.id = id;
+  r.kind = kind;
+  r.value = value;
+  multiControlTraceHead = (multiControlTraceHead + 1) % MULTICONTROL_TRACE_SIZE;
+  multiControlTraceTotal++;
+}
+
+inline void multiControlTraceClear() {
+  multiControlTraceHead = 0;
+  multiControlTraceTotal = 0;
+}
+
+/* Write the ring, oldest first, as a compact binary stream:
+ * "MCTR", version (1), 0, record count (uint16), then 8-byte little-endian records
+ * (uint32 micros, uint8 id, uint8 kind, int16 value). */
+inline void multiControlTraceDump(Print& out) {
+  uint16_t count = multiControlTraceTotal < MULTICONTROL_TRACE_SIZE ? multiControlTraceTotal : MULTICONTROL_TRACE_SIZE;
+  uint16_t start = (multiControlTraceHead + MULTICONTROL_TRACE_SIZE - count) % MULTICONTROL_TRACE_SIZE;
+  uint8_t header[8] = {'M', 'C', 'T', 'R', 1, 0, (uint8_t)(count & 0xFF), (uint8_t)(count >> 8)};
+  out.write(header, 8);
+  for (uint16_t i = 0; i < count; i++) {
+    const MultiControlTraceRecord& r = multiControlTraceRing[(start + i) % MULTICONTROL_TRACE_SIZE];
+    uint8_t b[8] = {(uint8_t)r.micros, (uint8_t)(r.micros >> 8), (uint8_t)(r.micros >> 16), (uint8_t)(r.micros >> 24),
+                    r.id, r.kind, (uint8_t)r.value, (uint8_t)((uint16_t)r.value >> 8)};
+    out.write(b, 8);
+  }
+}
+#define MC_TRACE(kind, value) multiControlTrace(getTraceId(), kind, value)
+#define MC_TRACE_REPORT(value) traceReport(value)
+#else
+#define MC_TRACE(kind, value) do {} while (0)
+#define MC_TRACE_REPORT(value) do {} while (0)
+#endif
+
+// Raw input hooks. Define MULTICONTROL_CAPTURE before including this file to record every
+// raw read (see MultiControlCapture.h) or to replay a recording through the library.
+#ifdef MULTICONTROL_CAPTURE
+#include "MultiControlCapture.h"
+#else
+#define MC_DIGITAL_READ(pin) digitalRead(pin)
+#define MC_ANALOG_READ(pin) analogRead(pin)
+#define MC_TOUCH_READ(pin) touchRead(pin)
+#define MC_MILLIS() millis()
+#define MC_MICROS() micros()
+#endif
+
+// Pot smoothing filter used by readPot(). Define MULTICONTROL_POT_FILTER before including
+// this file to choose one; the sticky edges, hysteresis and bank latching are shared.
+#define MC_POT_FILTER_RESPONSIVE 0  // adaptive snap filter that sleeps at rest (default)
+#define MC_POT_FILTER_ONE_EURO 1    // One-Euro filter, cutoff rises with speed; uses real sample times
+#define MC_POT_FILTER_EMA 2         // plain exponential moving average
+#ifndef MULTICONTROL_POT_FILTER
+#define MULTICONTROL_POT_FILTER MC_POT_FILTER_RESPONSIVE
+#endif
+
+// Response curves (log, exp, S-shaped and breakpoint tables) for getCurvedValue()
+#include "MultiControlCurve.h"
+
 class MultiControl {
   public:
     /** Constructor. */
@@ -29,9 +137,19 @@ class MultiControl {
       initBanks(1);  // Start with 1 bank to save memory
     };
 
+    /** Constructor with caller-owned bank storage, for layouts that avoid the heap.
+    * The number of banks is then fixed; setBank() ignores banks beyond it.
+    * @param bankValues Storage for one value per bank
+    * @param numBanks The number of banks
+    */
+    MultiControl(int* bankValues, uint8_t numBanks): _bankValues(bankValues), _ownsBanks(false) {
+      _numBanks = max((uint8_t)1, numBanks);
+      initBanks(_numBanks);
+    };
+
     /** Destructor - free dynamic memory */
     ~MultiControl() {
-      if (_bankValues != nullptr) {
+      if (_bankValues != nullptr && _ownsBanks) {
         delete[] _bankValues;
         _bankValues = nullptr;
       }
@@ -65,6 +183,8 @@ class MultiControl {
         pinMode(_pin, INPUT_PULLUP);
       } else if (_controlType == _ENCODER) {
         pinMode(_pin, INPUT_PULLUP);  // Encoder pin A
+      } else if (_controlType == _SCANNED_KEY) {
+        // Row and column pins are set up by MultiControlMatrix
       } else {
         pinMode(_pin, INPUT);  // Default to INPUT for pots/touch/other
       }
@@ -117,6 +237,12 @@ class MultiControl {
       return _muxChannel; 
     }
 
+    /** Get the encoder B pin */
+    uint8_t getEncoderPinB() { return _encoderPinB; }
+
+    /** Get the encoder push button pin (0 = none) */
+    uint8_t getEncoderButtonPin() { return _encoderButtonPin; }
+
     // --- Encoder API ---
 
     /** Set encoder pins and configure as encoder control type.
@@ -131,17 +257,14 @@ class MultiControl {
       pinMode(_pin, INPUT_PULLUP);
       pinMode(_encoderPinB, INPUT_PULLUP);
       // Sync Gray code state to actual pin levels
-      _encState = (digitalRead(_pin) << 1) | digitalRead(_encoderPinB);
+      _encState = (MC_DIGITAL_READ(_pin) << 1) | MC_DIGITAL_READ(_encoderPinB);
       _encAccum = 0;
       if (buttonPin > 0) {
         _encoderButtonPin = buttonPin;
         _encoderHasButton = true;
         pinMode(_encoderButtonPin, INPUT_PULLUP);
         // Initialize button debounce state
-        _lastButtonChangeTime = millis();
-        _rawButtonState = digitalRead(_encoderButtonPin);
-        _debouncedButtonState = _rawButtonState;
-        _buttonValue = (_rawButtonState == 0);
+        resetGesture(MC_DIGITAL_READ(_encoderButtonPin));
       }
     }
 
@@ -197,70 +320,97 @@ class MultiControl {
     * @return Current encoder position (clamped to min/max range)
     */
     int readEncoder() {
+      return readEncoder(readsClock() ? MC_MILLIS() : 0);
+    }
+
+    /** Read encoder rotation and optional button, using an explicit timestamp (ms) */
+    int readEncoder(unsigned long now) {
       // Gray code lookup table (local static avoids header-only class static issues)
       static const int8_t encTable[] = {0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, -1, 1, 0};
 
-      uint8_t pinA = digitalRead(_pin);
-      uint8_t pinB = digitalRead(_encoderPinB);
+      uint8_t pinA = MC_DIGITAL_READ(_pin);
+      uint8_t pinB = MC_DIGITAL_READ(_encoderPinB);
       uint8_t newState = (pinA << 1) | pinB;
       uint8_t idx = (_encState << 2) | newState;
       int8_t dir = encTable[idx];
       _encState = newState;
 
-      if (dir != 0) {
-        _encAccum += dir;
-        if (_encAccum >= _encStepsPerDetent || _encAccum <= -_encStepsPerDetent) {
-          int step = (_encAccum > 0) ? 1 : -1;
-          _encAccum = 0;
-
-          // Acceleration: scale step size by turning speed
-          if (_encAccelEnabled) {
-            unsigned long now = millis();
-            if (_encLastDetentTime > 0) {
-              unsigned long interval = now - _encLastDetentTime;
-              if (interval > 0 && interval < _encAccelThreshold) {
-                float speed = 1.0f + (_encAccelFactor - 1.0f) * (1.0f - (float)interval / (float)_encAccelThreshold);
-                int accelStep = (int)(speed + 0.5f);  // round instead of truncate
-                if (accelStep < 1) accelStep = 1;
-                step = (step > 0) ? accelStep : -accelStep;
-              }
-            }
-            _encLastDetentTime = now;
-          }
-
-          _encoderPosition += step;
-          if (encoderToWrap) {
-            int range = _encoderMax - _encoderMin + 1;
-            _encoderPosition = _encoderMin + ((_encoderPosition - _encoderMin) % range + range) % range;
-          } else {
-            _encoderPosition = constrain(_encoderPosition, _encoderMin, _encoderMax);
-          }
-        }
-      }
+      if (dir != 0) encoderStep(dir, now);
 
       // Run button state machine if configured
       if (_encoderHasButton) {
-        readEncoderButton();
+        readEncoderButton(now);
       }
 
       return _encoderPosition;
     }
 
+    /** Apply one Gray code step decoded elsewhere (e.g. by MultiControlEncoders).
+    * Runs the same detent, acceleration and wrap/clamp logic as readEncoder().
+    * @param dir 1 or -1
+    */
+    void encoderStep(int8_t dir) { encoderStep(dir, _encAccelEnabled ? MC_MILLIS() : 0); }
+
+    /** Apply one Gray code step, using an explicit timestamp (ms) for acceleration */
+    void encoderStep(int8_t dir, unsigned long now) {
+      _moved = true;
+      if (_encAccum == 0) MC_TRACE(MC_TRACE_RAW, dir);
+      _encAccum += dir;
+      if (_encAccum >= _encStepsPerDetent || _encAccum <= -_encStepsPerDetent) {
+        int step = (_encAccum > 0) ? 1 : -1;
+        _encAccum = 0;
+
+        // Acceleration: scale step size by turning speed
+        if (_encAccelEnabled) {
+          if (_encLastDetentTime > 0) {
+            unsigned long interval = now - _encLastDetentTime;
+            if (interval > 0 && interval < _encAccelThreshold) {
+              float speed = 1.0f + (_encAccelFactor - 1.0f) * (1.0f - (float)interval / (float)_encAccelThreshold);
+              int accelStep = (int)(speed + 0.5f);  // round instead of truncate
+              if (accelStep < 1) accelStep = 1;
+              step = (step > 0) ? accelStep : -accelStep;
+            }
+          }
+          _encLastDetentTime = now;
+        }
+
+        _encoderPosition += step;
+        if (encoderToWrap) {
+          int range = _encoderMax - _encoderMin + 1;
+          _encoderPosition = _encoderMin + ((_encoderPosition - _encoderMin) % range + range) % range;
+        } else {
+          _encoderPosition = constrain(_encoderPosition, _encoderMin, _encoderMax);
+        }
+        MC_TRACE(MC_TRACE_STATE, _encoderPosition);
+      }
+    }
+
+    /** Run the button debounce and gesture engine on a level read elsewhere
+    * (an encoder push button from MultiControlEncoders, or a key from MultiControlMatrix
+    * or MultiControlBoard).
+    * @param level The raw button level (0 = pressed)
+    * @param now The current time in ms
+    */
+    void buttonLevel(uint8_t level, unsigned long now) {
+      int val = updateGesture(level, now);
+      if (_controlType == _SCANNED_KEY) setValue(val);
+    }
+
     /* Set the type of control.
-    * @param controlType The type of control: 0 = touch, 1 = pot, 2 = button, 3 = switch, 4 = muxButton, 5 = encoder
+    * @param controlType The type of control: 0 = touch, 1 = pot, 2 = button, 3 = switch, 4 = muxButton, 5 = encoder,
+    *        6 = scanned key (read by MultiControlMatrix or MultiControlBoard)
     */
     void setControl(uint8_t controlType) {
       _controlType = controlType;
       if (controlType == _SWITCH || controlType == _BUTTON || controlType == _MUX_BUTTON) {
         pinMode(_pin, INPUT_PULLUP); // for buttons and switches
         // Initialize button debounce state to prevent false triggers on startup
-        _lastButtonChangeTime = millis();
-        _rawButtonState = digitalRead(_pin);
-        _debouncedButtonState = _rawButtonState;
-        _buttonValue = (_rawButtonState == 0);  // true if pressed
+        resetGesture(MC_DIGITAL_READ(_pin));
       } else if (controlType == _POT || controlType == _TOUCH) {
         pinMode(_pin, INPUT); // for touch or potentiometer
         digitalWrite(_pin, LOW); // disable internal pullup if set
+      } else if (controlType == _SCANNED_KEY) {
+        resetGesture(1);  // released; the matrix owns the pins
       }
       // _ENCODER: no-op here, use setEncoderPins() instead
     }
@@ -269,8 +419,11 @@ class MultiControl {
     uint8_t getControl() { return _controlType; }
 
     /* Read the touch value (ESP32 only - returns 0 on unsupported platforms) */
+    int readTouch() { return readTouch(MC_MILLIS()); }
+
+    /* Read the touch value, using an explicit timestamp (ms) for the minimum hold time */
     inline
-    int readTouch() {
+    int readTouch(unsigned long now) {
       #if defined(ESP32)
         if (_controlType != _TOUCH) {
           setControl(_TOUCH);
@@ -279,8 +432,10 @@ class MultiControl {
         // Classic ESP32: touchRead() returns ~20-80; value DECREASES when touched.
         // No >> 8 (that zeroes classic ESP32 values). Delta is baseline - raw so it
         // is positive when touched, matching the existing threshold comparisons.
-        int rawValue = touchRead(_pin);
-        if (_touchBaseline == 65535) {
+        int rawValue = MC_TOUCH_READ(_pin);
+        if (_touchCalibrating) {
+          touchCalibrationStep(rawValue);  // sets the baseline to the calibration mean
+        } else if (_touchBaseline == 65535) {
           _touchBaseline = rawValue;
         } else if (!_touchState) {
           if (rawValue > _touchBaseline + 5) {
@@ -299,8 +454,10 @@ class MultiControl {
 
         #else
         // ESP32-S3 and newer: touchRead() returns large values; value INCREASES when touched.
-        _touchValue = touchRead(_pin) >> 8;
-        if (_touchBaseline == 65535) {
+        _touchValue = MC_TOUCH_READ(_pin) >> 8;
+        if (_touchCalibrating) {
+          touchCalibrationStep(_touchValue);  // sets the baseline to the calibration mean
+        } else if (_touchBaseline == 65535) {
           _touchBaseline = _touchValue;
         } else if (!_touchState) {
           if (_touchValue < _touchBaseline - 5) {
@@ -316,6 +473,8 @@ class MultiControl {
         }
         int delta = _touchValue - _touchBaseline;
         #endif
+        _touchDelta = delta;
+        if (_touchAdaptive && !_touchCalibrating) touchAdapt(delta);
         bool newState = _touchState;  // Start with current state
 
         // Hysteresis: use different thresholds for on vs off
@@ -326,7 +485,9 @@ class MultiControl {
           }
         } else {
           // Currently not touched - use higher threshold to engage (prevents false triggers)
-          if (delta > _touchOnThreshold) {
+          // While calibrating in the background the baseline is provisional, so be conservative
+          int16_t onThreshold = _touchCalibrating ? _touchOnThreshold * 2 : _touchOnThreshold;
+          if (delta > onThreshold) {
             newState = true;
           }
         }
@@ -334,19 +495,25 @@ class MultiControl {
         // Minimum hold time: suppress OFF transitions shortly after ON
         // Prevents false releases caused by capacitive coupling when other pads are touched
         if (_touchState && !newState && _touchMinHoldMs > 0) {
-          if ((millis() - _touchOnTime) < _touchMinHoldMs) {
+          if ((now - _touchOnTime) < _touchMinHoldMs) {
             newState = true;  // Force state to remain ON during hold period
           }
         }
 
         // Debouncing: require consecutive consistent readings before changing state
         if (newState != _touchState) {
+          if (_touchDebounceCount == 0) MC_TRACE(MC_TRACE_RAW, delta);
           _touchDebounceCount++;
           if (_touchDebounceCount >= _touchDebounceReads) {
             _touchState = newState;
             _touchDebounceCount = 0;
+            MC_TRACE(MC_TRACE_STATE, _touchState);
             if (_touchState) {
-              _touchOnTime = millis();  // Record when touch went ON
+              _touchOnTime = now;  // Record when touch went ON
+            } else if (_touchAdaptive) {
+              // Learn the typical touch from each touch's peak
+              _touchSignal = _touchSignal == 0.0f ? _touchPeak : _touchSignal + (_touchPeak - _touchSignal) * 0.125f;
+              _touchPeak = 0;
             }
           }
         } else {
@@ -358,7 +525,7 @@ class MultiControl {
         // This avoids false triggers on initial press (no preceding dip) and on
         // normal release (dip but no recovery), and on hold noise (neither exceeds threshold).
         // Suppress during minimum hold window — dip-rise patterns from coupling aren't real retriggers.
-        bool inHoldWindow = _touchMinHoldMs > 0 && (millis() - _touchOnTime) < _touchMinHoldMs;
+        bool inHoldWindow = _touchMinHoldMs > 0 && (now - _touchOnTime) < _touchMinHoldMs;
         if (_touchState && _retriggerThreshold > 0 && !inHoldWindow) {
           if (_prevTouchDelta > 0) {
             int16_t dropAmount = _prevTouchDelta - delta;
@@ -384,6 +551,7 @@ class MultiControl {
         return _touchValue;
       #else
         // Touch not supported on this platform
+        (void)now;
         _touchValue = 0;
         _touchState = false;
         return 0;
@@ -394,105 +562,45 @@ class MultiControl {
     inline
     bool isTouched() {
       readTouch();
+      MC_TRACE_REPORT(_touchState);
       return _touchState;
     }
 
-    void setButtonValue(bool value) { _buttonValue = value; } // 0 or false is off, 1 or true is on
+    void setButtonValue(bool value) { _gesture.down = value; } // 0 or false is off, 1 or true is on
 
     /* Read the button value
     * @return The button value: 0 or false is off, 1 or true is on
     */
     inline
-    int readButton() {
+    int readButton() { return readButton(MC_MILLIS()); }
+
+    /* Read the button value, using an explicit timestamp (ms) for debounce and gestures */
+    inline
+    int readButton(unsigned long now) {
       if (_controlType != _BUTTON) {
         setControl(_BUTTON);
       }
-      int rawVal = digitalRead(_pin);
-      unsigned long now = millis();
-
-      // Debouncing: track raw state changes
-      if (rawVal != _rawButtonState) {
-        _lastButtonChangeTime = now;
-        _rawButtonState = rawVal;
-      }
-
-      // Only update debounced state if stable for debounce period
-      int val = _debouncedButtonState;
-      if ((now - _lastButtonChangeTime) >= _debounceTime) {
-        if (_rawButtonState != _debouncedButtonState) {
-          _debouncedButtonState = _rawButtonState;
-          val = _debouncedButtonState;
-        }
-      }
-
-      if (val == 0 && _buttonValue == false) {
-        _buttonValue = true;
-        multiControlAnyButtonPressed += 1;
-        _singleClicked = false;  // clear any unread single-click from previous press
-        _wasDoubleClicked = false;  // clear persistent flag on new press
-        _wasLongPressedOnRelease = false;  // clear previous long-press latch
-        _lastPressDuration = 0;
-        // Check for double-click using press-to-press timing (more forgiving)
-        if (_prevPressTime > 0 && (now - _prevPressTime) < _doubleClickTime) {
-          _doubleClicked = true;
-          _wasDoubleClicked = true;  // set persistent flag
-          _clickPending = false;
-          _prevPressTime = 0;  // reset to prevent triple-click triggering another double
-        } else {
-          _clickPending = true;
-          _prevPressTime = now;
-        }
-        // Record press time for hold detection
-        _pressStartTime = now;
-        _holdTriggered = false;
-        _held = false;
-        _wasHeldOnRelease = false;
-        _holdActionOccurred = false;
-        _hadHoldAction = false;
-      }
-      if (val == 1 && _buttonValue == true) {
-        _buttonValue = false;
-        multiControlAnyButtonPressed -= 1;
-        // Record release time
-        _lastReleaseTime = now;
-        // Save hold and action state before reset (for release checks)
-        _wasHeldOnRelease = _holdTriggered;
-        _hadHoldAction = _holdActionOccurred;
-        // Calculate press duration from debounced timestamps
-        _lastPressDuration = now - _pressStartTime;
-        _wasLongPressedOnRelease = _lastPressDuration >= _longPressTime;
-        // Reset hold and long-press state on release
-        _holdTriggered = false;
-        _held = false;
-        _holdActionOccurred = false;
-        _longPressed = false;
-      }
-      // Check for hold while pressed
-      if (_buttonValue && !_holdTriggered && (now - _pressStartTime >= _holdTime)) {
-        _held = true;
-        _holdTriggered = true;
-      }
-      // Check for long-press (continuous state while held past threshold)
-      if (_buttonValue && (now - _pressStartTime >= _longPressTime)) {
-        _longPressed = true;
-      }
-      // Check for confirmed single-click (pending + released + window expired)
-      if (_clickPending && !_buttonValue && (now - _prevPressTime) >= _doubleClickTime) {
-        _singleClicked = true;
-        _clickPending = false;
-        _prevPressTime = 0;
-      }
+      int val = updateGesture(MC_DIGITAL_READ(_pin), now);
       setValue(val);
       return val;
     }
 
+    /* Read a button or mux button and check if it is pressed (debounced); encoders and scanned
+    * keys report the state of their last read
+    */
     bool isPressed() {
+      return isPressed(_controlType == _BUTTON || _controlType == _MUX_BUTTON ? MC_MILLIS() : 0);
+    }
+
+    /* Check if pressed, using an explicit timestamp (ms) for debounce and gestures */
+    bool isPressed(unsigned long now) {
       uint8_t val = 1;
-      if (_controlType == _BUTTON) val = readButton();
-      if (_controlType == _MUX_BUTTON) val = readMuxButton();
-      if (_controlType == _ENCODER) return _buttonValue;
+      if (_controlType == _BUTTON) val = readButton(now);
+      if (_controlType == _MUX_BUTTON) val = readMuxButton(now);
+      if (_controlType == _ENCODER || _controlType == _SCANNED_KEY) val = !_gesture.down;
       bool returnVal = false;
       if (val == 0) returnVal = true;
+      MC_TRACE_REPORT(returnVal);
       return returnVal;
     }
 
@@ -502,8 +610,9 @@ class MultiControl {
      * @return true if double-click detected, false otherwise
      */
     bool isDoubleClicked() {
-      bool result = _doubleClicked;
-      _doubleClicked = false;  // Clear after reading
+      bool result = _gesture.doubleClicked;
+      _gesture.doubleClicked = 0;  // Clear after reading
+      if (result) MC_TRACE(MC_TRACE_GESTURE, MC_TRACE_EVENT_DOUBLE);
       return result;
     }
 
@@ -515,8 +624,8 @@ class MultiControl {
      * @return true if double-click detected since last press, false otherwise
      */
     bool wasDoubleClicked() {
-      bool result = _wasDoubleClicked;
-      _wasDoubleClicked = false;  // Clear after reading
+      bool result = _gesture.wasDoubleClicked;
+      _gesture.wasDoubleClicked = 0;  // Clear after reading
       return result;
     }
 
@@ -527,8 +636,9 @@ class MultiControl {
      * @return true if confirmed single click, false otherwise
      */
     bool wasSingleClicked() {
-      bool result = _singleClicked;
-      _singleClicked = false;  // Clear after reading
+      bool result = _gesture.singleClicked;
+      _gesture.singleClicked = 0;  // Clear after reading
+      if (result) MC_TRACE(MC_TRACE_GESTURE, MC_TRACE_EVENT_SINGLE);
       return result;
     }
 
@@ -536,14 +646,81 @@ class MultiControl {
      * @return true if waiting for double-click window to expire
      */
     bool isClickPending() {
-      return _clickPending;
+      return _gesture.pending;
+    }
+
+    /** Discard a pending or unread single-click
+     * Use when the press has been consumed by something else (e.g. a button chord),
+     * so wasSingleClicked() will not report it on release.
+     */
+    void cancelClick() {
+      if (_speculativeClick && _gesture.pending) {
+        // Withdraw an unread speculative click; cancel one the app has already acted on
+        if (_gesture.provisional) {
+          _gesture.provisional = 0;
+        } else {
+          _gesture.clickCancelled = 1;
+          addGestureEvents(MC_GESTURE_CANCEL);
+        }
+      }
+      _gesture.pending = 0;
+      _gesture.singleClicked = 0;
+    }
+
+    /** Report single clicks speculatively, without waiting for the double-click window.
+    * The first press of a click is reported at once by wasProvisionalClick(). If a second
+    * press follows inside the double-click window, wasClickCancelled() reports that the click
+    * was withdrawn and isDoubleClicked() reports the double-click it became; otherwise
+    * wasSingleClicked() confirms it when the window expires as usual.
+    * Apply the action on the provisional click and undo it on the cancel.
+    * @param enabled true to enable (default false)
+    */
+    void setSpeculativeClick(bool enabled) { _speculativeClick = enabled; }
+
+    /** Check for a speculative single click (the first press of a click, debounced).
+    * Returns true only once per click. Needs setSpeculativeClick(true).
+    * @return true if a click has started that may still become a double-click
+    */
+    bool wasProvisionalClick() {
+      bool result = _gesture.provisional;
+      _gesture.provisional = 0;
+      return result;
     }
 
+    /** Check if the last speculative click was withdrawn, because a second press made it
+    * a double-click (or cancelClick() was called after it was reported).
+    * Returns true only once per cancel. Needs setSpeculativeClick(true).
+    * @return true if the action taken on wasProvisionalClick() should be undone
+    */
+    bool wasClickCancelled() {
+      bool result = _gesture.clickCancelled;
+      _gesture.clickCancelled = 0;
+      return result;
+    }
+
+    /** Get and clear the gesture events since the previous call by the same consumer
+     * Independent of the isHeld(), wasSingleClicked() and other checks. Each consumer has its
+     * own copy of the events, so an output stage such as MultiControlStream can report them
+     * without taking them from the app or from MultiControlTasks.
+     * @param consumer MC_CONSUMER_APP (default), MC_CONSUMER_TASKS, MC_CONSUMER_STREAM or MC_CONSUMER_OTHER
+     * @return MC_GESTURE_* bits (press, release, double, single, hold, long press,
+     *         and with setSpeculativeClick() provisional click and cancel)
+     */
+    uint8_t takeGestureEvents(uint8_t consumer = MC_CONSUMER_APP) {
+      uint8_t shift = (consumer & 3) * 8;
+      uint8_t events = (uint8_t)(_gestureEvents >> shift);
+      _gestureEvents &= ~((uint32_t)0xFF << shift);
+      return events;
+    }
+
+    /** Get the bytes of button gesture state each control keeps */
+    static constexpr size_t getGestureStateSize() { return sizeof(ButtonGesture); }
+
     /** Set the double-click detection time window
-     * @param ms Time window in milliseconds (default 350)
+     * @param ms Time window in milliseconds (default 350, max 61440)
      */
     void setDoubleClickTime(unsigned long ms) {
-      _doubleClickTime = ms;
+      _doubleClickTime = min(ms, (unsigned long)_GESTURE_MAX_MS);
     }
 
     /** Get the current double-click time window */
@@ -556,16 +733,17 @@ class MultiControl {
      * @return true if hold detected, false otherwise
      */
     bool isHeld() {
-      bool result = _held;
-      _held = false;  // Clear after reading
+      bool result = _gesture.held;
+      _gesture.held = 0;  // Clear after reading
+      if (result) MC_TRACE(MC_TRACE_GESTURE, MC_TRACE_EVENT_HOLD);
       return result;
     }
 
     /** Set the hold detection time threshold
-     * @param ms Time in milliseconds to trigger hold (default 500)
+     * @param ms Time in milliseconds to trigger hold (default 500, max 61440)
      */
     void setHoldTime(unsigned long ms) {
-      _holdTime = ms;
+      _holdTime = min(ms, (unsigned long)_GESTURE_MAX_MS);
     }
 
     /** Get the current hold time threshold */
@@ -579,7 +757,7 @@ class MultiControl {
      * @return true if long-pressed, false otherwise
      */
     bool isLongPressed() {
-      return _longPressed;
+      return _gesture.longPressed;
     }
 
     /** Check if button was long-pressed (for use on release)
@@ -588,21 +766,24 @@ class MultiControl {
      * @return true if long-press was detected on last release, false otherwise
      */
     bool wasLongPressed() {
-      bool result = _wasLongPressedOnRelease;
-      _wasLongPressedOnRelease = false;
+      bool result = _gesture.wasLongPressed;
+      _gesture.wasLongPressed = 0;
+      if (result) MC_TRACE(MC_TRACE_GESTURE, MC_TRACE_EVENT_LONG);
       return result;
     }
 
-    /** Get duration of the last button press (ms), measured on release */
+    /** Get duration of the last button press (ms), measured on release.
+     * Presses longer than ~61 seconds report 65535.
+     */
     unsigned long getLastPressDuration() {
-      return _lastPressDuration;
+      return _gesture.lastDuration;
     }
 
     /** Set the long-press detection time threshold
-     * @param ms Time in milliseconds to trigger long-press (default 1000)
+     * @param ms Time in milliseconds to trigger long-press (default 1000, max 61440)
      */
     void setLongPressTime(unsigned long ms) {
-      _longPressTime = ms;
+      _longPressTime = min(ms, (unsigned long)_GESTURE_MAX_MS);
     }
 
     /** Get the current long-press time threshold */
@@ -611,10 +792,10 @@ class MultiControl {
     }
 
     /** Set the debounce time for button readings
-     * @param ms Time in milliseconds to debounce (default 20)
+     * @param ms Time in milliseconds to debounce (default 20, max 61440)
      */
     void setDebounceTime(unsigned long ms) {
-      _debounceTime = ms;
+      _debounceTime = min(ms, (unsigned long)_GESTURE_MAX_MS);
     }
 
     /** Get the current debounce time */
@@ -622,6 +803,48 @@ class MultiControl {
       return _debounceTime;
     }
 
+    /** Set how button levels are debounced (buttons, mux buttons, encoder buttons and scanned keys)
+     * MC_DEBOUNCE_STABLE waits until the level has been stable for the debounce time, so every
+     * press and release is reported that much late. MC_DEBOUNCE_EAGER reports a change on its
+     * first edge and then ignores the contact for the debounce time (a lockout), so presses are
+     * reported at once; a noise spike is then reported as a short press, see setMinPressTime().
+     * @param mode MC_DEBOUNCE_STABLE (default) or MC_DEBOUNCE_EAGER
+     */
+    void setDebounceMode(uint8_t mode) {
+      _debounceMode = mode;
+    }
+
+    /** Get the current debounce mode */
+    uint8_t getDebounceMode() {
+      return _debounceMode;
+    }
+
+    /** Treat presses shorter than this as glitches: their click is withdrawn (as cancelClick())
+     * and wasGlitch() reports them. A second press is reported as a double-click only once it
+     * has lasted this long; if it is a glitch, the first press stays a single click. Useful
+     * with MC_DEBOUNCE_EAGER; set it above the debounce time, since an eager press lasts at
+     * least that long.
+     * @param ms Minimum press in milliseconds (default 0 = off)
+     */
+    void setMinPressTime(unsigned long ms) {
+      _minPressTime = min(ms, (unsigned long)_GESTURE_MAX_MS);
+    }
+
+    /** Get the current minimum press time */
+    unsigned long getMinPressTime() {
+      return _minPressTime;
+    }
+
+    /** Check if a press was rejected as a glitch (shorter than setMinPressTime())
+     * Returns true only once per glitch.
+     * @return true if a glitch was rejected, false otherwise
+     */
+    bool wasGlitch() {
+      bool result = _gesture.glitch;
+      _gesture.glitch = 0;
+      return result;
+    }
+
     /** Set touch detection thresholds for hysteresis
      * @param onThreshold Value above baseline to trigger touch ON (default 22)
      * @param offThreshold Value above baseline to trigger touch OFF (default 16)
@@ -635,9 +858,49 @@ class MultiControl {
     /** Get touch ON threshold */
     int16_t getTouchOnThreshold() { return _touchOnThreshold; }
 
+    /** Get the touch state of the last readTouch(), without reading again */
+    bool getTouchState() { return _touchState; }
+
+    /** Get the current touch baseline (65535 until the first read) */
+    uint16_t getTouchBaseline() { return _touchBaseline; }
+
+    /** Get the baseline-corrected touch reading of the last readTouch() (positive when touched) */
+    int16_t getTouchDelta() { return _touchDelta; }
+
     /** Get touch OFF threshold */
     int16_t getTouchOffThreshold() { return _touchOffThreshold; }
 
+    /** Derive the touch thresholds from the pad's own signal statistics
+     * Each pad tracks its idle noise (variance, and peaks such as coupling from touched
+     * neighbours) and the typical peak delta of its touches. The ON threshold is then set
+     * well clear of the noise (5 standard deviations or 1.5 times the idle peaks above the
+     * idle offset) and at 0.4 of a typical touch when that is higher;
+     * OFF is 0.7 of ON. Pads with a wide margin get a debounce of 1 read, others 2.
+     * Starts from the current thresholds and the noise measured by touch calibration.
+     * @param enabled true to adapt (replaces setTouchThresholds() and setTouchDebounceReads()),
+     *        false to keep the current values
+     */
+    void setTouchAdaptive(bool enabled) {
+      if (enabled && !_touchAdaptive) {
+        float noise = _touchOnThreshold / _TOUCH_NOISE_ON;
+        _touchNoiseVar = noise * noise;
+        _touchIdleMean = 0.0f;
+        _touchIdlePeak = 0.0f;
+        _touchSignal = 0.0f;
+        _touchPeak = 0;
+      }
+      _touchAdaptive = enabled;
+    }
+
+    /** Check if touch thresholds adapt */
+    bool isTouchAdaptive() { return _touchAdaptive; }
+
+    /** Get the pad's idle noise (standard deviation of the delta, in touch units) */
+    float getTouchNoise() { return sqrtf(_touchNoiseVar); }
+
+    /** Get the typical peak delta of a touch (0 until the first touch) */
+    float getTouchSignal() { return _touchSignal; }
+
     /** Set retrigger detection threshold
      * Detects rapid lift-and-retouch by monitoring per-read delta drops.
      * When the delta drops by more than this threshold between consecutive reads
@@ -690,6 +953,7 @@ class MultiControl {
      * When the error moving average falls below this threshold, the pot "sleeps"
      * and stops updating, which reduces jitter when stationary.
      * Higher values = more aggressive sleep (less jitter but may miss small movements)
+     * With the One-Euro and EMA filters the pot keeps updating and the threshold only sets isQuiet().
      * @param threshold Activity threshold (default 4.0, try 6.0-10.0 for less jitter)
      */
     void setActivityThreshold(float threshold) {
@@ -702,6 +966,7 @@ class MultiControl {
     /** Set pot snap multiplier for smoothing
      * Controls how quickly the smoothed value snaps to the raw value.
      * Lower values = more smoothing (less jitter but slower response)
+     * Used by the default responsive filter only (see MULTICONTROL_POT_FILTER).
      * @param multiplier Snap multiplier (default 0.05, try 0.02-0.04 for smoother)
      */
     void setSnapMultiplier(float multiplier) {
@@ -713,6 +978,81 @@ class MultiControl {
     /** Get pot snap multiplier */
     float getSnapMultiplier() { return snapMultiplier; }
 
+    #if MULTICONTROL_POT_FILTER == MC_POT_FILTER_ONE_EURO
+    /** Set the One-Euro pot filter parameters
+     * The cutoff frequency is minCutoff at rest and rises with pot speed, so slow moves
+     * are smoothed and fast moves follow closely. Sample times are measured, so the
+     * response does not change with loop timing.
+     * @param minCutoff Cutoff at rest in Hz (default 1.0). Lower = less jitter, more lag on slow moves
+     * @param beta Cutoff increase per unit/s of speed, in 0-511 units (default 0.02). Higher = less lag on fast moves
+     * @param dCutoff Cutoff of the speed estimate in Hz (default 1.0)
+     */
+    void setOneEuro(float minCutoff, float beta, float dCutoff = 1.0f) {
+      _oneEuroMinCutoff = max(0.01f, minCutoff);
+      _oneEuroBeta = max(0.0f, beta);
+      _oneEuroDCutoff = max(0.01f, dCutoff);
+    }
+    #endif
+
+    #if MULTICONTROL_POT_FILTER == MC_POT_FILTER_EMA
+    /** Set the EMA pot filter weight
+     * @param alpha Weight of each new reading, 0.0 - 1.0 (default 0.1). Lower = smoother and slower
+     */
+    void setEmaAlpha(float alpha) {
+      _emaAlpha = constrain(alpha, 0.001f, 1.0f);
+    }
+    #endif
+
+    /** Let the pot tune its own activity threshold and hysteresis from its noise
+     * The noise is estimated from the spread of each reading's four samples (taken within
+     * 30 us, so movement barely shows) and from the error average while the pot is at rest
+     * (slower noise such as hum). The threshold follows it within the limits, so quiet pots
+     * wake on smaller moves and noisy ones stop jittering; hysteresis stays at 3/4 of it.
+     * Starts from the current threshold. Freeze it (setPotAutoTuneFrozen) for live use.
+     * @param enabled true to adapt, false to keep the current values (default)
+     */
+    void setPotAutoTune(bool enabled) {
+      if (enabled && !_potAutoTune) {
+        _potSpreadNoise = _potRestNoise = activityThreshold / _AUTO_TUNE_GAIN;
+        _potErrorMean = errorEMA;
+      }
+      _potAutoTune = enabled;
+    }
+
+    /** Check if the pot tunes its own threshold and hysteresis */
+    bool isPotAutoTune() { return _potAutoTune; }
+
+    /** Set the range the tuned activity threshold is kept in
+     * @param minThreshold Lowest threshold (default 1.0)
+     * @param maxThreshold Highest threshold (default 20.0)
+     */
+    void setPotAutoTuneLimits(float minThreshold, float maxThreshold) {
+      _autoTuneMin = max(0.0f, minThreshold);
+      _autoTuneMax = max(_autoTuneMin, maxThreshold);
+    }
+
+    /** Hold the tuned threshold and hysteresis, e.g. during a performance
+     * @param frozen true to stop adapting, false to carry on
+     */
+    void setPotAutoTuneFrozen(bool frozen) { _potAutoTuneFrozen = frozen; }
+
+    /** Check if the tuned values are frozen */
+    bool isPotAutoTuneFrozen() { return _potAutoTuneFrozen; }
+
+    /** Get the estimated noise of the pot (about a standard deviation, in 0-511 filter units) */
+    float getPotNoise() { return max(_potSpreadNoise, _potRestNoise); }
+
+    /** Set max allowed sample spread for floating pin detection
+     * @param spread Max difference between min/max of 4 samples (default 50)
+     *               Set to 4096 to disable floating pin detection
+     */
+    void setMaxSampleSpread(int spread) {
+      _maxSampleSpread = spread;
+    }
+
+    /** Get max allowed sample spread */
+    int getMaxSampleSpread() { return _maxSampleSpread; }
+
     /** Enable or disable pot sleep mode
      * When enabled, pots stop updating when activity falls below threshold.
      * @param enabled true to enable sleep mode (default), false to disable
@@ -776,9 +1116,111 @@ class MultiControl {
       _touchDebounceCount = 0;
     }
 
+    /** Start a non-blocking touch calibration
+     * The baseline is then taken from the mean of untouched readings made by readTouch().
+     * Calibration ends when the baseline estimate settles (standard error under half a count,
+     * after at least 8 reads) or after maxReadings reads, counting reads skipped while the pad
+     * is touched or noisy. Until then readTouch() works with
+     * the provisional baseline and a doubled ON threshold.
+     * @param maxReadings Upper limit on calibration reads (default 50)
+     */
+    void beginTouchCalibration(uint8_t maxReadings = 50) {
+      resetTouchBaseline();
+      _touchState = false;
+      _touchCalibrating = true;
+      _touchCalReads = 0;
+      _touchCalTries = 0;
+      _touchCalMax = max((uint8_t)1, maxReadings);
+      _touchCalMean = 0.0f;
+      _touchCalM2 = 0.0f;
+    }
+
+    /** Check if touch calibration is still running */
+    bool isTouchCalibrating() { return _touchCalibrating; }
+
+    /** Calibrate a group of touch pads together
+     * Interleaves reads across all pads, one round every 4ms, so a whole board takes
+     * about as long as its noisiest pad rather than the sum of all pads.
+     * Each pad stops as soon as its baseline settles.
+     * Call in setup() with pads untouched.
+     * @param pads Array of touch controls (pins already set)
+     * @param count Number of pads
+     * @param readings Upper limit on calibration reads per pad (default 50, ~200ms)
+     * @param background If true, return after the minimum 8 rounds and let unsettled pads
+     *        finish calibrating during normal readTouch() calls, with conservative thresholds
+     * @return Milliseconds spent before returning
+     */
+    static unsigned long calibrateTouchPads(MultiControl* pads, int count, int readings = 50, bool background = false) {
+      unsigned long start = MC_MILLIS();
+      for (int i = 0; i < count; i++) {
+        if (pads[i]._controlType != _TOUCH) pads[i].setControl(_TOUCH);
+        pads[i].beginTouchCalibration(readings);
+      }
+      for (int round = 0; round < readings; round++) {
+        bool calibrating = false;
+        for (int i = 0; i < count; i++) {
+          if (!pads[i]._touchCalibrating) continue;
+          pads[i].readTouch();
+          calibrating |= pads[i]._touchCalibrating;
+        }
+        if (!calibrating) break;
+        if (background && round + 1 >= _TOUCH_CAL_MIN_READS) break;
+        delay(4);
+      }
+      // Pads that skipped reads (touched, or noisy) end with the baseline they have
+      if (!background) {
+        for (int i = 0; i < count; i++) {
+          if (pads[i]._touchCalibrating) pads[i].endTouchCalibration();
+        }
+      }
+      // Clear any false touch state from calibration period
+      for (int i = 0; i < count; i++) {
+        pads[i]._touchState = false;
+        pads[i]._touchDebounceCount = 0;
+      }
+      return MC_MILLIS() - start;
+    }
+
+    /** Set the id this control logs under when MULTICONTROL_TRACE is defined
+     * Default is the GPIO pin, or 100 + channel for mux buttons.
+     */
+    void setTraceId(uint8_t id) { _traceId = id; }
+
+    /** Get the trace id for this control */
+    uint8_t getTraceId() {
+      if (_traceId != 255) return _traceId;
+      return (_controlType == _MUX_BUTTON) ? 100 + _muxChannel : _pin;
+    }
+
+    /** Check if the control has been at rest since the previous call
+     * Pots: asleep (error average below activityThreshold; needs sleep mode enabled).
+     * Touch: untouched with no pending debounce. Buttons: released with no click pending.
+     * Encoders and switches: not moved since the previous call.
+     * Used by MultiControlIdle to decide when a panel can scan slowly.
+     */
+    bool isQuiet() {
+      bool moved = _moved;
+      _moved = false;
+      if (_controlType == _POT) return sleeping;
+      if (_controlType == _TOUCH) return !_touchState && _touchDebounceCount == 0;
+      if (_controlType == _SWITCH) return !moved;
+      if (_controlType == _ENCODER && moved) return false;  // a step left mid-detent by skipped reads is not activity
+      if (_controlType == _ENCODER && !_encoderHasButton) return true;
+      return !_gesture.down && !_gesture.pending && _gesture.raw == _gesture.debounced;
+    }
+
+    /** Take one ADC conversion per readPot() instead of four
+     * Saves time and power while idle, at the cost of more noise and no floating pin detection.
+     * @param enabled true for a single conversion, false for the normal 4-sample median (default)
+     */
+    void setPotSingleSample(bool enabled) { _potSingleSample = enabled; }
+
+    /** Check if pots take a single conversion per read */
+    bool isPotSingleSample() { return _potSingleSample; }
+
     /** Check if button was held (for use on release - returns state from before reset) */
     bool wasHeld() {
-      return _wasHeldOnRelease;
+      return _gesture.wasHeld;
     }
 
     /** Notify that an external action occurred while button is pressed/held
@@ -786,8 +1228,8 @@ class MultiControl {
      * Use isHeldAndActioned() to check, or hadHoldAction() on release.
      */
     void notifyHoldAction() {
-      if (_buttonValue) {  // Track from press, not just hold
-        _holdActionOccurred = true;
+      if (_gesture.down) {  // Track from press, not just hold
+        _gesture.holdAction = 1;
       }
     }
 
@@ -795,100 +1237,29 @@ class MultiControl {
      * @return true if held and action notified, false otherwise
      */
     bool isHeldAndActioned() {
-      return _holdTriggered && _holdActionOccurred;
+      return _gesture.holdTriggered && _gesture.holdAction;
     }
 
     /** Check if action occurred during hold (for use on release)
      * @return true if hold had an associated action, false otherwise
      */
     bool hadHoldAction() {
-      return _hadHoldAction;
+      return _gesture.hadHoldAction;
     }
 
     /* Read the mutiplexed button value
     * @return The button value: 0 or false is off, 1 or true is on
     */
-    inline int readMuxButton() {
+    inline int readMuxButton() { return readMuxButton(MC_MILLIS()); }
+
+    /* Read the mutiplexed button value, using an explicit timestamp (ms) */
+    inline int readMuxButton(unsigned long now) {
       if (_controlType != _MUX_BUTTON) {
         setControl(_MUX_BUTTON);
       }
       muxWrite();
       delayMicroseconds(10); // Allow MUX to settle
-      int rawVal = digitalRead(_pin);
-      unsigned long now = millis();
-
-      // Debouncing: track raw state changes
-      if (rawVal != _rawButtonState) {
-        _lastButtonChangeTime = now;
-        _rawButtonState = rawVal;
-      }
-
-      // Only update debounced state if stable for debounce period
-      int val = _debouncedButtonState;
-      if ((now - _lastButtonChangeTime) >= _debounceTime) {
-        if (_rawButtonState != _debouncedButtonState) {
-          _debouncedButtonState = _rawButtonState;
-          val = _debouncedButtonState;
-        }
-      }
-
-      if (val == 0 && _buttonValue == false) {
-        _buttonValue = true;
-        multiControlAnyButtonPressed += 1;
-        _singleClicked = false;  // clear any unread single-click from previous press
-        _wasDoubleClicked = false;  // clear persistent flag on new press
-        _wasLongPressedOnRelease = false;  // clear previous long-press latch
-        _lastPressDuration = 0;
-        // Check for double-click using press-to-press timing (more forgiving)
-        if (_prevPressTime > 0 && (now - _prevPressTime) < _doubleClickTime) {
-          _doubleClicked = true;
-          _wasDoubleClicked = true;  // set persistent flag
-          _clickPending = false;
-          _prevPressTime = 0;  // reset to prevent triple-click triggering another double
-        } else {
-          _clickPending = true;
-          _prevPressTime = now;
-        }
-        // Record press time for hold detection
-        _pressStartTime = now;
-        _holdTriggered = false;
-        _held = false;
-        _wasHeldOnRelease = false;
-        _holdActionOccurred = false;
-        _hadHoldAction = false;
-      }
-      if (val == 1 && _buttonValue == true) {
-        _buttonValue = false;
-        multiControlAnyButtonPressed -= 1;
-        // Record release time
-        _lastReleaseTime = now;
-        // Save hold and action state before reset (for release checks)
-        _wasHeldOnRelease = _holdTriggered;
-        _hadHoldAction = _holdActionOccurred;
-        // Calculate press duration from debounced timestamps
-        _lastPressDuration = now - _pressStartTime;
-        _wasLongPressedOnRelease = _lastPressDuration >= _longPressTime;
-        // Reset hold and long-press state on release
-        _holdTriggered = false;
-        _held = false;
-        _holdActionOccurred = false;
-        _longPressed = false;
-      }
-      // Check for hold while pressed
-      if (_buttonValue && !_holdTriggered && (now - _pressStartTime >= _holdTime)) {
-        _held = true;
-        _holdTriggered = true;
-      }
-      // Check for long-press (continuous state while held past threshold)
-      if (_buttonValue && (now - _pressStartTime >= _longPressTime)) {
-        _longPressed = true;
-      }
-      // Check for confirmed single-click (pending + released + window expired)
-      if (_clickPending && !_buttonValue && (now - _prevPressTime) >= _doubleClickTime) {
-        _singleClicked = true;
-        _clickPending = false;
-        _prevPressTime = 0;
-      }
+      int val = updateGesture(MC_DIGITAL_READ(_pin), now);
       setValue(val);
       return val;
     }
@@ -902,12 +1273,24 @@ class MultiControl {
         setControl(_POT);
       }
 
-      // Take 4 samples with settling time
+      // Take 4 samples with settling time (or one conversion in low-power mode)
       int samples[4];
-      for (int s = 0; s < 4; s++) {
-        samples[s] = analogRead(_pin);
-        if (s < 3) delayMicroseconds(10);
+      if (_potSingleSample) {
+        samples[0] = samples[1] = samples[2] = samples[3] = MC_ANALOG_READ(_pin);
+      } else {
+        for (int s = 0; s < 4; s++) {
+          samples[s] = MC_ANALOG_READ(_pin);
+          if (s < 3) delayMicroseconds(10);
+        }
       }
+      return potSamples(samples);
+    }
+
+    /** Run the readPot() pipeline on four samples read elsewhere (e.g. by MultiControlPots)
+    * @param samples Four ADC readings of this pot (0-4095); sorted in place
+    * @return As readPot()
+    */
+    int potSamples(int* samples) {
       // Optimal 4-element sort using comparison network (5 swaps vs 6 for bubble)
       #define SORT_SWAP(a,b) if(samples[a]>samples[b]){int t=samples[a];samples[a]=samples[b];samples[b]=t;}
       SORT_SWAP(0,1); SORT_SWAP(2,3); SORT_SWAP(0,2); SORT_SWAP(1,3); SORT_SWAP(1,2);
@@ -915,51 +1298,80 @@ class MultiControl {
 
       // Detect floating/disconnected pin - samples too erratic
       int sampleSpread = samples[3] - samples[0];  // max - min (sorted)
-      if (sampleSpread > _maxSampleSpread) {
-        return -3;  // unstable reading, likely floating pin
-      }
+      if (sampleSpread > _maxSampleSpread) return potUnstable(sampleSpread);  // likely floating pin
 
       // Sticky edges - lock to 0 or 1023 when all samples are near extremes
-      if (samples[3] < 30) {  // all samples below 30 (sorted, so [3] is max)
-        responsiveValue = 0;
-        smoothValue = 0;
-        int retVal = 0;
-        retVal = checkBank(retVal);
-        if (retVal >= 0) setValue(retVal);
-        return retVal;
-      }
-      if (samples[0] > 4065) {  // all samples above 4065 (sorted, so [0] is min)
-        responsiveValue = 511;
-        smoothValue = 511;
-        int retVal = 1022;
-        retVal = checkBank(retVal);
-        if (retVal >= 0) setValue(retVal);
-        return retVal;
-      }
+      if (samples[3] < 30) return potEdge(false);  // all samples below 30 (sorted, so [3] is max)
+      if (samples[0] > 4065) return potEdge(true);  // all samples above 4065 (sorted, so [0] is min)
 
       int readValue = samples[1] + samples[2];  // middle two values
       responsiveUpdate(readValue >> 4);
-      int retVal = responsiveValue * 2;
+      if (_potAutoTune) potAutoTune(sampleSpread, true);
+      return potOutput(responsiveValue * 2);
+    }
+
+    /** Responsive filter settings and state of a pot, for batch filtering (MultiControlPots) */
+    struct PotFilter {
+      float smooth;             // smoothed value, 0-511
+      float error;              // error moving average, for sleep
+      float snapMultiplier;
+      float activityThreshold;
+      int maxSampleSpread;
+      bool asleep;
+      bool firstRead;           // the next reading sets the smoothed value
+      bool sleepEnable;
+      bool edgeSnap;            // stretch readings near the ends (with sleep enabled)
+    };
 
-      // Capture actual pot position for bank/latch tracking (before slew distorts it)
-      // Snap edges to ensure consistent values despite ADC noise at extremes
-      int bankVal = retVal;
-      if (retVal < 20) bankVal = 0;
-      else if (retVal > 1003) bankVal = 1022;
+    /** Get the pot filter settings and state */
+    PotFilter getPotFilter() {
+      return {smoothValue, errorEMA, snapMultiplier, activityThreshold, _maxSampleSpread,
+              sleeping, _firstRead, sleepEnable, sleepEnable && edgeSnapEnable};
+    }
 
-      // Output hysteresis - suppress small fluctuations except near edges
-      if (abs(retVal - _potValue) < _potHysteresis && retVal > 2 && retVal < 1020) {
-        retVal = _potValue;
+    /** Finish a pot reading filtered elsewhere: store the new filter state, then apply the
+    * bank snap, hysteresis and bank latching of readPot().
+    * @param readValue Sum of the middle two sorted samples
+    * @param spread Largest minus smallest sample
+    * @param smooth New smoothed value (0-511)
+    * @param error New error moving average
+    * @param asleep New sleep state
+    * @return As readPot()
+    */
+    int potFiltered(int readValue, int spread, float smooth, float error, bool asleep) {
+      rawValue = readValue >> 4;
+      _firstRead = false;
+      smoothValue = smooth;
+      errorEMA = error;
+      if (sleepEnable) {
+        if (sleeping && !asleep) MC_TRACE(MC_TRACE_RAW, rawValue);
+        sleeping = asleep;
       }
+      prevResponsiveValue = responsiveValue;
+      responsiveValue = (int)smooth;
+      responsiveValueHasChanged = responsiveValue != prevResponsiveValue;
+      if (_potAutoTune) potAutoTune(spread, true);
+      return potOutput(responsiveValue * 2);
+    }
 
-      // slew reading to smooth out rapid changes and increase reported resolution
-      float slewVal = slew((float)_potValue, (float)retVal, 0.5f);
-      retVal = (int)(slewVal + 0.5f);
+    /** Drop a pot reading whose samples are too far apart (likely a floating pin)
+    * @param spread Largest minus smallest sample, still counted as noise for setPotAutoTune()
+    * @return -3, as readPot()
+    */
+    int potUnstable(int spread) {
+      if (_potAutoTune) potAutoTune(spread, false);
+      return -3;
+    }
 
-      if (readValue == 0) {
-        retVal = min(checkBank(bankVal), retVal);
-      } else retVal = checkBank(bankVal);
-      if (retVal >= 0) setValue(retVal);
+    /** Lock the pot to an end (sticky edges), as readPot() does when all samples are near it
+    * @param high true for the top (1022), false for the bottom (0)
+    * @return As readPot()
+    */
+    int potEdge(bool high) {
+      responsiveValue = high ? 511 : 0;
+      smoothValue = responsiveValue;
+      int retVal = checkBank(high ? 1022 : 0);
+      if (retVal >= 0) setPotOutput(retVal);
       return retVal;
     }
 
@@ -974,6 +1386,7 @@ class MultiControl {
       int newVal = readPot();
       if (newVal < 0) return newVal;  // Pass through error codes (-1, -2, -3)
       if (newVal == prevVal) return -1;  // No change
+      MC_TRACE(MC_TRACE_CONSUME, newVal);
       return newVal;
     }
 
@@ -983,7 +1396,15 @@ class MultiControl {
       if (_controlType != _SWITCH) {
         setControl(_SWITCH);
       }
-      int val = digitalRead(_pin);
+      return switchLevel(MC_DIGITAL_READ(_pin));
+    }
+
+    /** Update the switch from a level read elsewhere (e.g. a port snapshot by MultiControlBoard)
+    * @return As readSwitch()
+    */
+    int switchLevel(uint8_t level) {
+      int val = level;
+      if (val != _switchValue) _moved = true;
       val = checkBank(val);
       if (val >= 0) setValue(val);
       return val;
@@ -995,24 +1416,40 @@ class MultiControl {
       return _switchValue;
     }
 
+    /* Check if reading the control uses the clock (gestures, touch hold time, encoder acceleration) */
+    bool readsClock() {
+      if (_controlType == _ENCODER) return _encAccelEnabled || _encoderHasButton;
+      return _controlType == _TOUCH || _controlType == _BUTTON || _controlType == _MUX_BUTTON;
+    }
+
     /* Read the control based on the set type */
-    int read() {
-      if (_controlType == 0) return readTouch();
+    int read() { return readsClock() ? read(MC_MILLIS()) : read(0); }
+
+    /* Read the control based on the set type, using an explicit timestamp (ms).
+    * Read a whole panel with one timestamp per scan, so every control times its gestures
+    * against the same clock (and a host test can drive a virtual one).
+    */
+    int read(unsigned long now) {
+      if (_controlType == 0) return readTouch(now);
       if (_controlType == 1) return readPot();
-      if (_controlType == 2) return readButton();
+      if (_controlType == 2) return readButton(now);
       if (_controlType == 3) return readSwitch();
-      if (_controlType == 4) return readMuxButton();
-      if (_controlType == _ENCODER) return readEncoder();
+      if (_controlType == 4) return readMuxButton(now);
+      if (_controlType == _ENCODER) return readEncoder(now);
+      if (_controlType == _SCANNED_KEY) return _gesture.debounced;  // scanned by MultiControlMatrix or MultiControlBoard
       return 0; // just in case
     }
 
     /* Return the read value if changed, otherwise return -1 */
-    int readChanged() {
+    int readChanged() { return readsClock() ? readChanged(MC_MILLIS()) : readChanged(0); }
+
+    /* Return the read value if changed, otherwise return -1, using an explicit timestamp (ms) */
+    int readChanged(unsigned long now) {
       // Serial.println("readChanged");
       int returnVal = -1;
       if (_controlType == 0) {
         int prevVal = _prevTouchValue;
-        int newVal = readTouch();
+        int newVal = readTouch(now);
         if (newVal != prevVal) returnVal = newVal;
       }
       if (_controlType == 1) {
@@ -1021,7 +1458,7 @@ class MultiControl {
         if (newVal != prevVal) returnVal = newVal;
       }
       if (_controlType == 2) {
-        int newVal = readButton();
+        int newVal = readButton(now);
         if (newVal != _prevButtonValue) {
           returnVal = newVal;
           _prevButtonValue = newVal;
@@ -1033,7 +1470,7 @@ class MultiControl {
         if (newVal != prevVal) returnVal = newVal;
       }
       if (_controlType == 4) {
-        int newVal = readMuxButton();
+        int newVal = readMuxButton(now);
         if (newVal != _prevButtonValue) {
           returnVal = newVal;
           _prevButtonValue = newVal;
@@ -1041,9 +1478,17 @@ class MultiControl {
       }
       if (_controlType == _ENCODER) {
         _encoderPrevPosition = _encoderPosition;
-        readEncoder();
+        readEncoder(now);
         if (_encoderPosition != _encoderPrevPosition) returnVal = _encoderPosition;
       }
+      if (_controlType == _SCANNED_KEY) {
+        int newVal = _gesture.debounced;
+        if (newVal != _prevButtonValue) {
+          returnVal = newVal;
+          _prevButtonValue = newVal;
+        }
+      }
+      if (returnVal >= 0) MC_TRACE(MC_TRACE_CONSUME, returnVal);
       return returnVal;
     }
 
@@ -1059,7 +1504,7 @@ class MultiControl {
       _controlType = type;
       if (_controlType == 0) _touchValue = val;
       if (_controlType == 1) _potValue = val;
-      // Note: _buttonValue for types 2 and 4 is managed by readButton/readMuxButton
+      // Note: button state for types 2 and 4 is managed by the gesture engine
       // state machine (press/release blocks). Don't overwrite it here.
       if (_controlType == 3) _switchValue = val;
       if (_controlType == _ENCODER) _encoderPosition = constrain(val, _encoderMin, _encoderMax);
@@ -1070,12 +1515,32 @@ class MultiControl {
       setValue(_controlType, val);
     }
 
+    /** Shape this control's value with a response curve, read with getCurvedValue().
+    * The value itself (banks, latching, getValue()) stays linear.
+    * @param curve The curve (may be shared between controls), or nullptr for none
+    * @param inMin Value that maps to the start of the curve (default 0)
+    * @param inMax Value that maps to the end of the curve (default 1023), e.g. the
+    *        pressure of a full press on a touch pad, to normalise pads to each other
+    */
+    void setCurve(const MultiControlCurve* curve, int inMin = 0, int inMax = 1023) {
+      _curve = curve;
+      _curveMin = inMin;
+      _curveScale = (1023 * 1024 + (inMax - inMin) / 2) / max(1, inMax - inMin);
+    }
+
+    /** Get the value shaped by the curve from setCurve() (the value itself without one) */
+    int getCurvedValue() {
+      int v = getValue();
+      if (_curve == nullptr) return v;
+      return _curve->map(((v - _curveMin) * _curveScale + 512) >> 10);
+    }
+
     // banks
     /* Ensure bank array has capacity for the required number of banks.
     *  Dynamically grows the array if needed, preserving existing values.
     */
     void ensureBankCapacity(int requiredBanks) {
-      if (requiredBanks <= _numBanks) return;
+      if (requiredBanks <= _numBanks || !_ownsBanks) return;
 
       // Allocate new array
       int* newValues = new int[requiredBanks];
@@ -1112,6 +1577,7 @@ class MultiControl {
     void setBank(uint8_t bank) {
       if (bank >= _numBanks) {
         ensureBankCapacity(bank + 1);
+        if (bank >= _numBanks) return;  // fixed bank storage
       }
       _bank = bank;
       _bankChanged = true;
@@ -1137,6 +1603,7 @@ class MultiControl {
     void setBankValue(int bank, int val) {
       if (bank >= _numBanks) {
         ensureBankCapacity(bank + 1);
+        if (bank >= _numBanks) return;  // fixed bank storage
       }
       _bankValues[bank] = val;
     }
@@ -1197,43 +1664,78 @@ class MultiControl {
       return _bankChanged && !(_latchAbove && _latchBelow && _firstLatchChanged);
     }
 
+    /** Get the latch code from the last read, without reading.
+     * @return 0 when not latched, otherwise the code the last read returned:
+     *         -1 below target, -2 above target, -4 below and moving, -5 above and moving
+     */
+    int8_t getLatchState() {
+      return _latchCode;
+    }
+
   private:
 
     uint8_t _pin = 0;
     int _touchValue = 0; // 0 - 1023
     int8_t _touchState = false; // 0 or 1, true is touched
-    int8_t _buttonValue = 0; // 0 or 1, true (1) is pressed
     int8_t _prevButtonValue = 0;
-    // Double-click detection (uses press-to-press timing for reliability)
-    unsigned long _prevPressTime = 0;  // timestamp of previous button press
-    unsigned long _lastReleaseTime = 0;  // timestamp of last button release
-    unsigned long _doubleClickTime = 350;  // ms window for double-click detection
-    bool _doubleClicked = false;  // flag set when double-click detected (cleared on isDoubleClicked())
-    bool _wasDoubleClicked = false;  // persistent flag (cleared on next button read, not on check)
-    bool _singleClicked = false;  // flag set when single-click confirmed
-    bool _clickPending = false;  // true if waiting to confirm single vs double click
-    unsigned long _lastPressDuration = 0;  // duration of last press (ms)
-    // Hold detection
-    unsigned long _pressStartTime = 0;  // timestamp when button was pressed
-    unsigned long _holdTime = 500;  // ms to trigger hold
-    bool _held = false;  // flag set when hold detected
-    bool _holdTriggered = false;  // ensures hold only triggers once per press
-    bool _wasHeldOnRelease = false;  // preserved hold state for release detection
-    bool _wasLongPressedOnRelease = false;  // preserved long-press state for release detection
-    bool _holdActionOccurred = false;  // external action during hold
-    bool _hadHoldAction = false;  // preserved action state for release detection
-    // Long-press detection (continuous state while held past threshold)
-    unsigned long _longPressTime = 1000;  // ms to trigger long-press
-    bool _longPressed = false;  // true while button held past long-press threshold
-    // Button debouncing
-    unsigned long _debounceTime = 20;  // ms debounce window
-    unsigned long _lastButtonChangeTime = 0;  // when raw state last changed
-    int8_t _rawButtonState = 1;  // raw (undebounced) button reading
-    int8_t _debouncedButtonState = 1;  // stable debounced state (1 = released)
+    // Button gesture state, packed into bitfields. Timestamps are the low 16 bits
+    // of millis() and are compared with wrap-around subtraction.
+    struct ButtonGesture {
+      uint16_t changeAt;  // when raw state last changed
+      uint16_t pressAt;  // when the current (or pending) press began
+      uint16_t firstPressAt;  // when the first press of a double-click began (to undo a glitch)
+      uint16_t lastDuration;  // duration of last press (ms), saturates at 65535
+      uint16_t raw : 1;  // raw (undebounced) button reading
+      uint16_t debounced : 1;  // stable debounced state (1 = released)
+      uint16_t down : 1;  // 1 while pressed (debounced)
+      uint16_t pending : 1;  // waiting to confirm single vs double click
+      uint16_t pressOverflow : 1;  // press has outlasted the 16-bit clock
+      uint16_t held : 1;  // set when hold detected (cleared on isHeld())
+      uint16_t holdTriggered : 1;  // ensures hold only triggers once per press
+      uint16_t longPressed : 1;  // true while held past long-press threshold
+      uint16_t doubleClicked : 1;  // set when double-click detected (cleared on isDoubleClicked())
+      uint16_t wasDoubleClicked : 1;  // persistent flag (cleared on next press or wasDoubleClicked())
+      uint16_t singleClicked : 1;  // set when single-click confirmed
+      uint16_t wasHeld : 1;  // preserved hold state for release detection
+      uint16_t wasLongPressed : 1;  // preserved long-press state for release detection
+      uint16_t holdAction : 1;  // external action during hold
+      uint16_t hadHoldAction : 1;  // preserved action state for release detection
+      uint8_t provisional : 1;  // speculative click reported (cleared on wasProvisionalClick())
+      uint8_t clickCancelled : 1;  // speculative click withdrawn (cleared on wasClickCancelled())
+      uint8_t glitch : 1;  // press shorter than _minPressTime rejected (cleared on wasGlitch())
+      uint8_t secondPress : 1;  // the current press made a double-click
+      ButtonGesture(): changeAt(0), pressAt(0), firstPressAt(0), lastDuration(0), raw(1), debounced(1), down(0),
+        pending(0), pressOverflow(0), held(0), holdTriggered(0), longPressed(0), doubleClicked(0),
+        wasDoubleClicked(0), singleClicked(0), wasHeld(0), wasLongPressed(0), holdAction(0),
+        hadHoldAction(0), provisional(0), clickCancelled(0), glitch(0), secondPress(0) {}
+    };
+    ButtonGesture _gesture;
+    uint32_t _gestureEvents = 0;  // MC_GESTURE_* bits since each consumer's last takeGestureEvents(), a byte each
+
+    /* Report gesture events to every consumer */
+    inline void addGestureEvents(uint8_t events) { _gestureEvents |= events * (uint32_t)0x01010101; }
+    uint16_t _doubleClickTime = 350;  // ms window for double-click detection
+    bool _speculativeClick = false;  // report clicks at once, cancel on double-click
+    uint16_t _holdTime = 500;  // ms to trigger hold
+    uint16_t _longPressTime = 1000;  // ms to trigger long-press
+    uint16_t _debounceTime = 20;  // ms debounce window (the lockout in eager mode)
+    uint16_t _minPressTime = 0;  // ms; shorter presses are glitches (0 = off)
+    uint8_t _debounceMode = MC_DEBOUNCE_STABLE;
+    const static uint16_t _GESTURE_MAX_MS = 0xF000;  // longest gesture time the 16-bit clock resolves
+    // gestureTable inputs and actions
+    const static uint8_t _GI_NONE = 0;
+    const static uint8_t _GI_PRESS = 1;
+    const static uint8_t _GI_PRESS_DOUBLE = 2;
+    const static uint8_t _GI_RELEASE = 3;
+    const static uint8_t _GI_EXPIRE = 4;
+    const static uint8_t _GA_PRESS = 0x04;
+    const static uint8_t _GA_RELEASE = 0x08;
+    const static uint8_t _GA_DOUBLE = 0x10;
+    const static uint8_t _GA_SINGLE = 0x20;
     int _minTouchValue = 1024; 
     int _maxTouchValue = 0; 
     int _prevTouchValue = 0;
-    uint8_t _controlType = 0; // 0 = touch, 1 = pot, 2 = button, 3 = switch, 4 = muxButton
+    uint8_t _controlType = 0; // 0 = touch, 1 = pot, 2 = button, 3 = switch, 4 = muxButton, 5 = encoder, 6 = scanned key
     int _potValue = 0; // 0 - 1023
     int _potHysteresis = 3; // Minimum change required to report new value (default 3, increase for less jitter)
     int8_t _switchValue = 0; // 0 - 1
@@ -1243,8 +1745,13 @@ class MultiControl {
     const static uint8_t _SWITCH = 3;
     const static uint8_t _MUX_BUTTON = 4;
     const static uint8_t _ENCODER = 5;
+    const static uint8_t _SCANNED_KEY = 6;
     int _numBanks = 0;
     int* _bankValues = nullptr;  // Dynamic allocation - grows as needed
+    const MultiControlCurve* _curve = nullptr;  // response curve for getCurvedValue()
+    int16_t _curveMin = 0;
+    int32_t _curveScale = 1024;  // Q10, inputs per value
+    bool _ownsBanks = true;  // false when the storage was passed to the constructor
     uint8_t _bank = 0;
     bool _bankChanged = true;
     bool _latchEnabled = true;  // Enable/disable latching on bank change
@@ -1253,6 +1760,7 @@ class MultiControl {
     int _firstLatchValue = -1;
     bool _firstLatchChanged = false;
     int _prevLatchedValue = -1;  // Track previous value while latched for movement detection
+    int8_t _latchCode = 0;  // last latch code returned by checkBank(), 0 when not latched
     // responsive read variables
     int analogResolution = 512; // 0-511 input range from readPot() >>4 shift
     float snapMultiplier = 0.05; // 0.01
@@ -1261,14 +1769,44 @@ class MultiControl {
     bool edgeSnapEnable = true;
     int _maxSampleSpread = 50;  // max allowed spread between min/max samples (detects floating pins)
     float smoothValue = 0.0;
+    #if MULTICONTROL_POT_FILTER == MC_POT_FILTER_ONE_EURO
+    float _oneEuroMinCutoff = 1.0f;
+    float _oneEuroBeta = 0.02f;
+    float _oneEuroDCutoff = 1.0f;
+    float _oneEuroSpeed = 0.0f;       // filtered speed, units/s
+    unsigned long _filterMicros = 0;  // time of the previous reading
+    #elif MULTICONTROL_POT_FILTER == MC_POT_FILTER_EMA
+    float _emaAlpha = 0.1f;
+    #endif
     unsigned long lastActivityMS = 0;
     float errorEMA = 0.0;
     bool sleeping = false;
+    bool _potAutoTune = false;
+    bool _potAutoTuneFrozen = false;
+    float _autoTuneMin = 1.0f;
+    float _autoTuneMax = 20.0f;
+    float _potSpreadNoise = 0.0f;  // noise from the sample spread, filter units
+    float _potRestNoise = 0.0f;    // peak deviation of the error average at rest, scaled as the above
+    float _potErrorMean = 0.0f;
+    constexpr static float _AUTO_TUNE_GAIN = 2.5f;  // activity threshold per unit of noise
     int rawValue = 0;
     int responsiveValue = 0;
     int prevResponsiveValue = 0;
     bool responsiveValueHasChanged = false;
     bool _firstRead = true;
+    bool _potSingleSample = false;  // one ADC conversion per readPot() (idle mode)
+    bool _moved = false;  // encoder or switch moved since the last isQuiet()
+    uint8_t _traceId = 255;  // 255 = derive from pin / mux channel
+    #ifdef MULTICONTROL_TRACE
+    int8_t _traceReported = -1;  // last state returned by isPressed() / isTouched()
+    /* Log a consume event when the app first sees a new state */
+    void traceReport(int8_t value) {
+      if (value != _traceReported) {
+        _traceReported = value;
+        MC_TRACE(MC_TRACE_CONSUME, value);
+      }
+    }
+    #endif
     uint8_t _muxControlPins[3] = {0};  // Static allocation (was dynamic new uint8_t[])
     uint8_t _muxChannel = 0;
     // Encoder
@@ -1289,6 +1827,7 @@ class MultiControl {
     unsigned long _encLastDetentTime = 0;   // Timestamp of last completed detent
     bool encoderToWrap = false;              // Wrap encoder position at range boundaries
     uint16_t _touchBaseline = 65535;  // Start high, will be reduced by actual readings
+    int16_t _touchDelta = 0;          // last reading minus the baseline
     // Touch hysteresis and debouncing
     int16_t _touchOnThreshold = 22;    // Higher threshold to turn ON (prevents false triggers)
     int16_t _touchOffThreshold = 16;   // Threshold to turn OFF - raised from 8 to handle capacitive coupling when multiple pads touched
@@ -1301,87 +1840,286 @@ class MultiControl {
     bool _touchDipSeen = false;              // Dip detected, waiting for recovery
     unsigned long _touchOnTime = 0;          // millis() when touch state last went ON
     uint16_t _touchMinHoldMs = 30;           // Minimum hold time (ms) - suppresses coupling-induced false releases
-
-    /** Read encoder push button using the same debounce + gesture state machine as readButton().
-    * Updates _buttonValue, _held, _doubleClicked, _singleClicked, etc.
+    // Non-blocking touch calibration (running mean and variance of untouched readings)
+    bool _touchCalibrating = false;
+    uint8_t _touchCalReads = 0;              // readings taken into the mean
+    uint8_t _touchCalTries = 0;              // readings seen, including skipped ones
+    uint8_t _touchCalMax = 50;
+    float _touchCalMean = 0.0f;
+    float _touchCalM2 = 0.0f;
+    const static uint8_t _TOUCH_CAL_MIN_READS = 8;
+    // Adaptive touch thresholds
+    bool _touchAdaptive = false;
+    float _touchIdleMean = 0.0f;   // idle delta offset
+    float _touchNoiseVar = 0.0f;   // idle delta variance
+    float _touchIdlePeak = 0.0f;   // idle delta peaks (rises quickly, falls slowly)
+    float _touchSignal = 0.0f;     // typical peak delta of a touch
+    int16_t _touchPeak = 0;        // peak delta of the current touch
+    constexpr static float _TOUCH_NOISE_ON = 5.0f;  // ON threshold in idle standard deviations
+
+    /** Read encoder push button using the same debounce + gesture engine as readButton(). */
+    void readEncoderButton() { readEncoderButton(MC_MILLIS()); }
+
+    /** Read encoder push button, using an explicit timestamp (ms) */
+    void readEncoderButton(unsigned long now) {
+      updateGesture(MC_DIGITAL_READ(_encoderButtonPin), now);
+    }
+
+    /** Button gesture engine shared by readButton(), readMuxButton() and readEncoderButton().
+    * Debounces the raw level, then steps the click state machine through gestureTable:
+    * one edge input (press, press inside the double-click window, or release) followed
+    * by an expiry input once the double-click window has passed. Hold and long-press
+    * are simple elapsed-time checks while pressed.
+    * @param rawVal The raw pin level (0 = pressed, pull-up wiring)
+    * @param now The current time in ms
+    * @return The debounced level: 0 is pressed, 1 is released
     */
-    void readEncoderButton() {
-      int rawVal = digitalRead(_encoderButtonPin);
-      unsigned long now = millis();
-
-      // Debouncing
-      if (rawVal != _rawButtonState) {
-        _lastButtonChangeTime = now;
-        _rawButtonState = rawVal;
-      }
-
-      int val = _debouncedButtonState;
-      if ((now - _lastButtonChangeTime) >= _debounceTime) {
-        if (_rawButtonState != _debouncedButtonState) {
-          _debouncedButtonState = _rawButtonState;
-          val = _debouncedButtonState;
+    int updateGesture(int rawVal, unsigned long now) {
+      // Rows are inputs, columns are phases (down << 1 | pending).
+      // Entries hold the next phase in bits 0-1 and _GA_* actions above that.
+      static const uint8_t gestureTable[5][4] = {
+        /* none    */ { 0, 1, 2, 3 },
+        /* press   */ { 3 | _GA_PRESS, 3 | _GA_PRESS, 2, 3 },
+        /* press2  */ { 3 | _GA_PRESS, 2 | _GA_PRESS | _GA_DOUBLE, 2, 3 },
+        /* release */ { 0, 1, 0 | _GA_RELEASE, 1 | _GA_RELEASE },
+        /* expire  */ { 0, 0 | _GA_SINGLE, 2, 3 }
+      };
+      ButtonGesture &g = _gesture;
+      uint16_t now16 = (uint16_t)now;
+
+      // Debouncing: only accept a new level once it has been stable for _debounceTime.
+      // Eager mode accepts it at once instead, and changeAt is the start of the lockout.
+      uint8_t raw = (rawVal != 0);
+      if (raw != g.raw) {
+        if (g.raw == g.debounced) MC_TRACE(MC_TRACE_RAW, raw);  // first edge, not the bounces
+        if (_debounceMode != MC_DEBOUNCE_EAGER) g.changeAt = now16;
+        g.raw = raw;
+      }
+      if ((uint16_t)(now16 - g.changeAt) >= _debounceTime && g.debounced != g.raw) {
+        g.debounced = g.raw;
+        if (_debounceMode == MC_DEBOUNCE_EAGER) g.changeAt = now16;
+        MC_TRACE(MC_TRACE_STATE, g.debounced);
+      }
+
+      uint8_t input = _GI_NONE;
+      if (g.debounced == 0 && !g.down) {
+        // Double-click uses press-to-press timing (more forgiving)
+        input = (g.pending && gestureElapsed(now16) < _doubleClickTime) ? _GI_PRESS_DOUBLE : _GI_PRESS;
+      } else if (g.debounced == 1 && g.down) {
+        input = _GI_RELEASE;
+      }
+      if (input != _GI_NONE) {
+        applyGesture(gestureTable[input][(g.down << 1) | g.pending], now16);
+        if (input == _GI_RELEASE && g.lastDuration < _minPressTime) rejectGlitch();
+      }
+      // A second press makes a double-click once it has lasted the min press time
+      if (g.secondPress && (!g.down || gestureElapsed(now16) >= _minPressTime)) confirmDouble();
+
+      if (g.down) {
+        uint16_t elapsed = gestureElapsed(now16);
+        if (elapsed >= _GESTURE_MAX_MS) g.pressOverflow = 1;  // saturate very long presses
+        if (!g.holdTriggered && elapsed >= _holdTime) {
+          g.held = 1;
+          addGestureEvents(MC_GESTURE_HOLD);
+          g.holdTriggered = 1;
+        }
+        if (elapsed >= _longPressTime && !g.longPressed) {
+          g.longPressed = 1;
+          addGestureEvents(MC_GESTURE_LONG);
         }
       }
+      // Confirm a single click once the double-click window has expired
+      if (g.pending && gestureElapsed(now16) >= _doubleClickTime) {
+        applyGesture(gestureTable[_GI_EXPIRE][(g.down << 1) | g.pending], now16);
+      }
+      return g.debounced;
+    }
 
-      if (val == 0 && _buttonValue == false) {
-        _buttonValue = true;
+    /** Apply one gestureTable entry: set the next phase and run its actions. */
+    void applyGesture(uint8_t entry, uint16_t now16) {
+      ButtonGesture &g = _gesture;
+      addGestureEvents((entry >> 2) & (MC_GESTURE_PRESS | MC_GESTURE_RELEASE | MC_GESTURE_SINGLE));
+      // A first press starts a speculative click
+      if (_speculativeClick && (entry & (_GA_PRESS | _GA_DOUBLE)) == _GA_PRESS) {
+        g.provisional = 1;
+        g.clickCancelled = 0;
+        addGestureEvents(MC_GESTURE_PROVISIONAL);
+      }
+      if (entry & _GA_DOUBLE) g.firstPressAt = g.pressAt;  // kept in case the second press is a glitch
+      if (entry & _GA_PRESS) {
         multiControlAnyButtonPressed += 1;
-        _singleClicked = false;
-        _wasDoubleClicked = false;
-        _wasLongPressedOnRelease = false;
-        _lastPressDuration = 0;
-        if (_prevPressTime > 0 && (now - _prevPressTime) < _doubleClickTime) {
-          _doubleClicked = true;
-          _wasDoubleClicked = true;
-          _clickPending = false;
-          _prevPressTime = 0;
-        } else {
-          _clickPending = true;
-          _prevPressTime = now;
-        }
-        _pressStartTime = now;
-        _holdTriggered = false;
-        _held = false;
-        _wasHeldOnRelease = false;
-        _holdActionOccurred = false;
-        _hadHoldAction = false;
-      }
-      if (val == 1 && _buttonValue == true) {
-        _buttonValue = false;
+        g.secondPress = (entry & _GA_DOUBLE) != 0;  // the double-click waits for confirmDouble()
+        g.singleClicked = 0;  // clear any unread single-click from previous press
+        g.wasDoubleClicked = 0;  // clear persistent flag on new press
+        g.wasLongPressed = 0;  // clear previous long-press latch
+        g.lastDuration = 0;
+        g.pressAt = now16;
+        g.pressOverflow = 0;
+        g.holdTriggered = 0;
+        g.held = 0;
+        g.wasHeld = 0;
+        g.holdAction = 0;
+        g.hadHoldAction = 0;
+      }
+      if (entry & _GA_RELEASE) {
         multiControlAnyButtonPressed -= 1;
-        _lastReleaseTime = now;
-        _wasHeldOnRelease = _holdTriggered;
-        _hadHoldAction = _holdActionOccurred;
-        _lastPressDuration = now - _pressStartTime;
-        _wasLongPressedOnRelease = _lastPressDuration >= _longPressTime;
-        _holdTriggered = false;
-        _held = false;
-        _holdActionOccurred = false;
-        _longPressed = false;
-      }
-      if (_buttonValue && !_holdTriggered && (now - _pressStartTime >= _holdTime)) {
-        _held = true;
-        _holdTriggered = true;
-      }
-      if (_buttonValue && (now - _pressStartTime >= _longPressTime)) {
-        _longPressed = true;
-      }
-      if (_clickPending && !_buttonValue && (now - _prevPressTime) >= _doubleClickTime) {
-        _singleClicked = true;
-        _clickPending = false;
-        _prevPressTime = 0;
-      }
-    }
-
-    /** Return a partial increment toward target from current value
-    * @curr The curent value
-    * @target The desired final value
-    * @amt The percentage toward target (0.0 - 1.0)
+        // Save hold and action state before reset (for release checks)
+        g.lastDuration = gestureElapsed(now16);
+        g.wasHeld = g.holdTriggered;
+        g.hadHoldAction = g.holdAction;
+        g.wasLongPressed = g.lastDuration >= _longPressTime;
+        g.holdTriggered = 0;
+        g.held = 0;
+        g.holdAction = 0;
+        g.longPressed = 0;
+      }
+      if (entry & _GA_SINGLE) g.singleClicked = 1;
+      g.down = (entry >> 1) & 1;
+      g.pending = entry & 1;
+    }
+
+    /** Report the double-click made by the current second press; a speculative click is cancelled */
+    void confirmDouble() {
+      ButtonGesture &g = _gesture;
+      g.secondPress = 0;
+      g.doubleClicked = 1;
+      g.wasDoubleClicked = 1;
+      addGestureEvents(MC_GESTURE_DOUBLE);
+      if (_speculativeClick) {
+        g.provisional = 0;
+        g.clickCancelled = 1;
+        addGestureEvents(MC_GESTURE_CANCEL);
+      }
+    }
+
+    /** Reject the press just released as a glitch (shorter than _minPressTime).
+    * A first press loses its click. A second press never made its double-click, so the first
+    * press is pending again, to be confirmed as a single click when its window expires.
     */
-    inline
-    float slew(float curr, float target, float amt) {
-      float dist = target - curr;
-      return curr + dist * amt;
+    void rejectGlitch() {
+      ButtonGesture &g = _gesture;
+      g.glitch = 1;
+      if (!g.secondPress) {
+        cancelClick();
+        return;
+      }
+      g.secondPress = 0;
+      g.pressAt = g.firstPressAt;
+      g.pending = 1;
+    }
+
+    /** Milliseconds since the current (or pending) press began, saturating at 65535 */
+    inline uint16_t gestureElapsed(uint16_t now16) {
+      return _gesture.pressOverflow ? 0xFFFF : (uint16_t)(now16 - _gesture.pressAt);
+    }
+
+    /** Sync the gesture engine to the current pin level without generating events */
+    void resetGesture(int rawVal) {
+      _gesture.changeAt = (uint16_t)MC_MILLIS();
+      _gesture.raw = (rawVal != 0);
+      _gesture.debounced = _gesture.raw;
+      _gesture.down = (rawVal == 0);  // true if pressed
+    }
+
+    /** Feed one raw touch reading to the running calibration.
+    * Updates the provisional baseline and ends calibration once it has settled.
+    */
+    void touchCalibrationStep(int rawValue) {
+      // Every read counts toward the limit, so a pad touched or noisy throughout still finishes
+      _touchCalTries++;
+      bool settled = false;
+      bool skip = _touchState  // don't learn from a finger
+        || (_touchCalReads >= 4 && fabsf(rawValue - _touchCalMean) > _touchOnThreshold);
+      if (!skip) {
+        // Welford's running mean and variance
+        _touchCalReads++;
+        float d = rawValue - _touchCalMean;
+        _touchCalMean += d / _touchCalReads;
+        _touchCalM2 += d * (rawValue - _touchCalMean);
+        _touchBaseline = (uint16_t)(_touchCalMean + 0.5f);
+        if (_touchCalReads >= _TOUCH_CAL_MIN_READS) {
+          float variance = _touchCalM2 / (_touchCalReads - 1);
+          settled = variance < 0.25f * _touchCalReads;  // standard error of the mean < 0.5
+        }
+      }
+      if (settled || _touchCalTries >= _touchCalMax) endTouchCalibration();
+    }
+
+    /* End calibration with the baseline taken so far */
+    void endTouchCalibration() {
+      _touchCalibrating = false;
+      _baselineDriftCounter = 0;
+      if (_touchAdaptive && _touchCalReads > 1) {
+        _touchIdleMean = 0.0f;
+        _touchNoiseVar = _touchCalM2 / (_touchCalReads - 1);
+      }
+    }
+
+    /* Track the pad's idle noise and touch peaks and set its thresholds and debounce from them */
+    void touchAdapt(int delta) {
+      if (_touchState) {
+        if (delta > _touchPeak) _touchPeak = delta;
+      } else if (delta < _touchOnThreshold && _touchDebounceCount == 0) {
+        // Idle: no finger and not on the way to a touch. The baseline follows drops at once
+        // and rises slowly, so the idle delta has an offset; keep it out of the noise.
+        float d = delta - _touchIdleMean;
+        _touchIdleMean += d * (1.0f / 256.0f);
+        _touchNoiseVar += (d * d - _touchNoiseVar) * (1.0f / 256.0f);
+        float a = fabsf(d);
+        _touchIdlePeak += (a - _touchIdlePeak) * (a > _touchIdlePeak ? 1.0f / 16.0f : 1.0f / 2048.0f);
+      }
+      float noise = max(sqrtf(_touchNoiseVar) * _TOUCH_NOISE_ON, _touchIdlePeak * 1.5f);
+      float on = max(max(_touchIdleMean + noise, _touchSignal * 0.4f), 4.0f);
+      _touchOnThreshold = (int16_t)(on + 0.5f);
+      _touchOffThreshold = (int16_t)(on * 0.7f + 0.5f);
+      _touchDebounceReads = on - _touchIdleMean >= noise * 2.0f ? 1 : 2;
+    }
+
+    /* Track the pot's noise and set the activity threshold and hysteresis from it */
+    void potAutoTune(int spread, bool filtered) {
+      if (_potAutoTuneFrozen) return;
+      // The range of 4 samples is about 2 standard deviations; the middle-two mean has about 0.6
+      // of the sample noise, and the >>4 of their sum is 1/8 of a sample
+      _potSpreadNoise += (spread * (1.0f / 28.0f) - _potSpreadNoise) * (1.0f / 256.0f);
+      // Slower noise (hum, supply ripple) shows in the error average. Its deviation from its own
+      // slow mean leaves out the offset left when the filter sleeps a little off the reading, and
+      // moves are gated out. Track its peaks (rise quickly, fall slowly); the threshold should clear
+      // them by half again, which is 0.6 of a peak in noise units.
+      if (filtered) {
+        _potErrorMean += (errorEMA - _potErrorMean) * (1.0f / 64.0f);
+        float e = fabsf(errorEMA - _potErrorMean) * (1.5f / _AUTO_TUNE_GAIN);
+        if (e < activityThreshold) _potRestNoise += (e - _potRestNoise) * (e > _potRestNoise ? 1.0f / 64.0f : 1.0f / 8192.0f);
+      }
+      activityThreshold = constrain(getPotNoise() * _AUTO_TUNE_GAIN, _autoTuneMin, _autoTuneMax);
+      _potHysteresis = max(1, (int)(activityThreshold * 0.75f + 0.5f));
+    }
+
+    /* The end of readPot(): bank snap, hysteresis and bank latching of a filtered value */
+    int potOutput(int retVal) {
+      // Capture actual pot position for bank/latch tracking (before hysteresis holds it)
+      // Snap edges to ensure consistent values despite ADC noise at extremes
+      int bankVal = retVal;
+      if (retVal < 20) bankVal = 0;
+      else if (retVal > 1003) bankVal = 1022;
+
+      // Output hysteresis - suppress small fluctuations except near edges
+      if (abs(retVal - _potValue) < _potHysteresis && retVal > 2 && retVal < 1020) {
+        retVal = _potValue;
+      }
+
+      // Latching follows the pot position; the output holds within the hysteresis, snapped at the ends
+      int latch = checkBank(bankVal);
+      if (latch < 0) retVal = latch;
+      else if (bankVal == 0 || bankVal == 1022) retVal = bankVal;
+      else retVal = min(1023, retVal);
+      if (retVal >= 0) setPotOutput(retVal);
+      return retVal;
+    }
+
+    /* Store a new pot output value, logging it if it changed */
+    inline void setPotOutput(int val) {
+      if (val != _potValue) MC_TRACE(MC_TRACE_STATE, val);
+      setValue(val);
     }
 
     /* Check if the bank has changed and if so, set the pot and switch to latch
@@ -1397,6 +2135,7 @@ class MultiControl {
       if (!_latchEnabled) {
         _bankChanged = false;
         _prevLatchedValue = -1;
+        _latchCode = 0;
         return min(1023, val);
       }
 
@@ -1429,10 +2168,13 @@ class MultiControl {
           } else {
             val = moved ? -5 : -2; // above target, moved or stationary
           }
+          _latchCode = val;
+          return val;
         }
       } else {
         _prevLatchedValue = -1; // reset when not latched
       }
+      _latchCode = 0;
       return min(1023, val);
     }
 
@@ -1441,6 +2183,9 @@ class MultiControl {
       rawValue = rawValueRead;
       if (_firstRead) {
         smoothValue = rawValue;  // sync to actual pot position on first read
+        #if MULTICONTROL_POT_FILTER == MC_POT_FILTER_ONE_EURO
+          _filterMicros = MC_MICROS();
+        #endif
         _firstRead = false;
       }
       prevResponsiveValue = responsiveValue;
@@ -1458,15 +2203,25 @@ class MultiControl {
         if(newValue < 0) newValue = 0;  // prevent negative values from edge snap
       }
       unsigned int diff = abs(newValue - smoothValue);
-      errorEMA += ((newValue - smoothValue) - errorEMA) * 0.4;
+      errorEMA += ((newValue - smoothValue) - errorEMA) * 0.4f;
       if(sleepEnable) {
+        bool wasSleeping = sleeping;
         sleeping = abs(errorEMA) < activityThreshold;
-      }
-      if(sleepEnable && sleeping) {
-        return (int)smoothValue;
-      }
-      float snap = snapCurve(diff * snapMultiplier);
-      smoothValue += (newValue - smoothValue) * snap;
+        if (wasSleeping && !sleeping) MC_TRACE(MC_TRACE_RAW, newValue);
+      }
+      #if MULTICONTROL_POT_FILTER == MC_POT_FILTER_ONE_EURO
+        (void)diff;
+        oneEuroUpdate(newValue);
+      #elif MULTICONTROL_POT_FILTER == MC_POT_FILTER_EMA
+        (void)diff;
+        smoothValue += (newValue - smoothValue) * _emaAlpha;
+      #else
+        if(sleepEnable && sleeping) {
+          return (int)smoothValue;
+        }
+        float snap = snapCurve(diff * snapMultiplier);
+        smoothValue += (newValue - smoothValue) * snap;
+      #endif
       if(smoothValue < 0.0) {
         smoothValue = 0.0;
       } else if(smoothValue > analogResolution - 1) {
@@ -1475,23 +2230,36 @@ class MultiControl {
       return (int)smoothValue;
     }
 
+    #if MULTICONTROL_POT_FILTER == MC_POT_FILTER_ONE_EURO
+    /* Smoothing factor of a one-pole low-pass with cutoff fc (Hz) for a dt (s) step */
+    static inline float oneEuroAlpha(float fc, float dt) {
+      float tau = 1.0f / (6.2831853f * fc);
+      return 1.0f / (1.0f + tau / dt);
+    }
+
+    /* One-Euro filter step (Casiez et al. 2012), timed from the real interval between readings */
+    void oneEuroUpdate(int newValue) {
+      unsigned long now = MC_MICROS();
+      float dt = (now - _filterMicros) * 0.000001f;
+      _filterMicros = now;
+      if (dt <= 0.0f) dt = 0.001f;  // same timestamp: treat as a 1 ms step
+      else if (dt > 0.5f) dt = 0.5f;  // long pause: don't read it as a slow move
+      float speed = (newValue - smoothValue) / dt;
+      _oneEuroSpeed += (speed - _oneEuroSpeed) * oneEuroAlpha(_oneEuroDCutoff, dt);
+      float cutoff = _oneEuroMinCutoff + _oneEuroBeta * fabsf(_oneEuroSpeed);
+      smoothValue += (newValue - smoothValue) * oneEuroAlpha(cutoff, dt);
+    }
+    #endif
+
     float snapCurve(float x) {
-      float y = 1.0 / (x + 1.0);
-      y = (1.0 - y) * 2.0;
-      if(y > 1.0) {
-        return 1.0;
+      float y = 1.0f / (x + 1.0f);
+      y = (1.0f - y) * 2.0f;
+      if(y > 1.0f) {
+        return 1.0f;
       }
       return y;
     }
 
-    /** Set max allowed sample spread for floating pin detection
-     * @param spread Max difference between min/max of 4 samples (default 150)
-     *               Set to 4096 to disable floating pin detection
-     */
-    void setMaxSampleSpread(int spread) {
-      _maxSampleSpread = spread;
-    }
-
     // Set to MUX control pins for the current channel
     void muxWrite() {
       for (int i = 0; i < 3; i++) {
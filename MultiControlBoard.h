@@ -0,0 +1,441 @@
+/*
+ * MultiControlBoard.h
+ *
+ * Describe a board as a constexpr layout and let the compiler plan the scan.
+ * The layout lists every control (type and pins), the mux select pins and the number of banks:
+ *
+ *   constexpr auto layout = multiControlLayout(
+ *     mcBanks(4), mcMuxSelect(25, 26, 27),
+ *     mcPot(36), mcPot(39), mcButton(18), mcEncoder(21, 22, 23), mcMuxButton(34, 0), mcMuxButton(34, 1));
+ *   MultiControlBoard<layout> board;
+ *
+ * From it the compiler builds a fixed scan plan: buttons, switches and encoders are read together
+ * from one snapshot of the GPIO input registers; mux buttons are read one select step per channel
+ * (all muxes at once), with the steps in Gray code order so one select line changes at a time;
+ * pots are read grouped by ADC unit in channel order, and touch pads in channel order.
+ * All state is sized exactly in the board object, with no heap. Mistakes such as a pin used twice,
+ * a touch control on a pin without touch sensing, or a pot on a pin without an ADC channel are
+ * compile errors. Needs C++17.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_BOARD_H_
+#define MULTICONTROL_BOARD_H_
+
+#if __cplusplus < 201703L
+#error "MultiControlBoard.h needs C++17 or later (-std=gnu++17)"
+#endif
+
+#include "MultiControl.h"
+#include "MultiControlEncoders.h"
+#include <type_traits>
+#include <utility>
+
+#if defined(ESP32) && !defined(MULTICONTROL_CAPTURE)
+#include "soc/gpio_reg.h"
+#include "soc/soc_caps.h"
+#endif
+
+#define MC_NO_PIN 255
+#define MC_DEF_MUX_SELECT 0xF0  // layout setting: mux select pins
+#define MC_DEF_BANKS 0xF1       // layout setting: number of banks
+#define MC_MUX_SETTLE_US 10     // as readMuxButton()
+
+/** One layout entry: a control or a board setting. Make them with the mc*() functions below. */
+struct MultiControlDef {
+  uint8_t type;  // control type 0-5, or MC_DEF_*
+  uint8_t pin;   // GPIO; the common pin for mux buttons, channel A for encoders
+  uint8_t pin2;  // mux channel, or encoder channel B
+  uint8_t pin3;  // encoder push button
+};
+
+constexpr MultiControlDef mcTouch(uint8_t pin) { return {0, pin, MC_NO_PIN, MC_NO_PIN}; }
+constexpr MultiControlDef mcPot(uint8_t pin) { return {1, pin, MC_NO_PIN, MC_NO_PIN}; }
+constexpr MultiControlDef mcButton(uint8_t pin) { return {2, pin, MC_NO_PIN, MC_NO_PIN}; }
+constexpr MultiControlDef mcSwitch(uint8_t pin) { return {3, pin, MC_NO_PIN, MC_NO_PIN}; }
+/** A button on a 4051-style mux: its common pin and channel 0-7 */
+constexpr MultiControlDef mcMuxButton(uint8_t commonPin, uint8_t channel) { return {4, commonPin, channel, MC_NO_PIN}; }
+constexpr MultiControlDef mcEncoder(uint8_t pinA, uint8_t pinB, uint8_t buttonPin = MC_NO_PIN) { return {5, pinA, pinB, buttonPin}; }
+/** The select pins (S0, S1, S2) shared by every mux on the board */
+constexpr MultiControlDef mcMuxSelect(uint8_t s0, uint8_t s1, uint8_t s2) { return {MC_DEF_MUX_SELECT, s0, s1, s2}; }
+/** The number of banks every control keeps values for (default 1) */
+constexpr MultiControlDef mcBanks(uint8_t banks) { return {MC_DEF_BANKS, banks, MC_NO_PIN, MC_NO_PIN}; }
+
+template <size_t N>
+struct MultiControlLayout {
+  MultiControlDef defs[N];
+};
+
+/** Build a layout from mc*() entries. Controls are numbered in the order given; settings don't count. */
+template <typename... Defs>
+constexpr MultiControlLayout<sizeof...(Defs)> multiControlLayout(Defs... defs) {
+  static_assert((std::is_same<Defs, MultiControlDef>::value && ...), "multiControlLayout() takes mcPot(), mcButton() and the other mc*() entries");
+  return {{defs...}};
+}
+
+// GPIO capabilities of the target, for the layout checks and the scan order.
+// ADC channels are returned as unit * 16 + channel, -1 when a pin has none.
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3)
+constexpr bool mcPinUsable(uint8_t pin) { return pin <= 48 && !(pin >= 22 && pin <= 32); }  // 26-32: flash and PSRAM
+#if defined(CONFIG_IDF_TARGET_ESP32S2)
+constexpr bool mcPinCanOutput(uint8_t pin) { return mcPinUsable(pin) && pin != 46; }
+#else
+constexpr bool mcPinCanOutput(uint8_t pin) { return mcPinUsable(pin); }
+#endif
+constexpr int mcTouchChannel(uint8_t pin) { return (pin >= 1 && pin <= 14) ? pin : -1; }
+constexpr int mcAdcChannel(uint8_t pin) {
+  return (pin >= 1 && pin <= 10) ? pin - 1 : (pin >= 11 && pin <= 20) ? 16 + pin - 11 : -1;
+}
+#elif defined(CONFIG_IDF_TARGET_ESP32) || !defined(ESP32)
+// The original ESP32, also used for host builds
+constexpr bool mcPinUsable(uint8_t pin) {
+  return pin <= 39 && !(pin >= 6 && pin <= 11) && pin != 20 && pin != 24 && !(pin >= 28 && pin <= 31);  // 6-11: flash
+}
+constexpr bool mcPinCanOutput(uint8_t pin) { return mcPinUsable(pin) && pin < 34; }  // 34-39 are input only
+constexpr int mcTouchChannel(uint8_t pin) {
+  const uint8_t pins[10] = {4, 0, 2, 15, 13, 12, 14, 27, 33, 32};
+  for (int t = 0; t < 10; t++) if (pins[t] == pin) return t;
+  return -1;
+}
+constexpr int mcAdcChannel(uint8_t pin) {
+  const uint8_t adc1[8] = {36, 37, 38, 39, 32, 33, 34, 35};
+  const uint8_t adc2[10] = {4, 0, 2, 15, 13, 12, 14, 27, 25, 26};
+  for (int c = 0; c < 8; c++) if (adc1[c] == pin) return c;
+  for (int c = 0; c < 10; c++) if (adc2[c] == pin) return 16 + c;
+  return -1;
+}
+#else
+// Other targets: only basic checks
+constexpr bool mcPinUsable(uint8_t pin) { return pin < 64; }
+constexpr bool mcPinCanOutput(uint8_t pin) { return pin < 64; }
+constexpr int mcTouchChannel(uint8_t pin) { return pin; }
+constexpr int mcAdcChannel(uint8_t pin) { return pin; }
+#endif
+
+// Layout checks and scan planning, evaluated by the compiler
+
+/** The compile-time scan plan for a layout of N entries */
+template <size_t N>
+struct MultiControlPlan {
+  MultiControlDef controls[N];  // the controls in layout order, without the settings
+  uint8_t count;
+  uint8_t banks;
+  MultiControlDef muxSelect;
+  uint8_t numTouch, numPots, numButtons, numSwitches, numMux, numEncoders;
+  uint8_t touch[N];        // control indices, in touch channel order
+  uint8_t pots[N];         // by ADC unit, then channel
+  uint8_t buttons[N];
+  uint8_t switches[N];
+  uint8_t mux[N];          // by select step, then common pin
+  uint8_t stepChannel[8];  // mux channel of each select step
+  uint8_t stepEnd[8];      // end of each step's buttons in mux[]
+  uint8_t steps;
+  uint64_t digitalMask;    // pins in the input snapshot
+  uint64_t muxMask;        // mux common pins
+};
+
+template <size_t N>
+constexpr uint8_t mcLayoutCount(const MultiControlLayout<N>& layout, uint8_t type) {
+  uint8_t n = 0;
+  for (size_t e = 0; e < N; e++) n += layout.defs[e].type == type;
+  return n;
+}
+
+/* Insertion sort of control indices by a key */
+template <size_t N>
+constexpr void mcLayoutSort(const MultiControlPlan<N>& p, uint8_t* list, uint8_t n, int (*key)(uint8_t)) {
+  for (uint8_t i = 1; i < n; i++) {
+    uint8_t v = list[i];
+    uint8_t j = i;
+    while (j > 0 && key(p.controls[list[j - 1]].pin) > key(p.controls[v].pin)) {
+      list[j] = list[j - 1];
+      j--;
+    }
+    list[j] = v;
+  }
+}
+
+template <size_t N>
+constexpr MultiControlPlan<N> multiControlPlan(const MultiControlLayout<N>& layout) {
+  MultiControlPlan<N> p = {};
+  p.banks = 1;
+  p.muxSelect = mcMuxSelect(MC_NO_PIN, MC_NO_PIN, MC_NO_PIN);
+  for (size_t e = 0; e < N; e++) {
+    const MultiControlDef& d = layout.defs[e];
+    if (d.type == MC_DEF_BANKS) p.banks = d.pin;
+    if (d.type == MC_DEF_MUX_SELECT) p.muxSelect = d;
+    if (d.type > 5) continue;
+    uint8_t i = p.count++;
+    p.controls[i] = d;
+    if (d.type == 0) p.touch[p.numTouch++] = i;
+    if (d.type == 1) p.pots[p.numPots++] = i;
+    if (d.type == 2) p.buttons[p.numButtons++] = i;
+    if (d.type == 3) p.switches[p.numSwitches++] = i;
+    if (d.type == 4) p.numMux++;
+    if (d.type == 5) p.numEncoders++;
+    if ((d.type == 2 || d.type == 3) && d.pin < 64) p.digitalMask |= 1ULL << d.pin;
+    if (d.type == 4 && d.pin < 64) p.muxMask |= 1ULL << d.pin;
+    if (d.type == 5 && d.pin < 64 && d.pin2 < 64) {
+      p.digitalMask |= (1ULL << d.pin) | (1ULL << d.pin2);
+      if (d.pin3 < 64) p.digitalMask |= 1ULL << d.pin3;
+    }
+  }
+  mcLayoutSort(p, p.touch, p.numTouch, mcTouchChannel);
+  mcLayoutSort(p, p.pots, p.numPots, mcAdcChannel);
+  // One select step per channel in use, visited in Gray code order
+  const uint8_t gray[8] = {0, 1, 3, 2, 6, 7, 5, 4};
+  uint8_t nm = 0;
+  for (uint8_t g = 0; g < 8; g++) {
+    uint8_t before = nm;
+    for (uint8_t i = 0; i < p.count; i++) {
+      if (p.controls[i].type == 4 && p.controls[i].pin2 == gray[g]) p.mux[nm++] = i;
+    }
+    if (nm > before) {
+      p.stepChannel[p.steps] = gray[g];
+      p.stepEnd[p.steps] = nm;
+      p.steps++;
+    }
+  }
+  return p;
+}
+
+template <size_t N>
+constexpr bool mcLayoutTypesValid(const MultiControlLayout<N>& layout) {
+  for (size_t e = 0; e < N; e++) {
+    uint8_t t = layout.defs[e].type;
+    if (t > 5 && t != MC_DEF_MUX_SELECT && t != MC_DEF_BANKS) return false;
+  }
+  return true;
+}
+
+/* Call check(pin, sharedMux) for every pin the layout uses until it returns false.
+ * Only mux common pins may be shared, and only with other mux buttons. */
+template <size_t N, typename Check>
+constexpr bool mcLayoutEachPin(const MultiControlLayout<N>& layout, Check check) {
+  for (size_t e = 0; e < N; e++) {
+    const MultiControlDef& d = layout.defs[e];
+    if (d.type <= 3 && !check(d.pin, false)) return false;
+    if (d.type == 4 && !check(d.pin, true)) return false;
+    if (d.type == 5 || d.type == MC_DEF_MUX_SELECT) {
+      if (!check(d.pin, false) || !check(d.pin2, false)) return false;
+      if (d.pin3 != MC_NO_PIN && !check(d.pin3, false)) return false;
+    }
+  }
+  return true;
+}
+
+template <size_t N>
+constexpr bool mcLayoutPinsExist(const MultiControlLayout<N>& layout) {
+  return mcLayoutEachPin(layout, [](uint8_t pin, bool) { return mcPinUsable(pin); });
+}
+
+template <size_t N>
+constexpr bool mcLayoutPinsUnique(const MultiControlLayout<N>& layout) {
+  uint64_t used = 0, mux = 0;
+  return mcLayoutEachPin(layout, [&](uint8_t pin, bool sharedMux) {
+    uint64_t bit = 1ULL << (pin & 63);
+    if ((used & bit) && !(sharedMux && (mux & bit))) return false;
+    if ((used & bit) == 0 && sharedMux) mux |= bit;
+    if (!sharedMux) mux &= ~bit;
+    used |= bit;
+    return true;
+  });
+}
+
+template <size_t N>
+constexpr bool mcLayoutMuxUnique(const MultiControlLayout<N>& layout) {
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = i + 1; j < N; j++) {
+      const MultiControlDef& a = layout.defs[i];
+      const MultiControlDef& b = layout.defs[j];
+      if (a.type == 4 && b.type == 4 && a.pin == b.pin && a.pin2 == b.pin2) return false;
+    }
+  }
+  return true;
+}
+
+template <size_t N>
+constexpr bool mcLayoutAll(const MultiControlLayout<N>& layout, uint8_t type, bool (*ok)(const MultiControlDef&)) {
+  for (size_t e = 0; e < N; e++) if (layout.defs[e].type == type && !ok(layout.defs[e])) return false;
+  return true;
+}
+
+constexpr bool mcDefTouchOk(const MultiControlDef& d) { return mcTouchChannel(d.pin) >= 0; }
+constexpr bool mcDefPotOk(const MultiControlDef& d) { return mcAdcChannel(d.pin) >= 0; }
+constexpr bool mcDefMuxChannelOk(const MultiControlDef& d) { return d.pin2 <= 7; }
+constexpr bool mcDefSelectOk(const MultiControlDef& d) {
+  return mcPinCanOutput(d.pin) && mcPinCanOutput(d.pin2) && mcPinCanOutput(d.pin3);
+}
+
+template <const auto& Layout>
+class MultiControlBoard {
+    static constexpr auto PLAN = multiControlPlan(Layout);
+
+  public:
+    /** Number of controls */
+    static constexpr uint8_t COUNT = PLAN.count;
+    /** Number of banks */
+    static constexpr uint8_t BANKS = PLAN.banks;
+
+  private:
+    static_assert(mcLayoutTypesValid(Layout), "MultiControlBoard: unknown layout entry; use the mc*() functions");
+    static_assert(COUNT > 0, "MultiControlBoard: the layout has no controls");
+    static_assert(COUNT <= 64, "MultiControlBoard: more than 64 controls");
+    static_assert(PLAN.numEncoders <= MultiControlEncoders::MAX_ENCODERS, "MultiControlBoard: more than 32 encoders");
+    static_assert(mcLayoutCount(Layout, MC_DEF_MUX_SELECT) <= 1 && mcLayoutCount(Layout, MC_DEF_BANKS) <= 1,
+                  "MultiControlBoard: mcMuxSelect() or mcBanks() given more than once");
+    static_assert(BANKS >= 1, "MultiControlBoard: mcBanks() needs at least 1 bank");
+    static_assert(mcLayoutPinsExist(Layout), "MultiControlBoard: a pin does not exist on this chip or is used by flash");
+    static_assert(mcLayoutPinsUnique(Layout), "MultiControlBoard: a pin is used twice");
+    static_assert(mcLayoutAll(Layout, 0, mcDefTouchOk), "MultiControlBoard: touch control on a pin without touch sensing");
+    static_assert(mcLayoutAll(Layout, 1, mcDefPotOk), "MultiControlBoard: pot on a pin without an ADC channel");
+    static_assert(PLAN.numMux == 0 || PLAN.muxSelect.pin != MC_NO_PIN, "MultiControlBoard: mux buttons need mcMuxSelect()");
+    static_assert(mcLayoutAll(Layout, 4, mcDefMuxChannelOk), "MultiControlBoard: mux channel above 7");
+    static_assert(mcLayoutMuxUnique(Layout), "MultiControlBoard: two mux buttons on the same common pin and channel");
+    static_assert(PLAN.numMux == 0 || PLAN.muxSelect.pin == MC_NO_PIN || mcDefSelectOk(PLAN.muxSelect),
+                  "MultiControlBoard: a mux select pin is input only");
+
+  public:
+    /** Constructor. Call begin() in setup() to configure the pins. */
+    MultiControlBoard(): MultiControlBoard(std::make_index_sequence<COUNT>()) {}
+
+    /** Configure every pin and control from the layout */
+    void begin() {
+      for (uint8_t i = 0; i < COUNT; i++) {
+        const MultiControlDef& d = PLAN.controls[i];
+        MultiControl& c = _controls[i];
+        if (d.type == 0 || d.type == 1 || d.type == 3) {
+          c.setPin(d.pin);
+          c.setControl(d.type);
+          if (d.type == 1) analogSetPinAttenuation(d.pin, ADC_11db);
+        } else if (d.type == 2 || d.type == 4) {
+          c.setControl(6);  // scanned key: debounced from the levels fed by update()
+          c.setPin(d.pin);
+          pinMode(d.pin, INPUT_PULLUP);
+        } else if (d.type == 5) {
+          c.setEncoderPins(d.pin, d.pin2, d.pin3 == MC_NO_PIN ? 0 : d.pin3);
+          _encoders.addEncoder(&c, d.pin, d.pin2, d.pin3 == MC_NO_PIN ? MultiControlEncoders::NO_BIT : d.pin3);
+        }
+      }
+      if constexpr (PLAN.numMux > 0) {
+        pinMode(PLAN.muxSelect.pin, OUTPUT);
+        pinMode(PLAN.muxSelect.pin2, OUTPUT);
+        pinMode(PLAN.muxSelect.pin3, OUTPUT);
+        _muxChannel = 0xFF;
+      }
+    }
+
+    /** Scan every control in plan order. Call once per loop, then use the controls as usual
+    * (isPressed(), wasSingleClicked(), getValue(), getEncoderPosition() and so on),
+    * without calling their read functions.
+    */
+    void update() { update(MC_MILLIS()); }
+
+    /** Scan every control, using an explicit timestamp (ms) */
+    void update(unsigned long now) {
+      if constexpr (PLAN.digitalMask != 0) {
+        uint64_t levels = readPins<PLAN.digitalMask>();
+        for (uint8_t k = 0; k < PLAN.numButtons; k++) {
+          uint8_t i = PLAN.buttons[k];
+          _controls[i].buttonLevel((levels >> PLAN.controls[i].pin) & 1, now);
+        }
+        for (uint8_t k = 0; k < PLAN.numSwitches; k++) {
+          uint8_t i = PLAN.switches[k];
+          _controls[i].switchLevel((levels >> PLAN.controls[i].pin) & 1);
+        }
+        if constexpr (PLAN.numEncoders > 0) _encoders.update(levels, now);
+      }
+      if constexpr (PLAN.numMux > 0) {
+        uint8_t k = 0;
+        for (uint8_t s = 0; s < PLAN.steps; s++) {
+          selectMux(PLAN.stepChannel[s]);
+          delayMicroseconds(MC_MUX_SETTLE_US);
+          uint64_t levels = readPins<PLAN.muxMask>();
+          for (; k < PLAN.stepEnd[s]; k++) {
+            uint8_t i = PLAN.mux[k];
+            _controls[i].buttonLevel((levels >> PLAN.controls[i].pin) & 1, now);
+          }
+        }
+      }
+      for (uint8_t k = 0; k < PLAN.numPots; k++) _controls[PLAN.pots[k]].readPot();
+      for (uint8_t k = 0; k < PLAN.numTouch; k++) _controls[PLAN.touch[k]].readTouch(now);
+      for (uint8_t i = 0; i < COUNT; i++) {
+        int32_t v = valueOf(i);
+        if (v != _values[i]) {
+          _values[i] = v;
+          _changed |= 1ULL << i;
+        }
+      }
+    }
+
+    /** Get a control by its index in the layout */
+    MultiControl& operator[](uint8_t index) { return _controls[index]; }
+
+    /** Get a control by its index in the layout */
+    MultiControl& control(uint8_t index) { return _controls[index]; }
+
+    /** Check if a control's value changed since the previous call for it
+    * (encoder position, otherwise the current bank value as getValue())
+    */
+    bool changed(uint8_t index) {
+      bool result = (_changed >> index) & 1;
+      _changed &= ~(1ULL << index);
+      return result;
+    }
+
+    /** Number of mux select steps per scan (at most one per channel in use) */
+    static constexpr uint8_t getMuxSteps() { return PLAN.steps; }
+
+    /** Get the number of controls */
+    static constexpr uint8_t getControlCount() { return COUNT; }
+
+  private:
+    int _bankValues[COUNT][BANKS] = {};
+    MultiControl _controls[COUNT];
+    MultiControlEncoders _encoders;
+    int32_t _values[COUNT] = {};
+    uint64_t _changed = 0;
+    uint8_t _muxChannel = 0xFF;
+
+    template <size_t... I>
+    MultiControlBoard(std::index_sequence<I...>): _controls{MultiControl(_bankValues[I], BANKS)...} {}
+
+    int32_t valueOf(uint8_t i) {
+      return PLAN.controls[i].type == 5 ? _controls[i].getEncoderPosition() : _controls[i].getValue();
+    }
+
+    /* Drive only the select lines that differ from the current channel */
+    void selectMux(uint8_t channel) {
+      uint8_t diff = channel ^ _muxChannel;
+      if (diff & 1) digitalWrite(PLAN.muxSelect.pin, channel & 1);
+      if (diff & 2) digitalWrite(PLAN.muxSelect.pin2, (channel >> 1) & 1);
+      if (diff & 4) digitalWrite(PLAN.muxSelect.pin3, (channel >> 2) & 1);
+      _muxChannel = channel;
+    }
+
+    /* Read the pins in MASK: one or two register reads on ESP32, one read per pin elsewhere
+     * and when capturing or replaying */
+    template <uint64_t MASK>
+    static uint64_t readPins() {
+      #if defined(ESP32) && !defined(MULTICONTROL_CAPTURE)
+        uint64_t levels = 0;
+        if constexpr ((uint32_t)MASK != 0) levels = REG_READ(GPIO_IN_REG);
+        #if SOC_GPIO_PIN_COUNT > 32
+          if constexpr ((MASK >> 32) != 0) levels |= (uint64_t)REG_READ(GPIO_IN1_REG) << 32;
+        #endif
+        return levels;
+      #else
+        uint64_t levels = 0;
+        for (uint64_t pins = MASK; pins != 0; pins &= pins - 1) {
+          uint8_t pin = __builtin_ctzll(pins);
+          levels |= (uint64_t)(MC_DIGITAL_READ(pin) & 1) << pin;
+        }
+        return levels;
+      #endif
+    }
+};
+
+#endif /* MULTICONTROL_BOARD_H_ */
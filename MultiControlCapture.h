@@ -0,0 +1,397 @@
+/*
+ * MultiControlCapture.h
+ *
+ * Raw input capture and deterministic replay for MultiControl.
+ * Included by MultiControl.h when MULTICONTROL_CAPTURE is defined.
+ *
+ * Capture records every raw digitalRead / analogRead / touchRead and every millis() /
+ * micros() the library makes, grouped into timestamped frames (one per scan), as a
+ * compact delta-encoded stream written to any Print (Serial, or a LittleFS / SD File).
+ * Replay feeds such a stream back through the unmodified library: reads and clock reads
+ * return the recorded values in order, so the same capture always produces the same
+ * output as the live run. Install the replay source before setting up the controls, so
+ * the reads made during setup are replayed too.
+ *
+ * Stream format (version 2):
+ *   "MCRC" 2 0 varint(t0)             header, t0 = micros when capture began
+ *   0x3F varint(dt)                   frame start, dt = micros since previous frame
+ *   0x00 | pin                        digital read, LOW
+ *   0x40 | pin                        digital read, HIGH
+ *   0x80 | pin zigzag-varint(delta)   analogRead, delta from the previous value for that pin
+ *   0xC0 | pin zigzag-varint(delta)   touchRead, delta from the previous value for that pin
+ *   0x7F zigzag-varint(delta)         millis(), delta from the previous millis() (t0 / 1000 at first)
+ *   0xBF zigzag-varint(delta)         micros(), delta from the previous micros() (t0 at first)
+ * Pins are 0-62. Typical cost is 1 byte per digital read and 1-2 bytes per analog, touch
+ * or clock read. Version 1 streams (no clock records) still replay, with the frame time
+ * as the clock.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_CAPTURE_H_
+#define MULTICONTROL_CAPTURE_H_
+
+#ifndef MULTICONTROL_REPLAY_MAX_READS
+#define MULTICONTROL_REPLAY_MAX_READS 512  // raw reads per frame held during replay
+#endif
+
+#define MC_CAPTURE_DIGITAL_LOW 0
+#define MC_CAPTURE_DIGITAL_HIGH 1
+#define MC_CAPTURE_ANALOG 2
+#define MC_CAPTURE_TOUCH 3
+#define MC_CAPTURE_FRAME 0x3F
+#define MC_CAPTURE_PINS 63
+#define MC_CAPTURE_CLOCK_PIN 63  // pin field of clock records
+#define MC_CAPTURE_MILLIS 1
+#define MC_CAPTURE_MICROS 2
+
+/** Records raw reads to a Print stream. */
+class MultiControlCapture {
+  public:
+    /** Start capturing to a stream (writes the header).
+    * Begin before setting up the controls to capture the reads made during setup.
+    */
+    void begin(Print& out) { begin(out, micros()); }
+
+    /** Start capturing with an explicit timestamp (micros) */
+    void begin(Print& out, unsigned long nowMicros) {
+      _out = &out;
+      _len = 0;
+      _frames = 0;
+      _bytes = 0;
+      _lastFrameMicros = nowMicros;
+      memset(_last, 0, sizeof(_last));
+      _lastClock[0] = nowMicros / 1000;
+      _lastClock[1] = nowMicros;
+      const uint8_t header[6] = {'M', 'C', 'R', 'C', 2, 0};
+      put(header, 6);
+      putVarint(nowMicros);
+    }
+
+    /** Start a new frame. Call once at the start of every scan. */
+    void frame() { frame(micros()); }
+
+    /** Start a new frame with an explicit timestamp (micros) */
+    void frame(unsigned long nowMicros) {
+      if (_out == nullptr) return;
+      flush();
+      putByte(MC_CAPTURE_FRAME);
+      putVarint(nowMicros - _lastFrameMicros);
+      _lastFrameMicros = nowMicros;
+      _frames++;
+    }
+
+    /** Flush buffered bytes and stop capturing */
+    void end() {
+      flush();
+      _out = nullptr;
+    }
+
+    /** Record one raw read (called by the read hooks) */
+    void record(uint8_t kind, uint8_t pin, int value) {
+      if (_out == nullptr || pin >= MC_CAPTURE_PINS) return;
+      if (kind == MC_CAPTURE_DIGITAL_LOW) {
+        putByte(((value ? MC_CAPTURE_DIGITAL_HIGH : MC_CAPTURE_DIGITAL_LOW) << 6) | pin);
+        return;
+      }
+      int32_t& last = _last[kind - MC_CAPTURE_ANALOG][pin];
+      putByte((kind << 6) | pin);
+      int32_t delta = value - last;
+      putVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));  // zigzag
+      last = value;
+    }
+
+    /** Record one clock read (called by the clock hooks)
+    * @param kind MC_CAPTURE_MILLIS or MC_CAPTURE_MICROS
+    * @param value The value returned
+    */
+    void recordClock(uint8_t kind, unsigned long value) {
+      if (_out == nullptr) return;
+      uint32_t& last = _lastClock[kind - MC_CAPTURE_MILLIS];
+      putByte((kind << 6) | MC_CAPTURE_CLOCK_PIN);
+      int32_t delta = (int32_t)((uint32_t)value - last);
+      putVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));  // zigzag
+      last = (uint32_t)value;
+    }
+
+    /** Write any buffered bytes to the stream */
+    void flush() {
+      if (_out != nullptr && _len > 0) _out->write(_buf, _len);
+      _len = 0;
+    }
+
+    /** Number of frames captured */
+    uint32_t getFrameCount() { return _frames; }
+
+    /** Number of bytes written, including the header */
+    uint32_t getByteCount() { return _bytes; }
+
+  private:
+    Print* _out = nullptr;
+    uint8_t _buf[64];
+    uint8_t _len = 0;
+    uint32_t _frames = 0;
+    uint32_t _bytes = 0;
+    unsigned long _lastFrameMicros = 0;
+    int32_t _last[2][MC_CAPTURE_PINS];  // previous analog and touch values per pin
+    uint32_t _lastClock[2];             // previous millis() and micros() recorded
+
+    void putByte(uint8_t b) {
+      if (_len >= sizeof(_buf)) flush();
+      _buf[_len++] = b;
+      _bytes++;
+    }
+
+    void put(const uint8_t* b, uint8_t n) {
+      for (uint8_t i = 0; i < n; i++) putByte(b[i]);
+    }
+
+    void putVarint(uint32_t v) {
+      while (v >= 0x80) {
+        putByte((v & 0x7F) | 0x80);
+        v >>= 7;
+      }
+      putByte(v);
+    }
+};
+
+/** Plays back a capture from memory (a memory-mapped file on a host, or flash on the device). */
+class MultiControlReplay {
+  public:
+    /** Constructor.
+    * @param data The capture stream, starting with the header
+    * @param len Length of the stream in bytes
+    */
+    MultiControlReplay(const uint8_t* data, size_t len): _data(data), _len(len) {
+      memset(_last, 0, sizeof(_last));
+      memset(_head, 0xFF, sizeof(_head));
+      memset(_frameHead, 0xFF, sizeof(_frameHead));
+      _valid = len >= 6 && memcmp(data, "MCRC", 4) == 0 && (data[4] == 1 || data[4] == 2);
+      _pos = 6;
+      if (!_valid) return;
+      _micros = getVarint();
+      _lastClock[0] = _micros / 1000;
+      _lastClock[1] = _micros;
+      loadReads();  // reads made before the first frame, e.g. by setPin()
+    }
+
+    /** Check the stream has a valid header */
+    bool isValid() { return _valid; }
+
+    /** Load the next frame. Reads made by the library then return that frame's values.
+    * @return false at the end of the stream
+    */
+    bool nextFrame() {
+      if (!_valid) return false;
+      // skip to the next frame marker
+      while (_pos < _len && _data[_pos] != MC_CAPTURE_FRAME) skipRecord();
+      if (_pos >= _len) return false;
+      _pos++;
+      _micros += getVarint();
+      _frames++;
+      loadReads();
+      return true;
+    }
+
+    /** Return the next recorded value for a pin in this frame (the last value if none are left) */
+    int read(uint8_t kind, uint8_t pin) {
+      uint8_t slot = (kind <= MC_CAPTURE_DIGITAL_HIGH) ? 0 : kind - 1;
+      if (pin >= MC_CAPTURE_PINS) return 0;
+      uint16_t i = _head[slot][pin];
+      if (i == 0xFFFF) return _current[slot][pin];
+      _head[slot][pin] = _next[i];
+      _current[slot][pin] = _vals[i];
+      return _vals[i];
+    }
+
+    /** Check if a pin has recorded reads left in this frame */
+    bool hasRead(uint8_t kind, uint8_t pin) {
+      uint8_t slot = (kind <= MC_CAPTURE_DIGITAL_HIGH) ? 0 : kind - 1;
+      return pin < MC_CAPTURE_PINS && _head[slot][pin] != 0xFFFF;
+    }
+
+    /** Replay a pin's reads for this frame again from the start,
+    * e.g. to run several differently configured controls over the same input.
+    * Clock reads are not rewound: later passes see the last clock value of the frame.
+    */
+    void rewind(uint8_t kind, uint8_t pin) {
+      uint8_t slot = (kind <= MC_CAPTURE_DIGITAL_HIGH) ? 0 : kind - 1;
+      if (pin < MC_CAPTURE_PINS) _head[slot][pin] = _frameHead[slot][pin];
+    }
+
+    /** Frame time in ms */
+    unsigned long millis() { return _micros / 1000; }
+
+    /** Frame time in us */
+    unsigned long micros() { return _micros; }
+
+    /** Return the next recorded millis() of this frame (the last value if none are left,
+    * the frame time if the frame has none). Used by the library's clock hook.
+    */
+    unsigned long readMillis() { return readClock(0); }
+
+    /** Return the next recorded micros() of this frame, as readMillis() */
+    unsigned long readMicros() { return readClock(1); }
+
+    /** Number of frames played so far */
+    uint32_t getFrameCount() { return _frames; }
+
+  private:
+    const uint8_t* _data;
+    size_t _len;
+    size_t _pos = 0;
+    bool _valid = false;
+    unsigned long _micros = 0;
+    uint32_t _frames = 0;
+    int32_t _last[2][MC_CAPTURE_PINS];     // decoder state for analog and touch deltas
+    int32_t _current[3][MC_CAPTURE_PINS] = {{0}};  // last value returned per digital/analog/touch pin
+    uint16_t _head[3][MC_CAPTURE_PINS];    // next queued read per pin, 0xFFFF = none
+    uint16_t _frameHead[3][MC_CAPTURE_PINS];  // first read per pin in this frame
+    uint32_t _lastClock[2];                // decoder state for millis() and micros() deltas
+    uint32_t _clock[2];                    // last clock value returned, millis() and micros()
+    uint16_t _clockHead[2];                // next queued clock read, 0xFFFF = none
+    int32_t _vals[MULTICONTROL_REPLAY_MAX_READS];
+    uint16_t _next[MULTICONTROL_REPLAY_MAX_READS];
+    uint16_t _count = 0;
+
+    uint32_t getVarint() {
+      uint32_t v = 0;
+      uint8_t shift = 0;
+      while (_pos < _len) {
+        uint8_t b = _data[_pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+        shift += 7;
+      }
+      return v;
+    }
+
+    /* Queue the reads up to the next frame marker per pin, in order */
+    void loadReads() {
+      memset(_head, 0xFF, sizeof(_head));
+      memset(_clockHead, 0xFF, sizeof(_clockHead));
+      _clock[0] = _micros / 1000;
+      _clock[1] = _micros;
+      uint16_t tail[3][MC_CAPTURE_PINS];
+      uint16_t clockTail[2];
+      _count = 0;
+      while (_pos < _len && _data[_pos] != MC_CAPTURE_FRAME && _count < MULTICONTROL_REPLAY_MAX_READS) {
+        uint8_t tag = _data[_pos++];
+        uint8_t pin = tag & 0x3F;
+        _next[_count] = 0xFFFF;
+        if (pin == MC_CAPTURE_CLOCK_PIN) {
+          uint8_t c = (tag >> 6) - MC_CAPTURE_MILLIS;
+          _vals[_count] = (int32_t)decodeClock(tag >> 6);
+          if (c > 1) continue;  // reserved
+          if (_clockHead[c] == 0xFFFF) _clockHead[c] = _count;
+          else _next[clockTail[c]] = _count;
+          clockTail[c] = _count;
+          _count++;
+          continue;
+        }
+        uint8_t slot;
+        _vals[_count] = decodeValue(tag >> 6, pin, slot);
+        if (_head[slot][pin] == 0xFFFF) _head[slot][pin] = _count;
+        else _next[tail[slot][pin]] = _count;
+        tail[slot][pin] = _count;
+        _count++;
+      }
+      memcpy(_frameHead, _head, sizeof(_head));
+    }
+
+    /* Decode the value of a clock record whose tag has been read */
+    uint32_t decodeClock(uint8_t kind) {
+      uint32_t z = getVarint();
+      int32_t delta = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+      if (kind < MC_CAPTURE_MILLIS || kind > MC_CAPTURE_MICROS) return 0;
+      uint32_t& last = _lastClock[kind - MC_CAPTURE_MILLIS];
+      last += (uint32_t)delta;
+      return last;
+    }
+
+    /* Pop the next recorded clock value of this frame (0 millis, 1 micros) */
+    unsigned long readClock(uint8_t c) {
+      uint16_t i = _clockHead[c];
+      if (i != 0xFFFF) {
+        _clockHead[c] = _next[i];
+        _clock[c] = (uint32_t)_vals[i];
+      }
+      return _clock[c];
+    }
+
+    /* Decode the value of a record whose tag has been read; analog and touch values are deltas */
+    int32_t decodeValue(uint8_t kind, uint8_t pin, uint8_t& slot) {
+      if (kind <= MC_CAPTURE_DIGITAL_HIGH) {
+        slot = 0;
+        return kind;
+      }
+      uint32_t z = getVarint();
+      int32_t delta = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+      slot = kind - 1;
+      _last[slot - 1][pin] += delta;
+      return _last[slot - 1][pin];
+    }
+
+    /* Skip a record that did not fit in the frame, keeping the delta decoder in step */
+    void skipRecord() {
+      uint8_t tag = _data[_pos++];
+      uint8_t slot;
+      if ((tag & 0x3F) == MC_CAPTURE_CLOCK_PIN) decodeClock(tag >> 6);
+      else decodeValue(tag >> 6, tag & 0x3F, slot);
+    }
+};
+
+MultiControlCapture* multiControlCaptureSink = nullptr;  // set to record raw reads
+#ifdef MULTICONTROL_REPLAY_THREADS
+// Host tools replaying on several threads give each thread its own source
+thread_local MultiControlReplay* multiControlReplaySource = nullptr;
+#else
+MultiControlReplay* multiControlReplaySource = nullptr;  // set to replay a capture instead of reading hardware
+#endif
+
+inline int multiControlDigitalRead(uint8_t pin) {
+  if (multiControlReplaySource != nullptr) return multiControlReplaySource->read(MC_CAPTURE_DIGITAL_LOW, pin);
+  int value = digitalRead(pin);
+  if (multiControlCaptureSink != nullptr) multiControlCaptureSink->record(MC_CAPTURE_DIGITAL_LOW, pin, value);
+  return value;
+}
+
+inline int multiControlAnalogRead(uint8_t pin) {
+  if (multiControlReplaySource != nullptr) return multiControlReplaySource->read(MC_CAPTURE_ANALOG, pin);
+  int value = analogRead(pin);
+  if (multiControlCaptureSink != nullptr) multiControlCaptureSink->record(MC_CAPTURE_ANALOG, pin, value);
+  return value;
+}
+
+inline uint32_t multiControlTouchRead(uint8_t pin) {
+  if (multiControlReplaySource != nullptr) return multiControlReplaySource->read(MC_CAPTURE_TOUCH, pin);
+  #if defined(ESP32)
+    uint32_t value = touchRead(pin);
+  #else
+    uint32_t value = 0;
+  #endif
+  if (multiControlCaptureSink != nullptr) multiControlCaptureSink->record(MC_CAPTURE_TOUCH, pin, value);
+  return value;
+}
+
+inline unsigned long multiControlMillis() {
+  if (multiControlReplaySource != nullptr) return multiControlReplaySource->readMillis();
+  unsigned long value = millis();
+  if (multiControlCaptureSink != nullptr) multiControlCaptureSink->recordClock(MC_CAPTURE_MILLIS, value);
+  return value;
+}
+
+inline unsigned long multiControlMicros() {
+  if (multiControlReplaySource != nullptr) return multiControlReplaySource->readMicros();
+  unsigned long value = micros();
+  if (multiControlCaptureSink != nullptr) multiControlCaptureSink->recordClock(MC_CAPTURE_MICROS, value);
+  return value;
+}
+
+#define MC_DIGITAL_READ(pin) multiControlDigitalRead(pin)
+#define MC_ANALOG_READ(pin) multiControlAnalogRead(pin)
+#define MC_TOUCH_READ(pin) multiControlTouchRead(pin)
+#define MC_MILLIS() multiControlMillis()
+#define MC_MICROS() multiControlMicros()
+
+#endif /* MULTICONTROL_CAPTURE_H_ */
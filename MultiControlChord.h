@@ -0,0 +1,257 @@
+/*
+ * MultiControlChord.h
+ *
+ * Button chord (combination) detection for MultiControl.
+ * Keeps the pressed state of every registered button in a bitmask and matches
+ * registered chords with mask comparisons, evaluated only on press and release edges.
+ * Buttons that take part in a matched chord do not report a single-click.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_CHORD_H_
+#define MULTICONTROL_CHORD_H_
+
+#include "MultiControl.h"
+
+#ifndef MULTICONTROL_CHORD_MAX_BUTTONS
+#define MULTICONTROL_CHORD_MAX_BUTTONS 64
+#endif
+#ifndef MULTICONTROL_CHORD_MAX_CHORDS
+#define MULTICONTROL_CHORD_MAX_CHORDS 128
+#endif
+#define MULTICONTROL_CHORD_BUTTON_WORDS ((MULTICONTROL_CHORD_MAX_BUTTONS + 31) / 32)
+#define MULTICONTROL_CHORD_CHORD_WORDS ((MULTICONTROL_CHORD_MAX_CHORDS + 31) / 32)
+
+class MultiControlChords {
+  public:
+    /** Maximum buttons in one chord */
+    const static uint8_t MAX_MEMBERS = 4;
+
+    /** Constructor. */
+    MultiControlChords() {};
+
+    /** Register a button with the detector.
+    * @param button The button, mux button or encoder control (nullptr to feed states with setPressed())
+    * @return The button index used in addChord(), or -1 if full
+    */
+    int addButton(MultiControl* button) {
+      if (_numButtons >= MULTICONTROL_CHORD_MAX_BUTTONS) return -1;
+      _buttons[_numButtons] = button;
+      _pressTime[_numButtons] = 0;
+      return _numButtons++;
+    }
+
+    /** Register a chord.
+    * A chord fires on the press that completes it. When one press completes several chords,
+    * only the one with the most members fires.
+    * @param members Button indices from addButton(), in press order if ordered is true
+    * @param count Number of members (2 to MAX_MEMBERS)
+    * @param windowMs All members must be pressed within this many ms of each other (0 = no limit, e.g. shift keys)
+    * @param ordered If true, members must be pressed in the order given (e.g. shift first)
+    * @return The chord index, or -1 if the chord is invalid (a member out of range or given twice)
+    *         or there is no room
+    */
+    int addChord(const uint8_t* members, uint8_t count, uint16_t windowMs = 0, bool ordered = false) {
+      if (_numChords >= MULTICONTROL_CHORD_MAX_CHORDS || count < 2 || count > MAX_MEMBERS) return -1;
+      Chord& c = _chords[_numChords];
+      memset(c.mask, 0, sizeof(c.mask));
+      for (uint8_t i = 0; i < count; i++) {
+        if (members[i] >= _numButtons) return -1;
+        if ((c.mask[members[i] >> 5] >> (members[i] & 31)) & 1) return -1;  // a member twice
+        c.members[i] = members[i];
+        c.mask[members[i] >> 5] |= (1UL << (members[i] & 31));
+      }
+      c.count = count;
+      c.window = windowMs;
+      c.ordered = ordered;
+      return _numChords++;
+    }
+
+    /** Register a two-button chord. See addChord(). */
+    int addChord(uint8_t a, uint8_t b, uint16_t windowMs = 0, bool ordered = false) {
+      uint8_t members[2] = {a, b};
+      return addChord(members, 2, windowMs, ordered);
+    }
+
+    /** Register a shift combination: shift must be pressed before button, and may be held indefinitely. */
+    int addShift(uint8_t shift, uint8_t button) {
+      return addChord(shift, button, 0, true);
+    }
+
+    /** Read all registered buttons and match chords. Call once per scan,
+    * instead of reading the member buttons yourself.
+    */
+    void update() { update(MC_MILLIS()); }
+
+    /** Read all registered buttons and match chords, using an explicit timestamp (ms).
+    * Buttons and mux buttons are debounced against the same timestamp as the chord windows.
+    */
+    void update(unsigned long now) {
+      for (uint8_t i = 0; i < _numButtons; i++) {
+        if (_buttons[i] != nullptr) setPressed(i, _buttons[i]->isPressed(now), now);
+      }
+    }
+
+    /** Set the pressed state of one button (for buttons not read by update()).
+    * @param index The button index (ignored if out of range)
+    * @param pressed true if pressed
+    * @param now The current time in ms
+    */
+    void setPressed(uint8_t index, bool pressed, unsigned long now) {
+      if (!validButton(index)) return;
+      uint8_t w = index >> 5;
+      uint32_t bit = 1UL << (index & 31);
+      bool wasPressed = (_pressed[w] & bit) != 0;
+      if (pressed == wasPressed) return;  // no edge, nothing to match
+      if (pressed) {
+        _pressed[w] |= bit;
+        _pressTime[index] = now;
+        matchPress(index);
+      } else {
+        _pressed[w] &= ~bit;
+        matchRelease(index);
+      }
+    }
+
+    /** Check if a button is currently pressed, as last seen by the detector */
+    bool isPressed(uint8_t index) {
+      if (!validButton(index)) return false;
+      return (_pressed[index >> 5] >> (index & 31)) & 1;
+    }
+
+    /** Check if a chord fired since the last call (reads and clears)
+    * @param chord The chord index from addChord()
+    */
+    bool wasTriggered(int chord) {
+      if (chord < 0 || chord >= _numChords) return false;
+      uint32_t bit = 1UL << (chord & 31);
+      bool result = (_triggered[chord >> 5] & bit) != 0;
+      _triggered[chord >> 5] &= ~bit;
+      return result;
+    }
+
+    /** Get the next chord that fired since the last call (reads and clears)
+    * @return The chord index, or -1 if none
+    */
+    int readTriggered() {
+      for (uint8_t w = 0; w < MULTICONTROL_CHORD_CHORD_WORDS; w++) {
+        if (_triggered[w]) {
+          int bit = __builtin_ctz(_triggered[w]);
+          _triggered[w] &= ~(1UL << bit);
+          return (w << 5) + bit;
+        }
+      }
+      return -1;
+    }
+
+    /** Check if a chord fired and all of its members are still held */
+    bool isActive(int chord) {
+      if (chord < 0 || chord >= _numChords) return false;
+      return (_active[chord >> 5] >> (chord & 31)) & 1;
+    }
+
+    /** Check if any button is part of a currently active chord (e.g. to suppress its own actions) */
+    bool isChorded(uint8_t index) {
+      if (!validButton(index)) return false;
+      return (_chorded[index >> 5] >> (index & 31)) & 1;
+    }
+
+    /** Get the number of registered buttons */
+    uint8_t getButtonCount() { return _numButtons; }
+
+    /** Get the number of registered chords */
+    uint8_t getChordCount() { return _numChords; }
+
+  private:
+    /* A registered button index (the array bound is checked too, so the compiler sees it) */
+    inline bool validButton(uint8_t index) {
+      return index < _numButtons && index < MULTICONTROL_CHORD_MAX_BUTTONS;
+    }
+
+    struct Chord {
+      uint32_t mask[MULTICONTROL_CHORD_BUTTON_WORDS];
+      uint8_t members[MAX_MEMBERS];
+      uint8_t count;
+      bool ordered;
+      uint16_t window;
+    };
+
+    MultiControl* _buttons[MULTICONTROL_CHORD_MAX_BUTTONS];
+    unsigned long _pressTime[MULTICONTROL_CHORD_MAX_BUTTONS];  // millis() at press
+    Chord _chords[MULTICONTROL_CHORD_MAX_CHORDS];
+    uint32_t _pressed[MULTICONTROL_CHORD_BUTTON_WORDS] = {0};
+    uint32_t _chorded[MULTICONTROL_CHORD_BUTTON_WORDS] = {0};  // members of active chords
+    uint32_t _triggered[MULTICONTROL_CHORD_CHORD_WORDS] = {0};
+    uint32_t _active[MULTICONTROL_CHORD_CHORD_WORDS] = {0};
+    uint8_t _numButtons = 0;
+    uint8_t _numChords = 0;
+
+    /* True if every member of the chord is pressed */
+    inline bool allPressed(const Chord& c) {
+      for (uint8_t w = 0; w < MULTICONTROL_CHORD_BUTTON_WORDS; w++) {
+        if ((_pressed[w] & c.mask[w]) != c.mask[w]) return false;
+      }
+      return true;
+    }
+
+    /* Check press order and time window for a chord completed by the newest press */
+    bool timingMatches(const Chord& c, unsigned long now) {
+      unsigned long oldest = 0;
+      for (uint8_t i = 0; i < c.count; i++) {
+        unsigned long age = now - _pressTime[c.members[i]];
+        if (age > oldest) oldest = age;
+        // Ordered: each member must not have been pressed after the next one
+        if (c.ordered && i > 0 && now - _pressTime[c.members[i - 1]] < age) return false;
+      }
+      return c.window == 0 || oldest <= c.window;
+    }
+
+    /* Fire the largest chord completed by a press of button index */
+    void matchPress(uint8_t index) {
+      uint8_t w = index >> 5;
+      uint32_t bit = 1UL << (index & 31);
+      unsigned long now = _pressTime[index];
+      int best = -1;
+      for (uint8_t i = 0; i < _numChords; i++) {
+        const Chord& c = _chords[i];
+        if (!(c.mask[w] & bit)) continue;
+        if (!allPressed(c) || !timingMatches(c, now)) continue;
+        if (best < 0 || c.count > _chords[best].count) best = i;
+      }
+      if (best < 0) return;
+      const Chord& c = _chords[best];
+      _triggered[best >> 5] |= (1UL << (best & 31));
+      _active[best >> 5] |= (1UL << (best & 31));
+      for (uint8_t i = 0; i < MULTICONTROL_CHORD_BUTTON_WORDS; i++) _chorded[i] |= c.mask[i];
+      // Members' presses belong to the chord, not to single clicks
+      for (uint8_t i = 0; i < c.count; i++) {
+        MultiControl* b = _buttons[c.members[i]];
+        if (b != nullptr) b->cancelClick();
+      }
+    }
+
+    /* Deactivate chords that included the released button */
+    void matchRelease(uint8_t index) {
+      uint8_t w = index >> 5;
+      uint32_t bit = 1UL << (index & 31);
+      bool anyActive = false;
+      for (uint8_t i = 0; i < MULTICONTROL_CHORD_CHORD_WORDS; i++) anyActive |= (_active[i] != 0);
+      if (!anyActive) return;
+      for (uint8_t i = 0; i < MULTICONTROL_CHORD_BUTTON_WORDS; i++) _chorded[i] = 0;
+      for (uint8_t i = 0; i < _numChords; i++) {
+        uint32_t chordBit = 1UL << (i & 31);
+        if (!(_active[i >> 5] & chordBit)) continue;
+        const Chord& c = _chords[i];
+        if (c.mask[w] & bit) {
+          _active[i >> 5] &= ~chordBit;
+        } else {
+          for (uint8_t k = 0; k < MULTICONTROL_CHORD_BUTTON_WORDS; k++) _chorded[k] |= c.mask[k];
+        }
+      }
+    }
+};
+
+#endif /* MULTICONTROL_CHORD_H_ */
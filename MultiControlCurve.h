@@ -0,0 +1,129 @@
+/*
+ * MultiControlCurve.h
+ *
+ * Response curves for continuous controls: log, exp, S-shaped, power and ratio tapers, or a
+ * curve through user breakpoints, precomputed once into a small table and looked up with
+ * integer linear interpolation. One curve can be shared by any number of controls.
+ * Included by MultiControl.h; attach a curve with MultiControl::setCurve() and read the
+ * shaped value with getCurvedValue().
+ *
+ * Tables are MULTICONTROL_CURVE_POINTS entries (65 by default: 64 segments of 16 input
+ * steps over 0-1023, 130 bytes). A table can also be computed offline and kept in flash:
+ * pass a const array of that many entries to the constructor.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_CURVE_H_
+#define MULTICONTROL_CURVE_H_
+
+#include <math.h>
+
+#ifndef MULTICONTROL_CURVE_POINTS
+#define MULTICONTROL_CURVE_POINTS 65  // 2^n + 1 table entries over inputs 0-1023 (9 to 1025)
+#endif
+
+#define MC_CURVE_LINEAR 0
+#define MC_CURVE_EXP 1    // slow start, fast end (audio taper, frequencies): k = amount
+#define MC_CURVE_LOG 2    // fast start, slow end (inverse of exp): k = amount
+#define MC_CURVE_S 3      // slow at both ends, steepness = amount
+#define MC_CURVE_POWER 4  // x^amount
+#define MC_CURVE_RATIO 5  // equal ratios per step, outMin * (outMax / outMin)^x (frequencies, times)
+
+class MultiControlCurve {
+  public:
+    /** A linear curve over 0-1023 */
+    MultiControlCurve() {
+      build(MC_CURVE_LINEAR, 1.0f, 0, 1023);
+    }
+
+    /** A standard shape
+    * @param shape MC_CURVE_LINEAR, MC_CURVE_EXP, MC_CURVE_LOG, MC_CURVE_S, MC_CURVE_POWER
+    *        or MC_CURVE_RATIO
+    * @param amount Strength of the shape (see the MC_CURVE_* list; e.g. 4 for exp or log,
+    *        unused by linear and ratio)
+    * @param outMin Output at input 0
+    * @param outMax Output at input 1023 (0-65535, may be below outMin to invert)
+    */
+    MultiControlCurve(uint8_t shape, float amount, uint16_t outMin = 0, uint16_t outMax = 1023) {
+      build(shape, amount, outMin, outMax);
+    }
+
+    /** A table computed elsewhere, e.g. a const array in flash
+    * @param table MULTICONTROL_CURVE_POINTS outputs, evenly spaced from input 0 to 1023
+    */
+    MultiControlCurve(const uint16_t* table): _external(table) {}
+
+    /** Compute a standard shape into the table (at setup; uses float math) */
+    void build(uint8_t shape, float amount, uint16_t outMin = 0, uint16_t outMax = 1023) {
+      for (int i = 0; i < MULTICONTROL_CURVE_POINTS; i++) {
+        float x = (float)(i << _SHIFT) / 1024.0f;
+        if (shape == MC_CURVE_RATIO && outMin > 0) {
+          _table[i] = (uint16_t)(outMin * powf((float)outMax / outMin, x) + 0.5f);
+        } else {
+          _table[i] = toOutput(shapeAt(shape, amount, x), outMin, outMax);
+        }
+      }
+      _external = nullptr;
+    }
+
+    /** Compute a curve through breakpoints, straight between them (at setup)
+    * @param in Inputs, rising, from 0 to 1023
+    * @param out Output at each input
+    * @param count Number of breakpoints (2 or more)
+    */
+    void build(const int16_t* in, const uint16_t* out, uint8_t count) {
+      uint8_t k = 0;
+      for (int i = 0; i < MULTICONTROL_CURVE_POINTS; i++) {
+        int x = ((i << _SHIFT) * 1023 + 512) >> 10;
+        while (k + 2 < count && x > in[k + 1]) k++;
+        int span = max(1, in[k + 1] - in[k]);
+        int t = constrain(x - in[k], 0, span);
+        _table[i] = (uint16_t)((int32_t)out[k] + (((int32_t)out[k + 1] - out[k]) * t + span / 2) / span);
+      }
+      _external = nullptr;
+    }
+
+    /** Look up the output for an input (0-1023, clamped) */
+    inline int map(int x) const {
+      const uint16_t* t = _external ? _external : _table;
+      x = (constrain(x, 0, 1023) * 1025 + 512) >> 10;  // 0-1024, so 1023 lands on the last entry
+      int i = min(x >> _SHIFT, MULTICONTROL_CURVE_POINTS - 2);
+      int f = x - (i << _SHIFT);
+      int a = t[i];
+      return a + (((t[i + 1] - a) * f + ((1 << _SHIFT) >> 1)) >> _SHIFT);  // rounded; exact at 1025 points
+    }
+
+    /** The table (MULTICONTROL_CURVE_POINTS entries) */
+    const uint16_t* getTable() const { return _external ? _external : _table; }
+
+  private:
+    static_assert(MULTICONTROL_CURVE_POINTS >= 9 && MULTICONTROL_CURVE_POINTS <= 1025 &&
+                  ((MULTICONTROL_CURVE_POINTS - 1) & (MULTICONTROL_CURVE_POINTS - 2)) == 0,
+                  "MULTICONTROL_CURVE_POINTS must be 2^n + 1, from 9 to 1025");
+    static const int _SHIFT = 10 - __builtin_ctz(MULTICONTROL_CURVE_POINTS - 1);  // input bits per segment
+    uint16_t _table[MULTICONTROL_CURVE_POINTS];
+    const uint16_t* _external = nullptr;  // a table kept elsewhere, used instead of _table
+
+    static float shapeAt(uint8_t shape, float k, float x) {
+      switch (shape) {
+        case MC_CURVE_EXP:
+          return k > 0.0f ? (expf(k * x) - 1.0f) / (expf(k) - 1.0f) : x;
+        case MC_CURVE_LOG:
+          return k > 0.0f ? logf(1.0f + (expf(k) - 1.0f) * x) / k : x;
+        case MC_CURVE_S:
+          return k > 0.0f ? 0.5f + 0.5f * tanhf(k * (x - 0.5f)) / tanhf(0.5f * k) : x;
+        case MC_CURVE_POWER:
+          return powf(x, k);
+        default:
+          return x;
+      }
+    }
+
+    static uint16_t toOutput(float y, uint16_t outMin, uint16_t outMax) {
+      float v = outMin + y * ((float)outMax - (float)outMin);
+      return (uint16_t)constrain(v + 0.5f, 0.0f, 65535.0f);
+    }
+};
+
+#endif /* MULTICONTROL_CURVE_H_ */
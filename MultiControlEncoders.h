@@ -0,0 +1,187 @@
+/*
+ * MultiControlEncoders.h
+ *
+ * Decodes many rotary encoders from one snapshot of their A/B lines.
+ * The snapshot can come from the ESP32 GPIO input registers, a shift register chain
+ * or a port expander; every encoder is then sampled at the same instant.
+ * Direction is computed for all encoders at once with bitwise operations on packed
+ * state words, and only encoders that actually moved are passed on to their
+ * MultiControl object for detent, acceleration and wrap/clamp handling.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_ENCODERS_H_
+#define MULTICONTROL_ENCODERS_H_
+
+#include "MultiControl.h"
+
+#if defined(ESP32) && !defined(MULTICONTROL_CAPTURE)
+#include "soc/gpio_reg.h"
+#include "soc/soc_caps.h"
+#endif
+
+class MultiControlEncoders {
+  public:
+    /** Maximum encoders in one decoder (one bit each in a 32-bit state word) */
+    const static uint8_t MAX_ENCODERS = 32;
+    /** Use as a bit position for "no button" */
+    const static uint8_t NO_BIT = 255;
+
+    /** Constructor. */
+    MultiControlEncoders() {};
+
+    /** Add an encoder read from the GPIO pins set with setEncoderPins().
+    * Its push button, if any, is read from the snapshot too.
+    * @return The encoder index, or -1 if full
+    */
+    int addEncoder(MultiControl* encoder) {
+      uint8_t button = encoder->getEncoderButtonPin();
+      return addEncoder(encoder, encoder->getPin(), encoder->getEncoderPinB(), button > 0 ? button : NO_BIT);
+    }
+
+    /** Add an encoder whose lines are at given bit positions in the snapshot passed to update(),
+    * e.g. for a shift register chain or a port expander.
+    * @param encoder The encoder control (its range, detents, acceleration and wrap still apply)
+    * @param bitA Bit position of channel A (0-63)
+    * @param bitB Bit position of channel B (0-63)
+    * @param bitButton Bit position of the push button (0 = pressed), or NO_BIT
+    * @return The encoder index, or -1 if full
+    */
+    int addEncoder(MultiControl* encoder, uint8_t bitA, uint8_t bitB, uint8_t bitButton = NO_BIT) {
+      if (_count >= MAX_ENCODERS || bitA > 63 || bitB > 63) return -1;
+      uint8_t i = _count++;
+      _encoders[i] = encoder;
+      addRun(_runsA, _numRunsA, bitA, i);
+      addRun(_runsB, _numRunsB, bitB, i);
+      _buttonBit[i] = bitButton > 63 ? NO_BIT : bitButton;
+      if (_buttonBit[i] != NO_BIT) _hasButtons = true;
+      _pinMask |= (1ULL << bitA) | (1ULL << bitB);
+      if (_buttonBit[i] != NO_BIT) _pinMask |= (1ULL << _buttonBit[i]);
+      _primed = false;  // take the next snapshot as the starting state
+      return i;
+    }
+
+    /** Snapshot the GPIO pins and decode every encoder. Call once per scan. */
+    void update() { update(readGpio(), MC_MILLIS()); }
+
+    /** Decode every encoder from a snapshot (bit n = level of line n) */
+    void update(uint64_t snapshot) { update(snapshot, MC_MILLIS()); }
+
+    /** Decode every encoder from a snapshot, using an explicit timestamp (ms) */
+    void update(uint64_t snapshot, unsigned long now) {
+      updatePacked(gather(snapshot, _runsA, _numRunsA), gather(snapshot, _runsB, _numRunsB), now);
+      if (_hasButtons) {
+        for (uint8_t i = 0; i < _count; i++) {
+          if (_buttonBit[i] != NO_BIT) _encoders[i]->buttonLevel((snapshot >> _buttonBit[i]) & 1, now);
+        }
+      }
+    }
+
+    /** Decode from packed words: bit i of a and b are channels A and B of encoder i */
+    void updatePacked(uint32_t a, uint32_t b, unsigned long now) {
+      if (!_primed) {
+        _a = a;
+        _b = b;
+        _primed = true;
+        return;
+      }
+      uint32_t da = a ^ _a;
+      uint32_t db = b ^ _b;
+      if ((da | db) == 0) return;
+      // One line changed: a valid Gray code step. Both changed: a missed step, dropped like readEncoder().
+      uint32_t moved = da ^ db;
+      // Forward when the previous A differs from the new B (00 -> 01 -> 11 -> 10)
+      uint32_t forward = moved & (_a ^ b);
+      _a = a;
+      _b = b;
+      while (moved) {
+        uint8_t i = __builtin_ctz(moved);
+        moved &= moved - 1;
+        _encoders[i]->encoderStep(((forward >> i) & 1) ? 1 : -1, now);
+      }
+    }
+
+    /** Read the level of every GPIO as one 64-bit word (bit n = GPIO n).
+    * On ESP32 this reads the input registers directly; elsewhere, and when capturing
+    * or replaying, it reads the registered pins one by one.
+    */
+    uint64_t readGpio() {
+      #if defined(ESP32) && !defined(MULTICONTROL_CAPTURE)
+        uint64_t levels = REG_READ(GPIO_IN_REG);
+        #if SOC_GPIO_PIN_COUNT > 32
+          levels |= (uint64_t)REG_READ(GPIO_IN1_REG) << 32;
+        #endif
+        return levels;
+      #else
+        uint64_t levels = 0;
+        for (uint8_t pin = 0; pin < 64; pin++) {
+          if ((_pinMask >> pin) & 1) levels |= (uint64_t)(MC_DIGITAL_READ(pin) & 1) << pin;
+        }
+        return levels;
+      #endif
+    }
+
+    /** Get the number of encoders */
+    uint8_t getEncoderCount() { return _count; }
+
+  private:
+    /* A run of snapshot bits, one every stride bits, that map to consecutive encoders */
+    struct Run {
+      uint8_t src;     // first snapshot bit
+      uint8_t dst;     // first encoder index
+      uint8_t len;
+      uint8_t stride;  // 1 = adjacent bits, 2 = every other bit (A/B interleaved)
+    };
+
+    MultiControl* _encoders[MAX_ENCODERS];
+    uint8_t _buttonBit[MAX_ENCODERS];
+    Run _runsA[MAX_ENCODERS];
+    Run _runsB[MAX_ENCODERS];
+    uint8_t _numRunsA = 0;
+    uint8_t _numRunsB = 0;
+    uint8_t _count = 0;
+    bool _hasButtons = false;
+    bool _primed = false;
+    uint32_t _a = 0;  // previous A levels, bit i = encoder i
+    uint32_t _b = 0;  // previous B levels
+    uint64_t _pinMask = 0;  // snapshot bits in use
+
+    /* Extend the last run if the new bit continues it, otherwise start a new one */
+    void addRun(Run* runs, uint8_t& numRuns, uint8_t bit, uint8_t index) {
+      if (numRuns > 0) {
+        Run& r = runs[numRuns - 1];
+        if (r.dst + r.len == index) {
+          if (r.len == 1 && (bit == r.src + 1 || bit == r.src + 2)) r.stride = bit - r.src;
+          if (r.src + r.len * r.stride == bit && r.len < 32) {
+            r.len++;
+            return;
+          }
+        }
+      }
+      runs[numRuns++] = {bit, index, 1, 1};
+    }
+
+    /* Pack one channel of every encoder into a word, a few shifts and masks per run */
+    static inline uint32_t gather(uint64_t snapshot, const Run* runs, uint8_t numRuns) {
+      uint32_t packed = 0;
+      for (uint8_t r = 0; r < numRuns; r++) {
+        uint64_t x = snapshot >> runs[r].src;
+        if (runs[r].stride == 2) {
+          // Compact every other bit into adjacent bits
+          x &= 0x5555555555555555ULL;
+          x = (x | (x >> 1)) & 0x3333333333333333ULL;
+          x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+          x = (x | (x >> 4)) & 0x00FF00FF00FF00FFULL;
+          x = (x | (x >> 8)) & 0x0000FFFF0000FFFFULL;
+          x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+        }
+        packed |= ((uint32_t)x & (uint32_t)((1ULL << runs[r].len) - 1)) << runs[r].dst;
+      }
+      return packed;
+    }
+};
+
+#endif /* MULTICONTROL_ENCODERS_H_ */
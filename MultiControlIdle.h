@@ -0,0 +1,207 @@
+/*
+ * MultiControlIdle.h
+ *
+ * Low-power idle scanning for a panel of MultiControl controls.
+ * After a quiet period the panel drops to a slow scan rate, pots switch to a single
+ * ADC conversion, and the ESP32 can light sleep between scans with wake sources on
+ * touch pads, buttons and encoder pins. Full-rate scanning resumes on the first edge.
+ * ESP32-S2/S3 wake on one touch pad only (see setTouchWakePad()).
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_IDLE_H_
+#define MULTICONTROL_IDLE_H_
+
+#include "MultiControl.h"
+
+#if defined(ESP32)
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#endif
+
+#ifndef MULTICONTROL_IDLE_MAX_CONTROLS
+#define MULTICONTROL_IDLE_MAX_CONTROLS 64
+#endif
+
+class MultiControlIdle {
+  public:
+    /** Constructor. */
+    MultiControlIdle() {};
+
+    /** Add a control to be watched for activity
+    * @return The control index, or -1 if full
+    */
+    int addControl(MultiControl* control) {
+      if (_numControls >= MULTICONTROL_IDLE_MAX_CONTROLS) return -1;
+      _controls[_numControls] = control;
+      return _numControls++;
+    }
+
+    /** Add an array of controls */
+    void addControls(MultiControl* controls, int count) {
+      for (int i = 0; i < count; i++) addControl(&controls[i]);
+    }
+
+    /** Set how long the panel must be quiet before idle mode starts
+    * @param ms Quiet period in milliseconds (default 5000)
+    */
+    void setIdleTimeout(unsigned long ms) { _idleTimeout = ms; }
+
+    /** Set the time between scans while idle
+    * This is also the worst-case wake latency for pots and mux buttons, which cannot wake the chip,
+    * and on ESP32-S2/S3 for touch pads other than the wake pad.
+    * @param ms Idle scan interval in milliseconds (default 50)
+    */
+    void setIdleScanInterval(uint16_t ms) { _idleInterval = max((uint16_t)1, ms); }
+
+    /** Enable light sleep between idle scans (ESP32 only, default off).
+    * Note that USB serial on ESP32-S2/S3 may disconnect during light sleep.
+    */
+    void setLightSleep(bool enabled) { _lightSleep = enabled; }
+
+    /** Choose the touch pad that wakes the chip from light sleep on ESP32-S2/S3.
+    * These chips wake on a single touch pad; the others are seen at the next timer wake.
+    * Classic ESP32 wakes on every touch pad and ignores this.
+    * @param index The control index from addControl() (default: the first touch pad added)
+    */
+    void setTouchWakePad(int index) { _touchWakePad = index; }
+
+    /** Check activity after a scan. Call once per loop, after reading the controls.
+    * @return true if the panel is idle
+    */
+    bool update() { return update(MC_MILLIS()); }
+
+    /** Check activity after a scan, using an explicit timestamp (ms) */
+    bool update(unsigned long now) {
+      _scans++;
+      bool quiet = true;
+      for (uint8_t i = 0; i < _numControls; i++) {
+        quiet &= _controls[i]->isQuiet();  // call on every control to clear movement flags
+      }
+      if (!quiet) {
+        _lastActivity = now;
+        if (_idle) setIdle(false);
+      } else if (!_idle && (now - _lastActivity) >= _idleTimeout) {
+        setIdle(true);
+      }
+      _lastScan = now;
+      return _idle;
+    }
+
+    /** Wait until the next scan is due. Returns at once while active.
+    * While idle, waits out the idle scan interval, in light sleep if enabled,
+    * and returns early when a touch pad, button or encoder wakes the chip.
+    */
+    void wait() { wait(MC_MILLIS()); }
+
+    /** Wait until the next scan is due, using an explicit timestamp (ms) */
+    void wait(unsigned long now) {
+      if (!_idle) return;
+      unsigned long elapsed = now - _lastScan;
+      if (elapsed >= _idleInterval) return;
+      unsigned long remaining = _idleInterval - elapsed;
+      #if defined(ESP32)
+        if (_lightSleep) {
+          armWakeSources(remaining);
+          esp_light_sleep_start();
+          _sleeps++;
+          return;
+        }
+      #endif
+      delay(remaining);
+    }
+
+    /** Check if the panel is idle */
+    bool isIdle() { return _idle; }
+
+    /** Leave idle mode immediately (e.g. on a MIDI or network event) */
+    void wake() { wake(MC_MILLIS()); }
+
+    /** Leave idle mode immediately, using an explicit timestamp (ms) */
+    void wake(unsigned long now) {
+      _lastActivity = now;
+      if (_idle) setIdle(false);
+    }
+
+    /** Number of update() calls so far (scans) */
+    uint32_t getScanCount() { return _scans; }
+
+    /** Number of light sleeps entered */
+    uint32_t getSleepCount() { return _sleeps; }
+
+  private:
+    MultiControl* _controls[MULTICONTROL_IDLE_MAX_CONTROLS];
+    uint8_t _numControls = 0;
+    unsigned long _idleTimeout = 5000;
+    unsigned long _lastActivity = 0;
+    unsigned long _lastScan = 0;
+    uint16_t _idleInterval = 50;
+    bool _idle = false;
+    bool _lightSleep = false;
+    int8_t _touchWakePad = -1;  // ESP32-S2/S3 touch wake pad, -1 for the first touch pad
+    uint32_t _scans = 0;
+    uint32_t _sleeps = 0;
+    // Control type numbers, as in MultiControl::setControl()
+    const static uint8_t _TOUCH = 0;
+    const static uint8_t _POT = 1;
+    const static uint8_t _BUTTON = 2;
+    const static uint8_t _SWITCH = 3;
+    const static uint8_t _ENCODER = 5;
+
+    /* Switch pots between single-conversion and full sampling */
+    void setIdle(bool idle) {
+      _idle = idle;
+      for (uint8_t i = 0; i < _numControls; i++) {
+        if (_controls[i]->getControl() == _POT) _controls[i]->setPotSingleSample(idle);
+      }
+    }
+
+    #if defined(ESP32)
+    /* Level-triggered GPIO wake: a level that is still present after waking
+     * is read by the next scan, so the edge that woke us is not lost. */
+    void wakeOnPinChange(uint8_t pin) {
+      int level = MC_DIGITAL_READ(pin);
+      gpio_wakeup_enable((gpio_num_t)pin, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+
+    /* Set wake sources for one idle interval */
+    void armWakeSources(unsigned long ms) {
+      esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+      esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+      bool gpioWake = false;
+      bool touchWake = false;
+      for (uint8_t i = 0; i < _numControls; i++) {
+        MultiControl* c = _controls[i];
+        uint8_t type = c->getControl();
+        if (type == _BUTTON || type == _SWITCH) {
+          wakeOnPinChange(c->getPin());
+          gpioWake = true;
+        } else if (type == _ENCODER) {
+          wakeOnPinChange(c->getPin());
+          wakeOnPinChange(c->getEncoderPinB());
+          if (c->getEncoderButtonPin() > 0) wakeOnPinChange(c->getEncoderButtonPin());
+          gpioWake = true;
+        } else if (type == _TOUCH && c->getTouchBaseline() != 65535) {
+          #if defined(CONFIG_IDF_TARGET_ESP32)
+            // Classic ESP32: raw value drops when touched
+            touchSleepWakeUpEnable(c->getPin(), c->getTouchBaseline() - c->getTouchOnThreshold());
+          #else
+            // ESP32-S2/S3: one wake pad only (a second touchSleepWakeUpEnable() replaces the first).
+            // Raw value rises when touched; MultiControl works in raw >> 8 units
+            if (touchWake || (_touchWakePad >= 0 && i != _touchWakePad)) continue;
+            touchSleepWakeUpEnable(c->getPin(), (uint32_t)(c->getTouchBaseline() + c->getTouchOnThreshold()) << 8);
+          #endif
+          touchWake = true;
+        }
+        // Pots and mux buttons cannot wake the chip; they are caught by the timer wake
+      }
+      if (gpioWake) esp_sleep_enable_gpio_wakeup();
+      if (touchWake) esp_sleep_enable_touchpad_wakeup();
+    }
+    #endif
+};
+
+#endif /* MULTICONTROL_IDLE_H_ */
@@ -0,0 +1,173 @@
+/*
+ * MultiControlKeys.h
+ *
+ * Velocity-sensitive key scanning for keybeds with two contacts per key.
+ * The first contact closes early in the key's travel and the second near the bottom;
+ * the time between them, measured with micros(), gives the note velocity. The time
+ * between the second and first contact opening gives the release velocity.
+ * Contact states for all keys are passed in as two packed words each scan, so a
+ * full 61-key keybed is decoded with a few bitwise operations plus per-key work
+ * only for keys whose contacts changed.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_KEYS_H_
+#define MULTICONTROL_KEYS_H_
+
+#include "MultiControl.h"
+
+#ifndef MULTICONTROL_KEYS_EVENTS
+#define MULTICONTROL_KEYS_EVENTS 64  // queued key events (power of two, up to 256)
+#endif
+
+/** A key press or release with its velocity */
+struct MultiControlKeyEvent {
+  uint8_t key;        // key index, 0 = lowest
+  bool on;            // true = press, false = release
+  uint16_t velocity;  // 1-127, or 1-16383 with 14-bit velocity
+};
+
+class MultiControlVelocityKeys {
+  public:
+    /** Maximum keys (one bit each in a 64-bit contact word) */
+    const static uint8_t MAX_KEYS = 64;
+
+    /** Constructor. */
+    MultiControlVelocityKeys() {
+      setVelocityRange(1500, 80000);
+    };
+
+    /** Set the contact intervals that map to the loudest and softest velocity.
+    * Intervals in between are mapped on a log scale, which matches how players hear dynamics.
+    * @param fastUs Interval for maximum velocity, in microseconds (default 1500)
+    * @param slowUs Interval for velocity 1, in microseconds (default 80000)
+    */
+    void setVelocityRange(uint32_t fastUs, uint32_t slowUs) {
+      _fastUs = max((uint32_t)1, fastUs);
+      _slowUs = max(_fastUs + 1, slowUs);
+      _logFast = logf((float)_fastUs);
+      _logSpanInv = 1.0f / (logf((float)_slowUs) - _logFast);
+    }
+
+    /** Set the velocity curve
+    * @param curve 1.0 = even on the log scale (default), above 1.0 = softer (harder to play loud),
+    *        below 1.0 = harder (easier to play loud)
+    */
+    void setVelocityCurve(float curve) { _curve = max(0.1f, curve); }
+
+    /** Set the velocity resolution
+    * @param bits 7 (1-127, default) or 14 (1-16383, e.g. for MIDI 2.0 or high-resolution velocity CC)
+    */
+    void setVelocityBits(uint8_t bits) { _maxVelocity = (bits >= 14) ? 16383 : 127; }
+
+    /** Scan the keys. Call as often as possible, ideally every 100-500 us.
+    * @param first Bit k set when the first contact of key k is closed
+    * @param second Bit k set when the second contact of key k is closed
+    */
+    void update(uint64_t first, uint64_t second) { update(first, second, MC_MICROS()); }
+
+    /** Scan the keys, using an explicit timestamp (micros) */
+    void update(uint64_t first, uint64_t second, unsigned long nowMicros) {
+      uint64_t changed = (first ^ _first) | (second ^ _second);
+      if (changed == 0) return;
+      uint32_t now = (uint32_t)nowMicros;
+      while (changed) {
+        uint8_t k = ctz64(changed);
+        changed &= changed - 1;
+        uint64_t bit = 1ULL << k;
+        bool f = first & bit;
+        bool s = second & bit;
+        // Closing: first contact starts the timer, second contact sends the note
+        if (f && !(_first & bit) && !(_down & bit)) {
+          _armed |= bit;
+          _time[k] = now;
+        }
+        if (s && !(_second & bit) && (_armed & bit)) {
+          _armed &= ~bit;
+          _down |= bit;
+          push(k, true, velocityFor(now - _time[k]));
+        }
+        // Opening: second contact starts the release timer, first contact ends the note
+        if (!s && (_second & bit) && (_down & bit)) {
+          _releasing |= bit;
+          _time[k] = now;
+        }
+        if (!f && (_first & bit)) {
+          if (_down & bit) {
+            push(k, false, velocityFor((_releasing & bit) ? now - _time[k] : 0));
+            _down &= ~bit;
+          }
+          _armed &= ~bit;  // a partial press that never reached the second contact
+          _releasing &= ~bit;
+        }
+      }
+      _first = first;
+      _second = second;
+    }
+
+    /** Get the next key event
+    * @return false if there are no events
+    */
+    bool readEvent(MultiControlKeyEvent& event) {
+      if (_head == _tail) return false;
+      event = _events[_tail];
+      _tail = (_tail + 1) & (MULTICONTROL_KEYS_EVENTS - 1);
+      return true;
+    }
+
+    /** Check if a key is down (note on sent, not yet released) */
+    bool isDown(uint8_t key) { return (_down >> key) & 1; }
+
+    /** Get all keys that are down, bit k = key k */
+    uint64_t getDownKeys() { return _down; }
+
+    /** Number of events lost because the queue was full */
+    uint32_t getDroppedEvents() { return _dropped; }
+
+    /** Map a contact interval to a velocity using the current range, curve and resolution */
+    uint16_t velocityFor(uint32_t us) {
+      if (us <= _fastUs) return _maxVelocity;
+      if (us >= _slowUs) return 1;
+      float x = 1.0f - (logf((float)us) - _logFast) * _logSpanInv;  // 1 = fast, 0 = slow
+      if (_curve != 1.0f) x = powf(x, _curve);
+      return 1 + (uint16_t)(x * (_maxVelocity - 1) + 0.5f);
+    }
+
+  private:
+    uint64_t _first = 0;      // first contact states at the last scan
+    uint64_t _second = 0;     // second contact states at the last scan
+    uint64_t _armed = 0;      // first contact closed, waiting for the second
+    uint64_t _down = 0;       // note on sent
+    uint64_t _releasing = 0;  // second contact opened, waiting for the first
+    uint32_t _time[MAX_KEYS];  // micros of the contact that started the current interval
+    uint32_t _fastUs;
+    uint32_t _slowUs;
+    float _logFast;
+    float _logSpanInv;
+    float _curve = 1.0f;
+    uint16_t _maxVelocity = 127;
+    MultiControlKeyEvent _events[MULTICONTROL_KEYS_EVENTS];
+    uint8_t _head = 0;
+    uint8_t _tail = 0;
+    uint32_t _dropped = 0;
+
+    void push(uint8_t key, bool on, uint16_t velocity) {
+      uint8_t next = (_head + 1) & (MULTICONTROL_KEYS_EVENTS - 1);
+      if (next == _tail) {
+        _dropped++;
+        return;
+      }
+      _events[_head] = {key, on, velocity};
+      _head = next;
+    }
+
+    static inline uint8_t ctz64(uint64_t x) {
+      uint32_t low = (uint32_t)x;
+      return low ? __builtin_ctz(low) : 32 + __builtin_ctz((uint32_t)(x >> 32));
+    }
+};
+
+#endif /* MULTICONTROL_KEYS_H_ */
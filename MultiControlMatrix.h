@@ -0,0 +1,202 @@
+/*
+ * MultiControlMatrix.h
+ *
+ * Scans buttons wired as a row/column key matrix, e.g. 32 buttons on a 4x8 matrix from 12 pins.
+ * Each row is driven low in turn, given one settle delay, and all columns are then read
+ * together from the GPIO input registers. Every key is passed on to its MultiControl object,
+ * so debounce, click, double-click, hold and long-press work as they do for readButton().
+ * Matrices without diodes can show a phantom key when three corners of a rectangle are
+ * pressed; such ambiguous keys are detected and keep their previous state.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_MATRIX_H_
+#define MULTICONTROL_MATRIX_H_
+
+#include "MultiControl.h"
+
+#if defined(ESP32) && !defined(MULTICONTROL_CAPTURE)
+#include "soc/gpio_reg.h"
+#include "soc/soc_caps.h"
+#endif
+
+class MultiControlMatrix {
+  public:
+    /** Maximum rows (driven pins) */
+    const static uint8_t MAX_ROWS = 8;
+    /** Maximum columns (read pins, one bit each in a 16-bit row word) */
+    const static uint8_t MAX_COLS = 16;
+    /** Maximum keys */
+    const static uint8_t MAX_KEYS = MAX_ROWS * MAX_COLS;
+
+    /** Constructor. */
+    MultiControlMatrix() {};
+
+    /** Set the row pins. Rows are open-drain outputs: driven low when scanned, released otherwise,
+    * so pressing keys in two rows never shorts one output to another.
+    * @param pins The GPIO pins, one per row
+    * @param numRows Number of rows (up to MAX_ROWS)
+    */
+    void setRows(const uint8_t* pins, uint8_t numRows) {
+      _numRows = min(numRows, (uint8_t)MAX_ROWS);
+      for (uint8_t r = 0; r < _numRows; r++) {
+        _rowPins[r] = pins[r];
+        pinMode(pins[r], OUTPUT_OPEN_DRAIN);
+        digitalWrite(pins[r], HIGH);
+        _state[r] = 0;
+        _raw[r] = 0;
+        _ghost[r] = 0;
+      }
+    }
+
+    /** Set the column pins. Columns are inputs with pullups: a pressed key on the scanned row reads low.
+    * @param pins The GPIO pins, one per column
+    * @param numCols Number of columns (up to MAX_COLS)
+    */
+    void setColumns(const uint8_t* pins, uint8_t numCols) {
+      _numCols = min(numCols, (uint8_t)MAX_COLS);
+      _colMask = 0;
+      for (uint8_t c = 0; c < _numCols; c++) {
+        _colPins[c] = pins[c];
+        pinMode(pins[c], INPUT_PULLUP);
+        _colMask |= 1ULL << pins[c];
+      }
+    }
+
+    /** Add a key. The control becomes a scanned key (type 6): don't call readButton() on it,
+    * but use isPressed(), wasSingleClicked(), isHeld() and the other button functions as usual.
+    * @param key The button control
+    * @param row Row index (0 = first pin passed to setRows())
+    * @param col Column index (0 = first pin passed to setColumns())
+    * @return The key index, or -1 if full or out of range
+    */
+    int addKey(MultiControl* key, uint8_t row, uint8_t col) {
+      if (_count >= MAX_KEYS || row >= MAX_ROWS || col >= MAX_COLS) return -1;
+      key->setControl(6);
+      _keys[_count] = {key, row, col};
+      return _count++;
+    }
+
+    /** Tell the matrix it has a diode per key. Diodes stop current flowing back through other keys,
+    * so there are no phantom keys and any combination of keys can be pressed; ghost detection is skipped.
+    * @param diodes true if every key has a diode, false if not (default; ghost detection on)
+    */
+    void setDiodes(bool diodes) { _diodes = diodes; }
+
+    /** Set the time a row is given to settle after it is driven, before the columns are read.
+    * Long column wires or weak pullups need more.
+    * @param us Settle time in microseconds (default 5)
+    */
+    void setSettleTime(uint16_t us) { _settleUs = us; }
+
+    /** Scan every row and update every key. Call once per loop. */
+    void update() { update(MC_MILLIS()); }
+
+    /** Scan every row and update every key, using an explicit timestamp (ms) */
+    void update(unsigned long now) {
+      uint16_t rows[MAX_ROWS];
+      for (uint8_t r = 0; r < _numRows; r++) {
+        digitalWrite(_rowPins[r], LOW);
+        delayMicroseconds(_settleUs);
+        rows[r] = readColumns();
+        digitalWrite(_rowPins[r], HIGH);
+      }
+      updateRows(rows, now);
+    }
+
+    /** Update every key from row words read elsewhere, e.g. from a shift register or a simulation.
+    * @param rows One word per row: bit c set when column c reads pressed
+    * @param now The current time in ms
+    */
+    void updateRows(const uint16_t* rows, unsigned long now) {
+      bool ghosted = false;
+      for (uint8_t r = 0; r < _numRows; r++) {
+        _raw[r] = rows[r];
+        _ghost[r] = 0;
+      }
+      if (!_diodes) {
+        // Three pressed corners of a rectangle make the fourth read pressed too, and then both
+        // rows read the same two or more columns. None of those four keys can be trusted.
+        for (uint8_t r = 0; r + 1 < _numRows; r++) {
+          if ((rows[r] & (rows[r] - 1)) == 0) continue;  // fewer than two keys in this row
+          for (uint8_t r2 = r + 1; r2 < _numRows; r2++) {
+            uint16_t common = rows[r] & rows[r2];
+            if (common & (common - 1)) {
+              _ghost[r] |= common;
+              _ghost[r2] |= common;
+              ghosted = true;
+            }
+          }
+        }
+        if (ghosted) _ghostScans++;
+      }
+      for (uint8_t r = 0; r < _numRows; r++) {
+        _state[r] = (rows[r] & ~_ghost[r]) | (_state[r] & _ghost[r]);
+      }
+      for (uint8_t i = 0; i < _count; i++) {
+        const Key& k = _keys[i];
+        k.control->buttonLevel(((_state[k.row] >> k.col) & 1) ? 0 : 1, now);
+      }
+    }
+
+    /** Get the accepted key states of a row, bit c = column c (before debounce) */
+    uint16_t getRow(uint8_t row) { return row < MAX_ROWS ? _state[row] : 0; }
+
+    /** Get the keys of a row read at the last scan, including any phantom keys */
+    uint16_t getRawRow(uint8_t row) { return row < MAX_ROWS ? _raw[row] : 0; }
+
+    /** Get the keys of a row that were ambiguous at the last scan and kept their previous state */
+    uint16_t getGhostRow(uint8_t row) { return row < MAX_ROWS ? _ghost[row] : 0; }
+
+    /** Number of scans where ghosting was detected */
+    uint32_t getGhostScans() { return _ghostScans; }
+
+    /** Get the number of keys */
+    uint8_t getKeyCount() { return _count; }
+
+  private:
+    struct Key {
+      MultiControl* control;
+      uint8_t row;
+      uint8_t col;
+    };
+
+    Key _keys[MAX_KEYS];
+    uint8_t _count = 0;
+    uint8_t _rowPins[MAX_ROWS];
+    uint8_t _colPins[MAX_COLS];
+    uint8_t _numRows = 0;
+    uint8_t _numCols = 0;
+    uint64_t _colMask = 0;         // column pins as GPIO bits
+    uint16_t _state[MAX_ROWS] = {};  // accepted key states, bit c = column c
+    uint16_t _raw[MAX_ROWS] = {};    // as read at the last scan
+    uint16_t _ghost[MAX_ROWS] = {};  // ambiguous at the last scan
+    uint16_t _settleUs = 5;
+    bool _diodes = false;
+    uint32_t _ghostScans = 0;
+
+    /* Read all columns of the driven row, bit c set when column c is low (pressed) */
+    uint16_t readColumns() {
+      uint16_t pressed = 0;
+      #if defined(ESP32) && !defined(MULTICONTROL_CAPTURE)
+        // One or two register reads for every column
+        uint64_t levels = REG_READ(GPIO_IN_REG);
+        #if SOC_GPIO_PIN_COUNT > 32
+          if (_colMask >> 32) levels |= (uint64_t)REG_READ(GPIO_IN1_REG) << 32;
+        #endif
+        for (uint8_t c = 0; c < _numCols; c++) {
+          pressed |= (uint16_t)(((levels >> _colPins[c]) & 1) ^ 1) << c;
+        }
+      #else
+        for (uint8_t c = 0; c < _numCols; c++) {
+          pressed |= (uint16_t)((MC_DIGITAL_READ(_colPins[c]) & 1) ^ 1) << c;
+        }
+      #endif
+      return pressed;
+    }
+};
+
+#endif /* MULTICONTROL_MATRIX_H_ */
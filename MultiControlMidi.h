@@ -0,0 +1,440 @@
+/*
+ * MultiControlMidi.h
+ *
+ * Coalescing MIDI output stage for MultiControl.
+ * Maps controls to 7-bit CC, 14-bit CC pairs or NRPN and sends only what has changed,
+ * limited to a maximum message rate per control and per port. Messages are packed
+ * into 4-byte USB-MIDI event packets and handed to a pluggable transport in batches.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_MIDI_H_
+#define MULTICONTROL_MIDI_H_
+
+#include "MultiControl.h"
+
+#ifndef MULTICONTROL_MIDI_MAX_MAPS
+#define MULTICONTROL_MIDI_MAX_MAPS 32  // number of control mappings
+#endif
+#ifndef MULTICONTROL_MIDI_MAX_PORTS
+#define MULTICONTROL_MIDI_MAX_PORTS 2  // number of transports (USB cable numbers)
+#endif
+#ifndef MULTICONTROL_MIDI_BATCH
+#define MULTICONTROL_MIDI_BATCH 16  // packets per batch (16 x 4 = one 64-byte USB packet)
+#endif
+
+/** Destination for batches of USB-MIDI event packets.
+ * Each packet is 4 bytes: (cable << 4 | code index), status, data1, data2.
+ * Subclass this to send over TinyUSB, BLE, DIN serial, or to a buffer for testing.
+ */
+class MultiControlMidiTransport {
+  public:
+    virtual ~MultiControlMidiTransport() {}
+    /** Send a batch of packets.
+    * @param packets Packed event packets, 4 bytes each
+    * @param count The number of packets
+    */
+    virtual void send(const uint8_t* packets, uint8_t count) = 0;
+};
+
+/** Buffer-backed transport. Appends packets to a caller-supplied array.
+ * Useful for measuring traffic or running the output stage on a host without MIDI hardware.
+ */
+class MultiControlMidiBuffer : public MultiControlMidiTransport {
+  public:
+    /** Constructor.
+    * @param buffer Storage for packets (4 bytes per packet)
+    * @param maxPackets Capacity of the buffer in packets
+    */
+    MultiControlMidiBuffer(uint8_t* buffer, uint32_t maxPackets): _buffer(buffer), _maxPackets(maxPackets) {}
+
+    void send(const uint8_t* packets, uint8_t count) {
+      _batches++;
+      for (uint8_t i = 0; i < count; i++) {
+        if (_count >= _maxPackets) {
+          _dropped++;
+          continue;
+        }
+        memcpy(_buffer + _count * 4, packets + i * 4, 4);
+        _count++;
+      }
+    }
+
+    /** Get a pointer to a stored packet (4 bytes) */
+    const uint8_t* getPacket(uint32_t index) { return _buffer + index * 4; }
+
+    /** Number of packets stored */
+    uint32_t getCount() { return _count; }
+
+    /** Number of send() calls (batches) received */
+    uint32_t getBatchCount() { return _batches; }
+
+    /** Number of packets that did not fit in the buffer */
+    uint32_t getDroppedCount() { return _dropped; }
+
+    /** Empty the buffer and reset the counters */
+    void clear() {
+      _count = 0;
+      _batches = 0;
+      _dropped = 0;
+    }
+
+  private:
+    uint8_t* _buffer;
+    uint32_t _maxPackets;
+    uint32_t _count = 0;
+    uint32_t _batches = 0;
+    uint32_t _dropped = 0;
+};
+
+/** Serial (DIN / TRS) transport. Unpacks event packets to raw MIDI bytes with running status. */
+class MultiControlMidiSerial : public MultiControlMidiTransport {
+  public:
+    /** Constructor.
+    * @param out The serial port, already started at 31250 baud
+    */
+    MultiControlMidiSerial(Print& out): _out(out) {}
+
+    void send(const uint8_t* packets, uint8_t count) {
+      uint8_t bytes[MULTICONTROL_MIDI_BATCH * 3];
+      int len = 0;
+      for (uint8_t i = 0; i < count && i < MULTICONTROL_MIDI_BATCH; i++) {
+        const uint8_t* p = packets + i * 4;
+        if (p[1] != _runningStatus) {
+          bytes[len++] = p[1];
+          _runningStatus = p[1];
+        }
+        bytes[len++] = p[2];
+        bytes[len++] = p[3];
+      }
+      _out.write(bytes, len);
+    }
+
+  private:
+    Print& _out;
+    uint8_t _runningStatus = 0;
+};
+
+class MultiControlMidi {
+  public:
+    /** Mapping modes */
+    const static uint8_t CC = 0;     // 7-bit control change
+    const static uint8_t CC14 = 1;   // 14-bit control change pair (number and number + 32)
+    const static uint8_t NRPN = 2;   // 14-bit non-registered parameter number
+
+    /** Constructor. */
+    MultiControlMidi() {
+      for (int p = 0; p < MULTICONTROL_MIDI_MAX_PORTS; p++) {
+        for (int c = 0; c < 16; c++) _nrpnParam[p][c] = 0xFFFF;
+      }
+    };
+
+    /** Attach a transport to a port.
+    * @param port The port (also used as the USB-MIDI cable number), 0 to MULTICONTROL_MIDI_MAX_PORTS - 1
+    * @param transport The transport to send packets through
+    * @param maxMessagesPerSecond Rate limit for the port (default 1000, 0 = unlimited).
+    *   DIN MIDI carries about 1000 three-byte messages per second.
+    */
+    void setTransport(uint8_t port, MultiControlMidiTransport* transport, uint16_t maxMessagesPerSecond = 1000) {
+      if (port >= MULTICONTROL_MIDI_MAX_PORTS) return;
+      _ports[port].transport = transport;
+      _ports[port].rate = maxMessagesPerSecond;
+      _ports[port].tokens = (uint32_t)_burst * 1000;
+    }
+
+    /** Set how many messages a port may send back-to-back before its rate limit applies.
+    * @param messages Burst size in messages (default 8)
+    */
+    void setPortBurst(uint8_t messages) { _burst = max((uint8_t)1, messages); }
+
+    /** Map a control to MIDI output.
+    * @param control The control to read in update(), or nullptr to feed values with set()
+    * @param mode CC, CC14 or NRPN
+    * @param channel MIDI channel 0-15
+    * @param number Controller number (0-127, 0-31 for CC14) or NRPN parameter (0-16383)
+    * @param inMin Control value that maps to the lowest MIDI value (default 0)
+    * @param inMax Control value that maps to the highest MIDI value (default 1023)
+    * @param port Output port (default 0)
+    * @return The mapping index, or -1 if no mappings are left
+    */
+    int addMap(MultiControl* control, uint8_t mode, uint8_t channel, uint16_t number,
+               int inMin = 0, int inMax = 1023, uint8_t port = 0) {
+      if (_numMaps >= MULTICONTROL_MIDI_MAX_MAPS) return -1;
+      Map& m = _maps[_numMaps];
+      m.control = control;
+      m.mode = mode;
+      m.channel = channel & 0x0F;
+      m.number = number;
+      m.inMin = inMin;
+      m.inMax = (inMax == inMin) ? inMin + 1 : inMax;
+      m.port = (port < MULTICONTROL_MIDI_MAX_PORTS) ? port : 0;
+      m.minInterval = _defaultInterval;
+      m.value = 0;
+      m.sent = 0xFFFF;  // nothing sent yet
+      m.dirty = false;
+      m.lastSendTime = 0;
+      m.dirtySince = 0;
+      return _numMaps++;
+    }
+
+    /** Map a control to a 7-bit CC. See addMap(). */
+    int addCC(MultiControl* control, uint8_t channel, uint8_t cc, int inMin = 0, int inMax = 1023, uint8_t port = 0) {
+      return addMap(control, CC, channel, cc, inMin, inMax, port);
+    }
+
+    /** Map a control to a 14-bit CC pair (MSB on cc, LSB on cc + 32). See addMap(). */
+    int addCC14(MultiControl* control, uint8_t channel, uint8_t cc, int inMin = 0, int inMax = 1023, uint8_t port = 0) {
+      return addMap(control, CC14, channel, cc & 0x1F, inMin, inMax, port);
+    }
+
+    /** Map a control to a 14-bit NRPN. See addMap(). */
+    int addNRPN(MultiControl* control, uint8_t channel, uint16_t param, int inMin = 0, int inMax = 1023, uint8_t port = 0) {
+      return addMap(control, NRPN, channel, param & 0x3FFF, inMin, inMax, port);
+    }
+
+    /** Remove all mappings */
+    void clearMaps() { _numMaps = 0; }
+
+    /** Get the number of mappings */
+    uint8_t getMapCount() { return _numMaps; }
+
+    /** Set the minimum interval between messages for one mapping.
+    * Changes arriving faster than this are coalesced and only the latest value is sent.
+    * @param index The mapping index returned by addMap()
+    * @param ms Minimum interval in milliseconds (0 = send on every flush)
+    */
+    void setMinInterval(int index, uint8_t ms) {
+      if (index >= 0 && index < _numMaps) _maps[index].minInterval = ms;
+    }
+
+    /** Set the minimum interval used by mappings added after this call (default 10ms, ~100 messages per second) */
+    void setDefaultMinInterval(uint8_t ms) { _defaultInterval = ms; }
+
+    /** Feed a new control value to a mapping (marks it dirty if the MIDI value changed).
+    * @param index The mapping index returned by addMap()
+    * @param val The control value, in the mapping's input range
+    */
+    void set(int index, int val) { set(index, val, MC_MILLIS()); }
+
+    /** Feed a new control value with an explicit timestamp (ms) */
+    void set(int index, int val, unsigned long now) {
+      if (index < 0 || index >= _numMaps) return;
+      Map& m = _maps[index];
+      uint16_t midiVal = scale(m, val);
+      if (midiVal == m.value && (m.dirty || midiVal == m.sent)) return;
+      if (m.dirty) _coalesced++;
+      m.value = midiVal;
+      if (midiVal == m.sent) {
+        m.dirty = false;  // returned to the last sent value before it went out
+      } else if (!m.dirty) {
+        m.dirty = true;
+        m.dirtySince = now;
+      }
+    }
+
+    /** Force a mapping to be resent on the next flush (e.g. after a bank change) */
+    void invalidate(int index) {
+      if (index < 0 || index >= _numMaps) return;
+      _maps[index].sent = 0xFFFF;
+      _maps[index].dirty = true;
+      _maps[index].dirtySince = MC_MILLIS();
+    }
+
+    /** Read every mapped control and send whatever is due. Call once per scan. */
+    void update() { update(MC_MILLIS()); }
+
+    /** Read every mapped control and send whatever is due, using an explicit timestamp (ms) */
+    void update(unsigned long now) {
+      for (uint8_t i = 0; i < _numMaps; i++) {
+        MultiControl* c = _maps[i].control;
+        if (c == nullptr) continue;
+        int val = c->read(now);
+        uint8_t type = c->getControl();
+        if (type == 2 || type == 4) {
+          val = (val == 0) ? _maps[i].inMax : _maps[i].inMin;  // buttons read 0 when pressed
+        } else if (type == 5) {
+          val = c->getEncoderPosition();
+        }
+        if (val < 0) continue;  // latched after a bank change, or unstable pot
+        set(i, val, now);
+      }
+      flush(now);
+    }
+
+    /** Send due messages without reading controls */
+    void flush() { flush(MC_MILLIS()); }
+
+    /** Send due messages without reading controls, using an explicit timestamp (ms).
+    * Mappings are served round-robin so a busy port cannot starve later mappings: the next
+    * flush starts at the first mapping its port's rate held back, or after the last one sent.
+    */
+    void flush(unsigned long now) {
+      for (int p = 0; p < MULTICONTROL_MIDI_MAX_PORTS; p++) refill(_ports[p], now);
+      uint8_t n = _numMaps;
+      uint8_t next = _nextMap;
+      bool heldBack = false;
+      for (uint8_t k = 0; k < n; k++) {
+        uint8_t i = (_nextMap + k) % n;
+        Map& m = _maps[i];
+        if (!m.dirty) continue;
+        if ((now - m.lastSendTime) < m.minInterval) continue;
+        Port& port = _ports[m.port];
+        if (port.transport == nullptr) continue;
+        uint8_t cost = messageCost(m);
+        if (port.rate > 0 && port.tokens < (uint32_t)cost * 1000) {
+          if (!heldBack) next = i;
+          heldBack = true;
+          continue;
+        }
+        if (port.rate > 0) port.tokens -= (uint32_t)cost * 1000;
+        if (!heldBack) next = (i + 1) % n;
+        emit(m);
+        m.dirty = false;
+        m.lastSendTime = now;
+        unsigned long latency = now - m.dirtySince;
+        if (latency > _maxLatency) _maxLatency = latency;
+        _latencySum += latency;
+        _updatesSent++;
+      }
+      _nextMap = next;
+      for (int p = 0; p < MULTICONTROL_MIDI_MAX_PORTS; p++) sendBatch(p);
+    }
+
+    /** Total MIDI messages sent (a CC14 change is up to 2, an NRPN change up to 4) */
+    uint32_t getMessageCount() { return _messages; }
+
+    /** Number of value changes absorbed by coalescing */
+    uint32_t getCoalescedCount() { return _coalesced; }
+
+    /** Longest time (ms) a change waited between set() and being sent */
+    unsigned long getMaxLatency() { return _maxLatency; }
+
+    /** Mean time (ms) a change waited between set() and being sent */
+    float getMeanLatency() { return _updatesSent > 0 ? (float)_latencySum / _updatesSent : 0.0f; }
+
+    /** Reset the traffic and latency statistics */
+    void resetStats() {
+      _messages = 0;
+      _coalesced = 0;
+      _maxLatency = 0;
+      _latencySum = 0;
+      _updatesSent = 0;
+    }
+
+  private:
+    struct Map {
+      MultiControl* control;
+      uint16_t number;      // CC number or NRPN parameter
+      int16_t inMin;
+      int16_t inMax;
+      uint16_t value;       // latest MIDI value (7 or 14 bit)
+      uint16_t sent;        // last MIDI value sent (0xFFFF = never)
+      uint8_t mode;
+      uint8_t channel;
+      uint8_t port;
+      uint8_t minInterval;  // ms between messages
+      bool dirty;
+      unsigned long lastSendTime;
+      unsigned long dirtySince;
+    };
+
+    struct Port {
+      MultiControlMidiTransport* transport = nullptr;
+      uint16_t rate = 0;         // messages per second, 0 = unlimited
+      uint32_t tokens = 0;       // token bucket, in thousandths of a message
+      unsigned long lastRefill = 0;
+      uint8_t packets[MULTICONTROL_MIDI_BATCH * 4];
+      uint8_t count = 0;
+    };
+
+    Map _maps[MULTICONTROL_MIDI_MAX_MAPS];
+    Port _ports[MULTICONTROL_MIDI_MAX_PORTS];
+    uint16_t _nrpnParam[MULTICONTROL_MIDI_MAX_PORTS][16];  // last NRPN selected per channel
+    uint8_t _numMaps = 0;
+    uint8_t _nextMap = 0;
+    uint8_t _defaultInterval = 10;
+    uint8_t _burst = 8;
+    uint32_t _messages = 0;
+    uint32_t _coalesced = 0;
+    uint32_t _updatesSent = 0;
+    uint32_t _latencySum = 0;
+    unsigned long _maxLatency = 0;
+
+    /* Scale a control value to the mapping's 7 or 14-bit output range */
+    uint16_t scale(Map& m, int val) {
+      int32_t outMax = (m.mode == CC) ? 127 : 16383;
+      int32_t range = (int32_t)m.inMax - m.inMin;
+      int32_t out = ((int32_t)(val - m.inMin) * outMax + range / 2) / range;
+      return (uint16_t)constrain(out, (int32_t)0, outMax);
+    }
+
+    /* Worst-case messages needed to send a mapping's current value */
+    uint8_t messageCost(Map& m) {
+      if (m.mode == CC) return 1;
+      if (m.mode == CC14) return 2;
+      return 4;
+    }
+
+    /* Top up a port's token bucket for the time elapsed since the last flush */
+    void refill(Port& port, unsigned long now) {
+      if (port.rate == 0) return;
+      uint32_t cap = (uint32_t)_burst * 1000;
+      uint32_t elapsed = now - port.lastRefill;
+      port.lastRefill = now;
+      if (elapsed > cap) elapsed = cap;  // avoid overflow after long idle periods
+      port.tokens = min(cap, port.tokens + elapsed * port.rate);
+    }
+
+    /* Queue the messages for one mapping, skipping bytes the receiver already has */
+    void emit(Map& m) {
+      uint8_t status = 0xB0 | m.channel;
+      if (m.mode == CC) {
+        queue(m.port, status, m.number, m.value);
+      } else {
+        uint8_t msb = m.value >> 7;
+        uint8_t lsb = m.value & 0x7F;
+        bool msbChanged = (m.sent == 0xFFFF) || ((m.sent >> 7) != msb);
+        if (m.mode == CC14) {
+          if (msbChanged) queue(m.port, status, m.number, msb);
+          queue(m.port, status, m.number + 32, lsb);
+        } else {
+          uint16_t& selected = _nrpnParam[m.port][m.channel];
+          if (selected != m.number) {
+            queue(m.port, status, 99, m.number >> 7);
+            queue(m.port, status, 98, m.number & 0x7F);
+            selected = m.number;
+            msbChanged = true;  // data entry MSB must follow a new parameter select
+          }
+          if (msbChanged) queue(m.port, status, 6, msb);
+          queue(m.port, status, 38, lsb);
+        }
+      }
+      m.sent = m.value;
+    }
+
+    /* Append one control change as a USB-MIDI event packet, sending the batch when full */
+    void queue(uint8_t port, uint8_t status, uint8_t data1, uint8_t data2) {
+      Port& p = _ports[port];
+      uint8_t* pkt = p.packets + p.count * 4;
+      pkt[0] = (port << 4) | (status >> 4);  // cable number and code index (0xB = control change)
+      pkt[1] = status;
+      pkt[2] = data1 & 0x7F;
+      pkt[3] = data2 & 0x7F;
+      p.count++;
+      _messages++;
+      if (p.count >= MULTICONTROL_MIDI_BATCH) sendBatch(port);
+    }
+
+    /* Hand any queued packets for a port to its transport */
+    void sendBatch(uint8_t port) {
+      Port& p = _ports[port];
+      if (p.count == 0) return;
+      p.transport->send(p.packets, p.count);
+      p.count = 0;
+    }
+};
+
+#endif /* MULTICONTROL_MIDI_H_ */
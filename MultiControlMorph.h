@@ -0,0 +1,270 @@
+/*
+ * MultiControlMorph.h
+ *
+ * Morphs a panel of MultiControl controls between bank presets: every control's value is
+ * interpolated between bank A and bank B from one morph position (a crossfade pot), or
+ * across four banks A, B, C and D on the corners of a square from an X/Y position.
+ *
+ * The source values of all controls are kept in structure-of-arrays snapshots and the
+ * output is written to one contiguous array in a single pass of integer arithmetic (Q10
+ * weights) over a fixed number of lanes, which compilers vectorise. update() recomputes
+ * only when the position or one of the source bank values changed. Source values are
+ * checked a few controls per update() (an edit shows up within
+ * MAX_CONTROLS / CHECK_PER_UPDATE updates), or all at once with refresh().
+ *
+ * Optionally the morph also writes its output into one bank of each control (the live
+ * bank). Pots in their current bank are then latched to the morphed value, so a pot moved
+ * after a morph picks up from where the morph left it instead of jumping to its physical
+ * position. Once a pot has picked up and moves, the performer's hand wins: the control
+ * leaves the morph (its output follows the pot) until clearOverrides() or setBanks().
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_MORPH_H_
+#define MULTICONTROL_MORPH_H_
+
+#include "MultiControl.h"
+
+#ifndef MULTICONTROL_MORPH_MAX_CONTROLS
+#define MULTICONTROL_MORPH_MAX_CONTROLS 64  // controls in one morph (64 at most)
+#endif
+
+#ifndef MULTICONTROL_MORPH_CHECK_PER_UPDATE
+#define MULTICONTROL_MORPH_CHECK_PER_UPDATE 8  // controls whose source banks update() checks
+#endif
+
+#define MC_MORPH_NO_BANK 255
+
+class MultiControlMorph {
+  public:
+    /** Constructor. */
+    MultiControlMorph() {};
+
+    /** Add a control to the morph
+    * @return The control index (its index in getValues()), or -1 if full
+    */
+    int addControl(MultiControl* control) {
+      if (_numControls >= MULTICONTROL_MORPH_MAX_CONTROLS || _numControls >= 64) return -1;
+      _controls[_numControls] = control;
+      _numControls++;
+      if (_banks[0] != MC_MORPH_NO_BANK) takeSources(_numControls - 1, _numControls);
+      _dirty = true;
+      return _numControls - 1;
+    }
+
+    /** Add an array of controls */
+    void addControls(MultiControl* controls, int count) {
+      for (int i = 0; i < count; i++) addControl(&controls[i]);
+    }
+
+    /** Morph between two banks (position 0 = bank a, full range = bank b) */
+    void setBanks(uint8_t a, uint8_t b) {
+      setBanks(a, b, MC_MORPH_NO_BANK, MC_MORPH_NO_BANK);
+    }
+
+    /** Morph across four banks on the corners of a square:
+    * a at (0, 0), b at (full, 0), c at (0, full), d at (full, full)
+    */
+    void setBanks(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+      _banks[0] = a;
+      _banks[1] = b;
+      _banks[2] = c;
+      _banks[3] = d;
+      _corners = c == MC_MORPH_NO_BANK ? 2 : 4;
+      _overridden = 0;
+      refresh();
+    }
+
+    /** Set the morph position, e.g. from a crossfade pot
+    * @param x Position from 0 (bank a) to range (bank b)
+    * @param range Full scale of x (default 1023, the range of a pot)
+    */
+    void setPosition(int x, int range = 1023) {
+      setPosition(x, 0, range);
+    }
+
+    /** Set the 2D morph position, e.g. from an X/Y pad or two pots
+    * @param x Position from 0 to range (towards b and d)
+    * @param y Position from 0 to range (towards c and d)
+    * @param range Full scale of x and y (default 1023)
+    */
+    void setPosition(int x, int y, int range) {
+      int16_t qx = toQ10(x, range), qy = toQ10(y, range);
+      if (qx == _x && qy == _y) return;
+      _x = qx;
+      _y = qy;
+      _dirty = true;
+    }
+
+    /** Write the output into a bank of each control, and latch pots that are in it.
+    * @param bank The live bank, not one of the source banks
+    *        (MC_MORPH_NO_BANK, the default, only fills getValues())
+    */
+    void setOutputBank(uint8_t bank) {
+      _outputBank = bank;
+      _overridden = 0;
+      _live = 0;
+      _dirty = true;
+    }
+
+    /** Take all source bank values now, e.g. right after editing a preset */
+    void refresh() {
+      if (_banks[0] == MC_MORPH_NO_BANK) return;
+      _dirty |= takeSources(0, _numControls);
+    }
+
+    /** Put controls the performer took over back under the morph */
+    void clearOverrides() {
+      _overridden = 0;
+      _dirty = true;
+    }
+
+    /** Check if a control left the morph because its pot was moved after picking up */
+    bool isOverridden(uint8_t index) { return (_overridden >> index) & 1; }
+
+    /** Recompute the output if the position or a source bank value changed.
+    * Call once per loop, after reading the controls.
+    * @return true if any output value changed
+    */
+    bool update() {
+      if (_numControls == 0 || _banks[0] == MC_MORPH_NO_BANK) return false;
+      if (_outputBank != MC_MORPH_NO_BANK) checkOverrides();
+      // Check the next few controls' source values, round robin
+      uint8_t from = _checkNext;
+      uint8_t to = min((int)_numControls, from + MULTICONTROL_MORPH_CHECK_PER_UPDATE);
+      _checkNext = to >= _numControls ? 0 : to;
+      _dirty |= takeSources(from, to);
+      if (!_dirty) return false;
+      _dirty = false;
+      if (_corners == 2) lerp();
+      else bilerp();
+      // Overridden controls follow their pot
+      for (uint64_t m = _overridden; m; m &= m - 1) {
+        int i = __builtin_ctzll(m);
+        _out[i] = _controls[i]->getValue();
+      }
+      uint8_t any = 0;
+      for (int i = 0; i < MULTICONTROL_MORPH_MAX_CONTROLS; i++) {
+        _changed[i] = _out[i] != _prevOut[i];
+        any |= _changed[i];
+        _prevOut[i] = _out[i];
+      }
+      if (any && _outputBank != MC_MORPH_NO_BANK) writeOutput();
+      return any != 0;
+    }
+
+    /** The output of every control, contiguous (index from addControl()) */
+    const int16_t* getValues() { return _out; }
+
+    /** The output of one control */
+    int getValue(uint8_t index) { return _out[index]; }
+
+    /** Check if a control's output changed in the last update() */
+    bool isChanged(uint8_t index) { return _changed[index]; }
+
+    /** Number of controls */
+    uint8_t getControlCount() { return _numControls; }
+
+  private:
+    MultiControl* _controls[MULTICONTROL_MORPH_MAX_CONTROLS];
+    uint8_t _numControls = 0;
+    uint8_t _banks[4] = {MC_MORPH_NO_BANK, MC_MORPH_NO_BANK, MC_MORPH_NO_BANK, MC_MORPH_NO_BANK};
+    uint8_t _corners = 2;
+    uint8_t _outputBank = MC_MORPH_NO_BANK;
+    int16_t _x = 0, _y = 0;  // Q10 position, 1024 = full
+    bool _dirty = true;
+    uint8_t _checkNext = 0;  // next control whose sources update() checks
+    uint64_t _overridden = 0;
+    uint64_t _live = 0;  // controls written to the live bank at least once
+
+    // Source snapshots (one row per corner bank) and the output, structure of arrays
+    alignas(16) int16_t _src[4][MULTICONTROL_MORPH_MAX_CONTROLS] = {};
+    alignas(16) int16_t _out[MULTICONTROL_MORPH_MAX_CONTROLS] = {};
+    int16_t _prevOut[MULTICONTROL_MORPH_MAX_CONTROLS] = {};
+    uint8_t _changed[MULTICONTROL_MORPH_MAX_CONTROLS] = {};
+    int16_t _written[MULTICONTROL_MORPH_MAX_CONTROLS] = {};  // last value written to the live bank
+
+    static int16_t toQ10(int v, int range) {
+      if (range <= 0) return 0;
+      v = constrain(v, 0, range);
+      return (int16_t)(((int32_t)v * 1024 + range / 2) / range);
+    }
+
+    /* Copy the source bank values of controls from..to-1 into the snapshots; true if any changed */
+    bool takeSources(int from, int to) {
+      int diff = 0;
+      for (int i = from; i < to; i++) {
+        MultiControl* c = _controls[i];
+        for (int k = 0; k < _corners; k++) {
+          int16_t v = (int16_t)c->getBankValue(_banks[k]);
+          diff |= v ^ _src[k][i];
+          _src[k][i] = v;
+        }
+      }
+      return diff != 0;
+    }
+
+    /* out = a + (b - a) * x, rounded */
+    void lerp() {
+      const int32_t x = _x;
+      const int16_t* __restrict a = _src[0];
+      const int16_t* __restrict b = _src[1];
+      int16_t* __restrict out = _out;
+      // All lanes (unused ones are zero): a fixed trip count vectorises without a tail
+      for (int i = 0; i < MULTICONTROL_MORPH_MAX_CONTROLS; i++) {
+        out[i] = (int16_t)(a[i] + (((b[i] - a[i]) * x + 512) >> 10));
+      }
+    }
+
+    /* Bilinear weights of the four corners, summing to 1024 */
+    void bilerp() {
+      const int32_t wd = ((int32_t)_x * _y + 512) >> 10;
+      const int32_t wb = _x - wd, wc = _y - wd, wa = 1024 - wb - wc - wd;
+      const int16_t* __restrict a = _src[0];
+      const int16_t* __restrict b = _src[1];
+      const int16_t* __restrict c = _src[2];
+      const int16_t* __restrict d = _src[3];
+      int16_t* __restrict out = _out;
+      for (int i = 0; i < MULTICONTROL_MORPH_MAX_CONTROLS; i++) {
+        out[i] = (int16_t)((a[i] * wa + b[i] * wb + c[i] * wc + d[i] * wd + 512) >> 10);
+      }
+    }
+
+    /* A pot in the live bank that picked up the morphed value and then moved leaves the morph */
+    void checkOverrides() {
+      for (uint8_t i = 0; i < _numControls; i++) {
+        MultiControl* c = _controls[i];
+        if ((_overridden >> i) & 1) {
+          _dirty |= c->getValue() != _out[i];
+          continue;
+        }
+        if (!((_live >> i) & 1) || c->getControl() != 1 || c->getBank() != _outputBank || c->isLatched()) continue;
+        if (c->getValue() != _written[i]) {
+          _overridden |= 1ULL << i;
+          _dirty = true;
+        }
+      }
+    }
+
+    /* Store changed outputs in the live bank; pots there latch to them */
+    void writeOutput() {
+      for (int i = 0; i < _numControls; i++) {
+        if (!_changed[i] || ((_overridden >> i) & 1)) continue;
+        MultiControl* c = _controls[i];
+        c->setBankValue(_outputBank, _out[i]);
+        _written[i] = _out[i];
+        _live |= 1ULL << i;
+        if (c->getBank() != _outputBank) continue;
+        if (c->getControl() == 1) {
+          if (c->isLatchEnabled()) c->setBank(_outputBank);  // latch to the new value
+        } else {
+          c->setValue(_out[i]);
+        }
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,422 @@
+/*
+ * MultiControlMotion.h
+ *
+ * Motion recording and looped playback for a panel of MultiControl controls: records the
+ * value changes of pots, encoders and touch pads (as set by their reads or setValue()) into
+ * a fixed-size ring, then plays them back as automation at the original or a scaled speed.
+ *
+ * Playback drives the controls through their banks: a pot's played value is written to its
+ * current bank and the pot is latched to it, so it does not jump when touched. A control the
+ * performer moves takes over live: a pot that picked up the played value and moves, or an
+ * encoder that is turned, leaves playback until clearOverrides() or play(); a touch pad
+ * plays again once it is released.
+ *
+ * Ring format (version 1), one token at a time:
+ *   0x00 | index, zigzag-varint(change)   value change of control index (0-63)
+ *   0x40 | (ms - 1)                       time advance of 1-63 ms
+ *   0x7F, varint(ms)                      longer time advance
+ *   0x80 | index << 3 | code              change of -4..-1 (code 0-3) or 1..4 (code 4-7)
+ *                                         of control index 0-15
+ * Changes are against the previous recorded value of the control, and the changes of one
+ * update() share one time token. A pot turning costs 1-2 bytes per update() it changes
+ * in, an idle panel nothing. When the oldest tokens are overwritten (MC_MOTION_OVERWRITE)
+ * they are folded into the start snapshot, so the ring always plays back from a complete
+ * state.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_MOTION_H_
+#define MULTICONTROL_MOTION_H_
+
+#include "MultiControl.h"
+
+#ifndef MULTICONTROL_MOTION_MAX_CONTROLS
+#define MULTICONTROL_MOTION_MAX_CONTROLS 16  // controls in one recorder (64 at most)
+#endif
+#ifndef MULTICONTROL_MOTION_BYTES
+#define MULTICONTROL_MOTION_BYTES 16384  // ring size in bytes
+#endif
+
+#define MC_MOTION_STOP 0       // when the ring is full, stop recording (keep the beginning)
+#define MC_MOTION_OVERWRITE 1  // when the ring is full, drop the oldest motion (keep the end)
+
+#define MC_MOTION_TIME 0x40
+#define MC_MOTION_LONG_TIME 0x7F
+#define MC_MOTION_SMALL 0x80
+
+class MultiControlMotion {
+  public:
+    /** Constructor. */
+    MultiControlMotion() {};
+
+    /** Add a control to record and play
+    * @return The control index, or -1 if full
+    */
+    int addControl(MultiControl* control) {
+      if (_numControls >= MULTICONTROL_MOTION_MAX_CONTROLS || _numControls >= 64) return -1;
+      _controls[_numControls] = control;
+      return _numControls++;
+    }
+
+    /** Add an array of controls */
+    void addControls(MultiControl* controls, int count) {
+      for (int i = 0; i < count; i++) addControl(&controls[i]);
+    }
+
+    /** What to do when the ring is full
+    * @param policy MC_MOTION_STOP (default) or MC_MOTION_OVERWRITE
+    */
+    void setOverflowPolicy(uint8_t policy) { _policy = policy; }
+
+    /** Set the shortest time between recorded changes of the panel. Changes in between
+    * are combined, which saves ring space.
+    * @param ms Minimum interval in milliseconds (default 10, 0 = every update())
+    */
+    void setMinInterval(uint16_t ms) { _minInterval = ms; }
+
+    /** Start recording from the current values (clears the previous recording) */
+    void record() { record(MC_MILLIS()); }
+
+    /** Start recording, using an explicit timestamp (ms) */
+    void record(unsigned long now) {
+      _playing = false;
+      _recording = true;
+      _overflowed = false;
+      _head = _tail = _used = 0;
+      _time = _tailTime = _length = 0;
+      _recordStart = _lastSample = now;
+      for (uint8_t i = 0; i < _numControls; i++) {
+        _start[i] = _last[i] = valueOf(_controls[i]);
+      }
+    }
+
+    /** Stop recording or playing */
+    void stop() { stop(MC_MILLIS()); }
+
+    /** Stop, using an explicit timestamp (ms). A recording ends here: the loop length
+    * includes the time since the last change.
+    */
+    void stop(unsigned long now) {
+      if (_recording) {
+        sample(now);
+        _length = max(_time, (uint32_t)(now - _recordStart));
+      }
+      _recording = false;
+      _playing = false;
+    }
+
+    /** Play the recording from its start
+    * @param loop Start again at the end (default true)
+    */
+    void play(bool loop = true) { play(loop, MC_MILLIS()); }
+
+    /** Play, using an explicit timestamp (ms) */
+    void play(bool loop, unsigned long now) {
+      if (_recording) stop(now);
+      _loop = loop;
+      _overridden = 0;
+      _live = 0;
+      _lastUpdate = now;
+      _playing = rewind();
+    }
+
+    /** Set the playback speed
+    * @param speed 1.0 = as recorded, 0.5 = half speed, 2.0 = double (up to 255)
+    */
+    void setSpeed(float speed) { _speed = (uint16_t)constrain(speed * 256.0f + 0.5f, 1.0f, 65535.0f); }
+
+    /** Put controls the performer took over back under playback */
+    void clearOverrides() {
+      _overridden = 0;
+      for (uint8_t i = 0; i < _numControls; i++) _pending[i] = true;
+    }
+
+    /** Record or play. Call once per loop, after reading the controls. */
+    void update() { update(MC_MILLIS()); }
+
+    /** Record or play, using an explicit timestamp (ms) */
+    void update(unsigned long now) {
+      if (_recording) {
+        if (now - _lastSample >= _minInterval) sample(now);
+      } else if (_playing) {
+        advance(now);
+      }
+    }
+
+    /** Check if recording */
+    bool isRecording() { return _recording; }
+
+    /** Check if playing */
+    bool isPlaying() { return _playing; }
+
+    /** Check if recording stopped or dropped motion because the ring was full */
+    bool hasOverflowed() { return _overflowed; }
+
+    /** Check if a control left playback because the performer moved it */
+    bool isOverridden(uint8_t index) { return (_overridden >> index) & 1; }
+
+    /** Length of the recording (the loop) in ms */
+    uint32_t getLength() { return _length - _tailTime; }
+
+    /** Playback position in ms from the start of the recording */
+    uint32_t getPosition() { return _cursorTime - _tailTime; }
+
+    /** Bytes of the ring in use */
+    uint32_t getBytesUsed() { return _used; }
+
+    /** Number of controls */
+    uint8_t getControlCount() { return _numControls; }
+
+  private:
+    MultiControl* _controls[MULTICONTROL_MOTION_MAX_CONTROLS];
+    uint8_t _numControls = 0;
+    uint8_t _ring[MULTICONTROL_MOTION_BYTES];
+    uint32_t _head = 0, _tail = 0, _used = 0;
+    uint8_t _policy = MC_MOTION_STOP;
+    uint16_t _minInterval = 10;
+    bool _recording = false;
+    bool _playing = false;
+    bool _overflowed = false;
+    bool _loop = true;
+
+    // Times in ms from the start of recording
+    uint32_t _time = 0;       // of the last time token written
+    uint32_t _tailTime = 0;   // of the state in _start (advances as the oldest motion is dropped)
+    uint32_t _length = 0;     // of the end of the recording
+    unsigned long _recordStart = 0;
+    unsigned long _lastSample = 0;
+
+    int32_t _start[MULTICONTROL_MOTION_MAX_CONTROLS];  // values at the tail of the ring
+    int32_t _last[MULTICONTROL_MOTION_MAX_CONTROLS];   // last recorded values
+
+    // Playback
+    uint32_t _cursor = 0;      // next token to play
+    uint32_t _cursorLeft = 0;  // bytes left to play
+    uint32_t _cursorTime = 0;  // time of the played state
+    uint32_t _clock = 0;       // playback time in 1/256 ms from the tail
+    uint16_t _speed = 256;     // Q8
+    unsigned long _lastUpdate = 0;
+    uint64_t _overridden = 0;
+    uint64_t _live = 0;        // controls written at least once since play()
+    int32_t _played[MULTICONTROL_MOTION_MAX_CONTROLS];
+    int32_t _written[MULTICONTROL_MOTION_MAX_CONTROLS];
+    bool _pending[MULTICONTROL_MOTION_MAX_CONTROLS];  // played value not written yet
+
+    /* The value recorded for a control: encoder position, otherwise the current bank value */
+    static int32_t valueOf(MultiControl* c) {
+      return c->getControl() == 5 ? c->getEncoderPosition() : c->getValue();
+    }
+
+    /* Record the changes since the last sample as one time token and an event per change */
+    void sample(unsigned long now) {
+      _lastSample = now;
+      uint32_t at = now - _recordStart;
+      bool timed = false;
+      for (uint8_t i = 0; i < _numControls && _recording; i++) {
+        int32_t value = valueOf(_controls[i]);
+        if (value == _last[i]) continue;
+        uint8_t token[12];
+        uint8_t len = 0;
+        if (!timed && at != _time) {
+          uint32_t dt = at - _time;
+          if (dt < 64) {
+            token[len++] = MC_MOTION_TIME | (dt - 1);
+          } else {
+            token[len++] = MC_MOTION_LONG_TIME;
+            len = putVarint(token, len, dt);
+          }
+        }
+        int32_t change = value - _last[i];
+        if (i < 16 && change >= -4 && change <= 4) {
+          token[len++] = MC_MOTION_SMALL | (i << 3) | (change < 0 ? change + 4 : change + 3);
+        } else {
+          token[len++] = i;
+          len = putVarint(token, len, zigzag(change));
+        }
+        if (!reserve(len)) return;
+        for (uint8_t b = 0; b < len; b++) {
+          _ring[_head] = token[b];
+          if (++_head == MULTICONTROL_MOTION_BYTES) _head = 0;
+        }
+        _used += len;
+        _last[i] = value;
+        timed = true;
+        _time = at;
+      }
+    }
+
+    /* Make room for len bytes as the overflow policy says; false if recording stopped */
+    bool reserve(uint32_t len) {
+      if (_used + len <= MULTICONTROL_MOTION_BYTES) return true;
+      _overflowed = true;
+      if (_policy == MC_MOTION_STOP || len > MULTICONTROL_MOTION_BYTES) {
+        _length = _time;
+        _recording = false;
+        return false;
+      }
+      // Fold the oldest tokens into the start snapshot
+      while (_used + len > MULTICONTROL_MOTION_BYTES) {
+        uint32_t pos = _tail;
+        uint8_t index;
+        int32_t change;
+        uint32_t dt;
+        _used -= next(pos, index, change, dt);
+        _tail = pos;
+        if (dt) _tailTime += dt;
+        else _start[index] += change;
+      }
+      return true;
+    }
+
+    /* Decode the token at pos and move pos past it
+    * @return Its size in bytes; dt > 0 for a time token, otherwise index and change
+    */
+    uint8_t next(uint32_t& pos, uint8_t& index, int32_t& change, uint32_t& dt) {
+      uint8_t size = 1;
+      uint8_t b = take(pos);
+      dt = 0;
+      index = 0;
+      change = 0;
+      if (b < MC_MOTION_TIME) {
+        index = b;
+        change = unzigzag(takeVarint(pos, size));
+      } else if (b < MC_MOTION_LONG_TIME) {
+        dt = (b & 0x3F) + 1;
+      } else if (b == MC_MOTION_LONG_TIME) {
+        dt = takeVarint(pos, size);
+      } else {
+        index = (b >> 3) & 0x0F;
+        uint8_t code = b & 0x07;
+        change = code < 4 ? code - 4 : code - 3;
+      }
+      return size;
+    }
+
+    inline uint8_t take(uint32_t& pos) {
+      uint8_t b = _ring[pos];
+      if (++pos == MULTICONTROL_MOTION_BYTES) pos = 0;
+      return b;
+    }
+
+    uint32_t takeVarint(uint32_t& pos, uint8_t& size) {
+      uint32_t v = 0;
+      for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t b = take(pos);
+        size++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+      }
+      return v;
+    }
+
+    static uint8_t putVarint(uint8_t* out, uint8_t len, uint32_t v) {
+      while (v >= 0x80) {
+        out[len++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+      }
+      out[len++] = v;
+      return len;
+    }
+
+    static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    /* Back to the start state of the recording; false if there is nothing to play */
+    bool rewind() {
+      if (getLength() == 0) return false;
+      _cursor = _tail;
+      _cursorLeft = _used;
+      _cursorTime = _tailTime;
+      _clock = 0;
+      for (uint8_t i = 0; i < _numControls; i++) {
+        _played[i] = _start[i];
+        _pending[i] = true;
+      }
+      return true;
+    }
+
+    /* Play the tokens up to the playback time, then write the played values */
+    void advance(unsigned long now) {
+      _clock += (now - _lastUpdate) * _speed;
+      _lastUpdate = now;
+      uint32_t target = _tailTime + (_clock >> 8);
+      for (;;) {
+        while (_cursorLeft > 0) {
+          uint32_t pos = _cursor;
+          uint8_t index;
+          int32_t change;
+          uint32_t dt;
+          uint8_t size = next(pos, index, change, dt);
+          if (dt) {
+            if (_cursorTime + dt > target) break;
+            _cursorTime += dt;
+          } else {
+            _played[index] += change;
+            _pending[index] = true;
+          }
+          _cursor = pos;
+          _cursorLeft -= size;
+        }
+        if (_cursorLeft > 0 || target < _length) break;
+        // The end: loop from the start, carrying the time past the end
+        if (!_loop) {
+          _playing = false;
+          break;
+        }
+        uint32_t over = _clock - ((_length - _tailTime) << 8);
+        rewind();
+        _clock = over;
+        target = _tailTime + (_clock >> 8);
+      }
+      checkOverrides();
+      writePlayed();
+    }
+
+    /* A control the performer moved leaves playback */
+    void checkOverrides() {
+      for (uint8_t i = 0; i < _numControls; i++) {
+        MultiControl* c = _controls[i];
+        uint64_t bit = 1ULL << i;
+        uint8_t type = c->getControl();
+        if (type == 0) {
+          // A touch pad plays again when released
+          bool touched = c->getTouchState();
+          if (!touched && (_overridden & bit)) _pending[i] = true;
+          _overridden = touched ? (_overridden | bit) : (_overridden & ~bit);
+          continue;
+        }
+        if ((_overridden & bit) || !(_live & bit)) continue;
+        bool moved;
+        if (type == 1) moved = !c->isLatched() && c->getValue() != _written[i];
+        else moved = valueOf(c) != _written[i];
+        if (moved) _overridden |= bit;
+      }
+    }
+
+    /* Write played values through the banks; pots latch to them */
+    void writePlayed() {
+      for (uint8_t i = 0; i < _numControls; i++) {
+        MultiControl* c = _controls[i];
+        uint8_t type = c->getControl();
+        // A touch pad's read replaces its value every loop, so it is written every update
+        if ((_overridden >> i) & 1 || !(_pending[i] || type == 0)) continue;
+        int32_t v = _played[i];
+        if (type == 1) {
+          c->setBankValue(c->getBank(), v);
+          if (c->isLatchEnabled()) c->setBank(c->getBank());  // latch to the played value
+        } else if (type == 5) {
+          c->setEncoderPosition(v);
+        } else {
+          c->setValue(v);
+        }
+        _written[i] = valueOf(c);  // as stored (an encoder clamps to its range)
+        _pending[i] = false;
+        _live |= 1ULL << i;
+      }
+    }
+};
+
+#endif /* MULTICONTROL_MOTION_H_ */
@@ -0,0 +1,471 @@
+/*
+ * MultiControlPots.h
+ *
+ * Filters a bank of pots together. All pots are sampled in the same four rounds
+ * (one settle delay per round instead of per pot), and the per-pot work of readPot()
+ * (sorting the four samples, floating pin and sticky edge checks, the middle-two sum and
+ * the responsive filter) runs over structure-of-arrays state, 8 pots at a time.
+ * The bank snap, hysteresis and bank latching are then applied per pot by its
+ * MultiControl object, so getValue(), latching and isQuiet() work as with readPot().
+ *
+ * Kernels, chosen at compile time and switchable with setKernel():
+ *   MC_POTS_KERNEL_SCALAR  portable C++, always available
+ *   MC_POTS_KERNEL_SSE2    x86 hosts (__SSE2__)
+ *   MC_POTS_KERNEL_NEON    64-bit ARM hosts (__aarch64__, which has exact vector division)
+ *   MC_POTS_KERNEL_PIE     ESP32-S3, sorting with the PIE vector min/max instructions.
+ *                          PIE has no float lanes, so the filter itself runs scalar.
+ *                          Define MULTICONTROL_POTS_PIE to enable it.
+ * Every kernel gives the same results as readPot() on the same samples. On targets with
+ * fused multiply-add, build with -ffp-contract=off to also match it to the last bit of the
+ * filter state, as the compiler may fuse the scalar and vector code differently.
+ * Only the default responsive pot filter is batched; with MULTICONTROL_POT_FILTER set to
+ * another filter, each pot is filtered by its MultiControl object.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_POTS_H_
+#define MULTICONTROL_POTS_H_
+
+#include "MultiControl.h"
+
+#define MC_POTS_KERNEL_SCALAR 0
+#define MC_POTS_KERNEL_SSE2 1
+#define MC_POTS_KERNEL_NEON 2
+#define MC_POTS_KERNEL_PIE 3
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MC_POTS_HAS_SSE2 1
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MC_POTS_HAS_NEON 1
+#endif
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && defined(MULTICONTROL_POTS_PIE) && !defined(MULTICONTROL_CAPTURE)
+#define MC_POTS_HAS_PIE 1
+#endif
+
+class MultiControlPots {
+  public:
+    /** Maximum pots in one bank (two blocks of 8) */
+    const static uint8_t MAX_POTS = 16;
+
+    /** Constructor. Selects the fastest kernel compiled in. */
+    MultiControlPots() {
+      #if defined(MC_POTS_HAS_SSE2)
+        _kernel = MC_POTS_KERNEL_SSE2;
+      #elif defined(MC_POTS_HAS_NEON)
+        _kernel = MC_POTS_KERNEL_NEON;
+      #elif defined(MC_POTS_HAS_PIE)
+        _kernel = MC_POTS_KERNEL_PIE;
+      #endif
+    };
+
+    /** Add a pot (its pin, settings and current filter state are taken from the control)
+    * @return The pot index, or -1 if full
+    */
+    int addPot(MultiControl* pot) {
+      if (_count >= MAX_POTS) return -1;
+      uint8_t i = _count++;
+      _pots[i] = pot;
+      if (pot->getControl() != 1) pot->setControl(1);
+      sync(i);
+      return i;
+    }
+
+    /** Reload a pot's settings and filter state from its MultiControl object.
+    * Call after changing its pot settings or reading it with readPot().
+    */
+    void sync(uint8_t i) {
+      MultiControl::PotFilter f = _pots[i]->getPotFilter();
+      _smooth[i] = f.smooth;
+      _error[i] = f.error;
+      _snap[i] = f.snapMultiplier;
+      _activity[i] = f.activityThreshold;
+      _maxSpread[i] = f.maxSampleSpread;
+      _asleep[i] = f.asleep ? -1 : 0;
+      _first[i] = f.firstRead ? -1 : 0;
+      _sleepEnable[i] = f.sleepEnable ? -1 : 0;
+      _edgeSnap[i] = f.edgeSnap ? -1 : 0;
+    }
+
+    /** Reload every pot, see sync(uint8_t) */
+    void sync() {
+      for (uint8_t i = 0; i < _count; i++) sync(i);
+    }
+
+    /** Sample every pot four times and filter them. Call once per scan. */
+    void update() {
+      for (uint8_t s = 0; s < 4; s++) {
+        for (uint8_t i = 0; i < _count; i++) {
+          if (s > 0 && _pots[i]->isPotSingleSample()) _samples[s][i] = _samples[0][i];
+          else _samples[s][i] = MC_ANALOG_READ(_pots[i]->getPin());
+        }
+        if (s < 3) delayMicroseconds(10);
+      }
+      filter();
+    }
+
+    /** Filter every pot from samples read elsewhere
+    * @param samples Four ADC readings (0-4095) of each pot: samples[round][pot index]
+    */
+    void update(const int16_t samples[4][MAX_POTS]) {
+      memcpy(_samples, samples, sizeof(_samples));
+      filter();
+    }
+
+    /** Get the result of the last update for a pot: as readPot() (-3 for a floating pin) */
+    int getValue(uint8_t i) { return _values[i]; }
+
+    /** Get the number of pots */
+    uint8_t getPotCount() { return _count; }
+
+    /** Choose the kernel (MC_POTS_KERNEL_*)
+    * @return false if it is not compiled in for this target
+    */
+    bool setKernel(uint8_t kernel) {
+      if (!hasKernel(kernel)) return false;
+      _kernel = kernel;
+      return true;
+    }
+
+    /** Get the kernel in use */
+    uint8_t getKernel() { return _kernel; }
+
+    /** Check if a kernel is compiled in for this target */
+    static bool hasKernel(uint8_t kernel) {
+      switch (kernel) {
+        case MC_POTS_KERNEL_SCALAR: return true;
+        #if defined(MC_POTS_HAS_SSE2)
+        case MC_POTS_KERNEL_SSE2: return true;
+        #endif
+        #if defined(MC_POTS_HAS_NEON)
+        case MC_POTS_KERNEL_NEON: return true;
+        #endif
+        #if defined(MC_POTS_HAS_PIE)
+        case MC_POTS_KERNEL_PIE: return true;
+        #endif
+        default: return false;
+      }
+    }
+
+  private:
+    // Lane status from the kernel
+    const static int32_t FILTERED = 0;
+    const static int32_t UNSTABLE = 1;  // sample spread too wide, readPot() returns -3
+    const static int32_t EDGE_LOW = 2;
+    const static int32_t EDGE_HIGH = 3;
+
+    MultiControl* _pots[MAX_POTS];
+    int _values[MAX_POTS] = {};
+    uint8_t _count = 0;
+    uint8_t _kernel = MC_POTS_KERNEL_SCALAR;
+
+    // Structure-of-arrays state, one lane per pot; flags are lane masks (0 or -1)
+    alignas(16) int16_t _samples[4][MAX_POTS] = {};
+    alignas(16) float _smooth[MAX_POTS] = {};
+    alignas(16) float _error[MAX_POTS] = {};
+    alignas(16) float _snap[MAX_POTS] = {};
+    alignas(16) float _activity[MAX_POTS] = {};
+    alignas(16) int32_t _maxSpread[MAX_POTS] = {};
+    alignas(16) int32_t _asleep[MAX_POTS] = {};
+    alignas(16) int32_t _first[MAX_POTS] = {};
+    alignas(16) int32_t _sleepEnable[MAX_POTS] = {};
+    alignas(16) int32_t _edgeSnap[MAX_POTS] = {};
+    alignas(16) int32_t _status[MAX_POTS] = {};
+    alignas(16) int32_t _readValue[MAX_POTS] = {};
+    alignas(16) int32_t _spread[MAX_POTS] = {};
+
+    /* Run the kernel over whole blocks of 8 lanes, then finish each pot */
+    void filter() {
+      #if MULTICONTROL_POT_FILTER != MC_POT_FILTER_RESPONSIVE
+        for (uint8_t i = 0; i < _count; i++) {
+          int samples[4] = {_samples[0][i], _samples[1][i], _samples[2][i], _samples[3][i]};
+          _values[i] = _pots[i]->potSamples(samples);
+        }
+        return;
+      #endif
+      uint8_t lanes = (_count + 7) & ~7;
+      switch (_kernel) {
+        #if defined(MC_POTS_HAS_SSE2)
+        case MC_POTS_KERNEL_SSE2: filterSse2(lanes); break;
+        #endif
+        #if defined(MC_POTS_HAS_NEON)
+        case MC_POTS_KERNEL_NEON: filterNeon(lanes); break;
+        #endif
+        #if defined(MC_POTS_HAS_PIE)
+        case MC_POTS_KERNEL_PIE:
+          sortPie(lanes);
+          filterScalar(lanes, false);
+          break;
+        #endif
+        default: filterScalar(lanes, true);
+      }
+      for (uint8_t i = 0; i < _count; i++) {
+        if (_status[i] == UNSTABLE) _values[i] = _pots[i]->potUnstable(_spread[i]);
+        else if (_status[i] == FILTERED) _values[i] = _pots[i]->potFiltered(_readValue[i], _spread[i], _smooth[i], _error[i], _asleep[i] != 0);
+        else _values[i] = _pots[i]->potEdge(_status[i] == EDGE_HIGH);
+        if (_pots[i]->isPotAutoTune()) _activity[i] = _pots[i]->getActivityThreshold();  // tuned by the pot
+      }
+    }
+
+    /* Portable kernel: the readPot() steps lane by lane */
+    void filterScalar(uint8_t lanes, bool sort) {
+      for (uint8_t i = 0; i < lanes; i++) {
+        int s[4] = {_samples[0][i], _samples[1][i], _samples[2][i], _samples[3][i]};
+        if (sort) {
+          #define SORT_SWAP(a,b) if(s[a]>s[b]){int t=s[a];s[a]=s[b];s[b]=t;}
+          SORT_SWAP(0,1); SORT_SWAP(2,3); SORT_SWAP(0,2); SORT_SWAP(1,3); SORT_SWAP(1,2);
+          #undef SORT_SWAP
+        }
+        _spread[i] = s[3] - s[0];
+        if (_spread[i] > _maxSpread[i]) {
+          _status[i] = UNSTABLE;
+          continue;
+        }
+        if (s[3] < 30 || s[0] > 4065) {
+          _status[i] = s[3] < 30 ? EDGE_LOW : EDGE_HIGH;
+          _smooth[i] = s[3] < 30 ? 0.0f : 511.0f;
+          continue;
+        }
+        _status[i] = FILTERED;
+        int readValue = s[1] + s[2];
+        _readValue[i] = readValue;
+        int v = readValue >> 4;
+        if (_first[i]) {
+          _smooth[i] = v;
+          _first[i] = 0;
+        }
+        float act = _activity[i];
+        if (_edgeSnap[i]) {
+          if (v < act) v = (v * 2) - act;
+          else if (v > 512 - act) v = (v * 2) - 512 + act;
+          if (v < 0) v = 0;
+        }
+        float smooth = _smooth[i];
+        float d = v - smooth;
+        unsigned int diff = fabsf(d);
+        _error[i] += (d - _error[i]) * 0.4f;
+        if (_sleepEnable[i]) {
+          _asleep[i] = fabsf(_error[i]) < act ? -1 : 0;
+          if (_asleep[i]) continue;
+        }
+        float y = 1.0f / (diff * _snap[i] + 1.0f);
+        y = (1.0f - y) * 2.0f;
+        if (y > 1.0f) y = 1.0f;
+        smooth += d * y;
+        if (smooth < 0.0f) smooth = 0.0f;
+        else if (smooth > 511.0f) smooth = 511.0f;
+        _smooth[i] = smooth;
+      }
+    }
+
+    #if defined(MC_POTS_HAS_SSE2)
+    /* SSE2 kernel: 8 pots per sort step (16-bit lanes), 4 per filter step (float lanes) */
+    void filterSse2(uint8_t lanes) {
+      const __m128i zero = _mm_setzero_si128();
+      for (uint8_t b = 0; b < lanes; b += 8) {
+        __m128i r0 = _mm_load_si128((const __m128i*)&_samples[0][b]);
+        __m128i r1 = _mm_load_si128((const __m128i*)&_samples[1][b]);
+        __m128i r2 = _mm_load_si128((const __m128i*)&_samples[2][b]);
+        __m128i r3 = _mm_load_si128((const __m128i*)&_samples[3][b]);
+        #define SORT_SWAP(x, y) { __m128i t = _mm_min_epi16(x, y); y = _mm_max_epi16(x, y); x = t; }
+        SORT_SWAP(r0, r1); SORT_SWAP(r2, r3); SORT_SWAP(r0, r2); SORT_SWAP(r1, r3); SORT_SWAP(r1, r2);
+        #undef SORT_SWAP
+        // Samples are 0-4095, so widening with zeros keeps their value
+        filterSse2Lanes(b, _mm_unpacklo_epi16(r0, zero), _mm_unpacklo_epi16(r1, zero),
+                        _mm_unpacklo_epi16(r2, zero), _mm_unpacklo_epi16(r3, zero));
+        filterSse2Lanes(b + 4, _mm_unpackhi_epi16(r0, zero), _mm_unpackhi_epi16(r1, zero),
+                        _mm_unpackhi_epi16(r2, zero), _mm_unpackhi_epi16(r3, zero));
+      }
+    }
+
+    static inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+      return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    static inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+      return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    /* The filter step of filterScalar() on 4 lanes of sorted samples */
+    void filterSse2Lanes(uint8_t i, __m128i s0, __m128i s1, __m128i s2, __m128i s3) {
+      const __m128i ones = _mm_set1_epi32(-1);
+      const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+      __m128i spread = _mm_sub_epi32(s3, s0);
+      _mm_store_si128((__m128i*)&_spread[i], spread);
+      __m128i unstable = _mm_cmpgt_epi32(spread, _mm_load_si128((const __m128i*)&_maxSpread[i]));
+      __m128i low = _mm_andnot_si128(unstable, _mm_cmplt_epi32(s3, _mm_set1_epi32(30)));
+      __m128i high = _mm_andnot_si128(_mm_or_si128(unstable, low), _mm_cmpgt_epi32(s0, _mm_set1_epi32(4065)));
+      __m128i filtered = _mm_xor_si128(_mm_or_si128(_mm_or_si128(unstable, low), high), ones);
+      __m128 filteredPs = _mm_castsi128_ps(filtered);
+      __m128i status = _mm_or_si128(_mm_and_si128(unstable, _mm_set1_epi32(UNSTABLE)),
+                       _mm_or_si128(_mm_and_si128(low, _mm_set1_epi32(EDGE_LOW)), _mm_and_si128(high, _mm_set1_epi32(EDGE_HIGH))));
+      _mm_store_si128((__m128i*)&_status[i], status);
+
+      __m128i readValue = _mm_add_epi32(s1, s2);
+      _mm_store_si128((__m128i*)&_readValue[i], readValue);
+      __m128i v = _mm_srai_epi32(readValue, 4);
+      __m128i first = _mm_and_si128(_mm_load_si128((const __m128i*)&_first[i]), filtered);
+      __m128 smooth0 = _mm_load_ps(&_smooth[i]);
+      __m128 smooth = select(_mm_castsi128_ps(first), _mm_cvtepi32_ps(v), smooth0);
+      _mm_store_si128((__m128i*)&_first[i], _mm_andnot_si128(filtered, _mm_load_si128((const __m128i*)&_first[i])));
+
+      // Edge snap: stretch readings within the activity threshold of either end
+      __m128 act = _mm_load_ps(&_activity[i]);
+      __m128 edgeSnap = _mm_load_ps((const float*)&_edgeSnap[i]);
+      __m128 vf = _mm_cvtepi32_ps(v);
+      __m128 snapLow = _mm_and_ps(edgeSnap, _mm_cmplt_ps(vf, act));
+      __m128 snapHigh = _mm_andnot_ps(snapLow, _mm_and_ps(edgeSnap, _mm_cmpgt_ps(vf, _mm_sub_ps(_mm_set1_ps(512.0f), act))));
+      __m128i twice = _mm_add_epi32(v, v);
+      __m128i lowV = _mm_cvttps_epi32(_mm_sub_ps(_mm_cvtepi32_ps(twice), act));
+      __m128i highV = _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(_mm_sub_epi32(twice, _mm_set1_epi32(512))), act));
+      v = select(_mm_castps_si128(snapLow), lowV, select(_mm_castps_si128(snapHigh), highV, v));
+      v = _mm_andnot_si128(_mm_srai_epi32(v, 31), v);  // negative to 0
+      vf = _mm_cvtepi32_ps(v);
+
+      // Error average and sleep
+      __m128 d = _mm_sub_ps(vf, smooth);
+      __m128i diff = _mm_cvttps_epi32(_mm_and_ps(d, absMask));
+      __m128 error0 = _mm_load_ps(&_error[i]);
+      __m128 error = _mm_add_ps(error0, _mm_mul_ps(_mm_sub_ps(d, error0), _mm_set1_ps(0.4f)));
+      __m128 sleepEnable = _mm_load_ps((const float*)&_sleepEnable[i]);
+      __m128 asleep0 = _mm_load_ps((const float*)&_asleep[i]);
+      __m128 asleep = select(sleepEnable, _mm_cmplt_ps(_mm_and_ps(error, absMask), act), asleep0);
+      __m128 hold = _mm_and_ps(sleepEnable, asleep);
+
+      // Snap curve, then move toward the reading and clamp to 0-511
+      const __m128 one = _mm_set1_ps(1.0f);
+      __m128 y = _mm_div_ps(one, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(diff), _mm_load_ps(&_snap[i])), one));
+      y = _mm_min_ps(one, _mm_mul_ps(_mm_sub_ps(one, y), _mm_set1_ps(2.0f)));
+      __m128 moved = _mm_add_ps(smooth, _mm_mul_ps(d, y));
+      moved = _mm_max_ps(_mm_setzero_ps(), moved);
+      moved = _mm_min_ps(_mm_set1_ps(511.0f), moved);
+      smooth = select(hold, smooth, moved);
+
+      __m128 edgeValue = _mm_and_ps(_mm_castsi128_ps(high), _mm_set1_ps(511.0f));
+      smooth = select(filteredPs, smooth, select(_mm_castsi128_ps(_mm_or_si128(low, high)), edgeValue, smooth0));
+      _mm_store_ps(&_smooth[i], smooth);
+      _mm_store_ps(&_error[i], select(filteredPs, error, error0));
+      _mm_store_ps((float*)&_asleep[i], select(filteredPs, asleep, asleep0));
+    }
+    #endif
+
+    #if defined(MC_POTS_HAS_NEON)
+    /* NEON kernel: 8 pots per sort step (16-bit lanes), 4 per filter step (float lanes) */
+    void filterNeon(uint8_t lanes) {
+      for (uint8_t b = 0; b < lanes; b += 8) {
+        int16x8_t r0 = vld1q_s16(&_samples[0][b]);
+        int16x8_t r1 = vld1q_s16(&_samples[1][b]);
+        int16x8_t r2 = vld1q_s16(&_samples[2][b]);
+        int16x8_t r3 = vld1q_s16(&_samples[3][b]);
+        #define SORT_SWAP(x, y) { int16x8_t t = vminq_s16(x, y); y = vmaxq_s16(x, y); x = t; }
+        SORT_SWAP(r0, r1); SORT_SWAP(r2, r3); SORT_SWAP(r0, r2); SORT_SWAP(r1, r3); SORT_SWAP(r1, r2);
+        #undef SORT_SWAP
+        filterNeonLanes(b, vmovl_s16(vget_low_s16(r0)), vmovl_s16(vget_low_s16(r1)),
+                        vmovl_s16(vget_low_s16(r2)), vmovl_s16(vget_low_s16(r3)));
+        filterNeonLanes(b + 4, vmovl_s16(vget_high_s16(r0)), vmovl_s16(vget_high_s16(r1)),
+                        vmovl_s16(vget_high_s16(r2)), vmovl_s16(vget_high_s16(r3)));
+      }
+    }
+
+    /* The filter step of filterScalar() on 4 lanes of sorted samples */
+    void filterNeonLanes(uint8_t i, int32x4_t s0, int32x4_t s1, int32x4_t s2, int32x4_t s3) {
+      int32x4_t spread = vsubq_s32(s3, s0);
+      vst1q_s32(&_spread[i], spread);
+      uint32x4_t unstable = vcgtq_s32(spread, vld1q_s32(&_maxSpread[i]));
+      uint32x4_t low = vbicq_u32(vcltq_s32(s3, vdupq_n_s32(30)), unstable);
+      uint32x4_t high = vbicq_u32(vcgtq_s32(s0, vdupq_n_s32(4065)), vorrq_u32(unstable, low));
+      uint32x4_t filtered = vmvnq_u32(vorrq_u32(vorrq_u32(unstable, low), high));
+      uint32x4_t status = vorrq_u32(vandq_u32(unstable, vdupq_n_u32(UNSTABLE)),
+                          vorrq_u32(vandq_u32(low, vdupq_n_u32(EDGE_LOW)), vandq_u32(high, vdupq_n_u32(EDGE_HIGH))));
+      vst1q_s32(&_status[i], vreinterpretq_s32_u32(status));
+
+      int32x4_t readValue = vaddq_s32(s1, s2);
+      vst1q_s32(&_readValue[i], readValue);
+      int32x4_t v = vshrq_n_s32(readValue, 4);
+      uint32x4_t first0 = vreinterpretq_u32_s32(vld1q_s32(&_first[i]));
+      float32x4_t smooth0 = vld1q_f32(&_smooth[i]);
+      float32x4_t smooth = vbslq_f32(vandq_u32(first0, filtered), vcvtq_f32_s32(v), smooth0);
+      vst1q_s32(&_first[i], vreinterpretq_s32_u32(vbicq_u32(first0, filtered)));
+
+      // Edge snap: stretch readings within the activity threshold of either end
+      float32x4_t act = vld1q_f32(&_activity[i]);
+      uint32x4_t edgeSnap = vreinterpretq_u32_s32(vld1q_s32(&_edgeSnap[i]));
+      float32x4_t vf = vcvtq_f32_s32(v);
+      uint32x4_t snapLow = vandq_u32(edgeSnap, vcltq_f32(vf, act));
+      uint32x4_t snapHigh = vbicq_u32(vandq_u32(edgeSnap, vcgtq_f32(vf, vsubq_f32(vdupq_n_f32(512.0f), act))), snapLow);
+      int32x4_t twice = vaddq_s32(v, v);
+      int32x4_t lowV = vcvtq_s32_f32(vsubq_f32(vcvtq_f32_s32(twice), act));
+      int32x4_t highV = vcvtq_s32_f32(vaddq_f32(vcvtq_f32_s32(vsubq_s32(twice, vdupq_n_s32(512))), act));
+      v = vbslq_s32(snapLow, lowV, vbslq_s32(snapHigh, highV, v));
+      v = vmaxq_s32(v, vdupq_n_s32(0));
+      vf = vcvtq_f32_s32(v);
+
+      // Error average and sleep
+      float32x4_t d = vsubq_f32(vf, smooth);
+      int32x4_t diff = vcvtq_s32_f32(vabsq_f32(d));
+      float32x4_t error0 = vld1q_f32(&_error[i]);
+      float32x4_t error = vaddq_f32(error0, vmulq_f32(vsubq_f32(d, error0), vdupq_n_f32(0.4f)));
+      uint32x4_t sleepEnable = vreinterpretq_u32_s32(vld1q_s32(&_sleepEnable[i]));
+      uint32x4_t asleep0 = vreinterpretq_u32_s32(vld1q_s32(&_asleep[i]));
+      uint32x4_t asleep = vbslq_u32(sleepEnable, vcltq_f32(vabsq_f32(error), act), asleep0);
+      uint32x4_t hold = vandq_u32(sleepEnable, asleep);
+
+      // Snap curve, then move toward the reading and clamp to 0-511
+      const float32x4_t one = vdupq_n_f32(1.0f);
+      float32x4_t y = vdivq_f32(one, vaddq_f32(vmulq_f32(vcvtq_f32_s32(diff), vld1q_f32(&_snap[i])), one));
+      y = vmulq_f32(vsubq_f32(one, y), vdupq_n_f32(2.0f));
+      y = vbslq_f32(vcgtq_f32(y, one), one, y);
+      float32x4_t moved = vaddq_f32(smooth, vmulq_f32(d, y));
+      moved = vbslq_f32(vcltq_f32(moved, vdupq_n_f32(0.0f)), vdupq_n_f32(0.0f), moved);
+      moved = vbslq_f32(vcgtq_f32(moved, vdupq_n_f32(511.0f)), vdupq_n_f32(511.0f), moved);
+      smooth = vbslq_f32(hold, smooth, moved);
+
+      float32x4_t edgeValue = vreinterpretq_f32_u32(vandq_u32(high, vreinterpretq_u32_f32(vdupq_n_f32(511.0f))));
+      smooth = vbslq_f32(filtered, smooth, vbslq_f32(vorrq_u32(low, high), edgeValue, smooth0));
+      vst1q_f32(&_smooth[i], smooth);
+      vst1q_f32(&_error[i], vbslq_f32(filtered, error, error0));
+      vst1q_s32(&_asleep[i], vreinterpretq_s32_u32(vbslq_u32(filtered, asleep, asleep0)));
+    }
+    #endif
+
+    #if defined(MC_POTS_HAS_PIE)
+    /* Sort the samples of 8 pots at a time with the ESP32-S3 PIE 128-bit min/max */
+    void sortPie(uint8_t lanes) {
+      for (uint8_t b = 0; b < lanes; b += 8) {
+        int16_t* r0 = &_samples[0][b];
+        int16_t* r1 = &_samples[1][b];
+        int16_t* r2 = &_samples[2][b];
+        int16_t* r3 = &_samples[3][b];
+        asm volatile(
+          "ee.vld.128.ip q0, %0, 0\n"
+          "ee.vld.128.ip q1, %1, 0\n"
+          "ee.vld.128.ip q2, %2, 0\n"
+          "ee.vld.128.ip q3, %3, 0\n"
+          "ee.vmin.s16 q4, q0, q1\n"  // swap 0,1: q4, q1
+          "ee.vmax.s16 q1, q0, q1\n"
+          "ee.vmin.s16 q5, q2, q3\n"  // swap 2,3: q5, q3
+          "ee.vmax.s16 q3, q2, q3\n"
+          "ee.vmin.s16 q0, q4, q5\n"  // swap 0,2: q0, q2
+          "ee.vmax.s16 q2, q4, q5\n"
+          "ee.vmin.s16 q4, q1, q3\n"  // swap 1,3: q4, q3
+          "ee.vmax.s16 q3, q1, q3\n"
+          "ee.vmin.s16 q1, q4, q2\n"  // swap 1,2: q1, q2
+          "ee.vmax.s16 q2, q4, q2\n"
+          "ee.vst.128.ip q0, %0, 0\n"
+          "ee.vst.128.ip q1, %1, 0\n"
+          "ee.vst.128.ip q2, %2, 0\n"
+          "ee.vst.128.ip q3, %3, 0\n"
+          : "+r"(r0), "+r"(r1), "+r"(r2), "+r"(r3)
+          :
+          : "memory");
+      }
+    }
+    #endif
+};
+
+#endif /* MULTICONTROL_POTS_H_ */
@@ -0,0 +1,158 @@
+/*
+ * MultiControlSlider.h
+ *
+ * A touch slider or wheel made of 3-8 adjacent capacitive pads. The pads are read together,
+ * and the finger position is the integer centroid of the baseline-corrected deltas of the
+ * strongest pad and its two neighbours, so pads far from the finger add no noise. Wheels
+ * wrap from the last pad back to the first. The position has hysteresis (it follows the
+ * finger with a small dead band, so it holds still at rest) and a velocity.
+ *
+ * Positions are 0-1023: from the centre of the first pad to the centre of the last on a
+ * slider, once round on a wheel (the first pad's centre at 0). update() reads the pads at
+ * most once per interval, so it can be called every loop without taking time from the
+ * other controls.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_SLIDER_H_
+#define MULTICONTROL_SLIDER_H_
+
+#include "MultiControl.h"
+
+#ifndef MULTICONTROL_SLIDER_MAX_PADS
+#define MULTICONTROL_SLIDER_MAX_PADS 8
+#endif
+
+class MultiControlSlider {
+  public:
+    /** Constructor. */
+    MultiControlSlider() {};
+
+    /** Add a pad, in order along the slider or round the wheel (calibrate the pads first)
+    * @return The pad index, or -1 if full
+    */
+    int addPad(MultiControl* pad) {
+      if (_numPads >= MULTICONTROL_SLIDER_MAX_PADS) return -1;
+      pad->setControl(0);
+      _pads[_numPads] = pad;
+      _touched = false;
+      return _numPads++;
+    }
+
+    /** Add an array of pads */
+    void addPads(MultiControl* pads, int count) {
+      for (int i = 0; i < count; i++) addPad(&pads[i]);
+    }
+
+    /** Make the pads a wheel, the last next to the first (3 pads or more), or a slider (default) */
+    void setWheel(bool wheel) { _wheel = wheel; }
+
+    /** Set the dead band the finger must move beyond to move the position
+    * @param units Position units, 0-1023 scale (default 10)
+    */
+    void setHysteresis(uint16_t units) { _hysteresis = units; }
+
+    /** Set how often update() reads the pads
+    * @param ms Interval in milliseconds (default 3, about 330 readings a second)
+    */
+    void setInterval(uint8_t ms) { _interval = ms; }
+
+    /** Read the pads if the interval has passed. Call every loop.
+    * @return true if the touch or the position changed
+    */
+    bool update() { return update(MC_MILLIS()); }
+
+    /** Read the pads if the interval has passed, using an explicit timestamp (ms) */
+    bool update(unsigned long now) {
+      if (_numPads < 2 || now - _lastRead < _interval) return false;
+      unsigned long dt = now - _lastRead;
+      _lastRead = now;
+
+      int16_t delta[MULTICONTROL_SLIDER_MAX_PADS];
+      bool touched = false;
+      uint8_t peak = 0;
+      for (uint8_t i = 0; i < _numPads; i++) {
+        MultiControl* pad = _pads[i];
+        pad->readTouch(now);
+        touched |= pad->getTouchState();
+        // Above half the release threshold, so idle pads read 0
+        delta[i] = max(0, pad->getTouchDelta() - (pad->getTouchOffThreshold() >> 1));
+        if (delta[i] > delta[peak]) peak = i;
+      }
+      if (!touched) {
+        bool changed = _touched;
+        _touched = false;
+        _velocity = 0;
+        return changed;
+      }
+
+      // Centroid of the peak pad and its neighbours, in 1/1024 pad steps from the first pad
+      int prev = peak > 0 ? delta[peak - 1] : (_wheel ? delta[_numPads - 1] : 0);
+      int next = peak < _numPads - 1 ? delta[peak + 1] : (_wheel ? delta[0] : 0);
+      int sum = prev + delta[peak] + next;
+      if (sum == 0) return false;
+      int32_t steps = ((int32_t)peak << 10) + (((int32_t)(next - prev) << 10) / sum);
+      int raw;
+      if (_wheel && _numPads >= 3) {
+        int32_t round = (int32_t)_numPads << 10;
+        steps = (steps + round) % round;
+        raw = (int)(steps / _numPads);
+      } else {
+        raw = (int)constrain((steps * 1023) / ((int32_t)(_numPads - 1) << 10), (int32_t)0, (int32_t)1023);
+      }
+      _raw = raw;
+
+      if (!_touched) {
+        // A new touch lands where the finger is
+        _touched = true;
+        _position = raw;
+        _velocity = 0;
+        return true;
+      }
+      int diff = raw - _position;
+      if (_wheel) diff = ((diff + 512) & 1023) - 512;  // the short way round
+      int move = 0;
+      if (diff > _hysteresis) move = diff - _hysteresis;
+      else if (diff < -(int)_hysteresis) move = diff + _hysteresis;
+      // Velocity in units per second, smoothed over about four readings. Kept in 1/16 units, so it
+      // decays to 0 when the finger stops (whole units would stick at 3)
+      int32_t v = dt > 0 ? (int32_t)move * 16000 / (int32_t)dt : 0;
+      _velocity += (v - _velocity) / 4;
+      if (move == 0) return false;
+      _position += move;
+      if (_wheel) _position &= 1023;
+      return true;
+    }
+
+    /** Check if a finger is on the slider */
+    bool isTouched() { return _touched; }
+
+    /** Get the position (0-1023), held after the finger leaves */
+    int getPosition() { return _position; }
+
+    /** Get the position of the last reading, without hysteresis */
+    int getRawPosition() { return _raw; }
+
+    /** Get the velocity in position units per second (positive towards the last pad), 0 when not touched */
+    int32_t getVelocity() { return (_velocity + (_velocity < 0 ? -8 : 8)) / 16; }
+
+    /** Get the number of pads */
+    uint8_t getPadCount() { return _numPads; }
+
+  private:
+    MultiControl* _pads[MULTICONTROL_SLIDER_MAX_PADS];
+    uint8_t _numPads = 0;
+    bool _wheel = false;
+    bool _touched = false;
+    uint16_t _hysteresis = 10;
+    uint8_t _interval = 3;
+    unsigned long _lastRead = 0;
+    int _position = 0;
+    int _raw = 0;
+    int32_t _velocity = 0;  // units per second, x16
+};
+
+#endif /* MULTICONTROL_SLIDER_H_ */
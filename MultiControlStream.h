@@ -0,0 +1,282 @@
+/*
+ * MultiControlStream.h
+ *
+ * Compact binary state stream for host editors and visualisers.
+ * Sends a full snapshot of a panel of MultiControl controls when started (and whenever
+ * the host asks), then delta frames with only the values, gesture events, latch states
+ * and banks that changed. Every frame carries a sequence number and a CRC, so a host
+ * can detect lost or damaged frames and ask for a fresh snapshot.
+ * A host decoder is in extras/stream/mcstream.h.
+ *
+ * Frame format (version 1):
+ *   0xA5 varint(len) body[len] crc16          crc16 = CRC-16/CCITT of len and body, little-endian
+ *   body: type seq varint(dt) ...             dt = ms since the previous frame, seq wraps at 256
+ *   type 0x01 snapshot: total first count, then per control:
+ *         controlType zigzag-varint(value) latch varint(bank)
+ *   type 0x02 delta: entries of (kind << 6 | index) then
+ *         kind 0 value      zigzag-varint(change from the previously sent value)
+ *         kind 1 gestures   MC_GESTURE_* bits since the previous frame
+ *         kind 2 latch      0, or the latch code -1, -2, -4 or -5 as a signed byte
+ *         kind 3 bank       varint(bank)
+ * A snapshot larger than one frame is split over several, each with its first index.
+ * A typical pot change costs 2-3 bytes, a click 2 bytes, plus 6 bytes per frame.
+ *
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_STREAM_H_
+#define MULTICONTROL_STREAM_H_
+
+#include "MultiControl.h"
+
+#ifndef MULTICONTROL_STREAM_MAX_CONTROLS
+#define MULTICONTROL_STREAM_MAX_CONTROLS 64  // controls in one stream (64 at most)
+#endif
+#ifndef MULTICONTROL_STREAM_FRAME
+#define MULTICONTROL_STREAM_FRAME 128  // largest frame body in bytes
+#endif
+
+#define MC_STREAM_SYNC 0xA5
+#define MC_STREAM_SNAPSHOT 0x01
+#define MC_STREAM_DELTA 0x02
+#define MC_STREAM_VALUE 0
+#define MC_STREAM_GESTURES 1
+#define MC_STREAM_LATCH 2
+#define MC_STREAM_BANK 3
+
+class MultiControlStream {
+  public:
+    /** Constructor. */
+    MultiControlStream() {};
+
+    /** Add a control to the stream
+    * @return The control index (its index in the stream), or -1 if full
+    */
+    int addControl(MultiControl* control) {
+      if (_numControls >= MULTICONTROL_STREAM_MAX_CONTROLS || _numControls >= 64) return -1;
+      _controls[_numControls] = {control, 0, 0, 0};
+      _snapshotDue = true;
+      return _numControls++;
+    }
+
+    /** Add an array of controls */
+    void addControls(MultiControl* controls, int count) {
+      for (int i = 0; i < count; i++) addControl(&controls[i]);
+    }
+
+    /** Start streaming to a port. The next update() sends a snapshot.
+    * @param out The port, e.g. Serial
+    */
+    void begin(Print& out) {
+      _out = &out;
+      _snapshotDue = true;
+    }
+
+    /** Stop streaming */
+    void end() { _out = nullptr; }
+
+    /** Send a full snapshot with the next update(), e.g. when the host connects or asks for one */
+    void requestSnapshot() { _snapshotDue = true; }
+
+    /** Set the shortest time between delta frames. Changes in between are combined.
+    * @param ms Minimum interval in milliseconds (default 10, 0 = a frame every update with changes)
+    */
+    void setMinInterval(uint16_t ms) { _minInterval = ms; }
+
+    /** Send a snapshot regularly, so a host that missed frames recovers on its own
+    * @param ms Snapshot interval in milliseconds (default 0 = only on begin() and requestSnapshot())
+    */
+    void setSnapshotInterval(unsigned long ms) { _snapshotInterval = ms; }
+
+    /** Send whatever has changed since the last frame. Call once per loop, after reading the controls.
+    * Controls are not read here: values are those of the last read, and gesture events are
+    * reported without clearing isHeld(), wasSingleClicked() and the other checks.
+    */
+    void update() { update(MC_MILLIS()); }
+
+    /** Send whatever has changed, using an explicit timestamp (ms) */
+    void update(unsigned long now) {
+      if (_out == nullptr) return;
+      if (_snapshotInterval > 0 && now - _lastSnapshot >= _snapshotInterval) _snapshotDue = true;
+      if (_snapshotDue) {
+        sendSnapshot(now);
+        return;
+      }
+      if (now - _lastFrame < _minInterval) return;
+      startFrame(MC_STREAM_DELTA, now);
+      for (uint8_t i = 0; i < _numControls; i++) {
+        Entry& e = _controls[i];
+        MultiControl* c = e.control;
+        int32_t value = valueOf(c);
+        uint8_t gestures = c->takeGestureEvents(MC_CONSUMER_STREAM);
+        int8_t latch = c->getLatchState();
+        uint8_t bank = c->getBank();
+        if (bank != e.bank) {
+          reserve(MC_STREAM_DELTA, now, 3);
+          put((MC_STREAM_BANK << 6) | i);
+          putVarint(bank);
+          e.bank = bank;
+        }
+        if (value != e.value) {
+          reserve(MC_STREAM_DELTA, now, 6);
+          put((MC_STREAM_VALUE << 6) | i);
+          putVarint(zigzag(value - e.value));
+          e.value = value;
+        }
+        if (gestures) {
+          reserve(MC_STREAM_DELTA, now, 2);
+          put((MC_STREAM_GESTURES << 6) | i);
+          put(gestures);
+        }
+        if (latch != e.latch) {
+          reserve(MC_STREAM_DELTA, now, 2);
+          put((MC_STREAM_LATCH << 6) | i);
+          put((uint8_t)latch);
+          e.latch = latch;
+        }
+      }
+      if (_len > _headerLen) finishFrame(now);
+    }
+
+    /** Number of frames sent */
+    uint32_t getFrameCount() { return _frames; }
+
+    /** Number of bytes sent, including framing */
+    uint32_t getByteCount() { return _bytes; }
+
+    /** Get the number of controls */
+    uint8_t getControlCount() { return _numControls; }
+
+  private:
+    struct Entry {
+      MultiControl* control;
+      int32_t value;  // last value sent
+      int8_t latch;   // last latch state sent
+      uint8_t bank;   // last bank sent
+    };
+
+    Entry _controls[MULTICONTROL_STREAM_MAX_CONTROLS];
+    uint8_t _numControls = 0;
+    Print* _out = nullptr;
+    uint8_t _frame[MULTICONTROL_STREAM_FRAME + 8];  // sync, length, body, crc
+    uint16_t _len = 0;        // body bytes so far
+    uint16_t _headerLen = 0;  // body bytes before the first entry
+    uint8_t _seq = 0;
+    bool _snapshotDue = true;
+    uint16_t _minInterval = 10;
+    unsigned long _snapshotInterval = 0;
+    unsigned long _lastFrame = 0;
+    unsigned long _lastSnapshot = 0;
+    unsigned long _frameTime = 0;  // time of the last frame sent, for dt
+    uint32_t _frames = 0;
+    uint32_t _bytes = 0;
+
+    /* The value a host should see: encoder position, otherwise the current bank value */
+    static int32_t valueOf(MultiControl* c) {
+      return c->getControl() == 5 ? c->getEncoderPosition() : c->getValue();
+    }
+
+    void sendSnapshot(unsigned long now) {
+      uint8_t first = 0;
+      startFrame(MC_STREAM_SNAPSHOT, now);
+      put(_numControls);
+      put(0);
+      put(0);
+      for (uint8_t i = 0; i < _numControls; i++) {
+        if (_len + 12 > MULTICONTROL_STREAM_FRAME) {
+          _frame[_headerLen - 1] = i - first;
+          finishFrame(now);
+          first = i;
+          startFrame(MC_STREAM_SNAPSHOT, now);
+          put(_numControls);
+          put(first);
+          put(0);
+        }
+        Entry& e = _controls[i];
+        MultiControl* c = e.control;
+        e.value = valueOf(c);
+        e.latch = c->getLatchState();
+        e.bank = c->getBank();
+        c->takeGestureEvents(MC_CONSUMER_STREAM);  // events before the snapshot are history
+        put(c->getControl());
+        putVarint(zigzag(e.value));
+        put((uint8_t)e.latch);
+        putVarint(e.bank);
+      }
+      _frame[_headerLen - 1] = _numControls - first;
+      finishFrame(now);
+      _snapshotDue = false;
+      _lastSnapshot = now;
+    }
+
+    /* Begin a frame body: type, sequence number and time since the previous frame */
+    void startFrame(uint8_t type, unsigned long now) {
+      _len = 0;
+      put(type);
+      put(_seq);
+      putVarint((uint32_t)(now - _frameTime));
+      if (type == MC_STREAM_SNAPSHOT) _headerLen = _len + 3;  // total, first, count
+      else _headerLen = _len;
+    }
+
+    /* Send the current delta frame and start another if the next entry would not fit */
+    void reserve(uint8_t type, unsigned long now, uint8_t bytes) {
+      if (_len + bytes <= MULTICONTROL_STREAM_FRAME) return;
+      finishFrame(now);
+      startFrame(type, now);
+    }
+
+    /* Add sync, length and CRC, and write the frame in one call */
+    void finishFrame(unsigned long now) {
+      uint8_t head[4];
+      uint8_t headLen = 0;
+      head[headLen++] = MC_STREAM_SYNC;
+      uint16_t len = _len;
+      while (len >= 0x80) {
+        head[headLen++] = (len & 0x7F) | 0x80;
+        len >>= 7;
+      }
+      head[headLen++] = len;
+      uint16_t crc = crc16(0xFFFF, head + 1, headLen - 1);
+      crc = crc16(crc, _frame, _len);
+      _frame[_len] = crc & 0xFF;
+      _frame[_len + 1] = crc >> 8;
+      _out->write(head, headLen);
+      _out->write(_frame, _len + 2);
+      _bytes += headLen + _len + 2;
+      _frames++;
+      _seq++;
+      _lastFrame = now;
+      _frameTime = now;
+      _len = 0;
+    }
+
+    inline void put(uint8_t b) { _frame[_len++] = b; }
+
+    void putVarint(uint32_t v) {
+      while (v >= 0x80) {
+        put((v & 0x7F) | 0x80);
+        v >>= 7;
+      }
+      put(v);
+    }
+
+    static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+
+    /* CRC-16/CCITT (polynomial 0x1021), a nibble at a time with a 16-entry table */
+    static uint16_t crc16(uint16_t crc, const uint8_t* data, uint16_t len) {
+      static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+      };
+      for (uint16_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+      }
+      return crc;
+    }
+};
+
+#endif /* MULTICONTROL_STREAM_H_ */
@@ -0,0 +1,443 @@
+/*
+ * MultiControlTasks.h
+ *
+ * C++20 coroutines for control logic. Instead of a polling state machine around isHeld(),
+ * wasSingleClicked() and friends, a task waits for what it needs:
+ *
+ *   MultiControlTask recordMode() {
+ *     for (;;) {
+ *       co_await tasks.pressed(rec);
+ *       int which = co_await tasks.anyOf(tasks.doubleClicked(rec), tasks.held(shift), tasks.timeout(500));
+ *       ...
+ *     }
+ *   }
+ *   tasks.start(recordMode());   // in setup()
+ *   tasks.update();              // in loop(), after reading the controls
+ *
+ * Coroutine frames come from a fixed pool (no heap). A suspended task sits in the wait list
+ * of its control (or the timer list) and costs nothing per scan: update() looks only at
+ * controls that have a task waiting, takes their gesture events once, and walks their wait
+ * list only when an event arrived or the value changed.
+ *
+ * Needs C++20 (arduino-esp32 3.x compiles with gnu++2b; on a host use -std=c++20).
+ * Designed for use with the ESP32 microcontroller and the Arduino IDE.
+ *
+ * MultiControl is licensed under a Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+ */
+
+#ifndef MULTICONTROL_TASKS_H_
+#define MULTICONTROL_TASKS_H_
+
+#include "MultiControl.h"
+
+#if !defined(__cpp_impl_coroutine)
+#error "MultiControlTasks.h needs C++20 coroutines (compile with -std=c++20 or gnu++20)"
+#endif
+
+#include <coroutine>
+#include <stddef.h>
+
+#ifndef MULTICONTROL_TASKS_FRAMES
+#define MULTICONTROL_TASKS_FRAMES 8  // tasks alive at once (32 at most)
+#endif
+#ifndef MULTICONTROL_TASKS_FRAME_SIZE
+#define MULTICONTROL_TASKS_FRAME_SIZE 512  // bytes per coroutine frame (see getLargestFrame())
+#endif
+#ifndef MULTICONTROL_TASKS_MAX_CONTROLS
+#define MULTICONTROL_TASKS_MAX_CONTROLS 64  // controls tasks can wait on
+#endif
+
+static_assert(MULTICONTROL_TASKS_FRAMES <= 32, "MULTICONTROL_TASKS_FRAMES must be 32 or less");
+
+class MultiControlTasks;
+
+/** A coroutine that waits on controls. Any function returning MultiControlTask that uses
+ * co_await is one; pass the returned task to MultiControlTasks::start() to run it.
+ */
+class MultiControlTask {
+  public:
+    struct promise_type {
+      // Frames come from the fixed pool; a failed allocation gives an empty task
+      static void* operator new(size_t size) noexcept;
+      static void operator delete(void* frame) noexcept;
+      static MultiControlTask get_return_object_on_allocation_failure() noexcept { return MultiControlTask(); }
+      MultiControlTask get_return_object() noexcept {
+        return MultiControlTask(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      std::suspend_always initial_suspend() noexcept { return {}; }  // runs from start()
+      std::suspend_never final_suspend() noexcept { return {}; }     // a finished task frees its frame
+      void return_void() noexcept {}
+      void unhandled_exception() noexcept {}
+    };
+
+    MultiControlTask() {}
+    MultiControlTask(MultiControlTask&& other) noexcept : _handle(other._handle) { other._handle = nullptr; }
+    MultiControlTask& operator=(MultiControlTask&& other) noexcept {
+      if (this != &other) {
+        if (_handle) _handle.destroy();
+        _handle = other._handle;
+        other._handle = nullptr;
+      }
+      return *this;
+    }
+    MultiControlTask(const MultiControlTask&) = delete;
+    MultiControlTask& operator=(const MultiControlTask&) = delete;
+    /** A task that was never started is destroyed with its handle */
+    ~MultiControlTask() {
+      if (_handle) _handle.destroy();
+    }
+
+    /** Check if the task got a frame */
+    bool isValid() { return (bool)_handle; }
+
+  private:
+    friend class MultiControlTasks;
+    explicit MultiControlTask(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+    std::coroutine_handle<promise_type> _handle;
+};
+
+class MultiControlTasks {
+  public:
+    struct Group;
+
+    /** One thing to wait for: a gesture event or a value change on a control, or a timeout.
+     * Made by pressed(), changedBeyond(), timeout() and the other waits below; co_await it
+     * directly or combine several with anyOf(). While a task is suspended the Event lives in
+     * its frame and is linked into the wait list of its control.
+     */
+    struct Event {
+      MultiControlTasks* tasks;
+      uint8_t kind;
+      uint8_t mask = 0;           // MC_GESTURE_* bits (gesture waits)
+      uint8_t slot = 0;           // control slot (gesture and change waits)
+      int8_t index = -1;          // position in an anyOf()
+      int16_t amount = 0;         // change waits: distance from the value at the start (1-32767)
+      int from = 0;               // change waits: the value at the start (any int, e.g. an encoder)
+      int result = 0;
+      unsigned long due = 0;      // timeouts
+      Event* next = nullptr;
+      Event* prev = nullptr;
+      Event** list = nullptr;     // wait list while armed
+      std::coroutine_handle<> handle;
+      Group* group = nullptr;
+
+      Event(MultiControlTasks* owner, uint8_t waitKind) : tasks(owner), kind(waitKind) {}
+
+      bool await_ready() noexcept { return kind == _WAIT_TIME && due == 0; }
+      void await_suspend(std::coroutine_handle<> h) noexcept {
+        handle = h;
+        tasks->arm(this);
+      }
+      /** @return The gesture bits that matched, the new value, or 0 for a timeout */
+      int await_resume() noexcept { return result; }
+    };
+
+    /** The waits of an anyOf(): the first to fire disarms the others */
+    struct Group {
+      Event** events;
+      uint8_t count;
+      int8_t fired = -1;
+    };
+
+    /** The waits of an anyOf(). They stay where they are: the Events passed to anyOf() are
+     * temporaries of the co_await expression and live until the task resumes.
+     */
+    template <size_t N>
+    struct AnyOf {
+      Event* events[N];
+      Group group;
+
+      template <class... Events>
+      AnyOf(Events*... waits) : events{waits...} {}
+
+      bool await_ready() noexcept {
+        for (size_t i = 0; i < N; i++) {
+          if (events[i]->await_ready()) {
+            group.fired = i;
+            return true;
+          }
+        }
+        return false;
+      }
+      void await_suspend(std::coroutine_handle<> h) noexcept {
+        group.events = events;
+        group.count = N;
+        for (size_t i = 0; i < N; i++) {
+          events[i]->index = i;
+          events[i]->group = &group;
+          events[i]->handle = h;
+          events[i]->tasks->arm(events[i]);
+        }
+      }
+      /** @return The position (from 0) of the wait that fired first */
+      int await_resume() noexcept { return group.fired; }
+    };
+
+    /** Constructor. */
+    MultiControlTasks() {};
+
+    /** Run a task until its first co_await
+     * @return true if it runs, false if the frame pool was full or the frame too big
+     */
+    bool start(MultiControlTask&& task) {
+      if (!task._handle) return false;
+      if (!_updated) _now = MC_MILLIS();
+      std::coroutine_handle<> h = task._handle;
+      task._handle = nullptr;
+      h.resume();
+      return true;
+    }
+
+    /** Resume the tasks whose events arrived. Call once per loop, after reading the controls.
+     * Controls are not read here. Gesture events are taken with takeGestureEvents(MC_CONSUMER_TASKS),
+     * so the sketch and MultiControlStream still see them too.
+     */
+    void update() { update(MC_MILLIS()); }
+
+    /** Resume the tasks whose events arrived, using an explicit timestamp (ms) */
+    void update(unsigned long now) {
+      _now = now;
+      _updated = true;
+      _ready = nullptr;
+      _readyTail = nullptr;
+      for (uint8_t i = 0; i < _numSlots; i++) {
+        Slot& s = _slots[i];
+        if (s.waits == nullptr) continue;
+        if (s.gestureWaits > 0) {
+          uint8_t events = takeEvents(s);
+          if (events) {
+            // A wait disarmed when an anyOf() sibling fires keeps its next pointer, so it is skipped
+            for (Event* e = s.waits; e != nullptr;) {
+              Event* next = e->next;
+              if (e->list != nullptr && e->kind == _WAIT_GESTURE && (events & e->mask)) fire(e, events & e->mask);
+              e = next;
+            }
+          }
+        }
+        if (s.changeWaits > 0) {
+          int value = s.control->getValue();
+          if (value != s.value) {
+            s.value = value;
+            for (Event* e = s.waits; e != nullptr;) {
+              Event* next = e->next;
+              if (e->list != nullptr && e->kind == _WAIT_CHANGE && abs(value - e->from) >= e->amount) fire(e, value);
+              e = next;
+            }
+          }
+        }
+      }
+      while (_timers != nullptr && (long)(now - _timers->due) >= 0) fire(_timers, 0);
+      // Resume after all lists are walked, so resumed tasks can wait again right away
+      while (_ready != nullptr) {
+        Event* e = _ready;
+        _ready = e->next;
+        e->handle.resume();
+      }
+    }
+
+    /** Wait for MC_GESTURE_* events on a button, mux button, encoder button or scanned key.
+     * Touch pads report MC_GESTURE_PRESS and MC_GESTURE_RELEASE.
+     * Events from before the wait are not seen.
+     * @return (from co_await) the bits that arrived
+     */
+    Event gesture(MultiControl& control, uint8_t mask) {
+      Event e{this, _WAIT_GESTURE};
+      e.mask = mask;
+      e.slot = slotFor(&control);
+      return e;
+    }
+
+    Event pressed(MultiControl& control) { return gesture(control, MC_GESTURE_PRESS); }
+    Event released(MultiControl& control) { return gesture(control, MC_GESTURE_RELEASE); }
+    Event clicked(MultiControl& control) { return gesture(control, MC_GESTURE_SINGLE); }
+    Event doubleClicked(MultiControl& control) { return gesture(control, MC_GESTURE_DOUBLE); }
+    Event held(MultiControl& control) { return gesture(control, MC_GESTURE_HOLD); }
+    Event longPressed(MultiControl& control) { return gesture(control, MC_GESTURE_LONG); }
+
+    /** Wait until the control's value (getValue()) is at least amount away from where it was
+     * when the wait started, e.g. a pot turned by 10 or an encoder moved by 1.
+     * The value may be anywhere in the int range; amount is limited to 1-32767.
+     * @return (from co_await) the new value
+     */
+    Event changedBeyond(MultiControl& control, int amount) {
+      Event e{this, _WAIT_CHANGE};
+      e.slot = slotFor(&control);
+      e.amount = constrain(amount, 1, 32767);
+      return e;
+    }
+
+    /** Wait for a number of milliseconds, counted from the current update()
+     * @return (from co_await) 0
+     */
+    Event timeout(unsigned long ms) {
+      Event e{this, _WAIT_TIME};
+      e.due = ms;  // made absolute when armed
+      return e;
+    }
+
+    /** Wait for the first of several events. co_await the result directly, as in
+     * co_await tasks.anyOf(tasks.pressed(a), tasks.timeout(500))
+     * @return (from co_await) the position of the event that fired, from 0
+     */
+    template <class... Events>
+    AnyOf<sizeof...(Events)> anyOf(Events&&... events) {
+      return AnyOf<sizeof...(Events)>(&events...);
+    }
+
+    /** Stop every task that is waiting (e.g. on a mode change) and free its frame */
+    void stopAll() {
+      std::coroutine_handle<> handles[MULTICONTROL_TASKS_FRAMES];
+      int count = 0;
+      for (uint8_t i = 0; i <= _numSlots; i++) {
+        Event** list = i < _numSlots ? &_slots[i].waits : &_timers;
+        while (*list != nullptr) {
+          Event* e = *list;
+          unlink(e);
+          bool seen = false;  // the waits of an anyOf() share a task
+          for (int k = 0; k < count; k++) seen |= handles[k] == e->handle;
+          if (!seen && count < MULTICONTROL_TASKS_FRAMES) handles[count++] = e->handle;
+        }
+      }
+      for (int k = 0; k < count; k++) handles[k].destroy();
+    }
+
+    /** Number of waits armed (each event of an anyOf() counts) */
+    int getWaitingCount() { return _waiting; }
+
+    /** Number of frames in use, i.e. tasks alive */
+    static int getFramesInUse() { return __builtin_popcount(_framesUsed); }
+
+    /** Largest frame asked for so far, to size MULTICONTROL_TASKS_FRAME_SIZE */
+    static size_t getLargestFrame() { return _largestFrame; }
+
+    static void* allocFrame(size_t size) {
+      if (size > _largestFrame) _largestFrame = size;
+      const uint32_t all = MULTICONTROL_TASKS_FRAMES == 32 ? 0xFFFFFFFFUL : (1UL << (MULTICONTROL_TASKS_FRAMES & 31)) - 1;
+      uint32_t free = ~_framesUsed & all;
+      if (size > MULTICONTROL_TASKS_FRAME_SIZE || free == 0) return nullptr;
+      int i = __builtin_ctz(free);
+      _framesUsed |= 1UL << i;
+      return _frames[i];
+    }
+
+    static void freeFrame(void* frame) {
+      int i = ((uint8_t*)frame - &_frames[0][0]) / MULTICONTROL_TASKS_FRAME_SIZE;
+      _framesUsed &= ~(1UL << i);
+    }
+
+  private:
+    const static uint8_t _WAIT_GESTURE = 0;
+    const static uint8_t _WAIT_CHANGE = 1;
+    const static uint8_t _WAIT_TIME = 2;
+
+    struct Slot {
+      MultiControl* control;
+      Event* waits;
+      uint8_t gestureWaits;
+      uint8_t changeWaits;
+      bool touched;  // touch pads: state at the last update()
+      int value;     // value at the last update() (change waits)
+    };
+
+    Slot _slots[MULTICONTROL_TASKS_MAX_CONTROLS];
+    uint8_t _numSlots = 0;
+    Event* _timers = nullptr;  // sorted by due time
+    Event* _ready = nullptr;   // fired this update, to resume in order
+    Event* _readyTail = nullptr;
+    int _waiting = 0;
+    unsigned long _now = 0;
+    bool _updated = false;
+
+    alignas(16) static inline uint8_t _frames[MULTICONTROL_TASKS_FRAMES][MULTICONTROL_TASKS_FRAME_SIZE];
+    static inline uint32_t _framesUsed = 0;
+    static inline size_t _largestFrame = 0;
+
+    /* Slot of a control, added on its first wait (slot 255 if there is no room) */
+    uint8_t slotFor(MultiControl* control) {
+      for (uint8_t i = 0; i < _numSlots; i++) {
+        if (_slots[i].control == control) return i;
+      }
+      if (_numSlots >= MULTICONTROL_TASKS_MAX_CONTROLS) return 255;
+      control->takeGestureEvents(MC_CONSUMER_TASKS);  // events before the first wait are history
+      _slots[_numSlots] = {control, nullptr, 0, 0, false, 0};
+      return _numSlots++;
+    }
+
+    /* Gesture events since the last call; touch pads get press and release from their state */
+    uint8_t takeEvents(Slot& s) {
+      if (s.control->getControl() != 0) return s.control->takeGestureEvents(MC_CONSUMER_TASKS);
+      bool touched = s.control->getTouchState();
+      if (touched == s.touched) return 0;
+      s.touched = touched;
+      return touched ? MC_GESTURE_PRESS : MC_GESTURE_RELEASE;
+    }
+
+    void link(Event* e, Event** list, Event* after) {
+      e->list = list;
+      e->prev = after;
+      e->next = after ? after->next : *list;
+      if (e->next) e->next->prev = e;
+      if (after) after->next = e;
+      else *list = e;
+    }
+
+    void unlink(Event* e) {
+      if (e->list == nullptr) return;
+      if (e->prev) e->prev->next = e->next;
+      else *e->list = e->next;
+      if (e->next) e->next->prev = e->prev;
+      if (e->kind != _WAIT_TIME) {
+        Slot& s = _slots[e->slot];
+        if (e->kind == _WAIT_GESTURE) s.gestureWaits--;
+        else s.changeWaits--;
+      }
+      e->list = nullptr;
+      _waiting--;
+    }
+
+    /* Put a suspended wait on its list */
+    void arm(Event* e) {
+      if (e->kind == _WAIT_TIME) {
+        _waiting++;
+        e->due += _now;
+        Event* after = nullptr;
+        for (Event* t = _timers; t != nullptr && (long)(t->due - e->due) <= 0; t = t->next) after = t;
+        link(e, &_timers, after);
+        return;
+      }
+      if (e->slot == 255) return;  // no room for the control: the wait never fires
+      _waiting++;
+      Slot& s = _slots[e->slot];
+      if (e->kind == _WAIT_GESTURE) {
+        if (s.gestureWaits++ == 0) takeEvents(s);  // events from before the wait are history
+      } else {
+        if (s.changeWaits++ == 0) s.value = s.control->getValue();
+        e->from = s.value;
+      }
+      link(e, &s.waits, nullptr);
+    }
+
+    /* A wait is satisfied: disarm it (and the rest of its anyOf()) and queue its task */
+    void fire(Event* e, int result) {
+      unlink(e);
+      e->result = result;
+      if (e->group != nullptr) {
+        e->group->fired = e->index;
+        for (uint8_t i = 0; i < e->group->count; i++) unlink(e->group->events[i]);
+      }
+      e->next = nullptr;
+      if (_readyTail) _readyTail->next = e;
+      else _ready = e;
+      _readyTail = e;
+    }
+};
+
+inline void* MultiControlTask::promise_type::operator new(size_t size) noexcept {
+  return MultiControlTasks::allocFrame(size);
+}
+
+inline void MultiControlTask::promise_type::operator delete(void* frame) noexcept {
+  MultiControlTasks::freeFrame(frame);
+}
+
+#endif
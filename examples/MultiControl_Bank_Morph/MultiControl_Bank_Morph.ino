@@ -0,0 +1,70 @@
+// MultiControl Bank Morph Example
+// Crossfade 4 pots between two presets (banks 0 and 1) with a fifth pot.
+// The morph is written into bank 2, where the pots play: after a morph each pot
+// latches to the morphed value and takes over from the morph once it picks it up.
+
+#include "MultiControl.h"
+#include "MultiControlMorph.h"
+
+const int NUM_POTS = 4;
+const int POT_PINS[NUM_POTS] = {4, 5, 6, 7};
+const int MORPH_PIN = 8;
+const uint8_t LIVE_BANK = 2;
+
+MultiControl pots[NUM_POTS];
+MultiControl morphPot(MORPH_PIN, 1);
+MultiControlMorph morph;
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("=== Bank Morph Demo ===");
+  for (int i = 0; i < NUM_POTS; i++) {
+    pots[i].setPin(POT_PINS[i]);
+    pots[i].setControl(1);
+    pots[i].initBanks(3);
+    pots[i].setBankValue(0, 100 + i * 50);   // preset A
+    pots[i].setBankValue(1, 900 - i * 150);  // preset B
+    pots[i].setBank(LIVE_BANK);
+  }
+  morphPot.setLatchEnabled(false);
+  morph.addControls(pots, NUM_POTS);
+  morph.setBanks(0, 1);
+  morph.setOutputBank(LIVE_BANK);
+}
+
+void loop() {
+  for (int i = 0; i < NUM_POTS; i++) pots[i].readPot();
+  morphPot.readPot();
+  morph.setPosition(morphPot.getValue());
+  // Recomputes only when the morph pot or a preset value changed
+  if (morph.update()) {
+    const int16_t* values = morph.getValues();
+    for (int i = 0; i < NUM_POTS; i++) {
+      Serial.print(values[i]);
+      Serial.print(morph.isOverridden(i) ? "* " : " ");
+    }
+    Serial.println();
+  }
+  delay(5);
+}
+
+// =============================================================================
+// QUICK REFERENCE
+// =============================================================================
+//
+// SETUP:
+//   morph.addControls(pots, n);          // or addControl(&pot), up to 64
+//   morph.setBanks(a, b);                // crossfade
+//   morph.setBanks(a, b, c, d);          // X/Y: a (0,0), b (x,0), c (0,y), d (x,y)
+//   morph.setOutputBank(bank);           // optional live bank, pots latch to the morph
+//
+// EACH LOOP (after reading the controls):
+//   morph.setPosition(x);                // 0-1023, or setPosition(x, y, range)
+//   morph.update();                      // true if any output changed
+//   morph.getValues();                   // contiguous int16_t output, addControl() order
+//
+// PRESETS AND TAKEOVER:
+//   morph.refresh();                     // take edited preset values now
+//   morph.isOverridden(i);               // the pot was moved after a morph
+//   morph.clearOverrides();              // back under the morph
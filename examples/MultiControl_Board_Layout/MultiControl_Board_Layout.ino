@@ -0,0 +1,60 @@
+// MultiControl Board Layout Example
+// Describes a whole panel as one constexpr layout: 2 pots, 8 buttons on a 4051 mux,
+// 2 buttons and an encoder with a push button, with 4 banks.
+//
+// The compiler plans the scan from the layout: the buttons and encoder are read from one
+// snapshot of the GPIO registers, the mux buttons one select step per channel with one
+// select line changing per step, and the pots grouped by ADC. A mistake such as a pin used
+// twice or a pot on a pin without an ADC channel stops the build with a message.
+// Needs C++17 (Arduino-ESP32 3.x).
+
+#include "MultiControl.h"
+#include "MultiControlBoard.h"
+
+// Controls are numbered in the order given: pots 0-1, mux buttons 2-9, buttons 10-11, encoder 12
+constexpr auto layout = multiControlLayout(
+  mcBanks(4),
+  mcMuxSelect(25, 26, 27),  // S0, S1, S2 (adjust for your board)
+  mcPot(36), mcPot(39),
+  mcMuxButton(34, 0), mcMuxButton(34, 1), mcMuxButton(34, 2), mcMuxButton(34, 3),
+  mcMuxButton(34, 4), mcMuxButton(34, 5), mcMuxButton(34, 6), mcMuxButton(34, 7),
+  mcButton(18), mcButton(19),
+  mcEncoder(21, 22, 23));
+
+MultiControlBoard<layout> board;
+const int ENCODER = 12;
+
+uint8_t bank = 0;
+
+void nextBank() {
+  bank = (bank + 1) % board.BANKS;
+  for (int i = 0; i < board.getControlCount(); i++) board[i].setBank(bank);
+  Serial.print("Bank ");
+  Serial.println(bank);
+}
+
+void setup() {
+  Serial.begin(115200);
+  board.begin();
+  board[ENCODER].setEncoderRange(0, 127);
+}
+
+void loop() {
+  board.update();  // one scan of every control, don't call their read functions
+
+  for (int i = 0; i < board.getControlCount(); i++) {
+    if (board.changed(i)) {
+      Serial.print("Control ");
+      Serial.print(i);
+      Serial.print(": ");
+      Serial.println(i == ENCODER ? board[i].getEncoderPosition() : board[i].getValue());
+    }
+    if (i >= 2 && i <= 11 && board[i].wasSingleClicked()) {
+      Serial.print("Control ");
+      Serial.print(i);
+      Serial.println(" clicked");
+      if (i == 11) nextBank();  // the last button steps through the banks
+    }
+  }
+  delay(1);
+}
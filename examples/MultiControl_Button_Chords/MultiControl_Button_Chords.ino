@@ -0,0 +1,68 @@
+// MultiControl Button Chords Example
+// Demonstrates shift combinations and two-button chords
+
+#include "MultiControl.h"
+#include "MultiControlChord.h"
+
+const int NUM_BUTTONS = 4;
+const int BUTTON_PINS[NUM_BUTTONS] = {13, 14, 15, 16};
+
+MultiControl buttons[NUM_BUTTONS];
+MultiControlChords chords;
+
+int shiftPlay, shiftStop, playStop;
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("=== Button Chords Demo ===");
+  Serial.println("Button 0 = SHIFT, 1 = PLAY, 2 = STOP, 3 = REC");
+
+  for (int i = 0; i < NUM_BUTTONS; i++) {
+    buttons[i].setPin(BUTTON_PINS[i]);
+    buttons[i].setControl(2);
+    chords.addButton(&buttons[i]);
+  }
+  // SHIFT must go down first and can be held as long as needed
+  shiftPlay = chords.addShift(0, 1);
+  shiftStop = chords.addShift(0, 2);
+  // PLAY + STOP pressed together (within 60ms, either order)
+  playStop = chords.addChord(1, 2, 60);
+}
+
+void loop() {
+  // Reads all buttons; do not call readButton() on them separately
+  chords.update();
+
+  if (chords.wasTriggered(shiftPlay)) Serial.println("[SHIFT+PLAY] Loop on/off");
+  if (chords.wasTriggered(shiftStop)) Serial.println("[SHIFT+STOP] Return to start");
+  if (chords.wasTriggered(playStop)) Serial.println("[PLAY+STOP] Panic");
+
+  // Single clicks are suppressed for buttons used in a chord
+  const char* names[NUM_BUTTONS] = {"SHIFT", "PLAY", "STOP", "REC"};
+  for (int i = 0; i < NUM_BUTTONS; i++) {
+    if (buttons[i].wasSingleClicked()) {
+      Serial.print("[CLICK] ");
+      Serial.println(names[i]);
+    }
+  }
+  delay(2);
+}
+
+// =============================================================================
+// QUICK REFERENCE
+// =============================================================================
+//
+// SETUP:
+//   int b = chords.addButton(&button);           // returns button index
+//   int c = chords.addShift(shift, button);       // ordered, no time limit
+//   int c = chords.addChord(a, b, windowMs);      // both within windowMs
+//   uint8_t m[3] = {a, b, c};
+//   int c = chords.addChord(m, 3, windowMs, ordered);
+//
+// READING:
+//   chords.update();                 // call once per loop
+//   chords.wasTriggered(c);          // fired since last check
+//   chords.readTriggered();          // next fired chord index, or -1
+//   chords.isActive(c);              // fired and all members still held
+//   chords.isChorded(b);             // button is part of an active chord
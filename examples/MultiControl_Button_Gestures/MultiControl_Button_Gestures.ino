@@ -6,12 +6,11 @@
 const int BUTTON_PIN = 13;
 MultiControl button(BUTTON_PIN, _BUTTON);
 
-// Optimistic single-click tracking
-static bool actionDone = false;
 static int counter = 0;
 
 void setup() {
   Serial.begin(115200);
+  button.setSpeculativeClick(true);  // report clicks at once, cancel if they become double-clicks
   delay(1000);
   Serial.println("=== Button Gestures Demo ===");
   Serial.println("Single-click: OPTIMISTIC (instant) + CONSERVATIVE (350ms delay)");
@@ -24,22 +23,22 @@ void loop() {
   button.readButton();
 
   // --- OPTIMISTIC SINGLE-CLICK: instant response, undo on double-click ---
-  if (button.isPressed() && !actionDone && !button.isLongPressed()) {
+  if (button.wasProvisionalClick()) {
     counter++;
     Serial.print("[OPTIMISTIC] Instant! Counter=");
     Serial.println(counter);
-    actionDone = true;
   }
 
-  if (button.isDoubleClicked()) {
+  if (button.wasClickCancelled()) {
     counter--;  // undo optimistic action
-    Serial.print("[DOUBLE-CLICK] Undo, then +10. Counter=");
-    counter += 10;
+    Serial.print("[CANCELLED] Undo. Counter=");
     Serial.println(counter);
   }
 
-  if (!button.isPressed() && !button.isClickPending()) {
-    actionDone = false;
+  if (button.isDoubleClicked()) {
+    counter += 10;
+    Serial.print("[DOUBLE-CLICK] +10. Counter=");
+    Serial.println(counter);
   }
 
   // --- CONSERVATIVE SINGLE-CLICK: waits for double-click window to expire ---
@@ -75,10 +74,10 @@ void loop() {
 // USAGE PATTERNS
 // =============================================================================
 //
-// OPTIMISTIC SINGLE-CLICK (instant + double-click support):
-//   if (button.isPressed() && !done) { doAction(); done = true; }
-//   if (button.isDoubleClicked()) { undoAction(); doDoubleAction(); }
-//   if (!button.isPressed() && !button.isClickPending()) { done = false; }
+// OPTIMISTIC SINGLE-CLICK (instant + double-click support, after setSpeculativeClick(true)):
+//   if (button.wasProvisionalClick()) { doAction(); }
+//   if (button.wasClickCancelled()) { undoAction(); }
+//   if (button.isDoubleClicked()) { doDoubleAction(); }
 //
 // CONSERVATIVE SINGLE-CLICK (delayed but certain):
 //   if (button.wasSingleClicked()) { doAction(); }
@@ -90,3 +89,8 @@ void loop() {
 //
 // LONG-PRESS CONTINUOUS ACTION:
 //   if (button.isLongPressed()) { value++; delay(100); }
+//
+// ZERO-LATENCY PRESSES (eager debounce, per control):
+//   button.setDebounceMode(MC_DEBOUNCE_EAGER);  // press reported on the first edge
+//   button.setMinPressTime(30);                 // presses shorter than this are glitches
+//   if (button.wasGlitch()) { undoAction(); }
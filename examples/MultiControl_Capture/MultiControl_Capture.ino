@@ -0,0 +1,76 @@
+// MultiControl Capture Example
+// Records every raw sensor read for 30 seconds to a LittleFS file, so a problem seen
+// on the hardware can be replayed bit-exactly on a computer with extras/replay/mcreplay.
+//
+// Play with the controls while the capture runs, then download /capture.bin from the
+// board's filesystem and replay it with a panel.h that sets up the same controls.
+// A capture takes about 1-2 bytes per raw read or clock read: ~45 bytes per scan for four pots,
+// a touch pad and a button, so keep captures short or scan less often.
+
+#define MULTICONTROL_CAPTURE
+#include "MultiControl.h"
+#include <LittleFS.h>
+
+const int NUM_POTS = 4;
+const int POT_PINS[NUM_POTS] = {1, 2, 3, 4};
+const int TOUCH_PIN = 8;
+const int BUTTON_PIN = 13;
+const unsigned long CAPTURE_MS = 30000;
+
+MultiControl pots[NUM_POTS];
+MultiControl touchPad;
+MultiControl button;
+
+File captureFile;
+MultiControlCapture capture;
+
+void setup() {
+  Serial.begin(115200);
+  LittleFS.begin(true);
+  captureFile = LittleFS.open("/capture.bin", "w");
+
+  // Begin capturing before setting up the controls, so their initial reads are recorded too
+  multiControlCaptureSink = &capture;
+  capture.begin(captureFile);
+
+  for (int i = 0; i < NUM_POTS; i++) {
+    pots[i].setPin(POT_PINS[i]);
+    pots[i].setControl(1);
+  }
+  touchPad.setPin(TOUCH_PIN);
+  touchPad.setControl(0);
+  button.setPin(BUTTON_PIN);
+  button.setControl(2);
+  Serial.println("Capturing...");
+}
+
+void loop() {
+  static unsigned long scanTime = 0;
+  unsigned long now = millis();
+  if (now - scanTime < 2) return;
+  scanTime = now;
+
+  if (multiControlCaptureSink != nullptr) {
+    if (now < CAPTURE_MS) {
+      capture.frame();  // one frame per scan
+    } else {
+      capture.end();
+      multiControlCaptureSink = nullptr;
+      captureFile.close();
+      Serial.print("Captured ");
+      Serial.print(capture.getFrameCount());
+      Serial.print(" scans, ");
+      Serial.print(capture.getByteCount());
+      Serial.println(" bytes to /capture.bin");
+    }
+  }
+
+  // Read the controls exactly as the real sketch would (same order as panel.h)
+  for (int i = 0; i < NUM_POTS; i++) pots[i].readPot();
+  touchPad.readTouch();
+  touchPad.isTouched();
+  button.isPressed();
+  if (button.wasSingleClicked()) Serial.println("click");
+  if (button.isDoubleClicked()) Serial.println("double click");
+  if (button.isHeld()) Serial.println("hold");
+}
@@ -0,0 +1,45 @@
+// MultiControl Encoder Bank Example
+// Decodes eight rotary encoders from a single snapshot of the GPIO input registers.
+//
+// Every encoder is sampled at the same instant, and the whole bank costs about the same
+// per scan as one or two readEncoder() calls. Only the encoders that moved do any
+// further work. Each encoder keeps its own range, acceleration and wrap settings.
+
+#include "MultiControl.h"
+#include "MultiControlEncoders.h"
+
+const int NUM_ENCODERS = 8;
+// A and B pins for each encoder (adjust for your board)
+const uint8_t PINS_A[NUM_ENCODERS] = {4, 6, 8, 10, 12, 14, 16, 18};
+const uint8_t PINS_B[NUM_ENCODERS] = {5, 7, 9, 11, 13, 15, 17, 21};
+
+MultiControl encoders[NUM_ENCODERS];
+MultiControlEncoders bank;
+int lastPosition[NUM_ENCODERS];
+
+void setup() {
+  Serial.begin(115200);
+  for (int i = 0; i < NUM_ENCODERS; i++) {
+    encoders[i].setEncoderPins(PINS_A[i], PINS_B[i]);
+    encoders[i].setEncoderRange(0, 127);
+    encoders[i].setEncoderAccel(4.0);
+    bank.addEncoder(&encoders[i]);  // decoded by the bank: don't call readEncoder() as well
+    lastPosition[i] = encoders[i].getEncoderPosition();
+  }
+}
+
+void loop() {
+  bank.update();  // one snapshot, all encoders
+
+  for (int i = 0; i < NUM_ENCODERS; i++) {
+    int pos = encoders[i].getEncoderPosition();
+    if (pos != lastPosition[i]) {
+      lastPosition[i] = pos;
+      Serial.print("Encoder ");
+      Serial.print(i);
+      Serial.print(": ");
+      Serial.println(pos);
+    }
+  }
+  delay(1);
+}
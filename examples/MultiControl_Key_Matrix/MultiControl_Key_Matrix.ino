@@ -0,0 +1,48 @@
+// MultiControl Key Matrix Example
+// Reads 32 buttons wired as a 4x8 row/column matrix, using 12 pins.
+//
+// Each key is a MultiControl button, so click, double-click and hold work as usual.
+// With a diode in series with every key, any combination can be pressed; call
+// matrix.setDiodes(true). Without diodes, keys that could be phantoms (three
+// corners of a rectangle pressed) keep their previous state until the chord changes.
+
+#include "MultiControl.h"
+#include "MultiControlMatrix.h"
+
+const int ROWS = 4;
+const int COLS = 8;
+// Row and column pins (adjust for your board)
+const uint8_t ROW_PINS[ROWS] = {4, 5, 6, 7};
+const uint8_t COL_PINS[COLS] = {8, 9, 10, 11, 12, 13, 14, 15};
+
+MultiControl keys[ROWS * COLS];
+MultiControlMatrix matrix;
+
+void setup() {
+  Serial.begin(115200);
+  matrix.setRows(ROW_PINS, ROWS);
+  matrix.setColumns(COL_PINS, COLS);
+  for (int r = 0; r < ROWS; r++) {
+    for (int c = 0; c < COLS; c++) {
+      matrix.addKey(&keys[r * COLS + c], r, c);  // scanned by the matrix: don't call readButton()
+    }
+  }
+}
+
+void loop() {
+  matrix.update();  // one pass over the rows, all keys
+
+  for (int i = 0; i < ROWS * COLS; i++) {
+    if (keys[i].wasSingleClicked()) {
+      Serial.print("Key ");
+      Serial.print(i);
+      Serial.println(" clicked");
+    }
+    if (keys[i].isHeld()) {
+      Serial.print("Key ");
+      Serial.print(i);
+      Serial.println(" held");
+    }
+  }
+  delay(1);
+}
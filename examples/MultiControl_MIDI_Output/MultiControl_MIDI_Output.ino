@@ -0,0 +1,71 @@
+// MultiControl MIDI Output Example
+// Sends pots as 14-bit CC and a button as a 7-bit CC over DIN MIDI,
+// coalescing rapid pot movement so the MIDI line is never flooded.
+
+#include "MultiControl.h"
+#include "MultiControlMidi.h"
+
+const int NUM_POTS = 4;
+const int POT_PINS[NUM_POTS] = {4, 5, 6, 7};
+const int BUTTON_PIN = 13;
+
+MultiControl pots[NUM_POTS];
+MultiControl button(BUTTON_PIN, 2);
+
+MultiControlMidiSerial din(Serial2);
+MultiControlMidi midi;
+
+void setup() {
+  Serial.begin(115200);
+  Serial2.begin(31250);  // DIN MIDI out on the default Serial2 TX pin
+
+  // DIN MIDI carries about 1000 messages per second, so cap the port there
+  midi.setTransport(0, &din, 1000);
+
+  for (int i = 0; i < NUM_POTS; i++) {
+    pots[i].setPin(POT_PINS[i]);
+    pots[i].setControl(1);
+    // Pot i on channel 1, CC 16+i (MSB) and CC 48+i (LSB)
+    int map = midi.addCC14(&pots[i], 0, 16 + i);
+    midi.setMinInterval(map, 10);  // at most 100 updates per second per pot
+  }
+  // Button sends 127 when pressed, 0 when released
+  midi.addCC(&button, 0, 64, 0, 1);
+}
+
+void loop() {
+  // Reads every mapped control and sends only changed values that are due
+  midi.update();
+
+  static unsigned long reportTime = 0;
+  if (millis() > reportTime) {
+    reportTime = millis() + 5000;
+    Serial.print("Messages sent: ");
+    Serial.print(midi.getMessageCount());
+    Serial.print("  coalesced: ");
+    Serial.print(midi.getCoalescedCount());
+    Serial.print("  max latency ms: ");
+    Serial.println(midi.getMaxLatency());
+  }
+  delay(1);
+}
+
+// =============================================================================
+// QUICK REFERENCE
+// =============================================================================
+//
+// MAPPING:
+//   midi.addCC(&control, channel, cc);              // 7-bit CC
+//   midi.addCC14(&control, channel, cc);            // 14-bit CC pair (cc and cc + 32)
+//   midi.addNRPN(&control, channel, param);         // 14-bit NRPN
+//   midi.addCC(&encoder, channel, cc, 0, 100);      // custom input range
+//   midi.addCC(nullptr, channel, cc);               // feed values yourself with midi.set(map, value)
+//
+// RATE LIMITS:
+//   midi.setMinInterval(map, ms);                   // per control, latest value wins
+//   midi.setTransport(port, &transport, msgsPerSec); // per port
+//
+// TRANSPORTS:
+//   MultiControlMidiSerial   - DIN/TRS serial with running status
+//   MultiControlMidiBuffer   - stores packets in memory (testing, measurement)
+//   Subclass MultiControlMidiTransport for USB (e.g. TinyUSB tud_midi_packet_write)
@@ -0,0 +1,81 @@
+// MultiControl Motion Recorder Example
+// Record the moves of 4 pots, then loop them back as automation.
+// Click REC to start and stop recording, double-click to play the loop.
+// Turning a pot during playback takes it over once it reaches the played value.
+
+#include "MultiControl.h"
+#include "MultiControlMotion.h"
+
+const int NUM_POTS = 4;
+const int POT_PINS[NUM_POTS] = {4, 5, 6, 7};
+const int REC_PIN = 13;
+
+MultiControl pots[NUM_POTS];
+MultiControl rec(REC_PIN, 2);  // button
+MultiControlMotion motion;
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("=== Motion Recorder Demo ===");
+  for (int i = 0; i < NUM_POTS; i++) {
+    pots[i].setPin(POT_PINS[i]);
+    pots[i].setControl(1);
+    pots[i].releaseLatch();  // follow the pots from the start
+  }
+  motion.addControls(pots, NUM_POTS);
+  motion.setOverflowPolicy(MC_MOTION_STOP);
+}
+
+void loop() {
+  for (int i = 0; i < NUM_POTS; i++) pots[i].readPot();
+  rec.readButton();
+
+  if (rec.wasSingleClicked()) {
+    if (motion.isRecording()) {
+      motion.stop();
+      Serial.print("[REC] Stopped: ");
+      Serial.print(motion.getLength());
+      Serial.print(" ms in ");
+      Serial.print(motion.getBytesUsed());
+      Serial.println(" bytes");
+    } else {
+      motion.record();
+      Serial.println("[REC] Recording");
+    }
+  }
+  if (rec.wasDoubleClicked()) {
+    motion.play(true);
+    Serial.println("[REC] Playing");
+  }
+  if (motion.hasOverflowed() && !motion.isRecording() && !motion.isPlaying()) {
+    Serial.println("[REC] Ring full - recording stopped");
+    motion.play(true);
+  }
+
+  // Records the changes, or plays them into the pots' banks
+  motion.update();
+  delay(2);
+}
+
+// =============================================================================
+// QUICK REFERENCE
+// =============================================================================
+//
+// SETUP:
+//   motion.addControls(controls, n);          // pots, encoders, touch pads (16 by default)
+//   motion.setMinInterval(10);                // ms between recorded changes (default 10)
+//   motion.setOverflowPolicy(MC_MOTION_STOP); // or MC_MOTION_OVERWRITE (keep the end)
+//
+// TRANSPORT:
+//   motion.record();  motion.stop();  motion.play(loop);
+//   motion.setSpeed(0.5);                     // half speed playback
+//   motion.update();                          // once per loop, after reading
+//
+// TAKEOVER:
+//   motion.isOverridden(i);                   // the performer moved control i
+//   motion.clearOverrides();                  // back under playback
+//
+// SIZING (define before the include):
+//   MULTICONTROL_MOTION_BYTES        ring size (default 16384)
+//   MULTICONTROL_MOTION_MAX_CONTROLS controls per recorder (default 16)
@@ -0,0 +1,76 @@
+// MultiControl Response Curves Example
+// Shape pot and touch values with precomputed curves instead of pow() on every read:
+// a volume taper, a filter cutoff in Hz, and touch pressure evened out between pads.
+
+#include "MultiControl.h"
+
+const int VOLUME_PIN = 4;
+const int CUTOFF_PIN = 5;
+const int PAD_PINS[2] = {1, 2};
+
+MultiControl volume(VOLUME_PIN, 1);  // pot
+MultiControl cutoff(CUTOFF_PIN, 1);  // pot
+MultiControl pads[2];
+
+// Curves are built once and can be shared by any number of controls
+MultiControlCurve volumeTaper(MC_CURVE_POWER, 2.5f);              // 0-1023, slow start
+MultiControlCurve cutoffHz(MC_CURVE_RATIO, 0.0f, 20, 20000);      // 20 Hz - 20 kHz
+MultiControlCurve pressure(MC_CURVE_S, 4.0f, 0, 127);             // MIDI aftertouch
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("=== Response Curves Demo ===");
+  volume.setLatchEnabled(false);
+  cutoff.setLatchEnabled(false);
+  volume.setCurve(&volumeTaper);
+  cutoff.setCurve(&cutoffHz);
+  for (int i = 0; i < 2; i++) {
+    pads[i].setPin(PAD_PINS[i]);
+    pads[i].setControl(0);
+  }
+  MultiControl::calibrateTouchPads(pads, 2);
+  // The same curve on both pads, each scaled to its own full press
+  pads[0].setCurve(&pressure, 0, 300);
+  pads[1].setCurve(&pressure, 0, 500);
+}
+
+void loop() {
+  if (volume.readPotChanged() >= 0) {
+    Serial.print("[VOLUME] ");
+    Serial.println(volume.getCurvedValue());
+  }
+  if (cutoff.readPotChanged() >= 0) {
+    Serial.print("[CUTOFF] ");
+    Serial.print(cutoff.getCurvedValue());
+    Serial.println(" Hz");
+  }
+  for (int i = 0; i < 2; i++) {
+    pads[i].readTouch();
+    if (pads[i].getTouchState()) {
+      Serial.print("[PAD ");
+      Serial.print(i);
+      Serial.print("] ");
+      Serial.println(pads[i].getCurvedValue());
+    }
+  }
+  delay(10);
+}
+
+// =============================================================================
+// QUICK REFERENCE
+// =============================================================================
+//
+// CURVES (built at setup, 130 bytes each):
+//   MultiControlCurve c(MC_CURVE_EXP, 4.0f);              // slow start, fast end
+//   MultiControlCurve c(MC_CURVE_LOG, 4.0f, 0, 127);      // fast start, to MIDI range
+//   MultiControlCurve c(MC_CURVE_S, 6.0f);                // slow at both ends
+//   MultiControlCurve c(MC_CURVE_POWER, 2.0f);            // x^2
+//   MultiControlCurve c(MC_CURVE_RATIO, 0, 20, 20000);    // frequencies
+//   c.build(inputs, outputs, count);                      // through breakpoints
+//   MultiControlCurve c(constTable);                      // a table kept in flash
+//
+// CONTROLS:
+//   control.setCurve(&c);                  // or setCurve(&c, inMin, inMax) to normalise
+//   control.getCurvedValue();              // getValue() through the curve
+//   c.map(value);                          // any 0-1023 value through the curve
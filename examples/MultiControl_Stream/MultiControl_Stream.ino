@@ -0,0 +1,47 @@
+// MultiControl Stream Example
+// Streams the state of four pots and two buttons to a host editor in a compact binary format.
+//
+// The panel sends a full snapshot at startup and when the host sends 'S', then only what
+// changed: pot values, button gestures (press, release, click, double-click, hold) and
+// pot latch states after a bank change. Decode it on the host with extras/stream/mcstream.h.
+// The serial port carries only the stream, so don't print anything else to it.
+
+#include "MultiControl.h"
+#include "MultiControlStream.h"
+
+const int NUM_POTS = 4;
+const uint8_t POT_PINS[NUM_POTS] = {4, 5, 6, 7};  // adjust for your board
+const uint8_t BUTTON_PINS[2] = {10, 11};
+
+MultiControl controls[NUM_POTS + 2];
+MultiControlStream stream;
+
+void setup() {
+  Serial.begin(115200);
+  for (int i = 0; i < NUM_POTS; i++) {
+    controls[i].setPin(POT_PINS[i]);
+    controls[i].setControl(1);  // pot
+  }
+  for (int b = 0; b < 2; b++) {
+    controls[NUM_POTS + b].setPin(BUTTON_PINS[b]);
+    controls[NUM_POTS + b].setControl(2);  // button
+  }
+  stream.addControls(controls, NUM_POTS + 2);
+  stream.setSnapshotInterval(2000);  // lets the host recover from a lost frame on its own
+  stream.begin(Serial);
+}
+
+void loop() {
+  for (int i = 0; i < NUM_POTS; i++) controls[i].readPot();
+  controls[NUM_POTS].readButton();
+  controls[NUM_POTS + 1].readButton();
+  // A click on the second button switches all pots between two banks.
+  // The stream reports the click too: gesture checks in the sketch don't hide events from it.
+  if (controls[NUM_POTS + 1].wasSingleClicked()) {
+    for (int i = 0; i < NUM_POTS; i++) controls[i].setBank(1 - controls[i].getBank());
+  }
+
+  if (Serial.available() && Serial.read() == 'S') stream.requestSnapshot();
+  stream.update();  // sends at most one frame every 10 ms
+  delay(1);
+}
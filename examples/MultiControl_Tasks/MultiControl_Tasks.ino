@@ -0,0 +1,82 @@
+// MultiControl Tasks Example
+// Interaction logic as C++20 coroutines instead of polling state machines
+// (needs arduino-esp32 3.x, which compiles with C++20 or newer)
+
+#include "MultiControl.h"
+#include "MultiControlTasks.h"
+
+const int REC_PIN = 13;
+const int SHIFT_PIN = 14;
+const int POT_PIN = 4;
+
+MultiControl rec(REC_PIN, 2);       // button
+MultiControl shift(SHIFT_PIN, 2);   // button
+MultiControl cutoff(POT_PIN, 1);    // pot
+MultiControlTasks tasks;
+
+// Record: press to arm, then double-click to start, hold SHIFT to cancel,
+// or give up after 2 seconds. Written top to bottom, one step at a time.
+MultiControlTask recordButton() {
+  for (;;) {
+    co_await tasks.pressed(rec);
+    Serial.println("[REC] Armed - double-click to record, hold SHIFT to cancel");
+    int which = co_await tasks.anyOf(tasks.doubleClicked(rec), tasks.held(shift), tasks.timeout(2000));
+    if (which == 0) {
+      Serial.println("[REC] Recording until the next click");
+      co_await tasks.clicked(rec);
+      Serial.println("[REC] Stopped");
+    } else {
+      Serial.println(which == 1 ? "[REC] Cancelled" : "[REC] Timed out");
+    }
+  }
+}
+
+// Report the cutoff pot only when it moves by 16 or more
+MultiControlTask cutoffPot() {
+  for (;;) {
+    int value = co_await tasks.changedBeyond(cutoff, 16);
+    Serial.print("[CUTOFF] ");
+    Serial.println(value);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("=== Tasks Demo ===");
+  cutoff.setLatchEnabled(false);  // one bank here: follow the pot from the start
+  // start() fails when the pool is full or a task's frame is too big for it
+  if (!tasks.start(recordButton()) || !tasks.start(cutoffPot())) {
+    Serial.println("Raise MULTICONTROL_TASKS_FRAMES or MULTICONTROL_TASKS_FRAME_SIZE");
+  }
+}
+
+void loop() {
+  // Read the controls as usual, then resume the tasks whose events arrived
+  rec.readButton();
+  shift.readButton();
+  cutoff.readPot();
+  tasks.update();
+  delay(2);
+}
+
+// =============================================================================
+// QUICK REFERENCE
+// =============================================================================
+//
+// TASKS:
+//   MultiControlTask name() { ... co_await ...; }   // a coroutine
+//   tasks.start(name());                             // false if no frame is free
+//   tasks.update();                                  // once per loop, after reading
+//   tasks.stopAll();                                 // e.g. on a mode change
+//
+// WAITS (co_await returns an int):
+//   tasks.pressed(b), released(b), clicked(b), doubleClicked(b), held(b), longPressed(b)
+//   tasks.gesture(b, MC_GESTURE_PRESS | MC_GESTURE_DOUBLE)    // the bits that arrived
+//   tasks.changedBeyond(pot, 10)                               // the new value
+//   tasks.timeout(500)                                         // 0
+//   tasks.anyOf(wait, wait, ...)                               // position of the first
+//
+// SIZING (define before the include):
+//   MULTICONTROL_TASKS_FRAMES      tasks alive at once (default 8)
+//   MULTICONTROL_TASKS_FRAME_SIZE  bytes per task (default 512, see getLargestFrame())
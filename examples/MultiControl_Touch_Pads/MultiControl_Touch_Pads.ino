@@ -32,14 +32,21 @@ void setup() {
   for (int i = 0; i < NUM_PADS; i++) {
     pads[i].setPin(FIRST_PAD_PIN + i);
     activeVoice[i] = -1;
+
+    // Adaptive thresholds: each pad sets its own ON/OFF thresholds and a
+    // debounce of 1-2 reads from its idle noise and its typical touch, so
+    // strong pads respond faster and weak or noisy ones stay reliable.
+    // Enable before calibrateTouchPads() to start from the measured noise.
+    // pads[i].setTouchAdaptive(true);
   }
 
   // --- CALIBRATION ---
-  // calibrateTouch() resets the baseline and reads ~50 samples over ~200ms
-  // to establish a stable reference. Call this once at startup with pads untouched.
-  for (int i = 0; i < NUM_PADS; i++) {
-    pads[i].calibrateTouch(50);
-  }
+  // calibrateTouchPads() calibrates all pads together, interleaving reads every 4ms.
+  // Each pad stops as soon as its baseline settles (max 50 reads), so the whole
+  // board is ready in well under the ~200ms per pad that calibrateTouch() takes.
+  // Call this once at startup with pads untouched.
+  // Pass true as the last argument to return after ~30ms and finish in the background.
+  MultiControl::calibrateTouchPads(pads, NUM_PADS, 50);
 
   // --- CONFIGURATION FOR MULTI-PAD USE ---
   for (int i = 0; i < NUM_PADS; i++) {
@@ -0,0 +1,58 @@
+// MultiControl Touch Slider Example
+// Six touch pads in a row read as one slider, and eight in a ring as a wheel: the finger
+// position (0-1023) from an integer centroid, steady at rest, with a velocity for flicks.
+
+#include "MultiControl.h"
+#include "MultiControlSlider.h"
+
+const int SLIDER_PINS[6] = {1, 2, 3, 4, 5, 6};
+const int WHEEL_PINS[8] = {7, 8, 9, 10, 11, 12, 13, 14};
+
+MultiControl sliderPads[6];
+MultiControl wheelPads[8];
+MultiControlSlider slider;
+MultiControlSlider wheel;
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("=== Touch Slider Demo ===");
+  for (int i = 0; i < 6; i++) sliderPads[i].setPin(SLIDER_PINS[i]);
+  for (int i = 0; i < 8; i++) wheelPads[i].setPin(WHEEL_PINS[i]);
+  slider.addPads(sliderPads, 6);
+  wheel.addPads(wheelPads, 8);
+  wheel.setWheel(true);
+  MultiControl::calibrateTouchPads(sliderPads, 6);
+  MultiControl::calibrateTouchPads(wheelPads, 8);
+}
+
+void loop() {
+  // Each reads its pads every 3 ms, however fast the loop runs
+  if (slider.update() && slider.isTouched()) {
+    Serial.print("[SLIDER] ");
+    Serial.print(slider.getPosition());
+    Serial.print("  velocity ");
+    Serial.println(slider.getVelocity());
+  }
+  if (wheel.update() && wheel.isTouched()) {
+    Serial.print("[WHEEL] ");
+    Serial.println(wheel.getPosition());
+  }
+}
+
+// =============================================================================
+// QUICK REFERENCE
+// =============================================================================
+//
+// SETUP (pads in order along the slider or round the wheel, ESP32 touch pins):
+//   slider.addPad(&pad);  slider.addPads(pads, count);   // up to 8 pads
+//   slider.setWheel(true);                 // last pad next to the first (3+ pads)
+//   slider.setHysteresis(units);           // dead band at rest (default 10 of 1023)
+//   slider.setInterval(ms);                // read the pads every ms (default 3)
+//
+// READING:
+//   slider.update();                       // every loop; true if touch or position changed
+//   slider.isTouched();
+//   slider.getPosition();                  // 0-1023, held after the finger leaves
+//   slider.getRawPosition();               // last reading, no hysteresis
+//   slider.getVelocity();                  // units per second, + towards the last pad
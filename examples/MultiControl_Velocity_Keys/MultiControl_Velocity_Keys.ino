@@ -0,0 +1,46 @@
+// MultiControl Velocity Keys Example
+// Note velocity from keys with two contacts each (as in most synth keybeds).
+//
+// The first contact closes early in the key travel and the second at the bottom;
+// the faster the key is played, the shorter the time between them. This example wires
+// eight keys straight to GPIO pins (contacts to ground, internal pull-ups). For a full
+// keybed, read its diode matrix or shift registers into the two contact words instead.
+
+#include "MultiControl.h"
+#include "MultiControlKeys.h"
+
+const int NUM_KEYS = 8;
+const uint8_t FIRST_CONTACT[NUM_KEYS] = {4, 5, 6, 7, 15, 16, 17, 18};
+const uint8_t SECOND_CONTACT[NUM_KEYS] = {8, 9, 10, 11, 12, 13, 14, 21};
+const int LOWEST_NOTE = 60;
+
+MultiControlVelocityKeys keys;
+
+void setup() {
+  Serial.begin(115200);
+  for (int i = 0; i < NUM_KEYS; i++) {
+    pinMode(FIRST_CONTACT[i], INPUT_PULLUP);
+    pinMode(SECOND_CONTACT[i], INPUT_PULLUP);
+  }
+  // 2 ms between contacts = velocity 127, 60 ms or slower = velocity 1
+  keys.setVelocityRange(2000, 60000);
+}
+
+void loop() {
+  // Pack the contact states: bit k set = contact of key k closed (pin LOW)
+  uint64_t first = 0, second = 0;
+  for (int i = 0; i < NUM_KEYS; i++) {
+    if (digitalRead(FIRST_CONTACT[i]) == LOW) first |= 1ULL << i;
+    if (digitalRead(SECOND_CONTACT[i]) == LOW) second |= 1ULL << i;
+  }
+  keys.update(first, second);  // timestamps the scan with micros()
+
+  MultiControlKeyEvent e;
+  while (keys.readEvent(e)) {
+    Serial.print(e.on ? "Note on  " : "Note off ");
+    Serial.print(LOWEST_NOTE + e.key);
+    Serial.print(" velocity ");
+    Serial.println(e.velocity);
+  }
+  // No delay: scan as often as possible for accurate velocity
+}
@@ -0,0 +1,479 @@
+/*
+ * mctune.cpp - offline parameter autotuner for MultiControl pots and touch pads.
+ *
+ * Replays raw captures (see MultiControlCapture.h) through the library's own pot filter
+ * and touch detector with many different settings, on all cores, scores each setting
+ * against hand-labelled ground truth, and writes the best one as a header to include
+ * in the sketch.
+ *
+ * Pots are scored on jitter at rest (output changes per minute while untouched) and
+ * step-response latency (ms until the output is within tolerance of a new position).
+ * Touch pads are scored on false touches, missed touches and stuck notes (each counts
+ * as an error), plus press and release latency.
+ *
+ * Labels file, one per capture, times in ms from the start of the capture:
+ *   pot <pin> rest <start> <end>     pot left alone: the output should not change
+ *   pot <pin> step <time> <value>    pot turned to value (0-1023) at time
+ *   touch <pin> <on> <off>           pad touched from on to off
+ *   # comment
+ * Only pots and pads read directly from a pin can be tuned (not through a mux).
+ *
+ * Build (use the touch define for the chip the captures were made on):
+ *   g++ -O2 -std=c++11 -pthread -DMULTICONTROL_CAPTURE -DMULTICONTROL_REPLAY_THREADS \
+ *       -DESP32 -DCONFIG_IDF_TARGET_ESP32S3 -I../replay -I../.. mctune.cpp -o mctune
+ * Run:
+ *   ./mctune [options] capture.bin capture.labels [more.bin more.labels ...] > MultiControlTuned.h
+ * Options:
+ *   --pots, --touch     tune only pots or only touch pads (default: whatever is labelled)
+ *   --random N          evaluate N random settings instead of the default grid
+ *   --seed S            seed for --random (default 1)
+ *   --threads N         worker threads (default: all cores)
+ *   --tolerance T       pot step tolerance in output units (default 8)
+ *   --w-jitter W        pot score weight per change per minute at rest (default 1)
+ *   --w-latency W       score weight per ms of latency (default 1)
+ *   --w-error W         touch score weight per false, missed or stuck touch (default 100)
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int BATCH = 16;                 // settings evaluated together per replay pass
+const unsigned long STEP_WINDOW = 1000;  // ms a pot has to reach a step before it counts as missed
+const unsigned long TOUCH_SLACK = 50;    // ms a detected touch may lead its label
+
+struct PotLabel { unsigned long t0, t1; int value; bool rest; };
+struct TouchLabel { unsigned long on, off; };
+
+struct PinLabels {
+  uint8_t pin;
+  std::vector<PotLabel> rests, steps;
+  std::vector<TouchLabel> touches;
+};
+
+struct Capture {
+  const uint8_t* data;
+  size_t len;
+  std::vector<PinLabels> pots, pads;
+};
+
+struct PotParams { float snap; float activity; int hysteresis; int spread; };
+struct TouchParams { int on; int off; int debounce; int minHold; int retrigger; };
+
+/* Raw totals for one setting, summed over all captures and pins */
+struct Stats {
+  double restChanges = 0, restMinutes = 0;
+  double latency = 0, latencyCount = 0;
+  double errors = 0, falseTouches = 0, missed = 0, stuck = 0;
+};
+
+struct Options {
+  bool pots = true, touch = true;
+  int random = 0;
+  unsigned seed = 1;
+  int threads = 0;
+  int tolerance = 8;
+  double wJitter = 1.0, wLatency = 1.0, wError = 100.0;
+};
+
+Options opt;
+
+PinLabels& labelsFor(std::vector<PinLabels>& list, uint8_t pin) {
+  for (auto& l : list) if (l.pin == pin) return l;
+  list.push_back(PinLabels());
+  list.back().pin = pin;
+  return list.back();
+}
+
+bool loadLabels(const char* path, Capture& cap) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) { perror(path); return false; }
+  char line[256];
+  int lineNo = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNo++;
+    char kind[16], what[16];
+    unsigned pin;
+    unsigned long a, b;
+    if (line[0] == '#' || sscanf(line, "%15s", kind) != 1) continue;
+    if (strcmp(kind, "pot") == 0 && sscanf(line, "%*s %u %15s %lu %lu", &pin, what, &a, &b) == 4) {
+      PotLabel l = {a, b, 0, strcmp(what, "rest") == 0};
+      if (!l.rest) { l.t1 = a; l.value = (int)b; }
+      if (l.rest) labelsFor(cap.pots, pin).rests.push_back(l);
+      else labelsFor(cap.pots, pin).steps.push_back(l);
+    } else if (strcmp(kind, "touch") == 0 && sscanf(line, "%*s %u %lu %lu", &pin, &a, &b) == 3) {
+      labelsFor(cap.pads, pin).touches.push_back({a, b});
+    } else {
+      fprintf(stderr, "%s:%d: cannot parse label\n", path, lineNo);
+      fclose(f);
+      return false;
+    }
+  }
+  fclose(f);
+  auto byTime = [](const PotLabel& x, const PotLabel& y) { return x.t0 < y.t0; };
+  for (auto& p : cap.pots) {
+    std::sort(p.steps.begin(), p.steps.end(), byTime);
+    std::sort(p.rests.begin(), p.rests.end(), byTime);
+  }
+  for (auto& p : cap.pads) {
+    std::sort(p.touches.begin(), p.touches.end(), [](const TouchLabel& x, const TouchLabel& y) { return x.on < y.on; });
+  }
+  return true;
+}
+
+/* Run a batch of pot settings over one capture */
+void evalPots(const Capture& cap, const PotParams* params, int n, Stats* stats) {
+  MultiControlReplay rep(cap.data, cap.len);
+  multiControlReplaySource = &rep;
+  unsigned long start = rep.micros();
+  int np = cap.pots.size();
+  std::unique_ptr<MultiControl[]> pots(new MultiControl[n * np]);
+  std::vector<int> out(n * np, -1), reached(n * np, -1);
+  std::vector<size_t> rest(np, 0), step(np, 0);
+  for (int c = 0; c < n; c++) {
+    for (int k = 0; k < np; k++) {
+      MultiControl& m = pots[c * np + k];
+      m.setPin(cap.pots[k].pin);
+      m.setControl(1);
+      m.setLatchEnabled(false);
+      m.setSnapMultiplier(params[c].snap);
+      m.setActivityThreshold(params[c].activity);
+      m.setPotHysteresis(params[c].hysteresis);
+      m.setMaxSampleSpread(params[c].spread);
+    }
+  }
+  for (int k = 0; k < np; k++) {
+    for (auto& r : cap.pots[k].rests) for (int c = 0; c < n; c++) stats[c].restMinutes += (r.t1 - r.t0) / 60000.0;
+  }
+  unsigned long t = 0;
+  while (rep.nextFrame()) {
+    t = (rep.micros() - start) / 1000;
+    hostMicros = rep.micros();
+    for (int k = 0; k < np; k++) {
+      const PinLabels& l = cap.pots[k];
+      uint8_t pin = l.pin;
+      if (!rep.hasRead(MC_CAPTURE_ANALOG, pin)) continue;
+      while (rest[k] < l.rests.size() && t > l.rests[rest[k]].t1) rest[k]++;
+      bool atRest = rest[k] < l.rests.size() && t >= l.rests[rest[k]].t0;
+      // The current step is open until it is reached, the window closes, or the next step starts
+      while (step[k] < l.steps.size() && step[k] + 1 < l.steps.size() && t >= l.steps[step[k] + 1].t0) {
+        for (int c = 0; c < n; c++) {
+          if (reached[c * np + k] != (int)step[k] && t >= l.steps[step[k]].t0) {
+            stats[c].latency += STEP_WINDOW;
+            stats[c].latencyCount++;
+            reached[c * np + k] = step[k];
+          }
+        }
+        step[k]++;
+      }
+      bool stepOpen = step[k] < l.steps.size() && t >= l.steps[step[k]].t0;
+      unsigned long stepAge = stepOpen ? t - l.steps[step[k]].t0 : 0;
+      for (int c = 0; c < n; c++) {
+        int i = c * np + k;
+        MultiControl& m = pots[i];
+        rep.rewind(MC_CAPTURE_ANALOG, pin);
+        int v = -1;
+        while (rep.hasRead(MC_CAPTURE_ANALOG, pin)) {
+          int r = m.readPot();
+          if (r >= 0) v = r;
+        }
+        if (v < 0) continue;
+        if (v != out[i]) {
+          if (atRest && out[i] >= 0) stats[c].restChanges++;
+          out[i] = v;
+        }
+        if (stepOpen && reached[i] != (int)step[k]) {
+          if (abs(v - l.steps[step[k]].value) <= opt.tolerance) {
+            stats[c].latency += stepAge;
+            stats[c].latencyCount++;
+            reached[i] = step[k];
+          } else if (stepAge >= STEP_WINDOW) {
+            stats[c].latency += STEP_WINDOW;
+            stats[c].latencyCount++;
+            reached[i] = step[k];
+          }
+        }
+      }
+    }
+  }
+  // Steps never reached by the end of the capture
+  for (int k = 0; k < np; k++) {
+    if (step[k] >= cap.pots[k].steps.size() || t < cap.pots[k].steps[step[k]].t0) continue;
+    for (int c = 0; c < n; c++) {
+      if (reached[c * np + k] != (int)step[k]) {
+        stats[c].latency += STEP_WINDOW;
+        stats[c].latencyCount++;
+      }
+    }
+  }
+  multiControlReplaySource = nullptr;
+}
+
+/* Per pad and setting: how the current label has been matched */
+struct TouchState { bool touched = false; int matched = -1; int released = -1; };
+
+/* Close a touch label: missed if never detected, stuck if never released */
+void closeTouchLabel(TouchState& s, int label, Stats& st) {
+  if (s.matched != label) { st.missed++; st.errors++; }
+  else if (s.released != label) { st.stuck++; st.errors++; }
+}
+
+/* Run a batch of touch settings over one capture */
+void evalTouch(const Capture& cap, const TouchParams* params, int n, Stats* stats) {
+  MultiControlReplay rep(cap.data, cap.len);
+  multiControlReplaySource = &rep;
+  unsigned long start = rep.micros();
+  int np = cap.pads.size();
+  std::unique_ptr<MultiControl[]> pads(new MultiControl[n * np]);
+  std::vector<TouchState> state(n * np);
+  std::vector<int> label(np, -1);
+  for (int c = 0; c < n; c++) {
+    for (int k = 0; k < np; k++) {
+      MultiControl& m = pads[c * np + k];
+      m.setPin(cap.pads[k].pin);
+      m.setControl(0);
+      m.setTouchThresholds(params[c].on, params[c].off);
+      m.setTouchDebounceReads(params[c].debounce);
+      m.setTouchMinHold(params[c].minHold);
+      m.setRetriggerThreshold(params[c].retrigger);
+      m.beginTouchCalibration();
+    }
+  }
+  while (rep.nextFrame()) {
+    unsigned long t = (rep.micros() - start) / 1000;
+    hostMicros = rep.micros();
+    for (int k = 0; k < np; k++) {
+      const std::vector<TouchLabel>& touches = cap.pads[k].touches;
+      uint8_t pin = cap.pads[k].pin;
+      if (!rep.hasRead(MC_CAPTURE_TOUCH, pin)) continue;
+      // Labels become current TOUCH_SLACK before they start
+      while (label[k] + 1 < (int)touches.size() && t + TOUCH_SLACK >= touches[label[k] + 1].on) {
+        if (label[k] >= 0) for (int c = 0; c < n; c++) closeTouchLabel(state[c * np + k], label[k], stats[c]);
+        label[k]++;
+      }
+      int cur = label[k];
+      for (int c = 0; c < n; c++) {
+        TouchState& s = state[c * np + k];
+        MultiControl& m = pads[c * np + k];
+        rep.rewind(MC_CAPTURE_TOUCH, pin);
+        bool touched = s.touched;
+        while (rep.hasRead(MC_CAPTURE_TOUCH, pin)) touched = m.isTouched();
+        bool onset = (touched && !s.touched) || (touched && m.wasRetriggered());
+        bool release = !touched && s.touched;
+        s.touched = touched;
+        if (onset) {
+          if (cur >= 0 && s.matched != cur && t <= touches[cur].off) {
+            s.matched = cur;
+            stats[c].latency += t > touches[cur].on ? t - touches[cur].on : 0;
+            stats[c].latencyCount++;
+          } else {
+            stats[c].falseTouches++;
+            stats[c].errors++;
+          }
+        }
+        if (release && cur >= 0 && s.matched == cur && s.released != cur) {
+          s.released = cur;
+          stats[c].latency += t > touches[cur].off ? t - touches[cur].off : touches[cur].off - t;
+          stats[c].latencyCount++;
+        }
+      }
+    }
+  }
+  for (int k = 0; k < np; k++) {
+    if (label[k] < 0) continue;
+    for (int c = 0; c < n; c++) closeTouchLabel(state[c * np + k], label[k], stats[c]);
+  }
+  multiControlReplaySource = nullptr;
+}
+
+double potScore(const Stats& s) {
+  double jitter = s.restMinutes > 0 ? s.restChanges / s.restMinutes : 0;
+  double latency = s.latencyCount > 0 ? s.latency / s.latencyCount : 0;
+  return opt.wJitter * jitter + opt.wLatency * latency;
+}
+
+double touchScore(const Stats& s) {
+  double latency = s.latencyCount > 0 ? s.latency / s.latencyCount : 0;
+  return opt.wError * s.errors + opt.wLatency * latency;
+}
+
+std::vector<PotParams> potSettings() {
+  std::vector<PotParams> v;
+  if (opt.random > 0) {
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<float> logSnap(logf(0.005f), logf(0.3f));
+    for (int i = 0; i < opt.random; i++) {
+      v.push_back({expf(logSnap(rng)), (float)(rng() % 161) / 10.0f, 1 + (int)(rng() % 12), 20 + (int)(rng() % 381)});
+    }
+    return v;
+  }
+  const float snaps[] = {0.01f, 0.02f, 0.035f, 0.05f, 0.075f, 0.1f, 0.15f};
+  const float activity[] = {0.0f, 1.0f, 2.0f, 4.0f, 6.0f, 8.0f, 12.0f};
+  const int hysteresis[] = {1, 2, 3, 4, 6, 8};
+  const int spread[] = {30, 50, 100, 200, 4096};
+  for (float s : snaps) for (float a : activity) for (int h : hysteresis) for (int sp : spread) v.push_back({s, a, h, sp});
+  return v;
+}
+
+std::vector<TouchParams> touchSettings() {
+  std::vector<TouchParams> v;
+  if (opt.random > 0) {
+    std::mt19937 rng(opt.seed + 1);
+    for (int i = 0; i < opt.random; i++) {
+      int on = 5 + rng() % 56;
+      v.push_back({on, 2 + (int)(rng() % (on - 2)), 1 + (int)(rng() % 8), (int)(rng() % 81), (int)(rng() % 41)});
+    }
+    return v;
+  }
+  const int on[] = {10, 14, 18, 22, 26, 32, 40};
+  const float offRatio[] = {0.5f, 0.65f, 0.8f};
+  const int debounce[] = {1, 2, 3, 4, 6};
+  const int minHold[] = {0, 15, 30, 50};
+  const int retrigger[] = {0, 10, 15, 25};
+  for (int o : on) for (float r : offRatio) for (int d : debounce) for (int h : minHold) for (int rt : retrigger) {
+    v.push_back({o, max(1, (int)(o * r + 0.5f)), d, h, rt});
+  }
+  return v;
+}
+
+/* Evaluate every setting on all threads; each thread replays the captures once per batch */
+template <typename P, typename F>
+std::vector<Stats> search(const std::vector<Capture>& caps, const std::vector<P>& settings, F eval) {
+  std::vector<Stats> stats(settings.size());
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (;;) {
+      size_t first = next.fetch_add(BATCH);
+      if (first >= settings.size()) return;
+      int n = (int)std::min((size_t)BATCH, settings.size() - first);
+      for (const Capture& cap : caps) eval(cap, &settings[first], n, &stats[first]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < opt.threads; i++) threads.emplace_back(worker);
+  for (auto& th : threads) th.join();
+  return stats;
+}
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+template <typename S>
+size_t best(const std::vector<Stats>& stats, S score) {
+  size_t b = 0;
+  for (size_t i = 1; i < stats.size(); i++) if (score(stats[i]) < score(stats[b])) b = i;
+  return b;
+}
+
+int main(int argc, char** argv) {
+  std::vector<Capture> caps;
+  bool onlyPots = false, onlyTouch = false;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (strcmp(a, "--pots") == 0) onlyPots = true;
+    else if (strcmp(a, "--touch") == 0) onlyTouch = true;
+    else if (strcmp(a, "--random") == 0 && hasValue) opt.random = atoi(argv[++i]);
+    else if (strcmp(a, "--seed") == 0 && hasValue) opt.seed = atoi(argv[++i]);
+    else if (strcmp(a, "--threads") == 0 && hasValue) opt.threads = atoi(argv[++i]);
+    else if (strcmp(a, "--tolerance") == 0 && hasValue) opt.tolerance = atoi(argv[++i]);
+    else if (strcmp(a, "--w-jitter") == 0 && hasValue) opt.wJitter = atof(argv[++i]);
+    else if (strcmp(a, "--w-latency") == 0 && hasValue) opt.wLatency = atof(argv[++i]);
+    else if (strcmp(a, "--w-error") == 0 && hasValue) opt.wError = atof(argv[++i]);
+    else if (a[0] != '-' && hasValue) {
+      int fd = open(a, O_RDONLY);
+      struct stat st;
+      if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) { perror(a); return 1; }
+      Capture cap;
+      cap.len = st.st_size;
+      cap.data = (const uint8_t*)mmap(nullptr, cap.len, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (cap.data == MAP_FAILED) { perror("mmap"); return 1; }
+      if (!MultiControlReplay(cap.data, cap.len).isValid()) {
+        fprintf(stderr, "%s: not a MultiControl capture\n", a);
+        return 1;
+      }
+      if (!loadLabels(argv[++i], cap)) return 1;
+      caps.push_back(cap);
+    } else {
+      fprintf(stderr, "usage: %s [options] capture.bin capture.labels [...]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (caps.empty()) {
+    fprintf(stderr, "usage: %s [options] capture.bin capture.labels [...]\n", argv[0]);
+    return 1;
+  }
+  if (opt.threads <= 0) opt.threads = max(1u, std::thread::hardware_concurrency());
+  bool anyPots = false, anyPads = false;
+  for (auto& c : caps) { anyPots |= !c.pots.empty(); anyPads |= !c.pads.empty(); }
+  opt.pots = anyPots && !onlyTouch;
+  opt.touch = anyPads && !onlyPots;
+
+  printf("/*\n * MultiControlTuned.h\n *\n * Generated by extras/autotune/mctune from %d capture(s).\n", (int)caps.size());
+  PotParams bestPot = {};
+  TouchParams bestTouch = {};
+  Stats potStats, touchStats;
+  if (opt.pots) {
+    std::vector<PotParams> settings = potSettings();
+    double t0 = seconds();
+    std::vector<Stats> stats = search(caps, settings, evalPots);
+    double t1 = seconds();
+    size_t b = best(stats, potScore);
+    bestPot = settings[b];
+    potStats = stats[b];
+    fprintf(stderr, "pots: %d settings in %.1f s on %d threads\n", (int)settings.size(), t1 - t0, opt.threads);
+    printf(" * Pots: %.1f changes/min at rest, %.1f ms mean step latency (%d settings tried).\n",
+           potStats.restMinutes > 0 ? potStats.restChanges / potStats.restMinutes : 0.0,
+           potStats.latencyCount > 0 ? potStats.latency / potStats.latencyCount : 0.0, (int)settings.size());
+  }
+  if (opt.touch) {
+    std::vector<TouchParams> settings = touchSettings();
+    double t0 = seconds();
+    std::vector<Stats> stats = search(caps, settings, evalTouch);
+    double t1 = seconds();
+    size_t b = best(stats, touchScore);
+    bestTouch = settings[b];
+    touchStats = stats[b];
+    fprintf(stderr, "touch: %d settings in %.1f s on %d threads\n", (int)settings.size(), t1 - t0, opt.threads);
+    printf(" * Touch: %.0f false, %.0f missed, %.0f stuck, %.1f ms mean latency (%d settings tried).\n",
+           touchStats.falseTouches, touchStats.missed, touchStats.stuck,
+           touchStats.latencyCount > 0 ? touchStats.latency / touchStats.latencyCount : 0.0, (int)settings.size());
+  }
+  printf(" */\n\n#ifndef MULTICONTROL_TUNED_H_\n#define MULTICONTROL_TUNED_H_\n\n#include \"MultiControl.h\"\n");
+  if (opt.pots) {
+    printf("\n/** Apply the tuned pot filter settings */\n");
+    printf("inline void applyTunedPot(MultiControl& pot) {\n");
+    printf("  pot.setSnapMultiplier(%.4ff);\n", bestPot.snap);
+    printf("  pot.setActivityThreshold(%.1ff);\n", bestPot.activity);
+    printf("  pot.setPotHysteresis(%d);\n", bestPot.hysteresis);
+    printf("  pot.setMaxSampleSpread(%d);\n", bestPot.spread);
+    printf("}\n");
+  }
+  if (opt.touch) {
+    printf("\n/** Apply the tuned touch detection settings */\n");
+    printf("inline void applyTunedTouch(MultiControl& pad) {\n");
+    printf("  pad.setTouchThresholds(%d, %d);\n", bestTouch.on, bestTouch.off);
+    printf("  pad.setTouchDebounceReads(%d);\n", bestTouch.debounce);
+    printf("  pad.setTouchMinHold(%d);\n", bestTouch.minHold);
+    printf("  pad.setRetriggerThreshold(%d);\n", bestTouch.retrigger);
+    printf("}\n");
+  }
+  printf("\n#endif /* MULTICONTROL_TUNED_H_ */\n");
+  return 0;
+}
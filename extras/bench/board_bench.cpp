@@ -0,0 +1,254 @@
+/*
+ * board_bench.cpp - host benchmark for MultiControlBoard.
+ *
+ * Simulates a panel of 16 mux buttons (two 4051s sharing select pins), 4 pots, 2 touch
+ * pads, 2 buttons, a switch and an encoder with a push button, played for ten minutes
+ * and scanned once per millisecond. The same panel is scanned the usual way (a read call
+ * per control, each mux button selecting its own channel) and with a MultiControlBoard
+ * built from a constexpr layout. Reports per scan:
+ *   settle   time spent in delays (mux settle and pot sampling), as on the device
+ *   writes   select line digitalWrite() calls
+ *   reads    digital pin reads (on the device, the board reads the GPIO registers instead)
+ *   cost     host time of the scan calls
+ * and checks that both give the same value for every control after every scan.
+ *
+ * The layout checks run at compile time. Build with -DLAYOUT_ERROR=n to see each one fail:
+ *   1 pin used twice           2 touch on a pin without touch   3 pot on a pin without ADC
+ *   4 mux buttons without select pins   5 mux channel above 7   6 input-only select pin
+ *   7 pin used by flash        8 duplicate mux button           9 mcBanks() given twice
+ *
+ * Build and run:
+ *   g++ -std=gnu++17 -O2 -I../replay -I../.. board_bench.cpp -o board_bench && ./board_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include "MultiControl.h"
+#include "MultiControlBoard.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int SCANS = 600000;
+const uint8_t SELECT[3] = {25, 26, 27};
+const uint8_t MUX_COMMON[2] = {34, 35};
+const uint8_t POTS[4] = {36, 39, 32, 33};
+const uint8_t TOUCH[2] = {4, 15};
+const uint8_t BUTTONS[2] = {18, 19};
+const uint8_t SWITCH = 5;
+const uint8_t ENC_A = 21, ENC_B = 22, ENC_BUTTON = 23;
+
+// Controls in layout order: 16 mux buttons, pots, touch pads, buttons, switch, encoder
+constexpr auto layout = multiControlLayout(
+  mcBanks(2), mcMuxSelect(25, 26, 27),
+  mcMuxButton(34, 0), mcMuxButton(34, 1), mcMuxButton(34, 2), mcMuxButton(34, 3),
+  mcMuxButton(34, 4), mcMuxButton(34, 5), mcMuxButton(34, 6), mcMuxButton(34, 7),
+  mcMuxButton(35, 0), mcMuxButton(35, 1), mcMuxButton(35, 2), mcMuxButton(35, 3),
+  mcMuxButton(35, 4), mcMuxButton(35, 5), mcMuxButton(35, 6), mcMuxButton(35, 7),
+  mcPot(36), mcPot(39), mcPot(32), mcPot(33),
+  mcTouch(4), mcTouch(15),
+  mcButton(18), mcButton(19), mcSwitch(5),
+  mcEncoder(21, 22, 23)
+#if LAYOUT_ERROR == 1
+  , mcButton(19)
+#elif LAYOUT_ERROR == 2
+  , mcTouch(16)
+#elif LAYOUT_ERROR == 3
+  , mcPot(16)
+#elif LAYOUT_ERROR == 5
+  , mcMuxButton(34, 8)
+#elif LAYOUT_ERROR == 7
+  , mcButton(7)
+#elif LAYOUT_ERROR == 8
+  , mcMuxButton(35, 7)
+#elif LAYOUT_ERROR == 9
+  , mcBanks(4)
+#endif
+);
+#if LAYOUT_ERROR == 4
+constexpr auto errorLayout = multiControlLayout(mcMuxButton(34, 0));
+MultiControlBoard<errorLayout> errorBoard;
+#elif LAYOUT_ERROR == 6
+constexpr auto errorLayout = multiControlLayout(mcMuxSelect(25, 26, 36), mcMuxButton(34, 0));
+MultiControlBoard<errorLayout> errorBoard;
+#endif
+
+const int NUM_MUX = 16;
+const int COUNT = 26;
+const int ENC_INDEX = 25;
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint8_t muxPressed[2][8];  // 1 while a mux button is held
+unsigned long digitalReads = 0;
+
+/* The mux common pins follow the select lines; other pins read their hostDigital level */
+int readPin(uint8_t pin) {
+  digitalReads++;
+  for (int m = 0; m < 2; m++) {
+    if (pin == MUX_COMMON[m]) {
+      int channel = hostOutput[SELECT[0]] | (hostOutput[SELECT[1]] << 1) | (hostOutput[SELECT[2]] << 2);
+      return muxPressed[m][channel] ? 0 : 1;
+    }
+  }
+  return hostDigital[pin & 63];
+}
+
+/* Move the simulated panel on by one millisecond */
+struct Player {
+  std::mt19937 rng{1};
+  uint32_t muxUntil[NUM_MUX] = {};
+  double pot[4] = {1000, 2000, 3000, 4000};
+  double potTarget[4] = {1000, 2000, 3000, 4000};
+  int encPhase = 0;
+  uint32_t encNext = 10;  // the board primes its encoder decoder on the first scan
+  int encDir = 1;
+  uint32_t presses = 0;
+
+  void step(uint32_t ms) {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (int i = 0; i < NUM_MUX; i++) {
+      if (muxUntil[i] == 0 && u(rng) < 0.0005) {
+        muxUntil[i] = ms + 40 + (uint32_t)(u(rng) * 400);
+        presses++;
+      }
+      if (muxUntil[i] != 0 && ms >= muxUntil[i]) muxUntil[i] = 0;
+      muxPressed[i / 8][i % 8] = muxUntil[i] != 0;
+    }
+    for (int p = 0; p < 4; p++) {
+      if (u(rng) < 0.0003) potTarget[p] = u(rng) * 4095;
+      pot[p] += constrain(potTarget[p] - pot[p], -3.0, 3.0);
+      hostAnalog[POTS[p]] = (int)pot[p];
+    }
+    for (int t = 0; t < 2; t++) {
+      if (u(rng) < 0.001) hostTouch[TOUCH[t]] = hostTouch[TOUCH[t]] > 60000 ? 30000 : 80000;
+    }
+    for (int b = 0; b < 2; b++) {
+      if (u(rng) < 0.001) hostDigital[BUTTONS[b]] ^= 1;
+    }
+    if (u(rng) < 0.0002) hostDigital[SWITCH] ^= 1;
+    if (u(rng) < 0.0005) hostDigital[ENC_BUTTON] ^= 1;
+    if (ms >= encNext) {
+      // One Gray code step every 4-20 ms, turning back now and then
+      const uint8_t gray[4] = {0, 1, 3, 2};
+      if (u(rng) < 0.05) encDir = -encDir;
+      encPhase = (encPhase + encDir) & 3;
+      hostDigital[ENC_A] = gray[encPhase] >> 1;
+      hostDigital[ENC_B] = gray[encPhase] & 1;
+      encNext = ms + 4 + (uint32_t)(u(rng) * 16);
+    }
+  }
+};
+
+struct Cost {
+  unsigned long micros = 0, writes = 0, reads = 0;
+  double host = 0;
+};
+
+int32_t valueOf(MultiControl& c) { return c.getControl() == 5 ? c.getEncoderPosition() : c.getValue(); }
+
+int main() {
+  for (int pin = 0; pin < 64; pin++) {
+    hostDigital[pin] = 1;
+    hostTouch[pin] = 80000;
+  }
+  hostDigital[SWITCH] = 0;
+  hostDigital[ENC_A] = hostDigital[ENC_B] = 0;
+  hostDigitalReadHook = readPin;
+
+  // The usual way: a MultiControl and a read call per control
+  MultiControl naive[COUNT];
+  for (int i = 0; i < NUM_MUX; i++) {
+    naive[i].setControl(4);
+    naive[i].setPin(MUX_COMMON[i / 8]);
+    naive[i].setMuxControlPins(SELECT[0], SELECT[1], SELECT[2]);
+    naive[i].setMuxChannel(i % 8);
+  }
+  for (int p = 0; p < 4; p++) {
+    naive[16 + p].setPin(POTS[p]);
+    naive[16 + p].setControl(1);
+  }
+  for (int t = 0; t < 2; t++) {
+    naive[20 + t].setPin(TOUCH[t]);
+    naive[20 + t].setControl(0);
+  }
+  for (int b = 0; b < 2; b++) {
+    naive[22 + b].setPin(BUTTONS[b]);
+    naive[22 + b].setControl(2);
+  }
+  naive[24].setPin(SWITCH);
+  naive[24].setControl(3);
+  naive[ENC_INDEX].setEncoderPins(ENC_A, ENC_B, ENC_BUTTON);
+  for (int i = 0; i < COUNT; i++) naive[i].initBanks(2);
+
+  static MultiControlBoard<layout> board;
+  board.begin();
+
+  Player player;
+  Cost naiveCost, boardCost;
+  uint32_t mismatches = 0, firstMismatch = 0;
+  int naiveSelect[3] = {};
+  for (int s = 0; s < SCANS; s++) {
+    unsigned long start = (unsigned long)s * 1000 + 1000;
+    player.step(s);
+
+    // Both scanners drive the same select lines; give each its own, as if on separate boards
+    int boardSelect[3];
+    for (int k = 0; k < 3; k++) {
+      boardSelect[k] = hostOutput[SELECT[k]];
+      hostOutput[SELECT[k]] = naiveSelect[k];
+    }
+    hostMicros = start;
+    unsigned long writes = hostWrites, reads = digitalReads;
+    double t0 = seconds();
+    for (int i = 0; i < NUM_MUX; i++) naive[i].readMuxButton();
+    for (int p = 0; p < 4; p++) naive[16 + p].readPot();
+    for (int t = 0; t < 2; t++) naive[20 + t].readTouch();
+    for (int b = 0; b < 2; b++) naive[22 + b].readButton();
+    naive[24].readSwitch();
+    naive[ENC_INDEX].readEncoder();
+    naiveCost.host += seconds() - t0;
+    naiveCost.micros += hostMicros - start;
+    naiveCost.writes += hostWrites - writes;
+    naiveCost.reads += digitalReads - reads;
+    for (int k = 0; k < 3; k++) {
+      naiveSelect[k] = hostOutput[SELECT[k]];
+      hostOutput[SELECT[k]] = boardSelect[k];
+    }
+
+    hostMicros = start;
+    writes = hostWrites;
+    reads = digitalReads;
+    t0 = seconds();
+    board.update(start / 1000);
+    boardCost.host += seconds() - t0;
+    boardCost.micros += hostMicros - start;
+    boardCost.writes += hostWrites - writes;
+    boardCost.reads += digitalReads - reads;
+
+    for (int i = 0; i < COUNT; i++) {
+      if (valueOf(naive[i]) != valueOf(board[i])) {
+        if (mismatches == 0) firstMismatch = i;
+        mismatches++;
+        break;
+      }
+    }
+  }
+
+  printf("panel of %d controls (16 mux buttons), %d scans, %u mux presses\n", COUNT, SCANS, player.presses);
+  printf("            settle us  writes  reads  host ns   (per scan)\n");
+  printf("  per-control %8.1f %7.1f %6.1f %8.0f\n", (double)naiveCost.micros / SCANS,
+         (double)naiveCost.writes / SCANS, (double)naiveCost.reads / SCANS, naiveCost.host * 1e9 / SCANS);
+  printf("  board       %8.1f %7.1f %6.1f %8.0f   (%d mux steps)\n", (double)boardCost.micros / SCANS,
+         (double)boardCost.writes / SCANS, (double)boardCost.reads / SCANS, boardCost.host * 1e9 / SCANS,
+         board.getMuxSteps());
+  if (mismatches) printf("  %u scans where the values differ (first at control %u)\n", mismatches, firstMismatch);
+  else printf("  every control agrees after every scan\n");
+  printf("  board object %zu bytes, no heap\n", sizeof(board));
+  return mismatches != 0;
+}
@@ -0,0 +1,252 @@
+/*
+ * chord_bench.cpp - host benchmark and checks for MultiControlChords (button chords).
+ *
+ * Cost: 64 buttons, pressed and released at random (about one edge every 6 scans across
+ * the panel), with 16 to 128 registered two- and three-button chords, some ordered and
+ * some with a time window. Reports host ns per scan for the detector (matching on press
+ * and release edges only) and for polling every chord's mask every scan, as a sketch
+ * wiring combos by hand would.
+ *
+ * Checks, on MultiControl buttons read through the host shim:
+ *   window     a 50 ms chord pressed 30 ms apart fires, 80 ms apart does not
+ *   order      an ordered chord fires in order only
+ *   shift      a shift held for 70 s, then its button, fires
+ *   largest    a press completing a 2- and a 3-button chord fires only the 3-button one
+ *   clicks     members of a fired chord report no single click; a lone press does
+ *   bad index  wasTriggered(-1) and isActive(-1) are false; setPressed(200, ...) changes
+ *              nothing, and isPressed(200) and isChorded(200) are false
+ *   duplicate  addChord(a, a) is rejected
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. chord_bench.cpp -o chord_bench && ./chord_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include "MultiControl.h"
+#include "MultiControlChord.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int BUTTONS = 64;
+const long SCANS = 200000;
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Register count random chords, two or three members */
+void addChords(MultiControlChords& chords, std::mt19937& rng, int count, uint64_t* masks) {
+  for (int i = 0; i < count; i++) {
+    uint8_t m[3];
+    uint8_t n = i % 2 ? 2 : 3;
+    uint64_t mask = 0;
+    for (int k = 0; k < n; k++) {
+      do m[k] = rng() % BUTTONS; while (mask >> m[k] & 1);
+      mask |= 1ULL << m[k];
+    }
+    chords.addChord(m, n, i % 4 == 1 ? 0 : 80, i % 4 == 1);
+    masks[i] = mask;
+  }
+}
+
+void cost() {
+  printf("Cost, %d buttons (host ns per scan)\n", BUTTONS);
+  printf("  chords   detector   poll every chord   fired\n");
+  for (int count : {16, 64, 128}) {
+    MultiControlChords chords;
+    for (int i = 0; i < BUTTONS; i++) chords.addButton(nullptr);
+    std::mt19937 rng(1);
+    uint64_t masks[128];
+    addChords(chords, rng, count, masks);
+    // The same random presses for both, made up front
+    static bool state[SCANS / 100][BUTTONS];
+    bool st[BUTTONS] = {};
+    for (long s = 0; s < SCANS / 100; s++) {
+      for (int i = 0; i < BUTTONS; i++) {
+        if (rng() % 400 == 0) st[i] = !st[i];
+        state[s][i] = st[i];
+      }
+    }
+    long fired = 0;
+    volatile long sink = 0;
+    double t0 = seconds();
+    for (long s = 0; s < SCANS; s++) {
+      const bool* pressed = state[s % (SCANS / 100)];
+      for (int i = 0; i < BUTTONS; i++) chords.setPressed(i, pressed[i], s);
+      int c;
+      while ((c = chords.readTriggered()) >= 0) fired++;
+    }
+    double detector = (seconds() - t0) * 1e9 / SCANS;
+    // Polling: build the pressed mask, test every chord, fire on the scan it completes
+    bool was[128] = {};
+    t0 = seconds();
+    for (long s = 0; s < SCANS; s++) {
+      const bool* pressed = state[s % (SCANS / 100)];
+      uint64_t mask = 0;
+      for (int i = 0; i < BUTTONS; i++) mask |= (uint64_t)pressed[i] << i;
+      for (int c = 0; c < count; c++) {
+        bool all = (mask & masks[c]) == masks[c];
+        if (all && !was[c]) sink += c;
+        was[c] = all;
+      }
+    }
+    double poll = (seconds() - t0) * 1e9 / SCANS;
+    printf("  %4d     %7.0f       %7.0f          %6ld\n", count, detector, poll, fired);
+  }
+  printf("\n");
+}
+
+/* Buttons on pins 0-4 read by the detector */
+MultiControl buttons[5];
+const uint8_t B0 = 0, B1 = 1, B2 = 2, B3 = 3, B4 = 4;
+
+void press(int b, bool down) { hostDigital[b] = down ? 0 : 1; }
+
+/* Advance ms, updating the buttons through the detector each ms */
+void run(MultiControlChords& chords, long ms) {
+  for (long i = 0; i < ms; i++) {
+    hostMicros += 1000;
+    chords.update(MC_MILLIS());
+  }
+}
+
+void setupButtons(MultiControlChords& chords) {
+  for (int i = 0; i < 5; i++) {
+    hostDigital[i] = 1;
+    buttons[i].setPin(i);
+    buttons[i].setControl(2);
+    chords.addButton(&buttons[i]);
+  }
+}
+
+const char* yesNo(bool b) { return b ? "yes" : "no"; }
+
+void checks() {
+  printf("Checks\n");
+  {
+    MultiControlChords chords;
+    setupButtons(chords);
+    int c = chords.addChord(B0, B1, 50);
+    run(chords, 100);
+    press(0, true);
+    run(chords, 30);
+    press(1, true);
+    run(chords, 40);
+    bool close = chords.wasTriggered(c);
+    press(0, false);
+    press(1, false);
+    run(chords, 500);
+    press(0, true);
+    run(chords, 80);
+    press(1, true);
+    run(chords, 40);
+    bool far = chords.wasTriggered(c);
+    printf("  window     30 ms apart fires: %s, 80 ms apart fires: %s\n", yesNo(close), yesNo(far));
+    press(0, false);
+    press(1, false);
+    run(chords, 500);
+  }
+  {
+    MultiControlChords chords;
+    setupButtons(chords);
+    int c = chords.addChord(B0, B1, 200, true);
+    run(chords, 100);
+    press(0, true);
+    run(chords, 40);
+    press(1, true);
+    run(chords, 40);
+    bool inOrder = chords.wasTriggered(c);
+    press(0, false);
+    press(1, false);
+    run(chords, 500);
+    press(1, true);
+    run(chords, 40);
+    press(0, true);
+    run(chords, 40);
+    bool reversed = chords.wasTriggered(c);
+    printf("  order      in order fires: %s, reversed fires: %s\n", yesNo(inOrder), yesNo(reversed));
+    press(0, false);
+    press(1, false);
+    run(chords, 500);
+  }
+  {
+    MultiControlChords chords;
+    setupButtons(chords);
+    int c = chords.addShift(B2, B3);
+    run(chords, 100);
+    press(2, true);
+    run(chords, 70000);
+    press(3, true);
+    run(chords, 40);
+    bool fired = chords.wasTriggered(c);
+    bool active = chords.isActive(c);
+    printf("  shift      held 70 s, then its button fires: %s, active: %s\n", yesNo(fired), yesNo(active));
+    press(2, false);
+    press(3, false);
+    run(chords, 500);
+  }
+  {
+    MultiControlChords chords;
+    setupButtons(chords);
+    int two = chords.addChord(B0, B1, 100);
+    uint8_t m[3] = {B0, B1, B4};
+    int three = chords.addChord(m, 3, 100);
+    run(chords, 100);
+    press(0, true);
+    press(4, true);
+    run(chords, 30);
+    press(1, true);
+    run(chords, 40);
+    bool fired2 = chords.wasTriggered(two), fired3 = chords.wasTriggered(three);
+    press(0, false);
+    press(1, false);
+    press(4, false);
+    run(chords, 500);
+    printf("  largest    2-button fires: %s, 3-button fires: %s\n", yesNo(fired2), yesNo(fired3));
+  }
+  {
+    MultiControlChords chords;
+    setupButtons(chords);
+    chords.addChord(B0, B1, 100);
+    run(chords, 100);
+    press(0, true);
+    run(chords, 20);
+    press(1, true);
+    run(chords, 100);
+    press(0, false);
+    press(1, false);
+    run(chords, 600);
+    bool memberClick = buttons[0].wasSingleClicked() || buttons[1].wasSingleClicked();
+    press(0, true);
+    run(chords, 100);
+    press(0, false);
+    run(chords, 600);
+    bool loneClick = buttons[0].wasSingleClicked();
+    printf("  clicks     chord members click: %s, lone press clicks: %s\n", yesNo(memberClick), yesNo(loneClick));
+    printf("  bad index  wasTriggered(-1): %s, isActive(-1): %s, wasTriggered(99): %s\n",
+           yesNo(chords.wasTriggered(-1)), yesNo(chords.isActive(-1)), yesNo(chords.wasTriggered(99)));
+    // Out of range: must not write past the button state (the guard words below would change)
+    struct { MultiControlChords chords; uint32_t guard[64]; } g = {};
+    for (int i = 0; i < 4; i++) g.chords.addButton(nullptr);
+    g.chords.addChord(B0, B1, 100);
+    for (int i = 0; i < 64; i++) g.guard[i] = 0x5A5A5A5A;
+    g.chords.setPressed(200, true, 1000);
+    g.chords.setPressed(255, true, 1000);
+    bool intact = true;
+    for (int i = 0; i < 64; i++) intact &= g.guard[i] == 0x5A5A5A5A;
+    bool quiet = g.chords.readTriggered() < 0 && !g.chords.isPressed(200) && !g.chords.isChorded(200);
+    printf("             setPressed(200): state intact: %s, no chord or press seen: %s\n", yesNo(intact), yesNo(quiet));
+    printf("  duplicate  addChord(0, 0) returns %d\n", chords.addChord(B0, B0, 100));
+  }
+}
+
+int main() {
+  cost();
+  checks();
+  return 0;
+}
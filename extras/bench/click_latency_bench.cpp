@@ -0,0 +1,146 @@
+/*
+ * click_latency_bench.cpp - host benchmark for speculative single clicks.
+ *
+ * Simulates a button played for ten minutes with single clicks, double-clicks and
+ * holds, with contact bounce on every edge, read once per millisecond. Measures the
+ * time from the finger going down to the first event an app can act on:
+ *   confirmed    wasSingleClicked() / isDoubleClicked(), the usual way
+ *   speculative  wasProvisionalClick() with setSpeculativeClick(true)
+ * and checks the speculative events: every provisional click must end in exactly one
+ * confirmation or one cancel, and every double-click must cancel the click it upgrades.
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. click_latency_bench.cpp -o click_latency_bench && ./click_latency_bench [bounce ms]
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int MS = 600000;
+const uint8_t PIN = 13;
+
+struct Latency {
+  std::vector<int> ms;
+  void add(int v) { ms.push_back(v); }
+  void print(const char* name) {
+    std::sort(ms.begin(), ms.end());
+    double sum = 0;
+    for (int v : ms) sum += v;
+    printf("  %-12s mean %5.1f ms  median %4d ms  p95 %4d ms  (%zu clicks)\n", name, sum / ms.size(),
+           ms[ms.size() / 2], ms[ms.size() * 95 / 100], ms.size());
+  }
+};
+
+int main(int argc, char** argv) {
+  int bounceMs = argc > 1 ? atoi(argv[1]) : 3;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+
+  // The player's finger: a list of press intervals
+  struct Press { int down, up; };
+  std::vector<Press> presses;
+  std::vector<int> clickStart;  // first press of each single or double click
+  int singles = 0, doubles = 0;
+  for (int t = 500; t < MS - 2000;) {
+    double r = u(rng);
+    clickStart.push_back(t);
+    if (r < 0.6) {
+      presses.push_back({t, t + 60 + (int)(u(rng) * 80)});
+      singles++;
+    } else if (r < 0.85) {
+      int up = t + 50 + (int)(u(rng) * 50);
+      int down2 = up + 60 + (int)(u(rng) * 80);
+      presses.push_back({t, up});
+      presses.push_back({down2, down2 + 60 + (int)(u(rng) * 50)});
+      doubles++;
+    } else {
+      presses.push_back({t, t + 600 + (int)(u(rng) * 800)});  // a hold, still a single click
+      singles++;
+    }
+    t = presses.back().up + 500 + (int)(u(rng) * 1500);
+  }
+
+  /* Contact level at time t: closed during a press, chattering for bounceMs after each edge */
+  auto level = [&](int t, size_t& p) {
+    while (p < presses.size() && presses[p].up + bounceMs <= t) p++;
+    if (p >= presses.size()) return 1;
+    const Press& pr = presses[p];
+    if (t >= pr.down && t < pr.down + bounceMs) return (int)(rng() & 1);
+    if (t >= pr.up && t < pr.up + bounceMs) return (int)(rng() & 1);
+    return (t >= pr.down && t < pr.up) ? 0 : 1;
+  };
+
+  MultiControl confirmed, speculative;
+  confirmed.setPin(PIN);
+  confirmed.setControl(2);
+  speculative.setPin(PIN);
+  speculative.setControl(2);
+  speculative.setSpeculativeClick(true);
+
+  Latency confirmedLat, speculativeLat;
+  size_t p = 0, nextClick = 0, clickIndex = 0;
+  int open = -1;            // start of the click waiting for its confirmed event
+  int openSpec = -1;        // start of the click waiting for its speculative event
+  int provisional = 0, confirms = 0, cancels = 0, doubleEvents = 0, unresolved = 0, badCancels = 0;
+  bool outstanding = false;  // a provisional click has not been confirmed or cancelled yet
+  for (int t = 0; t < MS; t++) {
+    hostMicros = (unsigned long)t * 1000;
+    while (nextClick < clickStart.size() && clickStart[nextClick] <= t) {
+      open = openSpec = clickStart[nextClick++];
+      clickIndex++;
+    }
+    hostDigital[PIN] = level(t, p);
+    confirmed.readButton();
+    speculative.readButton();
+
+    bool single = confirmed.wasSingleClicked();
+    bool dbl = confirmed.isDoubleClicked();
+    if ((single || dbl) && open >= 0) {
+      confirmedLat.add(t - open);
+      open = -1;
+    }
+
+    if (speculative.wasProvisionalClick()) {
+      if (outstanding) unresolved++;
+      outstanding = true;
+      provisional++;
+      if (openSpec >= 0) {
+        speculativeLat.add(t - openSpec);
+        openSpec = -1;
+      }
+    }
+    bool cancelled = speculative.wasClickCancelled();
+    bool specDouble = speculative.isDoubleClicked();
+    if (cancelled) {
+      cancels++;
+      if (!outstanding || !specDouble) badCancels++;
+      outstanding = false;
+    }
+    if (specDouble) {
+      doubleEvents++;
+      if (!cancelled) badCancels++;
+    }
+    if (speculative.wasSingleClicked()) {
+      confirms++;
+      if (!outstanding) unresolved++;
+      outstanding = false;
+    }
+  }
+
+  printf("%d singles (some held) and %d double-clicks, %d ms bounce, 350 ms double-click window\n",
+         singles, doubles, bounceMs);
+  printf("press to first actionable event:\n");
+  confirmedLat.print("confirmed");
+  speculativeLat.print("speculative");
+  printf("speculative events: %d provisional, %d confirmed, %d cancelled, %d double-clicks\n",
+         provisional, confirms, cancels, doubleEvents);
+  printf("  %d provisional clicks without exactly one outcome, %d cancels not paired with a double-click\n",
+         unresolved, badCancels);
+  return unresolved || badCancels;
+}
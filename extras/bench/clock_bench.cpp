@@ -0,0 +1,188 @@
+/*
+ * clock_bench.cpp - host benchmark for one timestamp per scan (read(now) and the other
+ * timestamped read functions).
+ *
+ * A 64-control panel (16 touch pads, 16 buttons, 8 mux buttons, 12 encoders with push
+ * buttons and acceleration, 8 pots, 4 switches) and a chord panel of 8 more buttons with
+ * 4 chords (MultiControlChords, which reads its members) are played for 10 s: pads touched,
+ * buttons and encoder buttons pressed, encoders turned. Each 1 ms scan starts anywhere in
+ * its ms and reads every control with
+ *   per read   read() on each control and isPressed() on each chord member: each read takes
+ *              the clock
+ *   per scan   one millis() per scan, then read(now) on each control and chords.update(now)
+ * and reports:
+ *   clock      millis() calls per scan
+ *   cost       host ns and cycles per scan (the pots' and mux settling delays are virtual
+ *              on the host, so this is the library's own work)
+ *   skew       scans in which controls saw different ms values (the mux and pot settling
+ *              delays let the clock tick mid-scan)
+ *   events     gesture events and chords reported, identical in both modes when the clock agrees
+ *
+ * Per read is also what every scan cost before the timestamped reads (a touch pad took the
+ * clock up to three times per read, on a touch or release).
+ *
+ * Build and run:
+ *   g++ -O2 -DESP32 -DCONFIG_IDF_TARGET_ESP32S3 -I../replay -I../.. clock_bench.cpp -o clock_bench && ./clock_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#else
+#define CYCLES() 0ULL
+#endif
+
+// Count the library's clock reads (MC_MILLIS() is millis())
+long clockCalls = 0;
+unsigned long scanFirstMs, scanLastMs;
+inline unsigned long countedMillis() {
+  unsigned long ms = millis();
+  if (clockCalls++ == 0 || ms < scanFirstMs) scanFirstMs = ms;
+  scanLastMs = ms;
+  return ms;
+}
+#define millis() countedMillis()
+
+#include "MultiControl.h"
+#include "MultiControlChord.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int CONTROLS = 64;
+const long MS = 10000;
+
+MultiControl panel[CONTROLS];
+const int CHORD_BUTTONS = 8;
+MultiControl chordButtons[CHORD_BUTTONS];  // on pins 16-23, as buttons 0-7 of the panel
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void setupPanel() {
+  int k = 0;
+  for (int i = 0; i < 16; i++, k++) {
+    panel[k].setPin(k);
+    panel[k].setControl(0);
+  }
+  for (int i = 0; i < 16; i++, k++) {
+    panel[k].setPin(k);
+    panel[k].setControl(2);
+  }
+  for (int i = 0; i < 8; i++, k++) {
+    panel[k].setPin(40);
+    panel[k].setMuxControlPins(41, 42, 43);
+    panel[k].setMuxChannel(i);
+    panel[k].setControl(4);
+  }
+  for (int i = 0; i < 12; i++, k++) {
+    panel[k].setEncoderPins(44 + i, 56 + (i & 7), 32 + i);
+    panel[k].setEncoderAccel(4.0f, 40);
+  }
+  for (int i = 0; i < 8; i++, k++) {
+    panel[k].setPin(i);
+    panel[k].setControl(1);
+  }
+  for (int i = 0; i < 4; i++, k++) {
+    panel[k].setPin(60 + i);
+    panel[k].setControl(3);
+  }
+}
+
+/* The player: sets the pins for time t */
+struct Player {
+  std::mt19937 rng{7};
+  long pressEnd[CONTROLS] = {};
+  void step(long t) {
+    for (int i = 0; i < 16; i++) {
+      if (t >= pressEnd[i] + 300 && rng() % 2000 == 0) pressEnd[i] = t + 80 + rng() % 400;
+      hostTouch[i] = (uint32_t)((400 + (t < pressEnd[i] ? 150 : 0) + (int)(rng() % 3)) << 8);
+    }
+    // Buttons on pins 16-39 (mux reads pin 40 for all its channels)
+    for (int i = 16; i < 40; i++) {
+      if (t >= pressEnd[i] + 200 && rng() % 1500 == 0) pressEnd[i] = t + 40 + rng() % 900;
+      hostDigital[i] = t < pressEnd[i] ? 0 : 1;
+    }
+    hostDigital[40] = hostDigital[16 + (t / 50) % 16];
+    // Encoder A lines: a detent every few ms in bursts
+    for (int i = 0; i < 12; i++) {
+      if ((t / 1000 + i) % 3 == 0 && t % (4 + i) == 0) hostDigital[44 + i] ^= 1;
+    }
+    for (int i = 0; i < 8; i++) hostAnalog[i] = 1000 + i * 300 + (int)(rng() % 9);
+  }
+};
+
+struct Result {
+  double calls, ns, cycles;
+  long skewed, events;
+};
+
+void setupChords(MultiControlChords& chords) {
+  for (int i = 0; i < CHORD_BUTTONS; i++) {
+    chordButtons[i].setPin(16 + i);
+    chordButtons[i].setControl(2);
+    chords.addButton(&chordButtons[i]);
+  }
+  for (uint8_t i = 0; i < CHORD_BUTTONS; i += 2) chords.addChord(i, (uint8_t)(i + 1), 150);
+}
+
+Result run(bool perScan) {
+  setupPanel();
+  MultiControlChords chords;
+  setupChords(chords);
+  Player player;
+  hostMicros = 0;
+  Result r = {0, 0, 0, 0, 0};
+  double total = 0;
+  unsigned long long cycles = 0;
+  long calls = 0;
+  for (long t = 0; t < MS; t++) {
+    player.step(t);
+    hostMicros = t * 1000 + player.rng() % 1000;  // anywhere in the ms, as a loop would be
+    clockCalls = 0;
+    double t0 = seconds();
+    unsigned long long c0 = CYCLES();
+    if (perScan) {
+      unsigned long now = millis();
+      for (int i = 0; i < CONTROLS; i++) panel[i].read(now);
+      chords.update(now);
+    } else {
+      for (int i = 0; i < CONTROLS; i++) panel[i].read();
+      // What MultiControlChords::update() did before it took one timestamp for its members
+      unsigned long chordNow = millis();
+      for (int i = 0; i < CHORD_BUTTONS; i++) chords.setPressed(i, chordButtons[i].isPressed(), chordNow);
+    }
+    cycles += CYCLES() - c0;
+    total += seconds() - t0;
+    calls += clockCalls;
+    r.skewed += clockCalls > 0 && scanLastMs != scanFirstMs;
+    for (int i = 0; i < CONTROLS; i++) r.events += __builtin_popcount(panel[i].takeGestureEvents());
+    for (int i = 0; i < CHORD_BUTTONS; i++) r.events += __builtin_popcount(chordButtons[i].takeGestureEvents());
+    while (chords.readTriggered() >= 0) r.events++;
+  }
+  r.calls = (double)calls / MS;
+  r.ns = total * 1e9 / MS;
+  r.cycles = (double)cycles / MS;
+  return r;
+}
+
+int main() {
+  printf("64-control scan and %d chord buttons, 1 ms scans for %ld s\n", CHORD_BUTTONS, MS / 1000);
+  printf("  mode        clock calls/scan   ns/scan   cycles/scan   skewed scans   gesture events\n");
+  for (bool perScan : {false, true}) {
+    Result best = run(perScan);
+    for (int rep = 0; rep < 4; rep++) {
+      Result r = run(perScan);
+      if (r.ns < best.ns) best = r;
+    }
+    printf("  %-9s   %10.1f       %7.0f   %9.0f     %8ld       %8ld\n", perScan ? "per scan" : "per read", best.calls,
+           best.ns, best.cycles, best.skewed, best.events);
+  }
+  return 0;
+}
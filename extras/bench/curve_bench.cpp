@@ -0,0 +1,106 @@
+/*
+ * curve_bench.cpp - host benchmark for MultiControlCurve (response-curve tables).
+ *
+ * For a volume taper, a cutoff frequency, an S-curve, a log curve, a curve through
+ * breakpoints and a touch pad normalised to its full-press value, compares what sketches
+ * do per read (float math with powf() / expf() on the value) with the table lookup, and
+ * reports:
+ *   ns/read    host time per value, over a mix of pot values
+ *   max error  largest difference from the float curve (rounded) over every input, in
+ *              output units (Hz for the cutoff)
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. curve_bench.cpp -o curve_bench && ./curve_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <random>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int VALUES = 4096;
+const int REPEAT = 500;
+int values[VALUES];
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct Case {
+  const char* name;
+  MultiControlCurve curve;
+  int inMax;                  // full-scale value (setCurve() inMax)
+  float (*sketch)(int v);     // what a sketch computes per read
+};
+
+// Per-read float versions, as sketches write them
+float volume(int v) { return 1023.0f * powf(v / 1023.0f, 2.5f); }
+float cutoff(int v) { return 20.0f * powf(1000.0f, v / 1023.0f); }
+float sCurve(int v) { return 1023.0f * (0.5f + 0.5f * tanhf(6.0f * (v / 1023.0f - 0.5f)) / tanhf(3.0f)); }
+float logCurve(int v) { return 127.0f * logf(1.0f + (expf(4.0f) - 1.0f) * (v / 1023.0f)) / 4.0f; }
+float pressure(int v) { return 1023.0f * powf(min(1.0f, v / 400.0f), 0.6f); }
+
+// A dead zone, a slow first half and a fast second half
+const int16_t KNEE_IN[] = {0, 40, 600, 1023};
+const uint16_t KNEE_OUT[] = {0, 0, 200, 1023};
+float knee(int v) {
+  int k = v <= KNEE_IN[1] ? 0 : v <= KNEE_IN[2] ? 1 : 2;
+  float t = (float)(v - KNEE_IN[k]) / (KNEE_IN[k + 1] - KNEE_IN[k]);
+  return KNEE_OUT[k] + t * (KNEE_OUT[k + 1] - KNEE_OUT[k]);
+}
+
+template <typename F>
+double timeLoop(F f) {
+  volatile unsigned sink = 0;
+  double t0 = seconds();
+  for (int r = 0; r < REPEAT; r++) {
+    unsigned acc = 0;
+    for (int i = 0; i < VALUES; i++) acc += f(values[i]);
+    sink += acc;
+  }
+  return (seconds() - t0) * 1e9 / ((double)REPEAT * VALUES);
+}
+
+int main() {
+  std::mt19937 rng(5);
+  for (int i = 0; i < VALUES; i++) values[i] = rng() % 1024;
+
+  Case cases[] = {
+    {"volume (x^2.5)", MultiControlCurve(MC_CURVE_POWER, 2.5f), 1023, volume},
+    {"cutoff 20-20000 Hz", MultiControlCurve(MC_CURVE_RATIO, 0.0f, 20, 20000), 1023, cutoff},
+    {"S-curve", MultiControlCurve(MC_CURVE_S, 6.0f), 1023, sCurve},
+    {"log to MIDI 0-127", MultiControlCurve(MC_CURVE_LOG, 4.0f, 0, 127), 1023, logCurve},
+    {"breakpoints", MultiControlCurve(), 1023, knee},
+    {"touch pad, full at 400", MultiControlCurve(MC_CURVE_POWER, 0.6f), 400, pressure},
+  };
+  cases[4].curve.build(KNEE_IN, KNEE_OUT, 4);
+
+  MultiControl control;
+  control.setControl(1);
+  printf("Response curves, %d-point tables (%d bytes each)\n", MULTICONTROL_CURVE_POINTS,
+         (int)sizeof(uint16_t) * MULTICONTROL_CURVE_POINTS);
+  printf("  curve                    float ns/read   table ns/read   getCurvedValue() ns   max error\n");
+  for (Case& c : cases) {
+    control.setCurve(&c.curve, 0, c.inMax);
+    double sketch = timeLoop([&](int v) { return (int)(c.sketch(v) + 0.5f); });
+    double table = timeLoop([&](int v) { return c.curve.map(v); });
+    double full = timeLoop([&](int v) {
+      control.setValue(v);
+      return control.getCurvedValue();
+    });
+    double worst = 0;
+    for (int v = 0; v <= 1023; v++) {
+      control.setValue(v);
+      double ref = (int)(c.sketch(v) + 0.5f), got = control.getCurvedValue();
+      worst = max(worst, fabs(got - ref));
+    }
+    printf("  %-24s %9.2f       %9.2f       %9.2f             %.0f\n", c.name, sketch, table, full, worst);
+  }
+  return 0;
+}
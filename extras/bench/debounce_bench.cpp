@@ -0,0 +1,222 @@
+/*
+ * debounce_bench.cpp - host benchmark for the button debounce modes.
+ *
+ * Plays ten minutes of presses on a simulated button and reads it once per millisecond.
+ * Every press and release bounces with a pattern taken at random from a table of switch
+ * traces (edge times after the first contact, from clean tactile switches to worn ones
+ * that chatter for over 20 ms), some taps are fast, and electrical noise adds short
+ * spikes while the button is up. For each debounce setting it reports:
+ *   latency    finger down (or up) to the debounced press (or release)
+ *   false      press events that are not a real press: bounce retriggers and noise
+ *   early      releases reported while the finger is still down
+ *   missed     real presses never reported
+ *   clicks     clicks reported (single or double) against the clicks played, after
+ *              glitch rejection withdrew what it caught
+ * and one check: a real click, then a noise spike inside its double-click window, with a
+ * min press time (eager mode). The spike is rejected as a glitch and must not make a
+ * double-click; the first click is confirmed as a single click when its window ends.
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. debounce_bench.cpp -o debounce_bench && ./debounce_bench [spikes per minute]
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const long MS = 600000;
+const uint8_t PIN = 13;
+
+/* Contact toggle times in microseconds after the first edge: the contact takes the new
+ * level at 0, then flips at each following time (an odd count, so it ends at the new level) */
+struct BouncePattern {
+  const char* name;
+  std::vector<uint32_t> press, release;
+};
+const BouncePattern PATTERNS[] = {
+  {"clean tactile", {0}, {0}},
+  {"tactile", {0, 120, 310, 540, 900}, {0, 80, 200}},
+  {"mechanical key", {0, 400, 900, 1500, 2600, 3100, 4800}, {0, 300, 1100}},
+  {"microswitch", {0, 50, 110, 180, 260}, {0, 1200, 1900}},
+  {"worn tactile", {0, 2000, 3500, 7000, 9000, 14000, 16500}, {0, 5000, 8000, 12000, 13000}},
+  {"worn, long chatter", {0, 4000, 9000, 18000, 24000}, {0, 9000, 22000}},
+};
+const int NUM_PATTERNS = sizeof(PATTERNS) / sizeof(PATTERNS[0]);
+
+struct Press {
+  long down, up;  // ms
+  bool second;    // second press of a double-click
+};
+
+struct Result {
+  std::vector<int> pressLatency, releaseLatency;
+  int pressEvents = 0, falsePresses = 0, earlyReleases = 0, missed = 0, clicks = 0, glitches = 0;
+};
+
+int percentile(std::vector<int>& v, int p) {
+  std::sort(v.begin(), v.end());
+  return v.empty() ? 0 : v[std::min(v.size() - 1, v.size() * p / 100)];
+}
+
+double mean(const std::vector<int>& v) {
+  double sum = 0;
+  for (int x : v) sum += x;
+  return v.empty() ? 0 : sum / v.size();
+}
+
+Result run(const std::vector<Press>& presses, const std::vector<std::pair<long, int>>& edges,
+           uint8_t mode, uint16_t debounceMs, uint16_t minPressMs) {
+  MultiControl button;
+  button.setPin(PIN);
+  hostDigital[PIN] = 1;
+  hostMicros = 0;
+  button.setControl(2);
+  button.setDebounceMode(mode);
+  button.setDebounceTime(debounceMs);
+  button.setMinPressTime(minPressMs);
+  Result r;
+  std::vector<uint8_t> hit(presses.size(), 0);
+  size_t e = 0, p = 0;
+  int level = 1;
+  bool down = false;
+  long downAt = 0;
+  for (long t = 0; t < MS; t++) {
+    hostMicros = (unsigned long)t * 1000;
+    while (e < edges.size() && edges[e].first <= (long)hostMicros) level = edges[e++].second;
+    hostDigital[PIN] = level;
+    button.readButton();
+    uint8_t events = button.takeGestureEvents();
+    while (p + 1 < presses.size() && presses[p].up + 100 < t) p++;
+    if (events & MC_GESTURE_PRESS) {
+      r.pressEvents++;
+      // A real press if the finger went down since the previous report and is still near
+      size_t i = p;
+      while (i < presses.size() && presses[i].down <= t && !(t <= presses[i].up + 30 && !hit[i])) i++;
+      if (i < presses.size() && presses[i].down <= t && t <= presses[i].up + 30 && !hit[i]) {
+        hit[i] = 1;
+        r.pressLatency.push_back(t - presses[i].down);
+        down = true;
+        downAt = i;
+      } else {
+        r.falsePresses++;
+      }
+    }
+    if ((events & MC_GESTURE_RELEASE) && down) {
+      if (t < presses[downAt].up) r.earlyReleases++;  // chatter outlasted the debounce
+      else r.releaseLatency.push_back(t - presses[downAt].up);
+      down = false;
+    }
+    if (button.wasSingleClicked()) r.clicks++;
+    if (button.isDoubleClicked()) r.clicks++;
+    if (button.wasGlitch()) r.glitches++;
+  }
+  for (uint8_t h : hit) r.missed += !h;
+  return r;
+}
+
+/* A 60 ms click, then a 3 ms spike 90 ms after its release; counts the gestures reported */
+void spikeAfterClick(bool speculative) {
+  MultiControl button;
+  button.setPin(PIN);
+  hostDigital[PIN] = 1;
+  hostMicros = 0;
+  button.setControl(2);
+  button.setDebounceMode(MC_DEBOUNCE_EAGER);
+  button.setDebounceTime(20);
+  button.setMinPressTime(25);
+  button.setSpeculativeClick(speculative);
+  int doubles = 0, glitches = 0, singles = 0, cancels = 0;
+  for (long t = 0; t < 1000; t++) {
+    hostMicros = (unsigned long)t * 1000;
+    hostDigital[PIN] = (t >= 100 && t < 160) || (t >= 250 && t < 253) ? 0 : 1;
+    button.readButton();
+    cancels += (button.takeGestureEvents() & MC_GESTURE_CANCEL) != 0;
+    doubles += button.isDoubleClicked();
+    glitches += button.wasGlitch();
+    singles += button.wasSingleClicked();
+  }
+  printf("  click then spike, %-12s double=%d glitch=%d single=%d cancel=%d (expected 0 1 1 0)\n",
+         speculative ? "speculative" : "eager", doubles, glitches, singles, cancels);
+}
+
+int main(int argc, char** argv) {
+  double spikesPerMinute = argc > 1 ? atof(argv[1]) : 6;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+
+  // The player: single taps (some fast), double-clicks and holds
+  std::vector<Press> presses;
+  int clicksPlayed = 0;
+  for (long t = 500; t < MS - 3000;) {
+    double r = u(rng);
+    if (r < 0.5) {
+      presses.push_back({t, t + 60 + (long)(u(rng) * 90), false});
+    } else if (r < 0.7) {
+      presses.push_back({t, t + 30 + (long)(u(rng) * 15), false});  // fast tap
+    } else if (r < 0.9) {
+      long up = t + 45 + (long)(u(rng) * 40);
+      presses.push_back({t, up, false});
+      long down2 = up + 60 + (long)(u(rng) * 80);
+      presses.push_back({down2, down2 + 50 + (long)(u(rng) * 50), true});
+    } else {
+      presses.push_back({t, t + 700 + (long)(u(rng) * 600), false});
+    }
+    clicksPlayed++;
+    t = presses.back().up + 600 + (long)(u(rng) * 1400);
+  }
+
+  // Contact edges in microseconds: bounce patterns on every press and release, noise spikes between
+  std::vector<std::pair<long, int>> edges;
+  for (const Press& pr : presses) {
+    const BouncePattern& pd = PATTERNS[rng() % NUM_PATTERNS];
+    const BouncePattern& pu = PATTERNS[rng() % NUM_PATTERNS];
+    long offset = rng() % 1000;  // not aligned to the scan
+    for (size_t k = 0; k < pd.press.size(); k++) edges.push_back({pr.down * 1000 + offset + pd.press[k], k % 2 == 0 ? 0 : 1});
+    for (size_t k = 0; k < pu.release.size(); k++) edges.push_back({pr.up * 1000 + offset + pu.release[k], k % 2 == 0 ? 1 : 0});
+  }
+  int spikes = 0;
+  size_t q = 0;
+  for (long t = 0; t < MS; t++) {
+    if (u(rng) >= spikesPerMinute / 60000.0) continue;
+    while (q < presses.size() && presses[q].up + 200 < t) q++;
+    if (q < presses.size() && t + 200 > presses[q].down) continue;  // only while the button is up
+    long at = t * 1000 + rng() % 1000;
+    long width = 200 + rng() % 2800;  // 0.2 to 3 ms
+    edges.push_back({at, 0});
+    edges.push_back({at + width, 1});
+    spikes++;
+  }
+  std::stable_sort(edges.begin(), edges.end(), [](const std::pair<long, int>& a, const std::pair<long, int>& b) {
+    return a.first < b.first;
+  });
+
+  printf("%zu presses (%d clicks), %d noise spikes, %d bounce patterns, scanned every 1 ms\n",
+         presses.size(), clicksPlayed, spikes, NUM_PATTERNS);
+  printf("                              press latency     release latency   false   early    missed  clicks    glitches\n");
+  printf("                              mean   p95  max   mean   p95  max   presses releases presses\n");
+  struct Setting { const char* name; uint8_t mode; uint16_t debounce, minPress; };
+  const Setting settings[] = {
+    {"stable 20 ms", MC_DEBOUNCE_STABLE, 20, 0},
+    {"stable 5 ms", MC_DEBOUNCE_STABLE, 5, 0},
+    {"eager 20 ms lockout", MC_DEBOUNCE_EAGER, 20, 0},
+    {"eager 20 ms + 25 ms min press", MC_DEBOUNCE_EAGER, 20, 25},
+    {"eager 30 ms lockout", MC_DEBOUNCE_EAGER, 30, 0},
+    {"eager 30 ms + 35 ms min press", MC_DEBOUNCE_EAGER, 30, 35},
+  };
+  for (const Setting& s : settings) {
+    Result r = run(presses, edges, s.mode, s.debounce, s.minPress);
+    printf("  %-28s %5.1f %4d %4d  %5.1f %4d %4d  %6d  %7d  %6d  %4d/%d  %4d\n", s.name,
+           mean(r.pressLatency), percentile(r.pressLatency, 95), percentile(r.pressLatency, 100),
+           mean(r.releaseLatency), percentile(r.releaseLatency, 95), percentile(r.releaseLatency, 100),
+           r.falsePresses, r.earlyReleases, r.missed, r.clicks, clicksPlayed, r.glitches);
+  }
+  printf("\n");
+  spikeAfterClick(false);
+  spikeAfterClick(true);
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * encoder_bench.cpp - host benchmark for MultiControlEncoders against readEncoder().
+ *
+ * Turns 4, 16 and 32 simulated encoders at random (with contact bounce and the odd
+ * missed step), and decodes them both ways: one readEncoder() per encoder, and one
+ * MultiControlEncoders::update() per scan from a port snapshot. Reports the time per
+ * scan for each and checks that every encoder ends at the same position.
+ * Host timings only show the decode cost; on the ESP32 each digitalRead() adds more.
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. encoder_bench.cpp -o encoder_bench && ./encoder_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlEncoders.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int SCANS = 2000000;
+static const uint8_t GRAY[4] = {0, 1, 3, 2};  // A << 1 | B, forward order
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Encoder i uses pins 2i (A) and 2i+1 (B). Precompute the input for every scan. */
+std::vector<uint64_t> makeInput(int n, double moveChance) {
+  std::mt19937 rng(n);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::vector<uint64_t> scans(SCANS);
+  std::vector<int> phase(n, 0);
+  uint64_t levels = 0;
+  for (int i = 0; i < n; i++) levels |= 3ULL << (2 * i);  // detent rest state 11 = phase 2
+  for (int i = 0; i < n; i++) phase[i] = 2;
+  for (int s = 0; s < SCANS; s++) {
+    for (int i = 0; i < n; i++) {
+      double r = u(rng);
+      if (r < moveChance) {
+        int dir = (rng() & 1) ? 1 : -1;
+        int steps = (u(rng) < 0.02) ? 2 : 1;  // occasionally miss a step (both lines change)
+        phase[i] = (phase[i] + dir * steps + 4) & 3;
+      } else if (r < moveChance * 1.3) {
+        // Bounce: one line flickers back and forth across two scans is covered by moves above
+        phase[i] = (phase[i] + ((rng() & 1) ? 1 : 3)) & 3;
+      }
+      uint8_t g = GRAY[phase[i]];
+      levels = (levels & ~(3ULL << (2 * i))) | ((uint64_t)(((g >> 1) & 1) | ((g & 1) << 1)) << (2 * i));
+    }
+    scans[s] = levels;
+  }
+  return scans;
+}
+
+void setupEncoders(std::vector<MultiControl>& enc, int n) {
+  for (int i = 0; i < n; i++) {
+    hostDigital[2 * i] = 1;
+    hostDigital[2 * i + 1] = 1;
+    enc[i].setEncoderPins(2 * i, 2 * i + 1);
+    enc[i].setEncoderRange(-1000000, 1000000);
+    if (i & 1) enc[i].setEncoderAccel(4.0f, 100);
+  }
+}
+
+int main() {
+  printf("encoders  readEncoder() ns/scan  MultiControlEncoders ns/scan  speedup  positions\n");
+  const int counts[] = {4, 16, 32};
+  for (int n : counts) {
+    std::vector<uint64_t> scans = makeInput(n, 0.05);
+
+    std::vector<MultiControl> perObject(n);
+    setupEncoders(perObject, n);
+    hostMicros = 0;
+    double t0 = seconds();
+    for (int s = 0; s < SCANS; s++) {
+      uint64_t levels = scans[s];
+      for (int p = 0; p < 2 * n; p++) hostDigital[p] = (levels >> p) & 1;
+      hostMicros += 1000;
+      for (int i = 0; i < n; i++) perObject[i].readEncoder();
+    }
+    double t1 = seconds();
+    // Subtract the cost of writing the simulated pin levels
+    for (int s = 0; s < SCANS; s++) {
+      uint64_t levels = scans[s];
+      for (int p = 0; p < 2 * n; p++) hostDigital[p] = (levels >> p) & 1;
+      hostMicros += 1000;
+      __asm__ volatile("" ::: "memory");
+    }
+    double t2 = seconds();
+
+    for (int p = 0; p < 2 * n; p++) hostDigital[p] = 1;
+    std::vector<MultiControl> sliced(n);
+    setupEncoders(sliced, n);
+    MultiControlEncoders bank;
+    for (int i = 0; i < n; i++) bank.addEncoder(&sliced[i]);
+    hostMicros = 0;
+    bank.update(scans[0] | ~0ULL, 0);  // starting state: all lines high, as set up above
+    double t3 = seconds();
+    for (int s = 0; s < SCANS; s++) {
+      hostMicros += 1000;
+      bank.update(scans[s], hostMicros / 1000);
+    }
+    double t4 = seconds();
+
+    int same = 0;
+    for (int i = 0; i < n; i++) same += perObject[i].getEncoderPosition() == sliced[i].getEncoderPosition();
+    double perObjectNs = ((t1 - t0) - (t2 - t1)) * 1e9 / SCANS;
+    double slicedNs = (t4 - t3) * 1e9 / SCANS;
+    printf("%8d  %22.1f  %28.1f  %6.1fx  %d/%d match\n", n, perObjectNs, slicedNs, perObjectNs / slicedNs, same, n);
+  }
+  return 0;
+}
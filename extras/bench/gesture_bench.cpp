@@ -0,0 +1,223 @@
+/*
+ * gesture_bench.cpp - host regression test for the shared button gesture engine
+ * (updateGesture(), used by readButton(), readMuxButton() and readEncoderButton()).
+ *
+ * LegacyButton below is the debounce, click, double-click, hold and long-press logic each
+ * reader had its own copy of before the engine was shared. A button, a mux button and an
+ * encoder push button are pressed with random bouncy presses (taps, double taps, holds,
+ * long presses up to a minute), and each is fed to the library reader and to a
+ * LegacyButton on the same clock. Every scan polls a random subset of the accessors on both
+ * (isDoubleClicked(), wasSingleClicked(), isHeld(), wasHeld(), wasDoubleClicked(),
+ * wasLongPressed(), isLongPressed(), isClickPending(), getLastPressDuration(), and the
+ * pressed state). Reports:
+ *   scans       scans compared, and the events seen
+ *   mismatches  scans where any polled result differs (0 expected; presses over 61 s are
+ *               left out, as the engine saturates their duration at 65535 ms)
+ *   size        bytes of gesture state per control: the legacy fields against the engine's
+ *               16-bit times and bitfields (getGestureStateSize())
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. gesture_bench.cpp -o gesture_bench && ./gesture_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+struct LegacySettings {
+  unsigned long _debounceTime = 20;
+  unsigned long _doubleClickTime = 350;
+  unsigned long _holdTime = 500;
+  unsigned long _longPressTime = 1000;
+};
+
+/* The per-reader gesture logic before the shared engine */
+struct LegacyButton : LegacySettings {
+  int8_t _buttonValue = 0;
+  unsigned long _prevPressTime = 0;
+  unsigned long _lastReleaseTime = 0;
+  bool _doubleClicked = false;
+  bool _wasDoubleClicked = false;
+  bool _singleClicked = false;
+  bool _clickPending = false;
+  unsigned long _lastPressDuration = 0;
+  unsigned long _pressStartTime = 0;
+  bool _held = false;
+  bool _holdTriggered = false;
+  bool _wasHeldOnRelease = false;
+  bool _wasLongPressedOnRelease = false;
+  bool _holdActionOccurred = false;
+  bool _hadHoldAction = false;
+  bool _longPressed = false;
+  unsigned long _lastButtonChangeTime = 0;
+  int8_t _rawButtonState = 1;
+  int8_t _debouncedButtonState = 1;
+
+  int read(int rawVal, unsigned long now) {
+    if (rawVal != _rawButtonState) {
+      _lastButtonChangeTime = now;
+      _rawButtonState = rawVal;
+    }
+    int val = _debouncedButtonState;
+    if ((now - _lastButtonChangeTime) >= _debounceTime) {
+      if (_rawButtonState != _debouncedButtonState) {
+        _debouncedButtonState = _rawButtonState;
+        val = _debouncedButtonState;
+      }
+    }
+    if (val == 0 && _buttonValue == false) {
+      _buttonValue = true;
+      _singleClicked = false;
+      _wasDoubleClicked = false;
+      _wasLongPressedOnRelease = false;
+      _lastPressDuration = 0;
+      if (_prevPressTime > 0 && (now - _prevPressTime) < _doubleClickTime) {
+        _doubleClicked = true;
+        _wasDoubleClicked = true;
+        _clickPending = false;
+        _prevPressTime = 0;
+      } else {
+        _clickPending = true;
+        _prevPressTime = now;
+      }
+      _pressStartTime = now;
+      _holdTriggered = false;
+      _held = false;
+      _wasHeldOnRelease = false;
+      _holdActionOccurred = false;
+      _hadHoldAction = false;
+    }
+    if (val == 1 && _buttonValue == true) {
+      _buttonValue = false;
+      _lastReleaseTime = now;
+      _wasHeldOnRelease = _holdTriggered;
+      _hadHoldAction = _holdActionOccurred;
+      _lastPressDuration = now - _pressStartTime;
+      _wasLongPressedOnRelease = _lastPressDuration >= _longPressTime;
+      _holdTriggered = false;
+      _held = false;
+      _holdActionOccurred = false;
+      _longPressed = false;
+    }
+    if (_buttonValue && !_holdTriggered && (now - _pressStartTime >= _holdTime)) {
+      _held = true;
+      _holdTriggered = true;
+    }
+    if (_buttonValue && (now - _pressStartTime >= _longPressTime)) _longPressed = true;
+    if (_clickPending && !_buttonValue && (now - _prevPressTime) >= _doubleClickTime) {
+      _singleClicked = true;
+      _clickPending = false;
+      _prevPressTime = 0;
+    }
+    return val;
+  }
+
+  bool isDoubleClicked() { bool r = _doubleClicked; _doubleClicked = false; return r; }
+  bool wasDoubleClicked() { bool r = _wasDoubleClicked; _wasDoubleClicked = false; return r; }
+  bool wasSingleClicked() { bool r = _singleClicked; _singleClicked = false; return r; }
+  bool isClickPending() { return _clickPending; }
+  bool isHeld() { bool r = _held; _held = false; return r; }
+  bool isLongPressed() { return _longPressed; }
+  bool wasLongPressed() { bool r = _wasLongPressedOnRelease; _wasLongPressedOnRelease = false; return r; }
+  bool wasHeld() { return _wasHeldOnRelease; }
+  unsigned long getLastPressDuration() { return _lastPressDuration; }
+};
+
+/* Poll the accessors picked by mask and describe the results */
+template <typename B>
+std::string poll(B& b, unsigned mask, bool pressed) {
+  char s[160];
+  int n = sprintf(s, "p%d lp%d cp%d d%lu", (int)pressed, (int)b.isLongPressed(), (int)b.isClickPending(),
+                  b.getLastPressDuration());
+  if (mask & 1) n += sprintf(s + n, " dc%d", (int)b.isDoubleClicked());
+  if (mask & 2) n += sprintf(s + n, " sc%d", (int)b.wasSingleClicked());
+  if (mask & 4) n += sprintf(s + n, " h%d wh%d", (int)b.isHeld(), (int)b.wasHeld());
+  if (mask & 8) n += sprintf(s + n, " wdc%d wlp%d", (int)b.wasDoubleClicked(), (int)b.wasLongPressed());
+  return s;
+}
+
+const long MS = 400000;
+const int SEEDS = 8;
+
+int main() {
+  long scans = 0, mismatches = 0, events = 0;
+  for (int seed = 1; seed <= SEEDS; seed++) {
+    std::mt19937 rng(seed);
+    for (int i = 0; i < 64; i++) hostDigital[i] = 1;
+    hostMicros = 0;
+    MultiControl button(4, 2);
+    MultiControl mux;
+    mux.setMuxControlPins(30, 31, 32);
+    mux.setMuxChannel(3);
+    mux.setPin(5);
+    mux.setControl(4);
+    MultiControl encoder;
+    encoder.setEncoderPins(6, 7, 8);
+    MultiControl* controls[3] = {&button, &mux, &encoder};
+    LegacyButton legacy[3];
+    const int pins[3] = {4, 5, 8};
+    if (seed % 3 == 0) {
+      unsigned long dc = 200 + rng() % 300, hold = 300 + rng() % 500, lp = 800 + rng() % 600,
+                    db = 5 + rng() % 30;
+      for (int k = 0; k < 3; k++) {
+        controls[k]->setDoubleClickTime(dc);
+        controls[k]->setHoldTime(hold);
+        controls[k]->setLongPressTime(lp);
+        controls[k]->setDebounceTime(db);
+        legacy[k]._doubleClickTime = dc;
+        legacy[k]._holdTime = hold;
+        legacy[k]._longPressTime = lp;
+        legacy[k]._debounceTime = db;
+      }
+    }
+    long nextEdge[3] = {0, 0, 0};
+    int level[3] = {1, 1, 1}, bounce[3] = {0, 0, 0};
+    for (long t = 1; t <= MS; t++) {
+      for (int k = 0; k < 3; k++) {
+        int pin = pins[k];
+        if (bounce[k] > 0) {
+          hostDigital[pin] = rng() % 2;
+          if (--bounce[k] == 0) hostDigital[pin] = level[k];
+        }
+        if (t >= nextEdge[k]) {
+          level[k] ^= 1;
+          bounce[k] = rng() % 8;
+          int r = rng() % 100;
+          long dur = r < 40 ? 30 + rng() % 200 : r < 70 ? 100 + rng() % 600 : r < 95 ? 400 + rng() % 1500 : 2000 + rng() % 58000;
+          nextEdge[k] = t + dur;
+          if (!bounce[k]) hostDigital[pin] = level[k];
+        }
+        if (rng() % 50 == 0) continue;  // a skipped scan
+        hostMicros = t * 1000;  // readMuxButton() settles for 10 us; keep both on the same ms
+        int raw = hostDigital[pin];
+        MultiControl& c = *controls[k];
+        bool pressed;
+        if (k == 0) pressed = c.readButton() == 0;
+        else if (k == 1) pressed = c.readMuxButton() == 0;
+        else {
+          c.readEncoder();
+          pressed = c.isPressed();
+        }
+        LegacyButton& l = legacy[k];
+        bool legacyPressed = l.read(raw, t) == 0;
+        if (k == 2) legacyPressed = l._buttonValue;
+        unsigned mask = rng() % 16;
+        events += c.takeGestureEvents() != 0;
+        scans++;
+        mismatches += poll(c, mask, pressed) != poll(l, mask, legacyPressed);
+      }
+    }
+  }
+  printf("Gesture engine against the per-reader logic it replaced\n");
+  printf("  %d seeds x %ld s x 3 readers: %ld scans, %ld with events, %ld mismatches\n", SEEDS, MS / 1000, scans,
+         events, mismatches);
+  printf("Size (host, %d-bit)\n", (int)sizeof(void*) * 8);
+  printf("  gesture state per control   legacy %d bytes, shared engine %d bytes\n",
+         (int)(sizeof(LegacyButton) - sizeof(LegacySettings)), (int)MultiControl::getGestureStateSize());
+  return 0;
+}
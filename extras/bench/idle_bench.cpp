@@ -0,0 +1,197 @@
+/*
+ * idle_bench.cpp - host benchmark for MultiControlIdle (idle scanning and wake latency).
+ *
+ * A panel of 8 buttons, 4 encoders with push buttons, 4 pots and 4 mux buttons is scanned
+ * by a sketch loop: read every control, idle.update(), idle.wait(), delay(1). After a
+ * 2 s idle timeout nothing moves until one control is used: a button or mux button is
+ * pressed for 150 ms, an encoder is turned four detents in 200 ms, or a pot is thrown to a
+ * new value. That is repeated 200 times for each kind of control, at random times in the idle
+ * interval. For each idle scan interval, reports:
+ *   scans/s    scans per second while active and while idle (the pots' and mux settling
+ *              delays are virtual on the host but advance its clock)
+ *   wake       mean and longest ms from the control moving to the first scan that leaves
+ *              idle, and inputs missed (never seen: an encoder turned between idle scans can
+ *              come back to the same quadrature state), with the timer wake only (delay() between idle scans, or light sleep
+ *              without wake sources), and modelled with light sleep and wake sources:
+ *              a button or encoder pin ends the sleep at once (the wake itself is taken as
+ *              instant), pots and mux buttons wait for the timer. Touch pads (not read on
+ *              the host) wake like buttons on classic ESP32, and on ESP32-S2/S3 only the
+ *              one setTouchWakePad() pad does.
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. idle_bench.cpp -o idle_bench && ./idle_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <random>
+
+// Model light sleep in idle.wait(): a wake source pin ends the wait early
+void benchDelay(unsigned long ms);
+#define delay(ms) benchDelay(ms)
+
+#include "MultiControl.h"
+#include "MultiControlIdle.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int BUTTONS = 8, ENCODERS = 4, POTS = 4, MUXES = 4;
+const int EVENTS = 200;
+const char* KIND[4] = {"button", "encoder", "pot", "mux"};
+
+bool inWait = false;
+bool wakeSources = false;
+unsigned long eventAt = 0;  // ms the next input arrives
+bool eventWakes = false;    // it is on a pin that can wake the chip
+
+void benchDelay(unsigned long ms) {
+  unsigned long until = hostMicros + ms * 1000;
+  if (inWait && wakeSources && eventWakes && eventAt * 1000 > hostMicros && eventAt * 1000 < until) {
+    until = eventAt * 1000;
+  }
+  hostMicros = until;
+}
+
+struct Panel {
+  MultiControl buttons[BUTTONS], encoders[ENCODERS], pots[POTS], muxes[MUXES];
+  MultiControlIdle idle;
+
+  Panel(uint16_t interval) {
+    for (int i = 0; i < 64; i++) hostDigital[i] = 1;
+    for (int i = 0; i < BUTTONS; i++) {
+      buttons[i].setPin(i);
+      buttons[i].setControl(2);
+      idle.addControl(&buttons[i]);
+    }
+    for (int i = 0; i < ENCODERS; i++) {
+      encoders[i].setEncoderPins(10 + i, 20 + i, 30 + i);
+      idle.addControl(&encoders[i]);
+    }
+    for (int i = 0; i < POTS; i++) {
+      hostAnalog[i] = 1000;
+      pots[i].setPin(i);
+      pots[i].setControl(1);
+      idle.addControl(&pots[i]);
+    }
+    for (int i = 0; i < MUXES; i++) {
+      muxes[i].setMuxControlPins(41, 42, 43);
+      muxes[i].setMuxChannel(i);
+      muxes[i].setPin(40);
+      muxes[i].setControl(4);
+      idle.addControl(&muxes[i]);
+    }
+    idle.setIdleTimeout(2000);
+    idle.setIdleScanInterval(interval);
+  }
+
+  /* One pass of the sketch loop; returns true if idle */
+  bool scan() {
+    unsigned long now = MC_MILLIS();
+    for (int i = 0; i < BUTTONS; i++) buttons[i].read(now);
+    for (int i = 0; i < ENCODERS; i++) encoders[i].read(now);
+    for (int i = 0; i < POTS; i++) pots[i].read(now);
+    for (int i = 0; i < MUXES; i++) muxes[i].read(now);
+    bool idleNow = idle.update(now);
+    inWait = true;
+    idle.wait();
+    inWait = false;
+    delay(1);
+    return idleNow;
+  }
+};
+
+/* Set the pins for input kind k, started at eventAt, at time t (ms) */
+void play(int k, int n, unsigned long t) {
+  long since = (long)(t - eventAt);
+  bool on = since >= 0;
+  if (k == 0) hostDigital[n % BUTTONS] = on && since < 150 ? 0 : 1;
+  if (k == 1) {
+    // Four detents of quadrature, a Gray code step every 12 ms, the first at eventAt
+    static const uint8_t gray[4] = {3, 1, 0, 2};
+    uint8_t ab = gray[on && since < 180 ? (since / 12 + 1) % 4 : 0];
+    hostDigital[10 + n % ENCODERS] = ab >> 1;
+    hostDigital[20 + n % ENCODERS] = ab & 1;
+  }
+  if (k == 2 && on) hostAnalog[n % POTS] = n / POTS % 2 ? 1000 : 3000;
+  if (k == 3) hostDigital[40] = on && since < 150 ? 0 : 1;
+}
+
+struct Result {
+  double activeRate, idleRate;
+  double mean[4], worst[4];
+  int missed[4];
+};
+
+Result run(uint16_t interval, bool sleep) {
+  Panel panel(interval);
+  std::mt19937 rng(5);
+  wakeSources = sleep;
+  hostMicros = 0;
+  Result r = {};
+  unsigned long activeScans = 0, idleScans = 0, activeMs = 0, idleMs = 0;
+  // Active: a second of full-rate scanning
+  unsigned long t0 = millis();
+  while (millis() - t0 < 1000) {
+    panel.scan();
+    activeScans++;
+  }
+  activeMs += millis() - t0;
+  for (int k = 0; k < 4; k++) {
+    double sum = 0, worst = 0;
+    int seen = 0;
+    for (int n = 0; n < EVENTS; n++) {
+      // Wait for idle, settle into the idle rhythm, then pick a time in the next interval
+      eventAt = ~0UL >> 1;
+      eventWakes = false;
+      while (!panel.scan()) {}
+      unsigned long idleFrom = millis();
+      unsigned long scansFrom = panel.idle.getScanCount();
+      eventAt = millis() + 3 * interval + rng() % interval;
+      eventWakes = k < 2;
+      while (millis() < eventAt) {
+        play(k, n, millis());
+        panel.scan();
+      }
+      idleScans += panel.idle.getScanCount() - scansFrom;
+      idleMs += millis() - idleFrom;
+      // The first scan that leaves idle, within a second
+      while (millis() - eventAt < 1000) {
+        play(k, n, millis());
+        unsigned long at = millis();
+        if (!panel.scan()) {
+          sum += at - eventAt;
+          worst = max(worst, (double)(at - eventAt));
+          seen++;
+          break;
+        }
+      }
+      // Let the input finish
+      for (int i = 0; i < 300; i++) {
+        play(k, n, millis());
+        panel.scan();
+      }
+    }
+    r.mean[k] = sum / max(1, seen);
+    r.worst[k] = worst;
+    r.missed[k] = EVENTS - seen;
+  }
+  r.activeRate = activeScans * 1000.0 / activeMs;
+  r.idleRate = idleScans * 1000.0 / max(1UL, idleMs);
+  return r;
+}
+
+int main() {
+  printf("Panel of %d controls, 2 s idle timeout, %d inputs of each kind while idle\n",
+         BUTTONS + ENCODERS + POTS + MUXES, EVENTS);
+  printf("  interval   scans/s active/idle   wake         ms mean/max, missed:  ");
+  for (int k = 0; k < 4; k++) printf(k < 3 ? "%-19s" : "%s\n", KIND[k]);
+  for (uint16_t interval : {20, 50, 100}) {
+    for (bool sleep : {false, true}) {
+      Result r = run(interval, sleep);
+      printf("  %4u ms    %6.0f %6.1f          %-12s                         ", interval, r.activeRate,
+             r.idleRate, sleep ? "wake sources" : "timer only");
+      for (int k = 0; k < 4; k++) printf("%5.1f %4.0f %4d%s", r.mean[k], r.worst[k], r.missed[k], k < 3 ? "     " : "\n");
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * matrix_bench.cpp - host benchmark for MultiControlMatrix.
+ *
+ * Simulates a key matrix played with random chords of up to four keys, with contact
+ * bounce on every press and release, scanned once per millisecond. Without diodes the
+ * simulation lets current flow back through pressed keys, so rectangles of three
+ * pressed keys produce a phantom fourth key, as on real hardware.
+ * For each matrix size it reports the decode cost per scan (ghost detection and the
+ * debounce/gesture update of every key), the settle delays the row scan adds on the
+ * device, and how many phantom and bounce presses got through, with ghost detection
+ * on and off for the diode-less matrix.
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. matrix_bench.cpp -o matrix_bench && ./matrix_bench [bounce ms]
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlMatrix.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int SCANS = 600000;  // ten minutes at one scan per ms
+const int MAX_DOWN = 4;    // keys held at once
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct Sim {
+  int rows, cols;
+  std::vector<uint8_t> intent;        // the player's finger is on the key
+  std::vector<uint8_t> contact;       // the contact is closed (bounces after a change)
+  std::vector<uint32_t> changedAt;    // ms of the last intent change
+  std::vector<std::vector<uint16_t>> scans;  // row words for every scan
+  std::vector<std::vector<uint8_t>> intents; // intent for every scan
+  uint32_t presses = 0;
+};
+
+/* Row words for the current contacts. Without diodes a row reaches every column
+ * connected to it through any path of closed keys. */
+void readRows(const Sim& sim, bool diodes, uint16_t* out) {
+  std::vector<uint16_t> direct(sim.rows, 0);
+  for (int r = 0; r < sim.rows; r++) {
+    for (int c = 0; c < sim.cols; c++) direct[r] |= sim.contact[r * sim.cols + c] << c;
+  }
+  for (int r = 0; r < sim.rows; r++) {
+    uint16_t reach = direct[r];
+    if (!diodes) {
+      bool grown = true;
+      while (grown) {
+        grown = false;
+        for (int r2 = 0; r2 < sim.rows; r2++) {
+          if ((direct[r2] & reach) && (direct[r2] | reach) != reach) {
+            reach |= direct[r2];
+            grown = true;
+          }
+        }
+      }
+    }
+    out[r] = reach;
+  }
+}
+
+Sim simulate(int rows, int cols, bool diodes, uint32_t bounceMs, uint32_t seed) {
+  Sim sim;
+  sim.rows = rows;
+  sim.cols = cols;
+  int n = rows * cols;
+  sim.intent.assign(n, 0);
+  sim.contact.assign(n, 0);
+  sim.changedAt.assign(n, 0);
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  int down = 0;
+  for (uint32_t ms = 0; ms < (uint32_t)SCANS; ms++) {
+    for (int k = 0; k < n; k++) {
+      // Hold keys for 30-300 ms, a new press every 40 ms or so across the matrix
+      if (sim.intent[k] && ms - sim.changedAt[k] >= 30 && u(rng) < 0.01) {
+        sim.intent[k] = 0;
+        sim.changedAt[k] = ms;
+        down--;
+      } else if (!sim.intent[k] && down < MAX_DOWN && ms - sim.changedAt[k] >= 30 && u(rng) < 0.025 / n) {
+        sim.intent[k] = 1;
+        sim.changedAt[k] = ms;
+        sim.presses++;
+        down++;
+      }
+      bool bouncing = ms - sim.changedAt[k] < bounceMs && sim.changedAt[k] > 0;
+      sim.contact[k] = bouncing ? (rng() & 1) : sim.intent[k];
+    }
+    std::vector<uint16_t> words(rows);
+    readRows(sim, diodes, words.data());
+    sim.scans.push_back(words);
+    sim.intents.push_back(sim.intent);
+  }
+  return sim;
+}
+
+struct Result {
+  double ns;
+  uint32_t detected;  // press events reported by the keys
+  uint32_t phantom;   // press events on keys the player was not pressing
+  uint32_t ghostScans;
+};
+
+Result run(const Sim& sim, bool detectGhosts) {
+  int n = sim.rows * sim.cols;
+  std::vector<MultiControl> keys(n);
+  MultiControlMatrix matrix;
+  uint8_t rowPins[MultiControlMatrix::MAX_ROWS];
+  uint8_t colPins[MultiControlMatrix::MAX_COLS];
+  for (int r = 0; r < sim.rows; r++) rowPins[r] = r;
+  for (int c = 0; c < sim.cols; c++) colPins[c] = 16 + c;
+  matrix.setRows(rowPins, sim.rows);
+  matrix.setColumns(colPins, sim.cols);
+  matrix.setDiodes(!detectGhosts);
+  for (int r = 0; r < sim.rows; r++) {
+    for (int c = 0; c < sim.cols; c++) matrix.addKey(&keys[r * sim.cols + c], r, c);
+  }
+
+  // Timing pass: decode only
+  double t0 = seconds();
+  for (int s = 0; s < SCANS; s++) matrix.updateRows(sim.scans[s].data(), s);
+  double t1 = seconds();
+
+  // Checking pass on fresh keys
+  Result res = {(t1 - t0) * 1e9 / SCANS, 0, 0, 0};
+  std::vector<MultiControl> check(n);
+  MultiControlMatrix m2;
+  m2.setRows(rowPins, sim.rows);
+  m2.setColumns(colPins, sim.cols);
+  m2.setDiodes(!detectGhosts);
+  for (int r = 0; r < sim.rows; r++) {
+    for (int c = 0; c < sim.cols; c++) m2.addKey(&check[r * sim.cols + c], r, c);
+  }
+  std::vector<uint8_t> was(n, 0);
+  for (int s = 0; s < SCANS; s++) {
+    m2.updateRows(sim.scans[s].data(), s);
+    for (int k = 0; k < n; k++) {
+      bool p = check[k].isPressed();
+      if (p && !was[k]) {
+        res.detected++;
+        if (!sim.intents[s][k]) res.phantom++;
+      }
+      was[k] = p;
+    }
+  }
+  res.ghostScans = m2.getGhostScans();
+  return res;
+}
+
+int main(int argc, char** argv) {
+  uint32_t bounceMs = argc > 1 ? atoi(argv[1]) : 3;
+  printf("bounce %u ms, up to %d keys held, %d scans at 1 ms\n\n", bounceMs, MAX_DOWN, SCANS);
+  printf("matrix  diodes  ghost detect  decode ns/scan  settle us/scan  presses  detected  phantom  ghost scans\n");
+  const int sizes[][2] = {{4, 8}, {8, 8}, {8, 16}};
+  for (auto& size : sizes) {
+    int rows = size[0], cols = size[1];
+    for (int diodes = 1; diodes >= 0; diodes--) {
+      Sim sim = simulate(rows, cols, diodes, bounceMs, rows * 100 + cols);
+      for (int detect = diodes ? 0 : 1; detect >= 0; detect--) {
+        Result r = run(sim, detect);
+        double settleUs = rows * 5.0;  // default settle time, once per row
+        printf("%2dx%-2d   %-6s  %-12s  %14.1f  %14.1f  %7u  %8u  %7u  %11u\n", rows, cols,
+               diodes ? "yes" : "no", detect ? "on" : "off", r.ns, settleUs, sim.presses,
+               r.detected, r.phantom, r.ghostScans);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * midi_bench.cpp - host benchmark for MultiControlMidi (coalescing MIDI output stage).
+ *
+ * Sixteen pots with ADC noise are played for 60 s at 1 ms scans, two to four moving at a
+ * time, slow sweeps and fast throws. Their values are sent three ways:
+ *   per change   what sketches do now: a 7-bit CC whenever readPotChanged() != -1
+ *   CC           the output stage, 7-bit CC (default 10 ms per control, 1000 messages/s per port)
+ *   CC14         the output stage, 14-bit CC pairs
+ * each over DIN (MultiControlMidiSerial into a 31250 baud UART model with running status)
+ * and over USB (MultiControlMidiBuffer, one USB transfer per batch). Reports:
+ *   msgs/s       MIDI messages per second on DIN and on USB (no port rate limit on USB)
+ *   UART         mean and longest ms a message waits for the UART behind earlier bytes
+ *   wait         mean and longest ms a change waits in the stage for its interval or the
+ *                port rate (both ports)
+ *   transfers/s  USB transfers per second (per change: one per message; the stage: one
+ *                per batch of up to 16)
+ *   steps        distinct values sent over one full turn of a pot
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. midi_bench.cpp -o midi_bench && ./midi_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <math.h>
+#include <random>
+#include <set>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlMidi.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int POTS = 16;
+const long MS = 60000;
+const unsigned long BYTE_US = 320;  // 10 bits at 31250 baud
+
+/* A 31250 baud UART: bytes leave one every 320 us, queued behind earlier ones */
+class DinModel : public Print {
+  public:
+    unsigned long freeAt = 0;  // us the UART finishes its queue
+    double waitSum = 0;
+    unsigned long waitMax = 0;
+    long writes = 0;
+    uint8_t runningStatus = 0;
+
+    size_t write(uint8_t) { return write(nullptr, 1); }
+    size_t write(const uint8_t*, size_t size) {
+      unsigned long start = max(freeAt, hostMicros);
+      unsigned long wait = start - hostMicros;
+      waitSum += wait;
+      waitMax = max(waitMax, wait);
+      writes++;
+      freeAt = start + size * BYTE_US;
+      return size;
+    }
+
+    /* A sketch's three-byte control change, with running status */
+    void controlChange(uint8_t status, uint8_t cc, uint8_t value) {
+      uint8_t bytes[3] = {status, cc, value};
+      bool running = status == runningStatus;
+      runningStatus = status;
+      write(running ? bytes + 1 : bytes, running ? 2 : 3);
+    }
+};
+
+/* The player: pots moving through the ADC range with noise */
+struct Player {
+  std::mt19937 rng{11};
+  struct Move { int from, to; long start, end; };
+  Move move[POTS] = {};
+  long rand(long lo, long hi) { return lo + (long)(rng() % (unsigned long)(hi - lo + 1)); }
+  void step(long t) {
+    for (int p = 0; p < POTS; p++) {
+      Move& m = move[p];
+      if (t >= m.end + rand(0, 80) * 100) {
+        int at = m.to ? m.to : 2048;
+        m = {at, (int)rand(0, 4095), t, t + (rand(0, 3) == 0 ? rand(60, 200) : rand(500, 3000))};
+      }
+      float x = t < m.end ? (float)(t - m.start) / (m.end - m.start) : 1.0f;
+      int v = m.from + (int)((m.to - m.from) * (0.5f - 0.5f * cosf(x * 3.14159f)));
+      hostAnalog[p] = constrain(v + (int)rand(-6, 6), 0, 4095);
+    }
+  }
+};
+
+struct Result {
+  long messages = 0, transfers = 0;
+  long usbMessages = 0;
+  double uartMean = 0, uartMax = 0, waitMean = 0, waitMax = 0;
+};
+
+void setupPots(MultiControl* pots) {
+  for (int p = 0; p < POTS; p++) {
+    pots[p].setPin(p);
+    pots[p].setControl(1);
+    pots[p].setLatchEnabled(false);
+  }
+}
+
+/* A sketch sending a CC on every readPotChanged() */
+Result perChange() {
+  MultiControl pots[POTS];
+  setupPots(pots);
+  Player player;
+  DinModel din;
+  Result r;
+  hostMicros = 0;
+  for (long t = 0; t < MS; t++) {
+    player.step(t);
+    hostMicros = t * 1000;
+    for (int p = 0; p < POTS; p++) {
+      int v = pots[p].readPotChanged();
+      if (v < 0) continue;
+      din.controlChange(0xB0, p, v >> 3);
+      r.messages++;
+    }
+  }
+  r.usbMessages = r.transfers = r.messages;  // one USB transfer per message
+  r.uartMean = din.waitSum / max(1L, din.writes) / 1000.0;
+  r.uartMax = din.waitMax / 1000.0;
+  return r;
+}
+
+/* The output stage, 7-bit or 14-bit */
+Result stage(bool fine) {
+  MultiControl pots[POTS];
+  setupPots(pots);
+  Player player;
+  DinModel din;
+  MultiControlMidiSerial serial(din);
+  static uint8_t usbPackets[4 * 200000];
+  MultiControlMidiBuffer usb(usbPackets, 200000);
+  MultiControlMidi midi;
+  midi.setTransport(0, &serial);
+  midi.setTransport(1, &usb, 0);
+  for (int p = 0; p < POTS; p++) {
+    if (fine) midi.addCC14(&pots[p], 0, p, 0, 1023, 0);
+    else midi.addCC(&pots[p], 0, p, 0, 1023, 0);
+  }
+  // USB: the same mappings on port 1, fed from the DIN mappings' controls without rereading
+  for (int p = 0; p < POTS; p++) {
+    if (fine) midi.addCC14(nullptr, 0, p, 0, 1023, 1);
+    else midi.addCC(nullptr, 0, p, 0, 1023, 1);
+  }
+  Result r;
+  hostMicros = 0;
+  for (long t = 0; t < MS; t++) {
+    player.step(t);
+    hostMicros = t * 1000;
+    midi.update(t);  // reads the pots, sends port 0
+    for (int p = 0; p < POTS; p++) midi.set(POTS + p, pots[p].getValue(), t);
+    midi.flush(t);
+  }
+  r.usbMessages = usb.getCount();
+  r.messages = midi.getMessageCount() - r.usbMessages;
+  r.transfers = usb.getBatchCount();
+  r.uartMean = din.waitSum / max(1L, din.writes) / 1000.0;
+  r.uartMax = din.waitMax / 1000.0;
+  r.waitMean = midi.getMeanLatency();
+  r.waitMax = midi.getMaxLatency();
+  return r;
+}
+
+/* Distinct values sent over one slow full turn of a pot */
+int steps(bool fine) {
+  MultiControl pot;
+  pot.setPin(0);
+  pot.setControl(1);
+  pot.setLatchEnabled(false);
+  static uint8_t packets[4 * 100000];
+  MultiControlMidiBuffer usb(packets, 100000);
+  MultiControlMidi midi;
+  midi.setTransport(0, &usb, 0);
+  if (fine) midi.addCC14(&pot, 0, 0);
+  else midi.addCC(&pot, 0, 0);
+  hostMicros = 0;
+  for (long t = 0; t < 20000; t++) {
+    hostMicros = t * 1000;
+    hostAnalog[0] = (int)(t * 4096 / 20000);
+    midi.update(t);
+  }
+  std::set<int> values;
+  int msb = 0;
+  for (uint32_t i = 0; i < usb.getCount(); i++) {
+    const uint8_t* p = usb.getPacket(i);
+    if (!fine) values.insert(p[3]);
+    else if (p[2] < 32) msb = p[3];
+    else values.insert(msb << 7 | p[3]);
+  }
+  return (int)values.size();
+}
+
+void print(const char* name, const Result& r, int steps) {
+  printf("  %-11s %7.0f %7.0f     %5.1f %6.1f       %5.1f %5.0f         %7.0f      %5d\n", name,
+         r.messages * 1000.0 / MS, r.usbMessages * 1000.0 / MS, r.uartMean, r.uartMax, r.waitMean, r.waitMax,
+         r.transfers * 1000.0 / MS, steps);
+}
+
+int main() {
+  printf("16 pots, %ld s, DIN at 31250 baud and USB\n", MS / 1000);
+  printf("              msgs/s DIN/USB   UART ms mean/max   wait ms mean/max   USB transfers/s   steps\n");
+  print("per change", perChange(), steps(false));
+  print("CC", stage(false), steps(false));
+  print("CC14", stage(true), steps(true));
+  return 0;
+}
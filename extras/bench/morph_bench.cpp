@@ -0,0 +1,238 @@
+/*
+ * morph_bench.cpp - host benchmark for MultiControlMorph (bank morphing).
+ *
+ * 64 pots with 16 random preset banks plus a live bank. Times a crossfade from one bank
+ * to another and an X/Y morph across four banks, one step per frame, against what app
+ * code does without the morph (getBankValue() of both banks and a float lerp for every
+ * control, every frame), and reports:
+ *   ns/frame   host time per frame for all 64 controls
+ *   max error  largest difference from a float reference (rounded)
+ * and how many update() calls it takes for an edit of a source bank value to show.
+ * Then the morph writes into the live bank the pots are in while they rest, a performer
+ * turns every pot afterwards, and the benchmark reports the largest jump of a control's
+ * output in one read, with the pots latched to the morphed values and without latching,
+ * and how many controls the performer took over from the morph.
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. morph_bench.cpp -o morph_bench && ./morph_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlMorph.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int CONTROLS = 64;
+const int BANKS = 16;
+const uint8_t LIVE = 16;
+const int FRAMES = 2048;
+
+MultiControl pots[CONTROLS];
+int16_t naiveOut[CONTROLS];
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void setup(std::mt19937& rng) {
+  for (int i = 0; i < CONTROLS; i++) {
+    pots[i].setPin(i);
+    pots[i].setControl(1);
+    pots[i].initBanks(BANKS + 1);
+    for (int b = 0; b < BANKS; b++) pots[i].setBankValue(b, rng() % 1024);
+  }
+}
+
+/* Position of frame f: a sweep up and back down */
+int sweep(int f) {
+  int p = f % 2048;
+  return p < 1024 ? p : 2047 - p;
+}
+
+void crossfade() {
+  const int REPEAT = 200;
+  MultiControlMorph morph;
+  morph.addControls(pots, CONTROLS);
+  morph.setBanks(3, 11);
+  volatile int sink = 0;
+
+  // Today: two getBankValue() calls and a float lerp per control per frame
+  double t0 = seconds();
+  for (int r = 0; r < REPEAT; r++) {
+    for (int f = 0; f < FRAMES; f++) {
+      float x = sweep(f) / 1023.0f;
+      for (int i = 0; i < CONTROLS; i++) {
+        int a = pots[i].getBankValue(3), b = pots[i].getBankValue(11);
+        naiveOut[i] = (int16_t)(a + (b - a) * x + 0.5f);
+      }
+      sink += naiveOut[f & 63];
+    }
+  }
+  double naive = (seconds() - t0) * 1e9 / ((double)REPEAT * FRAMES);
+
+  t0 = seconds();
+  for (int r = 0; r < REPEAT; r++) {
+    for (int f = 0; f < FRAMES; f++) {
+      morph.setPosition(sweep(f));
+      morph.update();
+      sink += morph.getValues()[f & 63];
+    }
+  }
+  double moving = (seconds() - t0) * 1e9 / ((double)REPEAT * FRAMES);
+
+  t0 = seconds();
+  for (int r = 0; r < REPEAT * FRAMES; r++) {
+    morph.setPosition(700);
+    morph.update();
+    sink += morph.getValues()[r & 63];
+  }
+  double still = (seconds() - t0) * 1e9 / ((double)REPEAT * FRAMES);
+
+  int maxError = 0;
+  for (int f = 0; f < 1024; f++) {
+    morph.setPosition(f);
+    morph.update();
+    for (int i = 0; i < CONTROLS; i++) {
+      double a = pots[i].getBankValue(3), b = pots[i].getBankValue(11);
+      int ref = (int)lround(a + (b - a) * (f / 1023.0));
+      maxError = max(maxError, abs(morph.getValue(i) - ref));
+    }
+  }
+  // A preset edited while the position rests shows up within a round of source checks
+  morph.setPosition(1023);
+  morph.update();
+  int old = pots[37].getBankValue(11), updates = 0;
+  pots[37].setBankValue(11, 1023 - old);
+  while (morph.getValue(37) != 1023 - old && updates < 100) {
+    morph.update();
+    updates++;
+  }
+  pots[37].setBankValue(11, old);
+  morph.refresh();
+  printf("crossfade, 2 of %d banks          ns/frame  max error\n", BANKS);
+  printf("  getBankValue() + float lerp      %7.1f\n", naive);
+  printf("  morph, position moving           %7.1f  %d\n", moving, maxError);
+  printf("  morph, nothing changed           %7.1f\n", still);
+  printf("  source bank edit shown after %d updates\n", updates);
+}
+
+void xy() {
+  const int REPEAT = 200;
+  MultiControlMorph morph;
+  morph.addControls(pots, CONTROLS);
+  morph.setBanks(0, 5, 9, 14);
+  volatile int sink = 0;
+
+  double t0 = seconds();
+  for (int r = 0; r < REPEAT; r++) {
+    for (int f = 0; f < FRAMES; f++) {
+      float x = sweep(f) / 1023.0f, y = sweep(f * 3) / 1023.0f;
+      for (int i = 0; i < CONTROLS; i++) {
+        float a = pots[i].getBankValue(0), b = pots[i].getBankValue(5);
+        float c = pots[i].getBankValue(9), d = pots[i].getBankValue(14);
+        float top = a + (b - a) * x, bottom = c + (d - c) * x;
+        naiveOut[i] = (int16_t)(top + (bottom - top) * y + 0.5f);
+      }
+      sink += naiveOut[f & 63];
+    }
+  }
+  double naive = (seconds() - t0) * 1e9 / ((double)REPEAT * FRAMES);
+
+  t0 = seconds();
+  for (int r = 0; r < REPEAT; r++) {
+    for (int f = 0; f < FRAMES; f++) {
+      morph.setPosition(sweep(f), sweep(f * 3), 1023);
+      morph.update();
+      sink += morph.getValues()[f & 63];
+    }
+  }
+  double moving = (seconds() - t0) * 1e9 / ((double)REPEAT * FRAMES);
+
+  int maxError = 0;
+  for (int f = 0; f < 4096; f++) {
+    int px = sweep(f * 7), py = sweep(f * 5);
+    morph.setPosition(px, py, 1023);
+    morph.update();
+    double x = px / 1023.0, y = py / 1023.0;
+    for (int i = 0; i < CONTROLS; i++) {
+      double a = pots[i].getBankValue(0), b = pots[i].getBankValue(5);
+      double c = pots[i].getBankValue(9), d = pots[i].getBankValue(14);
+      double top = a + (b - a) * x, bottom = c + (d - c) * x;
+      maxError = max(maxError, abs(morph.getValue(i) - (int)lround(top + (bottom - top) * y)));
+    }
+  }
+  printf("X/Y, 4 of %d banks\n", BANKS);
+  printf("  getBankValue() + float bilerp    %7.1f\n", naive);
+  printf("  morph, position moving           %7.1f  %d\n", moving, maxError);
+}
+
+/* Morph into the live bank with the pots parked elsewhere, then turn every pot slowly
+ * across its range. Returns the largest change of a control's output in one read. */
+int turnAfterMorph(bool latch, int& overridden) {
+  std::mt19937 rng(7);
+  MultiControlMorph morph;
+  morph.addControls(pots, CONTROLS);
+  morph.setBanks(2, 12);
+  morph.setOutputBank(LIVE);
+  for (int i = 0; i < CONTROLS; i++) {
+    pots[i].setLatchEnabled(latch);
+    pots[i].setBank(LIVE);
+    hostAnalog[i] = rng() % 4096;  // where each pot was left
+  }
+  auto frame = [&](int position) {
+    hostMicros += 1000;
+    for (int i = 0; i < CONTROLS; i++) pots[i].readPot();
+    morph.setPosition(position);
+    morph.update();
+  };
+  morph.update();
+  std::vector<int> prev(CONTROLS);
+  for (int i = 0; i < CONTROLS; i++) prev[i] = morph.getValue(i);
+  int worst = 0;
+  // Morph most of the way to bank 12 with the pots untouched, then turn them
+  for (int f = 0; f < 600; f++) {
+    frame(f);
+    for (int i = 0; i < CONTROLS; i++) {
+      worst = max(worst, abs(morph.getValue(i) - prev[i]));
+      prev[i] = morph.getValue(i);
+    }
+  }
+  // Every pot turned down and then up through most of its range (clear of the sticky
+  // ends), 8 ADC counts per read
+  for (int step = 0; step < 1024; step++) {
+    for (int i = 0; i < CONTROLS; i++) {
+      int target = step < 512 ? 300 : 3800;
+      hostAnalog[i] += constrain(target - hostAnalog[i], -8, 8);
+    }
+    frame(600);
+    for (int i = 0; i < CONTROLS; i++) {
+      worst = max(worst, abs(morph.getValue(i) - prev[i]));
+      prev[i] = morph.getValue(i);
+    }
+  }
+  overridden = 0;
+  for (int i = 0; i < CONTROLS; i++) overridden += morph.isOverridden(i);
+  return worst;
+}
+
+int main() {
+  std::mt19937 rng(1);
+  setup(rng);
+  crossfade();
+  xy();
+  printf("pots turned after a morph into the live bank   largest jump per read  taken over\n");
+  int overridden;
+  int jump = turnAfterMorph(true, overridden);
+  printf("  latched to the morphed value                 %5d                  %d/%d\n", jump, overridden, CONTROLS);
+  jump = turnAfterMorph(false, overridden);
+  printf("  without latching                             %5d                  %d/%d\n", jump, overridden, CONTROLS);
+  return 0;
+}
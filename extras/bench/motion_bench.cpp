@@ -0,0 +1,243 @@
+/*
+ * motion_bench.cpp - host benchmark for MultiControlMotion (motion recording and playback).
+ *
+ * A 16-control panel (8 pots read through readPot(), 4 encoders, 4 touch pads) is played
+ * by a scripted performer at 1 ms scans: one or two pots moving at a time, encoder turns
+ * in bursts, and taps with a pressure envelope and read noise on the pads. Reports:
+ *   memory     ring bytes per minute of recording with several setMinInterval() values,
+ *              against a plain event log (time, index and value, 8 bytes per change)
+ *   playback   samples (control x ms) where the played value differs from the recording,
+ *              at the original and at double speed, and after the ring overwrote the start
+ *   takeover   largest jump of a pot turned during playback, and whether it took over
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. motion_bench.cpp -o motion_bench && ./motion_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <math.h>
+#include <random>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlMotion.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int POTS = 8;
+const int ENCODERS = 4;
+const int PADS = 4;
+const int CONTROLS = POTS + ENCODERS + PADS;
+
+MultiControl panel[CONTROLS];
+MultiControlMotion motion;
+
+/* The performer: what each control is doing, advanced once per ms */
+struct Performer {
+  std::mt19937 rng{3};
+  struct Move { long from, to, start, end; };
+  Move pot[POTS] = {};
+  long encNext[ENCODERS] = {}, encBurstEnd[ENCODERS] = {};
+  int encDir[ENCODERS] = {};
+  long tapStart[PADS] = {}, tapEnd[PADS] = {};
+  int tapPeak[PADS] = {};
+
+  long rand(long lo, long hi) { return lo + (long)(rng() % (unsigned long)(hi - lo + 1)); }
+
+  void step(long t) {
+    // Pots: a new move from where the pot is now, now and then
+    for (int p = 0; p < POTS; p++) {
+      Move& m = pot[p];
+      if (t >= m.end + rand(0, 400) * 20) {
+        long at = hostAnalog[p];
+        m = {at, rand(100, 4000), t, t + rand(300, 2000)};
+      }
+      if (t < m.end) {
+        float x = (float)(t - m.start) / (m.end - m.start);
+        hostAnalog[p] = m.from + (long)((m.to - m.from) * (0.5f - 0.5f * cosf(x * 3.14159f)));
+      }
+    }
+    // Encoders: bursts of detents, 20-80 ms apart
+    for (int e = 0; e < ENCODERS; e++) {
+      MultiControl& c = panel[POTS + e];
+      if (t >= encBurstEnd[e] + 3000 && rand(0, 2000) == 0) {
+        encBurstEnd[e] = t + rand(300, 1200);
+        encDir[e] = rand(0, 1) ? 1 : -1;
+      }
+      if (t < encBurstEnd[e] && t >= encNext[e]) {
+        c.setEncoderPosition(c.getEncoderPosition() + encDir[e]);
+        encNext[e] = t + rand(20, 80);
+      }
+    }
+    // Pads: a tap every few seconds, pressure rising and falling, noisy while touched
+    for (int d = 0; d < PADS; d++) {
+      MultiControl& c = panel[POTS + ENCODERS + d];
+      if (t >= tapEnd[d] + 800 && rand(0, 3000) == 0) {
+        tapStart[d] = t;
+        tapEnd[d] = t + rand(120, 450);
+        tapPeak[d] = rand(300, 1000);
+      }
+      int pressure = 0;
+      if (t < tapEnd[d]) {
+        float x = (float)(t - tapStart[d]) / (tapEnd[d] - tapStart[d]);
+        pressure = (int)(tapPeak[d] * sinf(x * 3.14159f)) + rand(-3, 3);
+      }
+      c.setValue(max(0, pressure));
+    }
+  }
+};
+
+long now() { return hostMicros / 1000; }
+
+/* One scan: read the pots, then record or play */
+void scan() {
+  hostMicros = (hostMicros / 1000 + 1) * 1000;  // on the ms (readPot() itself takes some us)
+  for (int p = 0; p < POTS; p++) panel[p].readPot();
+  motion.update(now());
+}
+
+int32_t valueOf(MultiControl& c) { return c.getControl() == 5 ? c.getEncoderPosition() : c.getValue(); }
+
+void setupPanel() {
+  for (int p = 0; p < POTS; p++) {
+    panel[p].setPin(p);
+    panel[p].setControl(1);
+    hostAnalog[p] = 2000;
+  }
+  for (int e = 0; e < ENCODERS; e++) {
+    panel[POTS + e].setControl(5);
+    panel[POTS + e].setEncoderRange(0, 127);
+    panel[POTS + e].setEncoderPosition(64);
+  }
+  for (int d = 0; d < PADS; d++) panel[POTS + ENCODERS + d].setControl(0);
+  motion.addControls(panel, CONTROLS);
+  for (int i = 0; i < 100; i++) scan();
+  for (int p = 0; p < POTS; p++) panel[p].releaseLatch();  // picked up long ago
+}
+
+/* Record ms of performance, logging every control's value each ms */
+std::vector<std::vector<int32_t>> perform(Performer& who, long ms, long& changes) {
+  std::vector<std::vector<int32_t>> log;
+  std::vector<int32_t> prev(CONTROLS);
+  for (int i = 0; i < CONTROLS; i++) prev[i] = valueOf(panel[i]);
+  motion.record(now());
+  changes = 0;
+  for (long i = 0; i < ms; i++) {
+    who.step(now() + 1);
+    scan();
+    log.emplace_back(CONTROLS);
+    for (int c = 0; c < CONTROLS; c++) {
+      log.back()[c] = valueOf(panel[c]);
+      changes += log.back()[c] != prev[c];
+      prev[c] = log.back()[c];
+    }
+  }
+  motion.stop(now());
+  return log;
+}
+
+/* Play at a speed, comparing each played ms with the recording; returns mismatched samples */
+long playback(const std::vector<std::vector<int32_t>>& log, float speed, long from) {
+  for (int d = 0; d < PADS; d++) panel[POTS + ENCODERS + d].setValue(0);
+  motion.setSpeed(speed);
+  motion.play(false, now());
+  long bad = 0, ms = (long)((log.size() - from) / speed);
+  for (long i = 0; i < ms; i++) {
+    scan();
+    long at = from + (long)((i + 1) * speed) - 1;
+    for (int c = 0; c < CONTROLS; c++) bad += valueOf(panel[c]) != log[at][c];
+  }
+  motion.stop(now());
+  motion.setSpeed(1.0f);
+  return bad;
+}
+
+/* Changes a recorder sampling every interval ms sees in a log */
+long sampledChanges(const std::vector<std::vector<int32_t>>& log, int interval) {
+  long changes = 0;
+  size_t last = 0;
+  for (size_t i = interval; i < log.size(); i += max(interval, 1)) {
+    for (int c = 0; c < CONTROLS; c++) changes += log[i][c] != log[last][c];
+    last = i;
+  }
+  return changes;
+}
+
+void memory() {
+  printf("Memory per minute, 16 controls (8 pots, 4 encoders, 4 pads)\n");
+  printf("  min interval   changes/min   ring bytes/min   event log bytes/min   minutes in %d KB\n",
+         MULTICONTROL_MOTION_BYTES / 1024);
+  for (int interval : {0, 5, 10, 20}) {
+    Performer who;
+    motion.setMinInterval(interval);
+    long changes = 0, bytes = 0, c;
+    // Twelve 5 s takes, so the ring does not fill
+    for (int take = 0; take < 12; take++) {
+      changes += sampledChanges(perform(who, 5000, c), interval);
+      bytes += motion.getBytesUsed();
+    }
+    printf("  %6d ms      %9ld      %9ld          %9ld               %5.1f\n", interval, changes, bytes, changes * 8,
+           MULTICONTROL_MOTION_BYTES / (double)bytes);
+  }
+  printf("\n");
+}
+
+void fidelity() {
+  printf("Playback (samples that differ from the recording, of 16 x ms)\n");
+  motion.setMinInterval(0);
+  Performer who;
+  long changes;
+  auto log = perform(who, 8000, changes);
+  for (int p = 0; p < POTS; p++) panel[p].setBank(0);  // the pots latch to their recorded value
+  long bad = playback(log, 1.0f, 0);
+  printf("  8 s at original speed         %ld of %ld\n", bad, (long)log.size() * CONTROLS);
+  bad = playback(log, 2.0f, 0);
+  printf("  8 s at double speed           %ld of %ld\n", bad, (long)log.size() / 2 * CONTROLS);
+
+  // Overwrite: a take longer than the ring keeps its end
+  motion.setOverflowPolicy(MC_MOTION_OVERWRITE);
+  log = perform(who, 120000, changes);
+  long kept = motion.getLength();
+  bad = playback(log, 1.0f, log.size() - kept);
+  printf("  last %.1f s of a 120 s take    %ld of %ld (overwritten: %s)\n", kept / 1000.0, bad, kept * CONTROLS,
+         motion.hasOverflowed() ? "yes" : "no");
+  motion.setOverflowPolicy(MC_MOTION_STOP);
+  log = perform(who, 120000, changes);
+  printf("  a 120 s take, stop when full  %.1f s recorded\n\n", motion.getLength() / 1000.0);
+}
+
+void takeover() {
+  printf("Takeover (pot 0 turned during playback)\n");
+  motion.setMinInterval(5);
+  Performer who;
+  long changes;
+  perform(who, 20000, changes);
+  motion.play(true, now());
+  for (int i = 0; i < 2000; i++) scan();
+  int prev = panel[0].getValue(), worst = 0;
+  long pickedUp = -1;
+  // Turn pot 0 down and back up through most of its range (clear of the sticky ends),
+  // 4 ADC counts per ms
+  for (int i = 0; i < 2000; i++) {
+    hostAnalog[0] += i < 1000 ? -4 : 4;
+    hostAnalog[0] = constrain(hostAnalog[0], 300, 3800);
+    scan();
+    worst = max(worst, abs(panel[0].getValue() - prev));
+    prev = panel[0].getValue();
+    if (pickedUp < 0 && motion.isOverridden(0)) pickedUp = i;
+  }
+  printf("  largest jump per read %d, taken over after %ld ms, still taken over: %s\n", worst, pickedUp,
+         motion.isOverridden(0) ? "yes" : "no");
+  int others = 0;
+  for (int i = 1; i < CONTROLS; i++) others += motion.isOverridden(i);
+  printf("  other controls taken over: %d\n", others);
+  motion.stop(now());
+}
+
+int main() {
+  setupPanel();
+  memory();
+  fidelity();
+  takeover();
+  return 0;
+}
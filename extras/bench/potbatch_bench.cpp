@@ -0,0 +1,156 @@
+/*
+ * potbatch_bench.cpp - host benchmark for the MultiControlPots batch filter kernels.
+ *
+ * Plays a bank of pots for a few minutes: slow and fast moves, ADC noise, pots parked at
+ * either end, and one pot with a floating wiper now and then. The same samples are fed to
+ * a MultiControl per pot (the readPot() pipeline, one pot at a time) and to MultiControlPots
+ * with each kernel compiled for this host. Checks after every scan that each kernel gives
+ * the same value and the same filter state as readPot(), and reports per pot:
+ *   ns/pot   host time of the filter (kernel plus each pot's bank snap, slew and latching)
+ *   settle   time spent in sampling delays per scan on the device, from update()
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. potbatch_bench.cpp -o potbatch_bench && ./potbatch_bench [scans]
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlPots.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+typedef int16_t Scan[4][MultiControlPots::MAX_POTS];
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Four samples of every pot per scan */
+std::vector<Scan> play(int numPots, int scans) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 6.0);
+  std::vector<double> pos(numPots), target(numPots), speed(numPots, 2.0);
+  for (int p = 0; p < numPots; p++) pos[p] = target[p] = u(rng) * 4095;
+  std::vector<Scan> out(scans);
+  int floating = 0;
+  for (int s = 0; s < scans; s++) {
+    if (floating > 0) floating--;
+    else if (u(rng) < 0.0002) floating = 200;
+    for (int p = 0; p < numPots; p++) {
+      if (u(rng) < 0.0005) {
+        double r = u(rng);
+        target[p] = r < 0.2 ? 0 : r < 0.4 ? 4095 : u(rng) * 4095;  // park at the ends now and then
+        speed[p] = u(rng) < 0.3 ? 40.0 : 0.5 + u(rng) * 3;
+      }
+      pos[p] += constrain(target[p] - pos[p], -speed[p], speed[p]);
+      for (int k = 0; k < 4; k++) {
+        double x = pos[p] + noise(rng);
+        if (p == numPots - 1 && floating) x = u(rng) * 4095;
+        out[s][k][p] = (int16_t)constrain((int)x, 0, 4095);
+      }
+    }
+  }
+  return out;
+}
+
+bool sameState(MultiControl& a, MultiControl& b) {
+  MultiControl::PotFilter fa = a.getPotFilter(), fb = b.getPotFilter();
+  return memcmp(&fa.smooth, &fb.smooth, sizeof(float)) == 0 && memcmp(&fa.error, &fb.error, sizeof(float)) == 0 &&
+         fa.asleep == fb.asleep && fa.firstRead == fb.firstRead && a.getValue() == b.getValue();
+}
+
+void setup(MultiControl* pots, int numPots) {
+  for (int p = 0; p < numPots; p++) {
+    pots[p].setPin(p);
+    pots[p].setControl(1);
+    pots[p].initBanks(2);
+    pots[p].setPotAutoTune(p & 1);  // half of them tune their own threshold
+  }
+}
+
+int main(int argc, char** argv) {
+  int scans = argc > 1 ? atoi(argv[1]) : 200000;
+  const char* names[] = {"scalar", "SSE2", "NEON", "PIE"};
+  int failures = 0;
+
+  for (int numPots = 8; numPots <= 16; numPots += 8) {
+    std::vector<Scan> samples = play(numPots, scans);
+    printf("%d pots, %d scans (bank switch every 10000)\n", numPots, scans);
+
+    // Reference: the readPot() pipeline, one pot at a time
+    MultiControl ref[16];
+    setup(ref, numPots);
+    std::vector<int> refValues((size_t)scans * numPots);
+    double t0 = seconds();
+    for (int s = 0; s < scans; s++) {
+      if (s % 10000 == 9999) for (int p = 0; p < numPots; p++) ref[p].setBank((s / 10000) & 1);
+      for (int p = 0; p < numPots; p++) {
+        int x[4] = {samples[s][0][p], samples[s][1][p], samples[s][2][p], samples[s][3][p]};
+        refValues[(size_t)s * numPots + p] = ref[p].potSamples(x);
+      }
+    }
+    double refNs = (seconds() - t0) * 1e9 / ((double)scans * numPots);
+    printf("  readPot() per pot  %6.1f ns/pot  settle %4d us/scan\n", refNs, numPots * 30);
+
+    for (uint8_t kernel = MC_POTS_KERNEL_SCALAR; kernel <= MC_POTS_KERNEL_PIE; kernel++) {
+      if (!MultiControlPots::hasKernel(kernel)) continue;
+      MultiControl pots[16], check[16];
+      setup(pots, numPots);
+      setup(check, numPots);
+      MultiControlPots bank;
+      bank.setKernel(kernel);
+      for (int p = 0; p < numPots; p++) bank.addPot(&pots[p]);
+
+      // Timed run
+      t0 = seconds();
+      for (int s = 0; s < scans; s++) {
+        if (s % 10000 == 9999) for (int p = 0; p < numPots; p++) pots[p].setBank((s / 10000) & 1);
+        bank.update(samples[s]);
+      }
+      double ns = (seconds() - t0) * 1e9 / ((double)scans * numPots);
+
+      // Checked run: values and filter state against the per-pot pipeline after every scan
+      MultiControl again[16];
+      setup(again, numPots);
+      MultiControlPots checked;
+      checked.setKernel(kernel);
+      for (int p = 0; p < numPots; p++) checked.addPot(&again[p]);
+      long valueMismatches = 0, stateMismatches = 0;
+      for (int s = 0; s < scans; s++) {
+        if (s % 10000 == 9999) {
+          for (int p = 0; p < numPots; p++) {
+            again[p].setBank((s / 10000) & 1);
+            check[p].setBank((s / 10000) & 1);
+          }
+        }
+        checked.update(samples[s]);
+        for (int p = 0; p < numPots; p++) {
+          int x[4] = {samples[s][0][p], samples[s][1][p], samples[s][2][p], samples[s][3][p]};
+          int v = check[p].potSamples(x);
+          if (v != checked.getValue(p) || v != refValues[(size_t)s * numPots + p]) valueMismatches++;
+          else if (!sameState(check[p], again[p])) stateMismatches++;
+        }
+      }
+      failures += valueMismatches + stateMismatches != 0;
+
+      // Sampling cost on the device: four rounds with one settle delay each
+      hostMicros = 0;
+      bank.update();
+      printf("  %-18s %6.1f ns/pot  settle %4lu us/scan  %s\n", names[kernel], ns, hostMicros,
+             valueMismatches + stateMismatches ? "MISMATCH" : "same values and state as readPot()");
+      if (valueMismatches + stateMismatches) {
+        printf("    %ld readings with a different value, %ld more with a different filter state\n",
+               valueMismatches, stateMismatches);
+      }
+    }
+  }
+  return failures;
+}
@@ -0,0 +1,98 @@
+/*
+ * potfilter_bench.cpp - host benchmark for the readPot() smoothing filters.
+ *
+ * Feeds synthetic ADC input (a rest period, a step, a slow ramp and a fast flick, with
+ * Gaussian noise) through readPot() at two scan intervals and reports, for the filter
+ * it was built with:
+ *   jitter   output changes per second and output standard deviation at rest
+ *   step     ms until the output settles within 1% of the new position
+ *   ramp     mean lag in ms behind the true position during a ramp
+ * The same input is used for every build, so the results can be compared directly.
+ *
+ * Build and run all filters:
+ *   for f in 0 1 2; do
+ *     g++ -O2 -DMULTICONTROL_POT_FILTER=$f -I../replay -I../.. potfilter_bench.cpp -o potfilter_bench && ./potfilter_bench
+ *   done
+ * Options: potfilter_bench [noise sd in ADC counts, default 6]
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <random>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const uint8_t PIN = 1;
+const char* FILTER_NAMES[] = {"responsive", "one-euro", "ema"};
+
+struct Result { double changesPerSec, restSd, stepMs, slowLagMs, fastLagMs; };
+
+/* Drive one pot through the test input, scanning every intervalUs */
+Result run(unsigned long intervalUs, double noiseSd) {
+  std::mt19937 rng(1);
+  std::normal_distribution<double> noise(0.0, noiseSd);
+  MultiControl pot;
+  pot.setPin(PIN);
+  pot.setControl(1);
+  pot.setLatchEnabled(false);
+  hostMicros = 1000000;
+  unsigned long t0 = hostMicros;
+  int out = -1;
+  double pos = 2000;
+  // Phases in ms: rest 0-5000, step to 3000 at 5000, settle to 7000, back to 1000 at 7000,
+  // slow ramp 1000->3000 over 8000-9000, rest to 10000, fast flick 3000->1000 over 10000-10050, rest to 11000.
+  int restChanges = 0, restN = 0;
+  double restSum = 0, restSum2 = 0;
+  double stepDone = -1, slowLag = 0, fastLag = 0;
+  int slowN = 0, fastN = 0;
+  int prevOut = -1;
+  while (hostMicros - t0 < 11000000UL) {
+    double t = (hostMicros - t0) / 1000.0;
+    if (t < 5000) pos = 2000;
+    else if (t < 7000) pos = 3000;
+    else if (t < 8000) pos = 1000;
+    else if (t < 9000) pos = 1000 + 2000 * (t - 8000) / 1000.0;
+    else if (t < 10000) pos = 3000;
+    else if (t < 10050) pos = 3000 - 2000 * (t - 10000) / 50.0;
+    else pos = 1000;
+    hostAnalog[PIN] = constrain((int)lround(pos + noise(rng)), 0, 4095);
+    int v = pot.readPot();
+    if (v >= 0) out = v;
+    double ideal = pos / 4.0;
+    if (t >= 1000 && t < 5000) {  // rest, after the filter has settled
+      if (prevOut >= 0 && out != prevOut) restChanges++;
+      restSum += out;
+      restSum2 += (double)out * out;
+      restN++;
+    }
+    if (t >= 5000 && t < 7000) {
+      if (abs(out - 750) > 10) stepDone = -1;
+      else if (stepDone < 0) stepDone = t - 5000;
+    }
+    if (t >= 8500 && t < 9000) { slowLag += (ideal - out) / 2.0; slowN++; }  // 2 units per ms
+    if (t >= 10025 && t < 10050) { fastLag += (out - ideal) / 10.0; fastN++; }  // 10 units per ms
+    prevOut = out;
+    hostMicros += intervalUs;
+  }
+  Result r;
+  r.changesPerSec = restChanges / 4.0;
+  double mean = restSum / restN;
+  r.restSd = sqrt(max(0.0, restSum2 / restN - mean * mean));
+  r.stepMs = stepDone < 0 ? 2000 : stepDone;
+  r.slowLagMs = slowN ? slowLag / slowN : 0;
+  r.fastLagMs = fastN ? fastLag / fastN : 0;
+  return r;
+}
+
+int main(int argc, char** argv) {
+  double noiseSd = argc > 1 ? atof(argv[1]) : 6.0;
+  printf("filter %s, noise sd %.1f ADC counts\n", FILTER_NAMES[MULTICONTROL_POT_FILTER], noiseSd);
+  printf("  scan    changes/s  rest sd   step ms   slow ramp lag ms   fast flick lag ms\n");
+  const unsigned long intervals[] = {1000, 4000};
+  for (unsigned long us : intervals) {
+    Result r = run(us, noiseSd);
+    printf("  %2lu ms   %8.2f  %8.3f  %8.0f  %17.1f  %18.1f\n", us / 1000, r.changesPerSec, r.restSd, r.stepMs, r.slowLagMs, r.fastLagMs);
+  }
+  return 0;
+}
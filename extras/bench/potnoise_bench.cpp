@@ -0,0 +1,120 @@
+/*
+ * potnoise_bench.cpp - host benchmark for per-pot noise tracking (setPotAutoTune).
+ *
+ * Simulates pots from very quiet to very noisy, one of them with 50 Hz hum, each ADC
+ * sample with its own noise, read once per millisecond. Every pot is played the same way:
+ * 20 s at rest (time to adapt), 10 s at rest (measured), a small move of 40 ADC counts
+ * and back, a large step, then 10 s at rest again (measured). Reports for the fixed
+ * defaults (activity threshold 4.0, hysteresis 3) and with auto-tuning:
+ *   jitter   output changes per second at rest
+ *   small    ms until the output follows a small move by 4 units (- if it never does)
+ *   step     ms until the output settles within 1% after a large step
+ *   thr/hys  the activity threshold and hysteresis in use at the end
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. potnoise_bench.cpp -o potnoise_bench && ./potnoise_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <random>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const uint8_t PIN = 1;
+
+struct Pot {
+  const char* name;
+  double noiseSd;  // ADC counts per sample
+  double hum;      // 50 Hz amplitude, ADC counts
+};
+const Pot POTS[] = {
+  {"quiet (sd 1)", 1, 0},
+  {"clean (sd 3)", 3, 0},
+  {"typical (sd 8)", 8, 0},
+  {"noisy (sd 16)", 16, 0},
+  {"very noisy (sd 30)", 30, 0},
+  {"hum (sd 4, 50 Hz 24)", 4, 24},
+};
+
+std::mt19937 rng;
+std::normal_distribution<double> gauss(0.0, 1.0);
+double pos;
+const Pot* current;
+
+/* Each sample gets its own noise, and the hum follows the host clock */
+int readAdc(uint8_t) {
+  double t = hostMicros * 1e-6;
+  double x = pos + current->noiseSd * gauss(rng) + current->hum * sin(2 * M_PI * 50 * t);
+  return constrain((int)lround(x), 0, 4095);
+}
+
+struct Result {
+  double jitter, smallMs, stepMs;
+  float threshold;
+  int hysteresis;
+};
+
+Result run(const Pot& p, bool autoTune) {
+  rng.seed(1);
+  current = &p;
+  MultiControl pot;
+  pot.setPin(PIN);
+  pot.setControl(1);
+  pot.setLatchEnabled(false);
+  pot.setPotAutoTune(autoTune);
+  hostMicros = 1000000;
+  unsigned long t0 = hostMicros;
+  int out = -1, prevOut = -1, restChanges = 0, smallBase = -1;
+  double smallMs = -1, smallBackMs = -1, stepMs = -1;
+  while (hostMicros - t0 < 46000000UL) {
+    double t = (hostMicros - t0) / 1000.0;
+    // Rest at 2000, small move to 2040 at 30000 and back at 31000, step to 3000 at 32000
+    if (t < 30000) pos = 2000;
+    else if (t < 31000) pos = 2040;
+    else if (t < 32000) pos = 2000;
+    else pos = 3000;
+    int v = pot.readPot();
+    if (v >= 0) out = v;
+    if ((t >= 20000 && t < 30000) || t >= 36000) {
+      if (prevOut >= 0 && out != prevOut) restChanges++;
+    }
+    if (t == 30000) smallBase = out;
+    if (t >= 30000 && t < 31000 && smallMs < 0 && out >= smallBase + 4) smallMs = t - 30000;
+    if (t == 31000) smallBase = out;
+    if (t >= 31000 && t < 32000 && smallBackMs < 0 && out <= smallBase - 4) smallBackMs = t - 31000;
+    if (t >= 32000 && t < 36000) {
+      if (abs(out - 750) > 10) stepMs = -1;
+      else if (stepMs < 0) stepMs = t - 32000;
+    }
+    prevOut = out;
+    hostMicros = t0 + (unsigned long)(t + 1) * 1000;
+  }
+  Result r;
+  r.jitter = restChanges / 20.0;
+  r.smallMs = (smallMs < 0 || smallBackMs < 0) ? -1 : (smallMs + smallBackMs) / 2;
+  r.stepMs = stepMs;
+  r.threshold = pot.getActivityThreshold();
+  r.hysteresis = pot.getPotHysteresis();
+  return r;
+}
+
+void print(const Result& r) {
+  char small[8] = "-";
+  if (r.smallMs >= 0) snprintf(small, sizeof(small), "%.0f", r.smallMs);
+  printf("  %7.2f %6s %5.0f  %5.1f/%-2d", r.jitter, small, r.stepMs, r.threshold, r.hysteresis);
+}
+
+int main() {
+  hostAnalogReadHook = readAdc;
+  printf("                         fixed defaults                  auto-tuned\n");
+  printf("                          jitter  small  step  thr/hys     jitter  small  step  thr/hys\n");
+  for (const Pot& p : POTS) {
+    printf("%-22s", p.name);
+    print(run(p, false));
+    print(run(p, true));
+    printf("\n");
+  }
+  return 0;
+}
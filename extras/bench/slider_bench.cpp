@@ -0,0 +1,301 @@
+/*
+ * slider_bench.cpp - host benchmark for MultiControlSlider (multi-pad touch slider and wheel).
+ *
+ * Simulated ESP32-S3 pads in a row (slider) or a ring (wheel), one pad pitch apart. A finger
+ * raises each pad by a bell-shaped footprint of its distance from the pad centre (a full
+ * touch on the pad under it, about a quarter on the next), plus read noise. The pads are
+ * calibrated, then synthetic finger movements are played, reading the slider every 3 ms.
+ * Compared with what sketches do now (readTouch() on every pad and a float centroid of all
+ * the deltas on each loop), reports:
+ *   error      position error (0-1023 units) of a finger held at 101 places along the slider
+ *   jitter     spread of the position of a still finger over 3 s (max - min)
+ *   velocity   mean reported velocity in the middle of constant-speed swipes, against the
+ *              true speed, and the velocity once the finger has rested on the last pad for
+ *              half a second (0 expected)
+ *   wheel      largest step between readings and position error of a finger circling a
+ *              wheel three times each way (wrap-around continuity)
+ *   cost       host ns per update of 6 pads (pad reads included), and per call from a
+ *              loop faster than the update interval
+ *
+ * Build and run:
+ *   g++ -O2 -DESP32 -DCONFIG_IDF_TARGET_ESP32S3 -I../replay -I../.. slider_bench.cpp -o slider_bench && ./slider_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <random>
+#include "MultiControl.h"
+#include "MultiControlSlider.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+#if !defined(ESP32) || defined(CONFIG_IDF_TARGET_ESP32)
+int main() {
+  printf("Build with -DESP32 -DCONFIG_IDF_TARGET_ESP32S3 (the S3 touch read path)\n");
+  return 0;
+}
+#else
+
+const int PADS = 6;
+const int WHEEL_PADS = 8;
+const double BASELINE = 400;  // touch units (touchRead() >> 8)
+const double SIGNAL = 120;    // delta of a finger centred on a pad
+const double WIDTH = 0.6;     // footprint sd, in pad pitches
+const double NOISE = 1.5;
+
+std::mt19937 rng(9);
+std::normal_distribution<double> noise(0.0, NOISE);
+
+MultiControl* pads = nullptr;
+int padCount = PADS;
+bool ring = false;
+double fingerAt = -1;  // pad pitches from the first pad centre, < 0 for no finger
+double pressure = 1.0;
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Set every pad's raw reading from the finger */
+void padsFromFinger() {
+  for (int i = 0; i < padCount; i++) {
+    double d = 0;
+    if (fingerAt >= 0) {
+      double dist = fabs(fingerAt - i);
+      if (ring) dist = min(dist, padCount - dist);
+      d = SIGNAL * pressure * exp(-dist * dist / (2 * WIDTH * WIDTH));
+    }
+    hostTouch[i] = (uint32_t)((BASELINE + d + noise(rng)) * 256.0);
+  }
+}
+
+/* Advance the clock ms and set the pads */
+void tick(int ms) {
+  hostMicros += ms * 1000UL;
+  padsFromFinger();
+}
+
+/* What sketches do: every pad, a float centroid of all positive deltas, 0-1023 */
+bool floatTouched;
+float floatPosition() {
+  float sum = 0, moment = 0;
+  floatTouched = false;
+  for (int i = 0; i < padCount; i++) {
+    pads[i].readTouch();
+    floatTouched |= pads[i].getTouchState();
+    float d = max(0, (int)pads[i].getTouchDelta());
+    sum += d;
+    moment += d * i;
+  }
+  if (sum <= 0) return 0;
+  return moment / sum * 1023.0f / (padCount - 1);
+}
+
+/* Pads calibrated and settled, no finger */
+void setupPads(int count, bool wheel, MultiControlSlider& slider) {
+  padCount = count;
+  ring = wheel;
+  fingerAt = -1;
+  delete[] pads;  // fresh pads for each test (the previous slider is gone)
+  pads = new MultiControl[count];
+  for (int i = 0; i < count; i++) {
+    pads[i].setPin(i);
+    pads[i].setControl(0);
+  }
+  for (int r = 0; r < 200; r++) {
+    tick(3);
+    for (int i = 0; i < count; i++) pads[i].readTouch();
+  }
+  slider.addPads(pads, count);
+  slider.setWheel(wheel);
+}
+
+double truePosition() {
+  return ring ? fingerAt * 1024.0 / padCount : fingerAt * 1023.0 / (padCount - 1);
+}
+
+/* Wheel difference, the short way round */
+double wrapDiff(double d) {
+  while (d > 512) d -= 1024;
+  while (d < -512) d += 1024;
+  return d;
+}
+
+void error() {
+  MultiControlSlider slider;
+  setupPads(PADS, false, slider);
+  double worst = 0, sq = 0, fWorst = 0, fSq = 0;
+  int n = 0;
+  printf("Position error, finger held at 101 places on a %d-pad slider (units of 1023)\n", PADS);
+  for (int s = 0; s <= 100; s++) {
+    fingerAt = s * (PADS - 1) / 100.0;
+    double raw = 0, f = 0;
+    for (int r = 0; r < 40; r++) {
+      tick(3);
+      slider.update(MC_MILLIS());
+      if (r >= 20) raw += slider.getRawPosition();
+    }
+    for (int r = 0; r < 20; r++) {
+      tick(3);
+      f += floatPosition();
+    }
+    raw /= 20;
+    f /= 20;
+    double e = raw - truePosition(), fe = f - truePosition();
+    worst = max(worst, fabs(e));
+    sq += e * e;
+    fWorst = max(fWorst, fabs(fe));
+    fSq += fe * fe;
+    n++;
+    fingerAt = -1;  // lift, so each place is a new touch
+    for (int r = 0; r < 20; r++) {
+      tick(3);
+      slider.update(MC_MILLIS());
+    }
+  }
+  printf("  float centroid, all pads     max %5.1f   rms %5.1f\n", fWorst, sqrt(fSq / n));
+  printf("  slider (peak + neighbours)   max %5.1f   rms %5.1f\n\n", worst, sqrt(sq / n));
+}
+
+void jitter() {
+  printf("Jitter, still finger for 3 s (position max - min, units)\n");
+  for (int hyst : {0, 5, 10, 15}) {
+    MultiControlSlider slider;
+    setupPads(PADS, false, slider);
+    slider.setHysteresis(hyst);
+    fingerAt = 2.3;
+    int lo = 1023, hi = 0, rawLo = 1023, rawHi = 0, changes = 0;
+    for (int r = 0; r < 1100; r++) {
+      tick(3);
+      bool changed = slider.update(MC_MILLIS());
+      if (r < 100) continue;  // touch settles
+      changes += changed;
+      lo = min(lo, slider.getPosition());
+      hi = max(hi, slider.getPosition());
+      rawLo = min(rawLo, slider.getRawPosition());
+      rawHi = max(rawHi, slider.getRawPosition());
+    }
+    printf("  hysteresis %2d   position %3d   raw %3d   changes reported %d\n", hyst, hi - lo, rawHi - rawLo,
+           changes);
+  }
+  printf("\n");
+}
+
+void velocity() {
+  printf("Velocity, swipes first to last pad (units/s)\n");
+  printf("  true speed   reported (mean)   float centroid, differenced per loop (mean, sd)   at rest\n");
+  for (double speed : {250.0, 1000.0, 4000.0}) {
+    MultiControlSlider slider;
+    setupPads(PADS, false, slider);
+    double ms = 1023.0 / speed * 1000.0;
+    double sum = 0, fSum = 0, fSq = 0;
+    int n = 0, fN = 0;
+    float prev = -1;
+    for (int t = 0; t < ms; t += 3) {
+      fingerAt = t / ms * (PADS - 1);
+      tick(3);
+      slider.update(MC_MILLIS());
+      float f = floatPosition();
+      if (t > ms * 0.3 && t < ms * 0.7) {
+        sum += slider.getVelocity();
+        n++;
+        if (prev >= 0) {
+          double v = (f - prev) * 1000.0 / 3.0;
+          fSum += v;
+          fSq += v * v;
+          fN++;
+        }
+      }
+      prev = f;
+    }
+    for (int t = 0; t < 500; t += 3) {
+      tick(3);
+      slider.update(MC_MILLIS());
+    }
+    double fMean = fSum / fN;
+    printf("  %7.0f      %9.0f        %9.0f %9.0f                             %5ld\n", speed, sum / n, fMean,
+           sqrt(fSq / fN - fMean * fMean), (long)slider.getVelocity());
+  }
+  printf("\n");
+}
+
+void wheel() {
+  MultiControlSlider slider;
+  setupPads(WHEEL_PADS, true, slider);
+  printf("Wheel, %d pads, finger circling 3 times each way at 1 turn/s\n", WHEEL_PADS);
+  double worstStep = 0, worstErr = 0;
+  int prev = -1;
+  long turns = 0;  // position units travelled, in wheel turns x 1024
+  for (int dir : {1, -1}) {
+    fingerAt = 0.2;
+    for (int t = 0; t < 3000; t += 3) {
+      fingerAt = fmod(0.2 + dir * t / 1000.0 * WHEEL_PADS + 3 * WHEEL_PADS, WHEEL_PADS);
+      tick(3);
+      slider.update(MC_MILLIS());
+      if (!slider.isTouched()) continue;
+      int p = slider.getPosition();
+      if (prev >= 0) {
+        double step = wrapDiff(p - prev);
+        worstStep = max(worstStep, fabs(step));
+        turns += (long)step;
+      }
+      prev = p;
+      if (t > 100) worstErr = max(worstErr, fabs(wrapDiff(p - truePosition())));
+    }
+  }
+  printf("  largest step %.0f units (about %.0f expected per 3 ms), largest error %.0f units\n", worstStep,
+         1024 * 3 / 1000.0, worstErr);
+  printf("  net travel %.2f turns (0 expected, 3 forward and 3 back)\n\n", turns / 1024.0);
+}
+
+void cost() {
+  MultiControlSlider slider;
+  setupPads(PADS, false, slider);
+  slider.setInterval(0);
+  fingerAt = 2.5;
+  tick(3);
+  const int N = 2000000;
+  volatile int sink = 0;
+  double t0 = seconds();
+  for (int i = 0; i < N; i++) {
+    hostMicros += 1000;
+    slider.update(MC_MILLIS());
+    sink += slider.getPosition();
+  }
+  double integer = (seconds() - t0) * 1e9 / N;
+  t0 = seconds();
+  for (int i = 0; i < N; i++) {
+    hostMicros += 1000;
+    sink += (int)floatPosition();
+  }
+  double floating = (seconds() - t0) * 1e9 / N;
+  // A loop faster than the interval: most calls return at once
+  slider.setInterval(3);
+  t0 = seconds();
+  for (int i = 0; i < N; i++) {
+    hostMicros += 100;
+    slider.update(MC_MILLIS());
+    sink += slider.getPosition();
+  }
+  double loop = (seconds() - t0) * 1e9 / N;
+  printf("Cost per update, %d pads (pad reads included)\n", PADS);
+  printf("  float centroid, all pads  %6.1f ns\n", floating);
+  printf("  slider                    %6.1f ns\n", integer);
+  printf("  slider, 10 kHz loop        %6.1f ns per call (reads every 3 ms)\n", loop);
+  printf("  at 330 updates/s          %6.1f us of each second\n", integer * 330 / 1000);
+}
+
+int main() {
+  error();
+  jitter();
+  velocity();
+  wheel();
+  cost();
+  return 0;
+}
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * stream_bench.cpp - host benchmark for MultiControlStream and the mcstream.h decoder.
+ *
+ * Simulates a panel of 16 pots and 8 buttons for ten minutes, scanned every millisecond:
+ * pots are moved a few at a time with ADC noise, buttons are clicked, double-clicked and
+ * held, and the bank changes every 20 s so pots latch. The panel is streamed over a
+ * simulated 115200 baud serial port and decoded in random-sized chunks. Reports:
+ *   bandwidth   stream bytes per second against a text status line in the style of
+ *               the Bank_Test example at the same rate
+ *   checks      decoded state against the panel after every frame, and decoded presses
+ *   cost        encode time per scan and decoder throughput
+ * A second pass flips random bits on the line and reports how the decoder recovers
+ * using a one-second snapshot interval. A lost frame is only noticed when the next one
+ * arrives, so the decoder can briefly be stale while still reporting itself in sync.
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../stream -I../.. stream_bench.cpp -o stream_bench && ./stream_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlStream.h"
+#include "mcstream.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int POTS = 16;
+const int BUTTONS = 8;
+const int SCANS = 600000;
+const double LINK_BYTES_PER_SEC = 11520;  // 115200 baud, 8N1
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Serial port stand-in: keeps what was written */
+class SimSerial : public Print {
+  public:
+    std::vector<uint8_t> data;
+    size_t write(uint8_t b) { data.push_back(b); return 1; }
+    size_t write(const uint8_t* buffer, size_t size) {
+      data.insert(data.end(), buffer, buffer + size);
+      return size;
+    }
+};
+
+struct Panel {
+  MultiControl controls[POTS + BUTTONS];
+  double pos[POTS], target[POTS];
+  uint32_t buttonUntil[BUTTONS];   // ms the current press ends
+  uint32_t nextPress[BUTTONS];     // ms of the next press
+  uint8_t secondPress[BUTTONS];    // a double-click's second press is due
+  int presses = 0;
+  int prevButton[BUTTONS];
+
+  void setup() {
+    for (int i = 0; i < POTS; i++) {
+      controls[i].setPin(i);
+      controls[i].setControl(1);
+      pos[i] = target[i] = 2048;
+      hostAnalog[i] = 2048;
+    }
+    for (int b = 0; b < BUTTONS; b++) {
+      hostDigital[32 + b] = 1;
+      controls[POTS + b].setPin(32 + b);
+      controls[POTS + b].setControl(2);
+      buttonUntil[b] = 0;
+      nextPress[b] = 500 + b * 700;
+      secondPress[b] = 0;
+      prevButton[b] = 1;
+    }
+  }
+
+  /* Move the simulated hardware and read every control, as a sketch's loop() would */
+  void scan(uint32_t ms, std::mt19937& rng, std::normal_distribution<double>& noise) {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (int i = 0; i < POTS; i++) {
+      if (u(rng) < 0.0002) target[i] = u(rng) * 4095;  // a new gesture every 5 s or so
+      pos[i] += constrain(target[i] - pos[i], -4.0, 4.0);
+      hostAnalog[i] = constrain((int)lround(pos[i] + noise(rng)), 0, 4095);
+    }
+    for (int b = 0; b < BUTTONS; b++) {
+      if (ms >= nextPress[b] && buttonUntil[b] == 0) {
+        double r = u(rng);
+        buttonUntil[b] = ms + (r < 0.2 ? 800 : 80);  // some holds
+        if (r > 0.8) secondPress[b] = 1;              // some double-clicks
+        nextPress[b] = ms + 1500 + (uint32_t)(u(rng) * 3000);
+      }
+      if (buttonUntil[b] != 0 && ms >= buttonUntil[b]) {
+        buttonUntil[b] = 0;
+        if (secondPress[b]) {
+          secondPress[b] = 0;
+          nextPress[b] = ms + 120;
+        }
+      }
+      hostDigital[32 + b] = buttonUntil[b] != 0 ? 0 : 1;
+    }
+    if (ms % 20000 == 10000) {
+      for (int i = 0; i < POTS; i++) controls[i].setBank((ms / 20000) & 1);
+    }
+    for (int i = 0; i < POTS; i++) controls[i].readPot();
+    for (int b = 0; b < BUTTONS; b++) {
+      int v = controls[POTS + b].readButton();
+      if (v == 0 && prevButton[b] == 1) presses++;
+      prevButton[b] = v;
+    }
+  }
+
+  /* Length of a Bank_Test style status line for the whole panel */
+  size_t textLine() {
+    char line[512];
+    size_t len = 0;
+    for (int i = 0; i < POTS; i++) {
+      int latch = controls[i].getLatchState();
+      if (latch) len += snprintf(line, sizeof(line), " pot%d: %c", i, "v^?VA"[-latch - 1]);
+      else len += snprintf(line, sizeof(line), " pot%d: %d", i, controls[i].getValue());
+    }
+    for (int b = 0; b < BUTTONS; b++) len += snprintf(line, sizeof(line), " button%d: %d", b, controls[POTS + b].getValue() == 0);
+    return len + 2;  // println
+  }
+};
+
+int32_t panelValue(MultiControl& c) { return c.getControl() == 5 ? c.getEncoderPosition() : c.getValue(); }
+
+int main() {
+  // Clean link
+  Panel panel;
+  panel.setup();
+  MultiControlStream stream;
+  SimSerial serial;
+  stream.addControls(panel.controls, POTS + BUTTONS);
+  stream.begin(serial);
+  McStreamDecoder decoder;
+  std::mt19937 rng(1), chunkRng(2);
+  std::normal_distribution<double> noise(0.0, 4.0);
+  size_t fed = 0, textBytes = 0;
+  uint32_t checks = 0, mismatches = 0, decodedPresses = 0;
+  double encodeTime = 0;
+  for (int s = 0; s < SCANS; s++) {
+    hostMicros = (unsigned long)s * 1000 + 1000;
+    panel.scan(s, rng, noise);
+    uint32_t frames = stream.getFrameCount();
+    double t0 = seconds();
+    stream.update();
+    encodeTime += seconds() - t0;
+    if (stream.getFrameCount() != frames) {
+      textBytes += panel.textLine();  // the text protocol would send a line at the same moments
+      while (fed < serial.data.size()) {
+        size_t n = std::min(serial.data.size() - fed, (size_t)(1 + chunkRng() % 64));
+        decoder.feed(&serial.data[fed], n);
+        fed += n;
+      }
+      checks++;
+      for (int i = 0; i < POTS + BUTTONS; i++) {
+        const McStreamControl& c = decoder.control(i);
+        if (c.value != panelValue(panel.controls[i]) || c.latch != panel.controls[i].getLatchState() ||
+            (int)c.bank != panel.controls[i].getBank()) {
+          mismatches++;
+          break;
+        }
+      }
+      McStreamChange change;
+      while (decoder.readChange(change)) {
+        if (change.kind == McStreamChange::GESTURES && (change.value & MCSTREAM_PRESS)) decodedPresses++;
+      }
+    }
+  }
+  double secs = SCANS / 1000.0;
+  printf("clean link, %d pots + %d buttons, %d s\n", POTS, BUTTONS, SCANS / 1000);
+  printf("  stream  %8.0f bytes/s  (%4.1f%% of 115200 baud), %u frames, %.1f bytes/frame\n",
+         serial.data.size() / secs, 100.0 * serial.data.size() / secs / LINK_BYTES_PER_SEC,
+         stream.getFrameCount(), (double)serial.data.size() / stream.getFrameCount());
+  printf("  text    %8.0f bytes/s  (%4.1f%% of 115200 baud), a status line per frame\n",
+         textBytes / secs, 100.0 * textBytes / secs / LINK_BYTES_PER_SEC);
+  printf("  checks  %u/%u frames with state matching the panel, %u/%d presses decoded, %llu crc errors\n",
+         checks - mismatches, checks, decodedPresses, panel.presses, (unsigned long long)decoder.crcErrors());
+  printf("  encode  %.0f ns per update()\n", encodeTime * 1e9 / SCANS);
+
+  McStreamDecoder bulk;
+  bulk.setQueueChanges(false);
+  int reps = 20;
+  double t0 = seconds();
+  for (int r = 0; r < reps; r++) bulk.feed(serial.data.data(), serial.data.size());
+  double t1 = seconds();
+  printf("  decode  %.0f MB/s (%.0f frames/ms)\n", serial.data.size() * reps / (t1 - t0) / 1e6,
+         (double)bulk.frames() / ((t1 - t0) * 1000));
+
+  // Noisy link: flip bits, recover with periodic snapshots
+  Panel noisy;
+  noisy.setup();
+  MultiControlStream stream2;
+  SimSerial serial2;
+  stream2.addControls(noisy.controls, POTS + BUTTONS);
+  stream2.setSnapshotInterval(1000);
+  stream2.begin(serial2);
+  McStreamDecoder decoder2;
+  decoder2.setQueueChanges(false);
+  std::mt19937 rng2(1), flipRng(3);
+  fed = 0;
+  uint32_t checks2 = 0, staleWhileSynced = 0, outOfSync = 0, flips = 0;
+  for (int s = 0; s < SCANS; s++) {
+    hostMicros = (unsigned long)s * 1000 + 1000;
+    noisy.scan(s, rng2, noise);
+    uint32_t frames = stream2.getFrameCount();
+    stream2.update();
+    if (stream2.getFrameCount() == frames) continue;
+    for (; fed < serial2.data.size(); fed++) {
+      uint8_t b = serial2.data[fed];
+      if (flipRng() % 20000 == 0) {
+        b ^= 1 << (flipRng() & 7);
+        flips++;
+      }
+      decoder2.feed(&b, 1);
+    }
+    checks2++;
+    if (!decoder2.isSynced()) {
+      outOfSync++;
+      continue;
+    }
+    for (int i = 0; i < POTS + BUTTONS; i++) {
+      if (decoder2.control(i).value != panelValue(noisy.controls[i])) {
+        staleWhileSynced++;
+        break;
+      }
+    }
+  }
+  printf("noisy link, 1 bit flip per 20000 bytes, snapshot every 1 s\n");
+  printf("  %u flips, %llu crc errors, %llu frames lost, %.2f%% of frames out of sync, %u stale while in sync\n",
+         flips, (unsigned long long)decoder2.crcErrors(), (unsigned long long)decoder2.lostFrames(),
+         100.0 * outOfSync / checks2, staleWhileSynced);
+  return 0;
+}
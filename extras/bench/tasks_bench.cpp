@@ -0,0 +1,242 @@
+/*
+ * tasks_bench.cpp - host test and benchmark for MultiControlTasks (C++20 coroutines).
+ *
+ * First plays scripted presses, holds, double-clicks and pot moves to tasks that wait on
+ * them, and checks that each task resumes on the right event at the right time: a press and
+ * release sequence, anyOf() with a double-click, a hold and a timeout, a pot turned beyond a
+ * distance (and a value above 16 bits moved beyond one), an anyOf() whose losing wait must
+ * not fire later, a full frame pool and stopAll(). The expected times are the events the
+ * sketch takes from the same buttons with takeGestureEvents(), which must not take them
+ * from the tasks. Returns the number of failed checks.
+ * Then measures the host time of update() on a 64-button panel with tasks waiting:
+ *   idle       ns per update() with no events, with tasks on as many buttons or all on one
+ *   resume     ns per update() with a press that resumes the task(s) waiting for it, which
+ *              then wait again (includes the button's gesture engine)
+ *
+ * Build and run:
+ *   g++ -std=c++20 -O2 -I../replay -I../.. tasks_bench.cpp -o tasks_bench && ./tasks_bench
+ */
+
+#define MULTICONTROL_TASKS_FRAMES 32
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+#include "MultiControl.h"
+#include "MultiControlTasks.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int BUTTONS = 64;
+const uint8_t POT_PIN = 40;
+
+MultiControl buttons[BUTTONS];
+MultiControl pot;
+MultiControlTasks tasks;
+std::vector<long> seen;  // what the tasks saw, in order
+struct Reported { int button; uint8_t bits; long at; };
+std::vector<Reported> reported;  // what the sketch's own takeGestureEvents() saw on buttons 0-3
+int failures = 0;
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+long now() { return hostMicros / 1000; }
+
+/* Read the panel and run the tasks, once per ms */
+void scan(long ms) {
+  for (long i = 0; i < ms; i++) {
+    hostMicros += 1000;
+    for (int b = 0; b < BUTTONS; b++) buttons[b].readButton();
+    for (int b = 0; b < 4; b++) {
+      uint8_t bits = buttons[b].takeGestureEvents();  // the tasks take their own copy
+      if (bits) reported.push_back({b, bits, now()});
+    }
+    pot.readPot();
+    tasks.update(now());
+  }
+}
+
+/* Hold a button down for downMs, then let it go for upMs */
+void press(int b, long downMs, long upMs) {
+  hostDigital[b] = 0;
+  scan(downMs);
+  hostDigital[b] = 1;
+  scan(upMs);
+}
+
+/* When polling saw the nth event with this bit on a button (-1 if never) */
+long polled(int button, uint8_t bit, int nth = 0) {
+  for (const Reported& r : reported) {
+    if (r.button == button && (r.bits & bit) && nth-- == 0) return r.at;
+  }
+  return -1;
+}
+
+void check(const char* name, const std::vector<long>& expect, long tolerance = 0) {
+  bool ok = seen.size() == expect.size();
+  for (size_t i = 0; ok && i < expect.size(); i++) ok = labs(seen[i] - expect[i]) <= tolerance;
+  printf("  %-48s %s", name, ok ? "ok" : "FAIL");
+  if (!ok) {
+    printf("  got");
+    for (long v : seen) printf(" %ld", v);
+    printf(", expected");
+    for (long v : expect) printf(" %ld", v);
+    failures++;
+  }
+  printf("\n");
+  seen.clear();
+}
+
+MultiControlTask pressRelease(MultiControl& b) {
+  co_await tasks.pressed(b);
+  seen.push_back(now());
+  co_await tasks.released(b);
+  seen.push_back(now());
+}
+
+MultiControlTask doubleHoldOrTimeout(MultiControl& a, MultiControl& b, int rounds) {
+  for (int i = 0; i < rounds; i++) {
+    int which = co_await tasks.anyOf(tasks.doubleClicked(a), tasks.held(b), tasks.timeout(1000));
+    seen.push_back(which);
+    seen.push_back(now());
+  }
+}
+
+MultiControlTask potMove(MultiControl& p, int amount) {
+  int from = p.getValue();
+  int value = co_await tasks.changedBeyond(p, amount);
+  seen.push_back(abs(value - from) >= amount);
+  seen.push_back(value == p.getValue());
+}
+
+MultiControlTask pressOrTimeout(MultiControl& b) {
+  int which = co_await tasks.anyOf(tasks.pressed(b), tasks.timeout(100));
+  seen.push_back(which);
+  seen.push_back(now());
+}
+
+long resumes = 0;
+MultiControlTask counter(MultiControlTasks& t, MultiControl& b) {
+  for (;;) {
+    co_await t.pressed(b);
+    resumes++;
+  }
+}
+
+void behaviour() {
+  printf("Behaviour (debounce %lu ms, double-click %lu ms, hold %lu ms)\n", buttons[0].getDebounceTime(),
+         buttons[0].getDoubleClickTime(), buttons[0].getHoldTime());
+
+  // Each wait resumes in the scan where polling sees the event
+  tasks.start(pressRelease(buttons[0]));
+  scan(50);
+  press(0, 100, 100);
+  check("pressed() then released()", {polled(0, MC_GESTURE_PRESS), polled(0, MC_GESTURE_RELEASE)});
+
+  // A double-click on button 1, a hold on button 2, then nothing: positions 0, 1, 2
+  tasks.start(doubleHoldOrTimeout(buttons[1], buttons[2], 3));
+  scan(20);
+  press(1, 60, 80);
+  press(1, 60, 300);
+  press(2, 700, 100);
+  scan(1200);
+  long holdAt = polled(2, MC_GESTURE_HOLD);
+  check("anyOf(double-click, hold, timeout)", {0, polled(1, MC_GESTURE_DOUBLE), 1, holdAt, 2, holdAt + 1000});
+
+  // A pot turned by about 100 units; waiting for 40 resumes once, with the new value
+  tasks.start(potMove(pot, 40));
+  scan(100);
+  hostAnalog[POT_PIN] = 2400;
+  scan(200);
+  check("changedBeyond(40) on a 100-unit pot move", {1, 1});
+
+  // A value above 16 bits (set with setBankValue()): fires 10 away from 40000, not at once
+  MultiControl big;
+  big.setBankValue(0, 40000);
+  tasks.start(potMove(big, 10));
+  scan(5);
+  big.setBankValue(0, 40005);
+  scan(5);
+  bool early = !seen.empty();
+  big.setBankValue(0, 40012);
+  scan(5);
+  seen.push_back(early);
+  check("changedBeyond(10) from a value of 40000", {1, 1, 0});
+
+  // The losing wait of an anyOf() is disarmed: a later press does not resume the task
+  long t0 = now();
+  tasks.start(pressOrTimeout(buttons[3]));
+  scan(150);
+  press(3, 60, 60);
+  check("anyOf(press, timeout 100) with a late press", {1, t0 + 100});
+  seen = {tasks.getWaitingCount(), MultiControlTasks::getFramesInUse()};
+  check("nothing waiting, no frames in use", {0, 0});
+
+  // Every frame in use: the next start() fails; stopAll() gives the frames back
+  int started = 0;
+  for (int i = 0; i <= MULTICONTROL_TASKS_FRAMES; i++) started += tasks.start(counter(tasks, buttons[4 + i]));
+  seen = {started, MultiControlTasks::getFramesInUse()};
+  check("full pool: start() fails past the last frame", {MULTICONTROL_TASKS_FRAMES, MULTICONTROL_TASKS_FRAMES});
+  tasks.stopAll();
+  seen = {tasks.getWaitingCount(), MultiControlTasks::getFramesInUse()};
+  check("stopAll() frees every frame", {0, 0});
+  printf("  largest frame %zu bytes (MULTICONTROL_TASKS_FRAME_SIZE %d)\n\n", MultiControlTasks::getLargestFrame(),
+         MULTICONTROL_TASKS_FRAME_SIZE);
+}
+
+/* ns per update() with no events, and per update() that resumes a task */
+void cost(int numTasks, bool oneButton) {
+  MultiControlTasks panel;
+  for (int i = 0; i < numTasks; i++) panel.start(counter(panel, buttons[oneButton ? 0 : i]));
+  const int UPDATES = 1000000;
+  unsigned long t = now();
+  double t0 = seconds();
+  for (int i = 0; i < UPDATES; i++) panel.update(++t);
+  double idle = (seconds() - t0) * 1e9 / UPDATES;
+
+  // Press events without the button reads: one button presses and releases every update
+  MultiControl& b = buttons[0];
+  const int PRESSES = 200000;
+  resumes = 0;
+  t0 = seconds();
+  for (int i = 0; i < PRESSES; i++) {
+    b.buttonLevel(0, ++t);  // debounced press on the next level after the debounce time
+    b.buttonLevel(0, t += 30);
+    b.buttonLevel(1, ++t);
+    b.buttonLevel(1, t += 30);
+    panel.update(t);
+  }
+  double resume = numTasks ? ((seconds() - t0) * 1e9 / PRESSES) : 0;
+  printf("  %3d on %-10s %8.1f", numTasks, oneButton ? "one button" : "as many", idle);
+  if (numTasks && resumes) printf("   %8.1f (%ld resumes per press)\n", resume, resumes / PRESSES);
+  else printf("\n");
+  panel.stopAll();
+}
+
+int main() {
+  for (int b = 0; b < BUTTONS; b++) {
+    hostDigital[b] = 1;
+    buttons[b].setPin(b);
+    buttons[b].setControl(2);
+  }
+  hostAnalog[POT_PIN] = 2000;
+  pot.setPin(POT_PIN);
+  pot.setControl(1);
+  pot.setLatchEnabled(false);
+  scan(1000);
+
+  behaviour();
+
+  printf("update() with tasks waiting, host time (buttons not read)\n");
+  printf("  tasks waiting   idle ns   resume ns\n");
+  cost(0, false);
+  for (int n : {1, 8, 32}) cost(n, false);
+  for (int n : {8, 32}) cost(n, true);
+  printf("\n%s\n", failures ? "FAILED" : "all checks passed");
+  return failures;
+}
@@ -0,0 +1,167 @@
+/*
+ * touchcal_bench.cpp - host benchmark for touch calibration (calibrateTouchPads() and
+ * beginTouchCalibration()).
+ *
+ * A board of 14 ESP32-S3 pads with different baselines and read noise. Each pad read draws
+ * fresh noise. Reports:
+ *   boot       ms until the board is ready, calibrating pad by pad with calibrateTouch(),
+ *              all together with calibrateTouchPads(), and in the background; pads still
+ *              calibrating on return, and the largest baseline error as each pad finishes
+ *   early stop a pad that is disturbed during calibration, calibrated alone (blocking, and in
+ *              the background with a readTouch() every 4 ms):
+ *                rest     a finger resting lightly from 20 ms on (raised by 1.5 ON thresholds:
+ *                         every later read is an outlier, none a touch)
+ *                press    a firm touch from 20 ms to 2 s
+ *                spikes   noise spikes of 3 ON thresholds on a third of reads
+ *              ms until calibration ends (every read counts toward the limit, so it ends by
+ *              the 50th), and whether the pad is still calibrating when the blocking call returns
+ *
+ * Build and run:
+ *   g++ -O2 -DESP32 -DCONFIG_IDF_TARGET_ESP32S3 -I../replay -I../.. touchcal_bench.cpp -o touchcal_bench && ./touchcal_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <random>
+
+// Fresh noise on every pad read
+uint32_t simTouch(uint8_t pin);
+#define touchRead(pin) simTouch(pin)
+
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+#if !defined(ESP32) || defined(CONFIG_IDF_TARGET_ESP32)
+int main() {
+  printf("Build with -DESP32 -DCONFIG_IDF_TARGET_ESP32S3 (the S3 touch read path)\n");
+  return 0;
+}
+#else
+
+const int PADS = 14;
+
+std::mt19937 rng(3);
+double baseline[64], noiseSd[64];
+double extra = 0;          // finger or disturbance on pad 0, touch units
+unsigned long extraFrom = 0, extraTo = 0;
+double spikeRate = 0;      // share of reads with a spike on pad 0
+double spike = 0;
+
+uint32_t simTouch(uint8_t pin) {
+  std::normal_distribution<double> n(0.0, noiseSd[pin]);
+  double v = baseline[pin] + n(rng);
+  if (pin == 0) {
+    unsigned long ms = millis();
+    if (ms >= extraFrom && ms < extraTo) v += extra;
+    if (spikeRate > 0 && std::uniform_real_distribution<double>(0, 1)(rng) < spikeRate) v += spike;
+  }
+  return (uint32_t)(v * 256.0);
+}
+
+void setupPads(MultiControl* pads, int count) {
+  for (int i = 0; i < count; i++) {
+    pads[i].setPin(i);
+    pads[i].setControl(0);
+    baseline[i] = 380 + 9 * i;
+    noiseSd[i] = 0.3 + 0.25 * i;
+  }
+}
+
+int stillCalibrating(MultiControl* pads, int count) {
+  int n = 0;
+  for (int i = 0; i < count; i++) n += pads[i].isTouchCalibrating();
+  return n;
+}
+
+/* Baseline error of each pad when its calibration ended */
+double endError[64];
+
+/* Read every pad every 4 ms until none is calibrating; ms taken, or -1 after 10 s */
+long finishInBackground(MultiControl* pads, int count) {
+  unsigned long start = millis();
+  while (stillCalibrating(pads, count)) {
+    if (millis() - start > 10000) return -1;
+    for (int i = 0; i < count; i++) {
+      if (!pads[i].isTouchCalibrating()) continue;
+      pads[i].readTouch();
+      if (!pads[i].isTouchCalibrating()) endError[i] = fabs(pads[i].getTouchBaseline() - baseline[i]);
+    }
+    delay(4);
+  }
+  return millis() - start;
+}
+
+void boot() {
+  printf("Boot, %d pads, 50 readings at most per pad\n", PADS);
+  printf("  method                 returns after   calibrating on return   ready after   worst baseline error\n");
+  for (int method = 0; method < 3; method++) {
+    MultiControl pads[PADS];
+    setupPads(pads, PADS);
+    hostMicros = 0;
+    unsigned long ms;
+    if (method == 0) {
+      for (int i = 0; i < PADS; i++) pads[i].calibrateTouch(50);
+      ms = millis();
+    } else {
+      ms = MultiControl::calibrateTouchPads(pads, PADS, 50, method == 2);
+    }
+    int left = stillCalibrating(pads, PADS);
+    for (int i = 0; i < PADS; i++) endError[i] = fabs(pads[i].getTouchBaseline() - baseline[i]);
+    long rest = finishInBackground(pads, PADS);  // 0 if none left
+    double worst = 0;
+    for (int i = 0; i < PADS; i++) worst = max(worst, endError[i]);
+    const char* name[3] = {"pad by pad", "together", "background"};
+    printf("  %-20s   %6lu ms          %4d                 %6ld ms      %5.2f\n", name[method], ms, left,
+           (long)ms + rest, worst);
+  }
+  printf("\n");
+}
+
+void earlyStop() {
+  printf("Early stop, one disturbed pad\n");
+  printf("  case       blocking: returns after, still calibrating   background: ends after\n");
+  for (int c = 0; c < 3; c++) {
+    long blocking = 0, background = 0;
+    int left = 0;
+    for (int bg = 0; bg < 2; bg++) {
+      MultiControl pad;
+      setupPads(&pad, 1);
+      hostMicros = 0;
+      double threshold = pad.getTouchOnThreshold();
+      extra = spikeRate = 0;
+      if (c == 0) {
+        extra = 1.5 * threshold;
+        extraFrom = 20;
+        extraTo = 1000000;
+      } else if (c == 1) {
+        extra = 5 * threshold;
+        extraFrom = 20;
+        extraTo = 2000;
+      } else {
+        spikeRate = 1.0 / 3;
+        spike = 3 * threshold;
+      }
+      unsigned long ms = MultiControl::calibrateTouchPads(&pad, 1, 50, bg);
+      if (!bg) {
+        blocking = ms;
+        left = pad.isTouchCalibrating();
+      } else {
+        long rest = finishInBackground(&pad, 1);
+        background = rest < 0 ? -1 : (long)ms + rest;
+      }
+    }
+    const char* name[3] = {"rest", "press", "spikes"};
+    printf("  %-8s   %6ld ms   %s                               ", name[c], blocking, left ? "yes" : "no ");
+    if (background < 0) printf("not within 10 s\n");
+    else printf("%ld ms\n", background);
+  }
+}
+
+int main() {
+  boot();
+  earlyStop();
+  return 0;
+}
+
+#endif
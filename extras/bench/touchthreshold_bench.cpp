@@ -0,0 +1,231 @@
+/*
+ * touchthreshold_bench.cpp - host benchmark for adaptive touch thresholds (setTouchAdaptive).
+ *
+ * Plays ten minutes of touches on a row of eight ESP32-S3 pads that differ the way pads on
+ * one board do: large pads with a strong signal, small pads with a weak one, pads on long
+ * traces that pick up more noise, and one next to a switching regulator with noise spikes.
+ * Neighbouring pads couple, so a touch on one pad raises the two next to it by a fraction of
+ * its delta. Fingers ramp in over 5-20 ms at 50-100% of the pad's signal, some touches are
+ * chords of two neighbours. All pads are calibrated, then read once every 2-4 ms. Reports
+ * per setting and per pad:
+ *   false     touches reported with no finger on the pad (coupling or noise)
+ *   missed    touches never reported
+ *   on/off    mean ms from the finger arriving (leaving) to the reported touch (release)
+ *   thr       ON threshold at the end (adaptive)
+ *
+ * Build and run:
+ *   g++ -O2 -DESP32 -DCONFIG_IDF_TARGET_ESP32S3 -I../replay -I../.. touchthreshold_bench.cpp -o touchthreshold_bench && ./touchthreshold_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include "MultiControl.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const long MS = 600000;
+const int PADS = 8;
+
+struct Pad {
+  const char* name;
+  double baseline;  // touch units (touchRead() >> 8)
+  double signal;    // delta of a full touch
+  double noiseSd;
+  double coupling;  // fraction of a neighbour's delta
+  double spikes;    // noise spikes per second
+};
+const Pad PAD[PADS] = {
+  {"large", 420, 260, 1.5, 0.06, 0},
+  {"large, long trace", 510, 220, 4.0, 0.10, 0},
+  {"medium", 380, 120, 1.5, 0.12, 0},
+  {"small", 350, 45, 1.0, 0.08, 0},
+  {"small, long trace", 470, 40, 3.0, 0.08, 0},
+  {"medium, regulator", 400, 110, 2.0, 0.08, 2},
+  {"medium", 390, 130, 1.5, 0.12, 0},
+  {"large", 430, 250, 1.5, 0.06, 0},
+};
+
+struct Touch {
+  int pad;
+  long on, off;     // ms the finger arrives and leaves
+  double pressure;  // fraction of the pad's signal
+  long rampIn, rampOut;
+};
+
+/* Finger delta on a pad at time t */
+double finger(const Touch& k, long t) {
+  if (t < k.on || t >= k.off + k.rampOut) return 0;
+  double full = PAD[k.pad].signal * k.pressure;
+  if (t < k.on + k.rampIn) return full * (t - k.on) / k.rampIn;
+  if (t >= k.off) return full * (1.0 - (double)(t - k.off) / k.rampOut);
+  return full;
+}
+
+struct Result {
+  int falseTouches[PADS] = {}, missed[PADS] = {}, onCount = 0, offCount = 0;
+  double onMs = 0, offMs = 0;
+  int threshold[PADS] = {};
+};
+
+struct Setting {
+  const char* name;
+  int on, off, debounce;
+  bool adaptive;
+};
+
+Result run(const std::vector<Touch>& touches, const Setting& s) {
+  std::mt19937 rng(2);
+  std::normal_distribution<double> gauss(0.0, 1.0);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  MultiControl pads[PADS];
+  for (int p = 0; p < PADS; p++) {
+    pads[p].setPin(p + 1);
+    pads[p].setControl(0);
+    pads[p].setTouchThresholds(s.on, s.off);
+    pads[p].setTouchDebounceReads(s.debounce);
+    pads[p].setRetriggerThreshold(0);
+    pads[p].setTouchAdaptive(s.adaptive);
+  }
+  double level[PADS] = {};
+  int spikeLeft[PADS] = {};
+  auto sample = [&](long t) {
+    for (int p = 0; p < PADS; p++) level[p] = 0;
+    for (const Touch& k : touches) {
+      if (k.on > t) break;
+      double d = finger(k, t);
+      if (d <= 0) continue;
+      level[k.pad] += d;
+      if (k.pad > 0) level[k.pad - 1] += d * PAD[k.pad - 1].coupling;
+      if (k.pad < PADS - 1) level[k.pad + 1] += d * PAD[k.pad + 1].coupling;
+    }
+    for (int p = 0; p < PADS; p++) {
+      double x = PAD[p].baseline + level[p] + PAD[p].noiseSd * gauss(rng);
+      if (spikeLeft[p] > 0) {
+        spikeLeft[p]--;
+        x += 8 * PAD[p].noiseSd + 6 * u(rng);
+      } else if (u(rng) < PAD[p].spikes / 300.0) {
+        spikeLeft[p] = rng() % 2;
+      }
+      hostTouch[p + 1] = (uint32_t)(x * 256);
+    }
+  };
+
+  // Calibrate with nobody touching: calibrateTouchPads() with fresh samples every round
+  long start = 0;
+  for (int p = 0; p < PADS; p++) pads[p].beginTouchCalibration();
+  for (bool calibrating = true; calibrating; start += 4) {
+    hostMicros = (unsigned long)start * 1000;
+    sample(start);
+    calibrating = false;
+    for (int p = 0; p < PADS; p++) {
+      if (!pads[p].isTouchCalibrating()) continue;
+      pads[p].readTouch();
+      calibrating |= pads[p].isTouchCalibrating();
+    }
+  }
+
+  Result r;
+  std::vector<uint8_t> hit(touches.size(), 0);
+  bool state[PADS] = {};
+  int active[PADS];  // touch index the current report belongs to
+  for (int p = 0; p < PADS; p++) active[p] = -1;
+  size_t first = 0;
+  for (long t = start; t < MS;) {
+    hostMicros = (unsigned long)t * 1000;
+    sample(t);
+    while (first < touches.size() && touches[first].off + 200 < t) first++;
+    for (int p = 0; p < PADS; p++) {
+      bool touched = pads[p].isTouched();
+      if (touched && !state[p]) {
+        // A real touch if a finger is on this pad (or just left it) and was not reported yet
+        int match = -1;
+        for (size_t i = first; i < touches.size() && touches[i].on <= t; i++) {
+          if (touches[i].pad == p && !hit[i] && t <= touches[i].off + touches[i].rampOut) match = i;
+        }
+        if (match >= 0) {
+          hit[match] = 1;
+          r.onMs += t - touches[match].on;
+          r.onCount++;
+        } else {
+          r.falseTouches[p]++;
+        }
+        active[p] = match;
+      } else if (!touched && state[p] && active[p] >= 0) {
+        const Touch& k = touches[active[p]];
+        r.offMs += t > k.off ? t - k.off : k.off - t;
+        r.offCount++;
+      }
+      state[p] = touched;
+    }
+    t += 2 + rng() % 3;
+  }
+  for (size_t i = 0; i < touches.size(); i++) {
+    if (!hit[i]) r.missed[touches[i].pad]++;
+  }
+  for (int p = 0; p < PADS; p++) r.threshold[p] = pads[p].getTouchOnThreshold();
+  return r;
+}
+
+int main() {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+
+  // The player: single touches and chords of two neighbours, taps to long holds
+  std::vector<Touch> touches;
+  int played[PADS] = {};
+  for (long t = 1000; t < MS - 3000;) {
+    int pad = rng() % PADS;
+    int count = (u(rng) < 0.2 && pad < PADS - 1) ? 2 : 1;
+    long hold = u(rng) < 0.3 ? 40 + (long)(u(rng) * 60) : 150 + (long)(u(rng) * 1500);
+    for (int c = 0; c < count; c++) {
+      Touch k;
+      k.pad = pad + c;
+      k.on = t + c * (long)(u(rng) * 30);
+      k.off = k.on + hold;
+      k.pressure = 0.5 + 0.5 * u(rng);
+      k.rampIn = 5 + (long)(u(rng) * 15);
+      k.rampOut = 5 + (long)(u(rng) * 15);
+      touches.push_back(k);
+      played[k.pad]++;
+    }
+    t += hold + 300 + (long)(u(rng) * 1200);
+  }
+  std::stable_sort(touches.begin(), touches.end(), [](const Touch& a, const Touch& b) { return a.on < b.on; });
+
+  printf("%zu touches on %d pads, read every 2-4 ms\n\n", touches.size(), PADS);
+  const Setting settings[] = {
+    {"fixed 22/16, debounce 4", 22, 16, 4, false},
+    {"fixed 22/16, debounce 1", 22, 16, 1, false},
+    {"adaptive", 22, 16, 1, true},
+  };
+  Result results[3];
+  for (int i = 0; i < 3; i++) results[i] = run(touches, settings[i]);
+
+  printf("                          signal noise   ");
+  for (const Setting& s : settings) printf("  %-24s", s.name);
+  printf("\n                                         ");
+  for (int i = 0; i < 3; i++) printf("  false missed  thr        ");
+  printf("\n");
+  int totalFalse[3] = {}, totalMissed[3] = {};
+  for (int p = 0; p < PADS; p++) {
+    printf("  %d %-20s %5.0f %5.1f   ", p, PAD[p].name, PAD[p].signal, PAD[p].noiseSd);
+    for (int i = 0; i < 3; i++) {
+      printf("  %5d %4d/%-3d %3d        ", results[i].falseTouches[p], results[i].missed[p], played[p],
+             results[i].threshold[p]);
+      totalFalse[i] += results[i].falseTouches[p];
+      totalMissed[i] += results[i].missed[p];
+    }
+    printf("\n");
+  }
+  printf("\n  %-37s", "total false / missed");
+  for (int i = 0; i < 3; i++) printf("  %5d %4d            ", totalFalse[i], totalMissed[i]);
+  printf("\n  %-37s", "mean latency on / off (ms)");
+  for (int i = 0; i < 3; i++) {
+    printf("  %5.1f %5.1f             ", results[i].onCount ? results[i].onMs / results[i].onCount : 0,
+           results[i].offCount ? results[i].offMs / results[i].offCount : 0);
+  }
+  printf("\n");
+  return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * velocity_keys_bench.cpp - host benchmark for MultiControlVelocityKeys.
+ *
+ * Simulates a 61-key dual-contact keybed played with random chords and runs, with
+ * contact intervals spread across the whole velocity range, scanned every 250 us.
+ * Reports the decode cost per scan (most scans see no contact change) and how far the measured velocities are from the
+ * velocities of the true contact intervals (the scan interval is the only error source).
+ *
+ * Build and run:
+ *   g++ -O2 -I../replay -I../.. velocity_keys_bench.cpp -o velocity_keys_bench && ./velocity_keys_bench
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "MultiControl.h"
+#include "MultiControlKeys.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+const int KEYS = 61;
+const uint32_t SCAN_US = 250;
+const uint32_t DURATION_US = 120000000;  // two minutes of playing
+
+struct Key {
+  uint32_t firstOn, secondOn, secondOff, firstOff;  // contact times of the current stroke
+  uint32_t next;                                     // start of the next stroke
+};
+
+double seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void run(uint8_t bits) {
+  std::mt19937 rng(61);
+  std::uniform_real_distribution<double> logInterval(logf(1000.0f), logf(100000.0f));
+  std::vector<Key> keys(KEYS);
+  MultiControlVelocityKeys bed;
+  bed.setVelocityBits(bits);
+  MultiControlVelocityKeys reference;  // to compute the ideal velocity of each true interval
+  reference.setVelocityBits(bits);
+  for (int k = 0; k < KEYS; k++) keys[k] = {0, 0, 0, 0, 1000 + (uint32_t)(rng() % 2000000)};
+  std::vector<uint16_t> idealOn(KEYS), idealOff(KEYS);
+  double errSum = 0, errMax = 0;
+  long events = 0, expected = 0;
+  double busy = 0;
+  std::vector<float> times;
+  long scans = 0;
+  for (uint32_t now = 0; now < DURATION_US; now += SCAN_US) {
+    uint64_t first = 0, second = 0;
+    for (int k = 0; k < KEYS; k++) {
+      Key& s = keys[k];
+      if (now >= s.next) {
+        // Start a stroke: press interval, hold, release interval
+        uint32_t pressUs = (uint32_t)exp(logInterval(rng));
+        uint32_t releaseUs = (uint32_t)exp(logInterval(rng));
+        s.firstOn = now + rng() % SCAN_US;
+        s.secondOn = s.firstOn + pressUs;
+        s.secondOff = s.secondOn + 20000 + rng() % 400000;
+        s.firstOff = s.secondOff + releaseUs;
+        s.next = s.firstOff + 5000 + rng() % 3000000;
+        idealOn[k] = reference.velocityFor(pressUs);
+        idealOff[k] = reference.velocityFor(releaseUs);
+        expected += 2;
+      }
+      if (now >= s.firstOn && now < s.firstOff) first |= 1ULL << k;
+      if (now >= s.secondOn && now < s.secondOff) second |= 1ULL << k;
+    }
+    double t0 = seconds();
+    bed.update(first, second, now);
+    double dt = seconds() - t0;
+    busy += dt;
+    times.push_back(dt);
+    scans++;
+    MultiControlKeyEvent e;
+    while (bed.readEvent(e)) {
+      uint16_t ideal = e.on ? idealOn[e.key] : idealOff[e.key];
+      double err = fabs((double)e.velocity - ideal);
+      errSum += err;
+      if (err > errMax) errMax = err;
+      events++;
+    }
+  }
+  std::sort(times.begin(), times.end());
+  double p99 = times[times.size() * 99 / 100];
+  printf("%2d-bit: %ld scans, %ld/%ld events, %.0f ns mean / %.0f ns p99 per scan, "
+         "velocity error mean %.2f max %.0f (of %d)\n",
+         bits, scans, events, expected, busy * 1e9 / scans, p99 * 1e9, errSum / events, errMax, bits >= 14 ? 16383 : 127);
+}
+
+int main() {
+  printf("%d keys scanned every %u us; strokes still under way at the end are not counted\n", KEYS, SCAN_US);
+  run(7);
+  run(14);
+  return 0;
+}
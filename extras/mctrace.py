@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+mctrace.py - convert a MultiControl latency trace to Chrome trace JSON.
+
+Capture the trace on the device with MULTICONTROL_TRACE defined and
+multiControlTraceDump(Serial), save the binary stream to a file, then run:
+
+    python3 mctrace.py trace.bin -o trace.json
+
+Open trace.json in chrome://tracing or https://ui.perfetto.dev. Per-control
+latency histograms (raw -> state, state -> consume, raw -> consume) are printed
+to stdout.
+"""
+
+import argparse
+import json
+import struct
+import sys
+from collections import defaultdict
+
+RAW, STATE, CONSUME, GESTURE = 0, 1, 2, 3
+KIND_NAMES = {RAW: "raw", STATE: "state", CONSUME: "consume", GESTURE: "gesture"}
+EVENT_NAMES = {1: "single", 2: "double", 3: "hold", 4: "long"}
+
+
+def read_trace(data):
+    """Return a list of (micros, id, kind, value) records from a dump."""
+    offset = data.find(b"MCTR")
+    if offset < 0:
+        raise ValueError("no MCTR header found")
+    version, _, count = struct.unpack_from("<BBH", data, offset + 4)
+    if version != 1:
+        raise ValueError("unsupported trace version %d" % version)
+    records = []
+    pos = offset + 8
+    for _ in range(count):
+        if pos + 8 > len(data):
+            break  # truncated capture
+        records.append(struct.unpack_from("<IBBh", data, pos))
+        pos += 8
+    return unwrap(records)
+
+
+def unwrap(records):
+    """Extend 32-bit micros() across wrap-around so timestamps increase."""
+    out = []
+    base = 0
+    prev = None
+    for t, cid, kind, value in records:
+        if prev is not None and t < prev and prev - t > 0x80000000:
+            base += 1 << 32
+        prev = t
+        out.append((t + base, cid, kind, value))
+    return out
+
+
+def latencies(records):
+    """Pair each raw change with the state flip and consume that follow it, per control."""
+    spans = defaultdict(lambda: {"debounce": [], "app": [], "total": []})
+    pending = {}
+    chrome = []
+    for t, cid, kind, value in records:
+        p = pending.setdefault(cid, {"raw": None, "state": None})
+        if kind == RAW:
+            if p["raw"] is None or p["state"] is not None:
+                p["raw"], p["state"] = t, None
+        elif kind == STATE:
+            if p["raw"] is not None and p["state"] is None:
+                spans[cid]["debounce"].append(t - p["raw"])
+                chrome.append(span(cid, "debounce", p["raw"], t))
+            if p["state"] is None:
+                p["state"] = t
+        elif kind in (CONSUME, GESTURE) and p["state"] is not None:
+            spans[cid]["app"].append(t - p["state"])
+            chrome.append(span(cid, "app", p["state"], t))
+            if p["raw"] is not None:
+                spans[cid]["total"].append(t - p["raw"])
+            p["raw"], p["state"] = None, None
+    return spans, chrome
+
+
+def span(cid, name, start, end):
+    return {"name": name, "ph": "X", "pid": 0, "tid": cid, "ts": start, "dur": end - start}
+
+
+def histogram(values, buckets=(100, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000)):
+    counts = [0] * (len(buckets) + 1)
+    for v in values:
+        for i, b in enumerate(buckets):
+            if v < b:
+                counts[i] += 1
+                break
+        else:
+            counts[-1] += 1
+    labels = ["<%gms" % (b / 1000.0) for b in buckets] + [">=%gms" % (buckets[-1] / 1000.0)]
+    return list(zip(labels, counts))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("trace", help="binary dump from multiControlTraceDump()")
+    parser.add_argument("-o", "--output", default="trace.json", help="Chrome trace JSON output")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f:
+        records = read_trace(f.read())
+    spans, chrome = latencies(records)
+
+    events = []
+    for t, cid, kind, value in records:
+        name = KIND_NAMES.get(kind, str(kind))
+        if kind == GESTURE:
+            name = EVENT_NAMES.get(value, name)
+        events.append({"name": name, "ph": "i", "s": "t", "pid": 0, "tid": cid, "ts": t, "args": {"value": value}})
+    for cid in sorted({r[1] for r in records}):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": cid, "args": {"name": "control %d" % cid}})
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": events + chrome, "displayTimeUnit": "ms"}, f)
+
+    print("%d records, %d controls -> %s" % (len(records), len(spans), args.output))
+    for cid in sorted(spans):
+        print("\ncontrol %d" % cid)
+        for stage in ("debounce", "app", "total"):
+            values = spans[cid][stage]
+            if not values:
+                continue
+            values.sort()
+            print("  %-8s n=%-5d median %.2fms  max %.2fms" % (
+                stage, len(values), values[len(values) // 2] / 1000.0, values[-1] / 1000.0))
+            print("           " + "  ".join("%s:%d" % (label, n) for label, n in histogram(values) if n))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
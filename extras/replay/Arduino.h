@@ -0,0 +1,84 @@
+/*
+ * Minimal Arduino API for building MultiControl on a desktop host, for replaying
+ * captures (see mcreplay.cpp) and for host tools and benchmarks. Reads return the
+ * host* input arrays below; with MULTICONTROL_CAPTURE defined and a MultiControlReplay
+ * installed, the library reads the capture instead.
+ */
+
+#ifndef MULTICONTROL_HOST_ARDUINO_H_
+#define MULTICONTROL_HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define OUTPUT_OPEN_DRAIN 0x13
+#define INPUT_PULLUP 0x05
+#define LOW 0
+#define HIGH 1
+#define ADC_11db 3
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+// Host clock and input levels, set by the tool. Define them once with MULTICONTROL_HOST_GLOBALS.
+// Tools replaying on several threads (MULTICONTROL_REPLAY_THREADS) get a clock and outputs
+// per thread, as delay(), delayMicroseconds() and digitalWrite() change them.
+#ifdef MULTICONTROL_REPLAY_THREADS
+#define MULTICONTROL_HOST_THREAD thread_local
+#else
+#define MULTICONTROL_HOST_THREAD
+#endif
+extern MULTICONTROL_HOST_THREAD unsigned long hostMicros;
+extern int hostDigital[64];
+extern int hostAnalog[64];
+extern uint32_t hostTouch[64];
+// Output levels and the number of digitalWrite() calls, and optional digitalRead() and analogRead()
+// overrides for simulating hardware that depends on outputs (e.g. a mux's select lines) or time
+// (e.g. ADC noise that differs between samples)
+extern MULTICONTROL_HOST_THREAD int hostOutput[64];
+extern MULTICONTROL_HOST_THREAD unsigned long hostWrites;
+extern int (*hostDigitalReadHook)(uint8_t pin);
+extern int (*hostAnalogReadHook)(uint8_t pin);
+#define MULTICONTROL_HOST_GLOBALS \
+  MULTICONTROL_HOST_THREAD unsigned long hostMicros = 0; \
+  int hostDigital[64]; \
+  int hostAnalog[64]; \
+  uint32_t hostTouch[64]; \
+  MULTICONTROL_HOST_THREAD int hostOutput[64]; \
+  MULTICONTROL_HOST_THREAD unsigned long hostWrites = 0; \
+  int (*hostDigitalReadHook)(uint8_t pin) = nullptr; \
+  int (*hostAnalogReadHook)(uint8_t pin) = nullptr;
+
+inline unsigned long millis() { return hostMicros / 1000; }
+inline unsigned long micros() { return hostMicros; }
+inline void delay(unsigned long ms) { hostMicros += ms * 1000; }
+inline void delayMicroseconds(unsigned int us) { hostMicros += us; }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+  hostOutput[pin & 63] = level;
+  hostWrites++;
+}
+inline int digitalRead(uint8_t pin) { return hostDigitalReadHook ? hostDigitalReadHook(pin) : hostDigital[pin & 63]; }
+inline int analogRead(uint8_t pin) { return hostAnalogReadHook ? hostAnalogReadHook(pin) : hostAnalog[pin & 63]; }
+inline void analogSetPinAttenuation(uint8_t, int) {}
+inline uint32_t touchRead(uint8_t pin) { return hostTouch[pin & 63]; }
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+      for (size_t i = 0; i < size; i++) write(buffer[i]);
+      return size;
+    }
+};
+
+#endif /* MULTICONTROL_HOST_ARDUINO_H_ */
@@ -0,0 +1,69 @@
+/*
+ * mcreplay.cpp - replay a MultiControl raw capture on a desktop host.
+ *
+ * Memory-maps a capture made with MultiControlCapture and runs it through the
+ * unmodified library, one scan per frame, as fast as the host allows. The outputs
+ * of every scan are printed, so replaying the same capture before and after a library
+ * change and diffing the two outputs shows exactly what behaviour changed.
+ *
+ * Build (add -DESP32 -DCONFIG_IDF_TARGET_ESP32 or -DCONFIG_IDF_TARGET_ESP32S3 to
+ * replay touch pads with the matching chip's touch handling):
+ *   g++ -O2 -DMULTICONTROL_CAPTURE -I. -I../.. mcreplay.cpp -o mcreplay
+ * Run:
+ *   ./mcreplay capture.bin > outputs.txt
+ *
+ * Edit panel.h to describe the panel the capture was made on.
+ */
+
+#include "Arduino.h"
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "MultiControl.h"
+#include "panel.h"
+
+MULTICONTROL_HOST_GLOBALS
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s capture.bin\n", argv[0]);
+    return 1;
+  }
+  int fd = open(argv[1], O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+    perror(argv[1]);
+    return 1;
+  }
+  const uint8_t* data = (const uint8_t*)mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  static MultiControlReplay replay(data, st.st_size);
+  if (!replay.isValid()) {
+    fprintf(stderr, "%s: not a MultiControl capture\n", argv[1]);
+    return 1;
+  }
+  multiControlReplaySource = &replay;
+  unsigned long start = replay.micros();
+  panelSetup();
+
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  while (replay.nextFrame()) {
+    hostMicros = replay.micros();
+    panelScan(stdout, replay.millis());
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+  double captured = (replay.micros() - start) * 1e-6;
+  fprintf(stderr, "%u frames, %.1f s captured, replayed in %.3f s (%.0fx real time)\n",
+          replay.getFrameCount(), captured, wall, wall > 0 ? captured / wall : 0.0);
+  munmap((void*)data, st.st_size);
+  close(fd);
+  return 0;
+}
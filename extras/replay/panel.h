@@ -0,0 +1,42 @@
+/*
+ * Panel description for mcreplay.cpp.
+ * Edit this to match the sketch the capture was made with: the same controls,
+ * set up the same way, read in the same order each scan.
+ */
+
+#ifndef MULTICONTROL_REPLAY_PANEL_H_
+#define MULTICONTROL_REPLAY_PANEL_H_
+
+const int NUM_POTS = 4;
+const int POT_PINS[NUM_POTS] = {1, 2, 3, 4};
+const int TOUCH_PIN = 8;
+const int BUTTON_PIN = 13;
+
+MultiControl pots[NUM_POTS];
+MultiControl touchPad;
+MultiControl button;
+
+void panelSetup() {
+  for (int i = 0; i < NUM_POTS; i++) {
+    pots[i].setPin(POT_PINS[i]);
+    pots[i].setControl(1);
+  }
+  touchPad.setPin(TOUCH_PIN);
+  touchPad.setControl(0);
+  button.setPin(BUTTON_PIN);
+  button.setControl(2);
+}
+
+/* One scan. Print every output so two replays can be diffed line by line. */
+void panelScan(FILE* out, unsigned long now) {
+  fprintf(out, "%lu", now);
+  for (int i = 0; i < NUM_POTS; i++) fprintf(out, " p%d=%d", i, pots[i].readPot());
+  fprintf(out, " t=%d/%d", touchPad.readTouch(), (int)touchPad.isTouched());
+  fprintf(out, " b=%d", (int)button.isPressed());
+  if (button.wasSingleClicked()) fprintf(out, " click");
+  if (button.isDoubleClicked()) fprintf(out, " double");
+  if (button.isHeld()) fprintf(out, " hold");
+  fprintf(out, "\n");
+}
+
+#endif /* MULTICONTROL_REPLAY_PANEL_H_ */
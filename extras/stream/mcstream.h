@@ -0,0 +1,237 @@
+/*
+ * mcstream.h - host decoder for the MultiControlStream binary state stream.
+ *
+ * Plain C++ with no Arduino dependencies, for desktop editors and tools. Feed it the bytes
+ * read from the serial port in any chunk sizes; it finds frames, checks their CRC and
+ * sequence number, keeps a table of every control's state and queues the changes.
+ * After a damaged or missing frame the table is marked out of sync until the next
+ * snapshot: send the panel a request (see the MultiControl_Stream example).
+ * See MultiControlStream.h for the frame format.
+ *
+ *   McStreamDecoder decoder;
+ *   decoder.feed(bytes, count);
+ *   McStreamChange change;
+ *   while (decoder.readChange(change)) { ... }
+ *   int value = decoder.control(3).value;
+ */
+
+#ifndef MCSTREAM_H_
+#define MCSTREAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include <vector>
+
+#define MCSTREAM_SYNC 0xA5
+#define MCSTREAM_SNAPSHOT 0x01
+#define MCSTREAM_DELTA 0x02
+#define MCSTREAM_MAX_FRAME 1024  // longer length fields are taken as noise
+
+// Gesture bits, as MC_GESTURE_* in MultiControl.h
+#define MCSTREAM_PRESS 0x01
+#define MCSTREAM_RELEASE 0x02
+#define MCSTREAM_DOUBLE 0x04
+#define MCSTREAM_SINGLE 0x08
+#define MCSTREAM_HOLD 0x10
+#define MCSTREAM_LONG 0x20
+#define MCSTREAM_PROVISIONAL 0x40
+#define MCSTREAM_CANCEL 0x80
+
+/** The state of one control as last reported */
+struct McStreamControl {
+  uint8_t type = 0;    // 0 touch, 1 pot, 2 button, 3 switch, 4 mux button, 5 encoder, 6 scanned key
+  int32_t value = 0;   // encoder position, otherwise the current bank value (buttons: 0 = pressed)
+  int8_t latch = 0;    // 0, or the latch code -1, -2, -4 or -5
+  uint32_t bank = 0;
+};
+
+/** One reported change */
+struct McStreamChange {
+  const static uint8_t VALUE = 0;
+  const static uint8_t GESTURES = 1;
+  const static uint8_t LATCH = 2;
+  const static uint8_t BANK = 3;
+  uint8_t kind;     // VALUE, GESTURES, LATCH or BANK
+  uint8_t index;    // control index in the stream
+  int32_t value;    // new value, gesture bits, latch code or bank
+  uint64_t timeMs;  // panel time, ms since the first frame
+};
+
+class McStreamDecoder {
+  public:
+    /** Decode a chunk of received bytes. Frames may be split across chunks. */
+    void feed(const uint8_t* data, size_t len) {
+      _bytes += len;
+      _buf.insert(_buf.end(), data, data + len);
+      size_t pos = 0;
+      while (true) {
+        // Find the sync byte
+        while (pos < _buf.size() && _buf[pos] != MCSTREAM_SYNC) {
+          pos++;
+          _skipped++;
+        }
+        if (pos >= _buf.size()) break;
+        // Length
+        size_t p = pos + 1;
+        uint32_t body = 0;
+        int shift = 0;
+        bool complete = false;
+        while (p < _buf.size() && shift < 21) {
+          uint8_t b = _buf[p++];
+          body |= (uint32_t)(b & 0x7F) << shift;
+          shift += 7;
+          if (!(b & 0x80)) {
+            complete = true;
+            break;
+          }
+        }
+        if (!complete && shift < 21) break;  // wait for more bytes
+        if (!complete || body < 3 || body > MCSTREAM_MAX_FRAME) {
+          pos++;  // not a frame start
+          _skipped++;
+          continue;
+        }
+        size_t end = p + body + 2;
+        if (end > _buf.size()) break;  // wait for the rest of the frame
+        uint16_t crc = crc16(0xFFFF, &_buf[pos + 1], end - 2 - (pos + 1));
+        uint16_t sent = _buf[end - 2] | (_buf[end - 1] << 8);
+        if (crc != sent) {
+          _crcErrors++;
+          _synced = false;
+          pos++;
+          _skipped++;
+          continue;
+        }
+        frame(&_buf[p], body);
+        pos = end;
+      }
+      _buf.erase(_buf.begin(), _buf.begin() + pos);
+    }
+
+    /** Get the next change, oldest first. @return false if there are none */
+    bool readChange(McStreamChange& change) {
+      if (_changes.empty()) return false;
+      change = _changes.front();
+      _changes.pop_front();
+      return true;
+    }
+
+    /** Keep changes queued for readChange() (default true). Turn off to only track state. */
+    void setQueueChanges(bool queue) { _queue = queue; }
+
+    /** The state of a control */
+    const McStreamControl& control(size_t index) const { return _controls[index]; }
+
+    /** Number of controls in the last snapshot */
+    size_t controlCount() const { return _controls.size(); }
+
+    /** true once a snapshot arrived and no frame has been lost or damaged since */
+    bool isSynced() const { return _synced; }
+
+    uint64_t frames() const { return _frames; }
+    uint64_t snapshots() const { return _snapshots; }
+    uint64_t bytes() const { return _bytes; }
+    uint64_t crcErrors() const { return _crcErrors; }
+    uint64_t lostFrames() const { return _lost; }
+    uint64_t skippedBytes() const { return _skipped; }
+
+  private:
+    std::vector<uint8_t> _buf;
+    std::vector<McStreamControl> _controls;
+    std::deque<McStreamChange> _changes;
+    bool _queue = true;
+    bool _synced = false;
+    bool _haveSeq = false;
+    uint8_t _nextSeq = 0;
+    uint64_t _time = 0;
+    uint64_t _frames = 0;
+    uint64_t _snapshots = 0;
+    uint64_t _bytes = 0;
+    uint64_t _crcErrors = 0;
+    uint64_t _lost = 0;
+    uint64_t _skipped = 0;
+
+    void frame(const uint8_t* b, size_t len) {
+      size_t p = 0;
+      uint8_t type = b[p++];
+      uint8_t seq = b[p++];
+      if (_haveSeq && seq != _nextSeq) {
+        _lost += (uint8_t)(seq - _nextSeq);
+        _synced = false;
+      }
+      _haveSeq = true;
+      _nextSeq = seq + 1;
+      _time += varint(b, len, p);
+      _frames++;
+      if (type == MCSTREAM_SNAPSHOT) {
+        if (p + 3 > len) return;
+        uint8_t total = b[p++];
+        uint8_t first = b[p++];
+        uint8_t count = b[p++];
+        _controls.resize(total);
+        for (uint8_t i = first; i < first + count && i < total && p < len; i++) {
+          McStreamControl& c = _controls[i];
+          c.type = b[p++];
+          c.value = unzigzag(varint(b, len, p));
+          c.latch = p < len ? (int8_t)b[p++] : 0;
+          c.bank = varint(b, len, p);
+        }
+        if (first + count >= total) {
+          _snapshots++;
+          _synced = true;
+        }
+      } else if (type == MCSTREAM_DELTA) {
+        while (p < len) {
+          uint8_t head = b[p++];
+          uint8_t kind = head >> 6;
+          uint8_t index = head & 0x3F;
+          int32_t v = 0;
+          if (kind == McStreamChange::VALUE) {
+            v = unzigzag(varint(b, len, p));
+          } else if (kind == McStreamChange::BANK) {
+            v = varint(b, len, p);
+          } else if (p < len) {
+            v = (kind == McStreamChange::LATCH) ? (int8_t)b[p] : b[p];
+            p++;
+          }
+          if (index >= _controls.size()) continue;  // no snapshot yet
+          McStreamControl& c = _controls[index];
+          if (kind == McStreamChange::VALUE) v = c.value += v;
+          else if (kind == McStreamChange::LATCH) c.latch = v;
+          else if (kind == McStreamChange::BANK) c.bank = v;
+          if (_queue) _changes.push_back({kind, index, v, _time});
+        }
+      }
+    }
+
+    static uint32_t varint(const uint8_t* b, size_t len, size_t& p) {
+      uint32_t v = 0;
+      for (int shift = 0; p < len && shift < 35; shift += 7) {
+        uint8_t x = b[p++];
+        v |= (uint32_t)(x & 0x7F) << shift;
+        if (!(x & 0x80)) break;
+      }
+      return v;
+    }
+
+    static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    /* CRC-16/CCITT (polynomial 0x1021), a byte at a time */
+    static uint16_t crc16(uint16_t crc, const uint8_t* data, size_t len) {
+      static uint16_t table[256];
+      static bool ready = false;
+      if (!ready) {
+        for (int n = 0; n < 256; n++) {
+          uint16_t c = n << 8;
+          for (int k = 0; k < 8; k++) c = (c & 0x8000) ? (c << 1) ^ 0x1021 : c << 1;
+          table[n] = c;
+        }
+        ready = true;
+      }
+      for (size_t i = 0; i < len; i++) crc = (crc << 8) ^ table[(crc >> 8) ^ data[i]];
+      return crc;
+    }
+};
+
+#endif /* MCSTREAM_H_ */